@@ -494,7 +494,8 @@ AggregateColumn::AggOp AggregateColumn::agname2num(const string& agname)
 		BIT_AND,
 		BIT_OR,
 		BIT_XOR,
-		GROUP_CONCAT
+		GROUP_CONCAT,
+		APPROX_COUNT_DISTINCT
 */
 	string lfn(agname);
 	algorithm::to_lower(lfn);
@@ -524,6 +525,8 @@ AggregateColumn::AggOp AggregateColumn::agname2num(const string& agname)
 		return VAR_SAMP;
 	if (lfn == "variance")
 		return VAR_POP;
+	if (lfn == "approx_count_distinct")
+		return APPROX_COUNT_DISTINCT;
 	return NOOP;
 }
 
@@ -367,6 +367,12 @@ boost::mutex CalpontSystemCatalog::map_mutex;
 CalpontSystemCatalog::CatalogMap CalpontSystemCatalog::fCatalogMap;
 /*static*/
 uint32_t CalpontSystemCatalog::fModuleID = numeric_limits<uint32_t>::max();
+/*static*/
+bool CalpontSystemCatalog::fShareCaches = false;
+/*static*/
+boost::mutex CalpontSystemCatalog::fTemplateLock;
+/*static*/
+boost::shared_ptr<CalpontSystemCatalog::CacheTemplate> CalpontSystemCatalog::fTemplate;
 
 const CalpontSystemCatalog::OID CalpontSystemCatalog::lookupOID(const TableColName& tableColName)
 {
@@ -1672,6 +1678,13 @@ boost::shared_ptr<CalpontSystemCatalog> CalpontSystemCatalog::makeCalpontSystemC
         instance.reset(new CalpontSystemCatalog());
         instance->sessionID(sessionID);
 	    instance->fExeMgr->setSessionId(sessionID);
+        if (fShareCaches)
+        {
+            // start from what earlier sessions already looked up
+            boost::mutex::scoped_lock tlk(fTemplateLock);
+            if (fTemplate && fTemplate->scn == instance->fSyscatSCN)
+                instance->copyFromTemplate(*fTemplate);
+        }
         fCatalogMap[sessionID] = instance;
         return instance;
     }
@@ -1684,7 +1697,24 @@ void CalpontSystemCatalog::removeCalpontSystemCatalog(uint32_t sessionID)
 {
     boost::mutex::scoped_lock lock(map_mutex);
     DEBUG << "remove calpont system catalog for session " << sessionID << endl;
-	fCatalogMap.erase(sessionID);
+	CatalogMap::iterator it = fCatalogMap.find(sessionID);
+	if (fShareCaches && sessionID != 0 && it != fCatalogMap.end())
+	{
+		// keep what this session looked up for the ones that follow. An
+		// instance at an older syscat version has nothing worth keeping.
+		CalpontSystemCatalog& csc = *it->second;
+		boost::mutex::scoped_lock sysCatLk(csc.fSyscatSCNLock);
+		boost::mutex::scoped_lock tlk(fTemplateLock);
+		if (!fTemplate || fTemplate->scn < csc.fSyscatSCN)
+		{
+			fTemplate.reset(new CacheTemplate());
+			fTemplate->scn = csc.fSyscatSCN;
+		}
+		if (fTemplate->scn == csc.fSyscatSCN)
+			csc.copyToTemplate(*fTemplate);
+	}
+	if (it != fCatalogMap.end())
+		fCatalogMap.erase(it);
 /*
     CatalogMap::iterator it = fCatalogMap.find(sessionID);
     if (it != fCatalogMap.end())
@@ -1695,6 +1725,66 @@ void CalpontSystemCatalog::removeCalpontSystemCatalog(uint32_t sessionID)
 */
 }
 
+/* static */
+void CalpontSystemCatalog::shareSessionCaches(bool share)
+{
+	boost::mutex::scoped_lock lk(fTemplateLock);
+	fShareCaches = share;
+	if (!share)
+		fTemplate.reset();
+}
+
+void CalpontSystemCatalog::copyFromTemplate(const CacheTemplate& t)
+{
+	// map::insert() leaves the entries this instance built for itself alone
+	boost::mutex::scoped_lock lk1(fOIDmapLock);
+	fOIDmap.insert(t.oidMap.begin(), t.oidMap.end());
+	fColRIDmap.insert(t.colRIDMap.begin(), t.colRIDMap.end());
+	lk1.unlock();
+
+	boost::mutex::scoped_lock lk2(fColinfomapLock);
+	fColinfomap.insert(t.colinfoMap.begin(), t.colinfoMap.end());
+	lk2.unlock();
+
+	boost::mutex::scoped_lock lk3(fTableInfoMapLock);
+	fTablemap.insert(t.tableMap.begin(), t.tableMap.end());
+	fTableRIDmap.insert(t.tableRIDMap.begin(), t.tableRIDMap.end());
+	fTableInfoMap.insert(t.tableInfoMap.begin(), t.tableInfoMap.end());
+	lk3.unlock();
+
+	boost::mutex::scoped_lock lk4(fDctTokenMapLock);
+	fDctTokenMap.insert(t.dctTokenMap.begin(), t.dctTokenMap.end());
+	lk4.unlock();
+
+	boost::mutex::scoped_lock lk5(fTableNameMapLock);
+	fTableNameMap.insert(t.tableNameMap.begin(), t.tableNameMap.end());
+}
+
+void CalpontSystemCatalog::copyToTemplate(CacheTemplate& t)
+{
+	boost::mutex::scoped_lock lk1(fOIDmapLock);
+	t.oidMap.insert(fOIDmap.begin(), fOIDmap.end());
+	t.colRIDMap.insert(fColRIDmap.begin(), fColRIDmap.end());
+	lk1.unlock();
+
+	boost::mutex::scoped_lock lk2(fColinfomapLock);
+	t.colinfoMap.insert(fColinfomap.begin(), fColinfomap.end());
+	lk2.unlock();
+
+	boost::mutex::scoped_lock lk3(fTableInfoMapLock);
+	t.tableMap.insert(fTablemap.begin(), fTablemap.end());
+	t.tableRIDMap.insert(fTableRIDmap.begin(), fTableRIDmap.end());
+	t.tableInfoMap.insert(fTableInfoMap.begin(), fTableInfoMap.end());
+	lk3.unlock();
+
+	boost::mutex::scoped_lock lk4(fDctTokenMapLock);
+	t.dctTokenMap.insert(fDctTokenMap.begin(), fDctTokenMap.end());
+	lk4.unlock();
+
+	boost::mutex::scoped_lock lk5(fTableNameMapLock);
+	t.tableNameMap.insert(fTableNameMap.begin(), fTableNameMap.end());
+}
+
 CalpontSystemCatalog::CalpontSystemCatalog():
     fExeMgr (new ClientRotator(0, "ExeMgr")),
     fSessionID (0)
@@ -753,6 +753,16 @@ public:
 	 *  @param sessionID
 	 */
 	static void removeCalpontSystemCatalog(uint32_t sessionID = 0);
+
+	/** share resolved metadata across sessions
+	 *
+	 *  When on, the caches of a session's instance are merged into a process
+	 *  wide template when the instance is removed, and new session instances
+	 *  start out with a copy of that template. Both ends check the syscat
+	 *  version, so DDL still invalidates everything. Off by default; ExeMgr
+	 *  turns it on.
+	 */
+	static void shareSessionCaches(bool share);
 	/** sessionid access and mutator methods
 	 *
 	 */
@@ -867,6 +877,26 @@ private:
 		TableNameMap fTableNameMap;
 		boost::mutex fTableNameMapLock;
 
+	/** metadata collected from finished sessions at one syscat version */
+	struct CacheTemplate
+	{
+		SCN scn;
+		OIDmap oidMap;
+		ColRIDmap colRIDMap;
+		Tablemap tableMap;
+		TableRIDmap tableRIDMap;
+		Colinfomap colinfoMap;
+		TableInfoMap tableInfoMap;
+		DctTokenMap dctTokenMap;
+		TableNameMap tableNameMap;
+	};
+	void copyFromTemplate(const CacheTemplate& t);
+	void copyToTemplate(CacheTemplate& t);
+
+	static bool fShareCaches;
+	static boost::mutex fTemplateLock;
+	static boost::shared_ptr<CacheTemplate> fTemplate;
+
 	ClientRotator* fExeMgr;
 	uint32_t fSessionID;
 	uint32_t fTxn;
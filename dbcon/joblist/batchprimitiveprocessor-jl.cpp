@@ -45,6 +45,8 @@ using namespace execplan;
 
 #include "bpp-jl.h"
 #include "jlf_common.h"
+#include "jointabledirectory.h"
+#include "hasher.h"
 using namespace messageqcpp;
 using namespace rowgroup;
 using namespace joiner;
@@ -72,12 +74,14 @@ BatchPrimitiveProcessorJL::BatchPrimitiveProcessorJL(const ResourceManager& rm)
 	sendRowGroups(false),
 	valueColumn(0),
 	sendTupleJoinRowGroupData(false),
+	fJoinCacheSize(rm.getHjPmJoinCacheSize()),
 	bop(BOP_AND),
 	forHJ(false),
 	threadCount(1),
 	fJoinerChunkSize(rm.getJlJoinerChunkSize()),
 	hasSmallOuterJoin(false),
-	_priority(1)
+	_priority(1),
+	cacheLBID(0)
 {
     PMJoinerCount = 0;
 	uuid = bu::nil_generator()();
@@ -85,6 +89,7 @@ BatchPrimitiveProcessorJL::BatchPrimitiveProcessorJL(const ResourceManager& rm)
 
 BatchPrimitiveProcessorJL::~BatchPrimitiveProcessorJL()
 {
+	releaseJoinTables(false);
 }
 
 void BatchPrimitiveProcessorJL::addFilterStep(const pColScanStep &scan, vector<BRM::LBID_t> lastScannedLBID)
@@ -650,6 +655,9 @@ bool BatchPrimitiveProcessorJL::countThisMsg(messageqcpp::ByteStream &in) const
 	const uint8_t *data = in.buf();
 	uint32_t offset = sizeof(ISMPacketHeader) + sizeof(PrimitiveHeader); // skip the headers
 
+	if (((const ISMPacketHeader *) data)->Command == JOIN_TABLE_NAK)
+		return false;
+
 	if (_hasScan)
 	{
 		if (data[offset] != 0)
@@ -678,7 +686,7 @@ void BatchPrimitiveProcessorJL::deserializeAggregateResult(ByteStream *in,
 void BatchPrimitiveProcessorJL::getRowGroupData(ByteStream &in, vector<RGData> *out,
 	bool *validCPData, uint64_t *lbid, int64_t *min, int64_t *max,
 	uint32_t *cachedIO, uint32_t *physIO, uint32_t *touchedBlocks, bool *countThis,
-	uint32_t threadID) const
+	BPPProfile *profile, uint32_t threadID) const
 {
 	uint64_t tmp64;
 	uint8_t tmp8;
@@ -697,6 +705,7 @@ void BatchPrimitiveProcessorJL::getRowGroupData(ByteStream &in, vector<RGData> *
 		*cachedIO = 0;
 		*physIO = 0;
 		*touchedBlocks = 0;
+		memset(profile, 0, sizeof(*profile));
 		return;
 	}
 
@@ -769,11 +778,20 @@ void BatchPrimitiveProcessorJL::getRowGroupData(ByteStream &in, vector<RGData> *
 		in >> *cachedIO;
 		in >> *physIO;
 		in >> *touchedBlocks;
+		in >> profile->queueWait;
+		in >> profile->filterTime;
+		in >> profile->joinTime;
+		in >> profile->projectTime;
+		in >> profile->aggTime;
+		in >> profile->cpuTime;
+		in >> profile->rowsIn;
+		in >> profile->rowsOut;
 	}
 	else {
 		*cachedIO = 0;
 		*physIO = 0;
 		*touchedBlocks = 0;
+		memset(profile, 0, sizeof(*profile));
 	}
 
 	idbassert(in.length() == 0);
@@ -806,6 +824,7 @@ void BatchPrimitiveProcessorJL::setLBID(uint64_t l, const BRM::EMEntry &scannedE
 {
 	uint32_t i;
 
+	cacheLBID = l;
 	dbRoot = scannedExtent.dbRoot;
 	baseRid = rowgroup::convertToRid(scannedExtent.partitionNum,
 			scannedExtent.segmentNum,
@@ -970,6 +989,12 @@ void BatchPrimitiveProcessorJL::createBPP(ByteStream &bs) const
 					bs << (uint32_t) tJoiners[i]->getKeyLength();
 				}
 			}
+			for (i = 0; i < PMJoinerCount; i++) {
+				bs << (uint64_t) (joinTableIDs ? joinTableIDs[i] : 0);
+				bs << (uint8_t) joinerCached(i);
+				bs << (uint64_t) (joinTableIDs ? joinTableKeySigs[i] : 0);
+			}
+			serializeVector<uint64_t>(bs, joinTableDrops);
 			if (atLeastOneFE)
 				bs << joinFERG;
 			if (sendTupleJoinRowGroupData) {
@@ -1079,11 +1104,12 @@ fields of every defined header. */
 
 	bs.append((uint8_t *) &ism, sizeof(ism));
 
-	/* The next 4 vars are for BPPSeeder; BPP itself skips them */
+	/* The next 5 vars are for BPPSeeder; BPP itself skips them */
 	bs << sessionID;
 	bs << stepID;
 	bs << uniqueID;
 	bs << _priority;
+	bs << cacheLBID;
 
 	bs << dbRoot;
 	bs << count;
@@ -1192,20 +1218,20 @@ void BatchPrimitiveProcessorJL::useJoiners(const vector<boost::shared_ptr<joiner
 /* This algorithm relies on the joiners being sorted by size atm */
 bool BatchPrimitiveProcessorJL::nextTupleJoinerMsg(ByteStream &bs)
 {
-	uint32_t size = 0, toSend, i, j;
+	uint32_t size = 0;
 	ISMPacketHeader ism;
-	Row r;
 	vector<Row::Pointer> *tSmallSide;
-	joiner::TypelessData tlData;
-	uint32_t smallKeyCol;
-	uint32_t largeKeyCol;
-	uint64_t smallkey;
-	bool isNull;
-	bool bSignedUnsigned;
 
 	memset((void*)&ism, 0, sizeof(ism));
 	tSmallSide = tJoiners[joinerNum]->getSmallSide();
-	size = tSmallSide->size();
+	/* the PMs already have the cached ones; skip over them */
+	size = (joinerCached(joinerNum) ? 0 : tSmallSide->size());
+	while (pos == size && joinerNum < PMJoinerCount-1) {
+		joinerNum++;
+		tSmallSide = tJoiners[joinerNum]->getSmallSide();
+		size = (joinerCached(joinerNum) ? 0 : tSmallSide->size());
+		pos = 0;
+	}
 	if (joinerNum == PMJoinerCount-1 && pos == size) {
 		/* last message */
 // 		cout << "sending last joiner msg\n";
@@ -1217,12 +1243,60 @@ bool BatchPrimitiveProcessorJL::nextTupleJoinerMsg(ByteStream &bs)
 		pos = 0;
 		return false;
 	}
-	else if (pos == size) {
-		joinerNum++;
-		tSmallSide = tJoiners[joinerNum]->getSmallSide();
-		size = tSmallSide->size();
-		pos = 0;
+
+	addJoinerMsg(joinerNum, pos, bs);
+	return true;
+}
+
+/* Another query dropped one of the join tables the PM was to reuse, or the PM had to
+   evict it.  The PM asks for the small side again, to be sent to it alone. */
+void BatchPrimitiveProcessorJL::joinTablesMissing(ByteStream &in, vector<uint32_t> *joiners,
+	uint32_t *connIndex)
+{
+	const ISMPacketHeader *ism = (const ISMPacketHeader *) in.buf();
+
+	idbassert(ism->Command == JOIN_TABLE_NAK);
+	*connIndex = ism->Interleave;
+	in.advance(sizeof(ISMPacketHeader) + sizeof(PrimitiveHeader));
+	deserializeVector<uint32_t>(in, *joiners);
+
+	/* the directory can't be trusted on it anymore */
+	if (!joinTableIDs)
+		return;
+	JoinTableDirectory *dir = JoinTableDirectory::instance(fJoinCacheSize);
+	for (uint32_t i = 0; i < joiners->size(); i++) {
+		uint32_t j = (*joiners)[i];
+		if (j < PMJoinerCount && joinTableIDs[j] != 0) {
+			dir->release(joinTableIDs[j], false);
+			joinTableIDs[j] = 0;
+		}
 	}
+}
+
+bool BatchPrimitiveProcessorJL::resendJoinerMsg(uint32_t joiner, uint32_t &rpos, ByteStream &bs)
+{
+	if (joiner >= PMJoinerCount || rpos >= tJoiners[joiner]->getSmallSide()->size())
+		return false;
+	addJoinerMsg(joiner, rpos, bs);
+	return true;
+}
+
+void BatchPrimitiveProcessorJL::addJoinerMsg(uint32_t joinerNum, uint32_t &pos, ByteStream &bs)
+{
+	uint32_t size, toSend, i, j;
+	ISMPacketHeader ism;
+	Row r;
+	vector<Row::Pointer> *tSmallSide;
+	joiner::TypelessData tlData;
+	uint32_t smallKeyCol;
+	uint32_t largeKeyCol;
+	uint64_t smallkey;
+	bool isNull;
+	bool bSignedUnsigned;
+
+	memset((void*)&ism, 0, sizeof(ism));
+	tSmallSide = tJoiners[joinerNum]->getSmallSide();
+	size = tSmallSide->size();
 
 	ism.Command = BATCH_PRIMITIVE_ADD_JOINER;
 	bs.load((uint8_t *) &ism, sizeof(ism));
@@ -1334,7 +1408,77 @@ bool BatchPrimitiveProcessorJL::nextTupleJoinerMsg(ByteStream &bs)
 	}
 
 	pos += toSend;
-	return true;
+}
+
+void BatchPrimitiveProcessorJL::useJoinTableCache()
+{
+	uint32_t i, j, col;
+	uint64_t fp, bytes, mix[2];
+	vector<uint64_t> sig;
+	bool cached;
+
+	if (fJoinCacheSize == 0 || PMJoinerCount == 0 || joinTableIDs)
+		return;
+
+	JoinTableDirectory *dir = JoinTableDirectory::instance(fJoinCacheSize);
+	joinTableIDs.reset(new uint64_t[PMJoinerCount]);
+	joinTableCached.reset(new bool[PMJoinerCount]);
+	joinTableKeySigs.reset(new uint64_t[PMJoinerCount]);
+	for (i = 0; i < PMJoinerCount; i++) {
+		joinTableIDs[i] = 0;
+		joinTableCached[i] = false;
+		joinTableKeySigs[i] = 0;
+		if (!tJoiners[i]->canonicalizeSmallSide(&fp))
+			continue;
+
+		/* What the keys the PM hashes are made of.  Equal contents under different
+		   key columns, or keys compared signed vs unsigned, give different tables. */
+		sig.clear();
+		sig.push_back(tJoiners[i]->getJoinType());
+		sig.push_back(tJoiners[i]->isTypelessJoin() ? tlKeyLens[i] : 0);
+		sig.push_back(sendTupleJoinRowGroupData);
+		for (j = 0; j < smallSideKeys[i].size(); j++) {
+			col = smallSideKeys[i][j];
+			sig.push_back(col);
+			sig.push_back(smallSideRGs[i].getColTypes()[col]);
+			sig.push_back(smallSideRGs[i].getColumnWidth(col));
+			col = tJoiners[i]->getLargeKeyColumns()[j];
+			sig.push_back(largeSideRG.getColTypes()[col]);
+			sig.push_back(largeSideRG.getColumnWidth(col));
+		}
+		joinTableKeySigs[i] = utils::Hasher128()((const char *) &sig[0],
+			sig.size() * sizeof(uint64_t));
+
+		/* a table stored without its row data can't serve a query that needs it */
+		mix[0] = fp;
+		mix[1] = sendTupleJoinRowGroupData;
+		fp = utils::Hasher128()((const char *) mix, sizeof(mix));
+
+		// a rough guess at the PM's footprint: hash table nodes, keys, row data
+		bytes = tJoiners[i]->size() * (48 + (tJoiners[i]->isTypelessJoin() ? tlKeyLens[i] : 0));
+		if (sendTupleJoinRowGroupData)
+			bytes += tJoiners[i]->size() * smallSideRGs[i].getRowSize();
+
+		joinTableIDs[i] = dir->acquire(fp, tJoiners[i]->size(), joinTableKeySigs[i],
+			bytes, &cached);
+		joinTableCached[i] = cached;
+	}
+	dir->takeDrops(joinTableDrops);
+}
+
+void BatchPrimitiveProcessorJL::releaseJoinTables(bool ok)
+{
+	if (!joinTableIDs)
+		return;
+
+	JoinTableDirectory *dir = JoinTableDirectory::instance(fJoinCacheSize);
+	for (uint32_t i = 0; i < PMJoinerCount; i++)
+		if (joinTableIDs[i] != 0)
+			dir->release(joinTableIDs[i], ok);
+	joinTableIDs.reset();
+	joinTableCached.reset();
+	joinTableKeySigs.reset();
+	joinTableDrops.clear();
 }
 
 void BatchPrimitiveProcessorJL::useJoiner(boost::shared_ptr<joiner::Joiner> j)
@@ -136,7 +136,7 @@ public:
 	void getRowGroupData(messageqcpp::ByteStream &in, std::vector<rowgroup::RGData> *out,
 		bool *validCPData, uint64_t *lbid, int64_t *min, int64_t *max,
 		uint32_t *cachedIO,	uint32_t *physIO, uint32_t *touchedBlocks, bool *countThis,
-		uint32_t threadID) const;
+		BPPProfile *profile, uint32_t threadID) const;
 	void deserializeAggregateResult(messageqcpp::ByteStream *in,
 		std::vector<rowgroup::RGData> *out) const;
 	bool countThisMsg(messageqcpp::ByteStream &in) const;
@@ -167,6 +167,21 @@ public:
 	bool nextTupleJoinerMsg(messageqcpp::ByteStream &);
 // 	void setSmallSideKeyColumn(uint32_t col);
 
+	/* PM join table reuse across queries (HashJoin/PmJoinCacheSize).  Call
+	useJoinTableCache() after useJoiners() and before createBPP(); it decides
+	which small sides the PMs already have and skips sending those.
+	releaseJoinTables() must follow once the query is done with the PMs. */
+	void useJoinTableCache();
+	void releaseJoinTables(bool ok);
+
+	/* A PM that lost a cached table answers the create with a JOIN_TABLE_NAK.
+	joinTablesMissing() reads which joiners it needs and which connection it's on,
+	resendJoinerMsg() gives the ADD_JOINER messages for one of them, starting
+	with pos = 0, until it returns false.  The PM's END_JOINER is already on its way. */
+	void joinTablesMissing(messageqcpp::ByteStream &in, std::vector<uint32_t> *joiners,
+		uint32_t *connIndex);
+	bool resendJoinerMsg(uint32_t joiner, uint32_t &pos, messageqcpp::ByteStream &bs);
+
 	/* OR hacks */
 	void setBOP(uint32_t op);   // BOP_AND or BOP_OR, default is BOP_AND
 	void setForHJ(bool b);  // default is false
@@ -275,6 +290,15 @@ private:
 	bool sendTupleJoinRowGroupData;
 	uint32_t PMJoinerCount;
 
+	/* PM join table cache; ids are 0 for the joiners it doesn't cover */
+	bool joinerCached(uint32_t i) const { return (joinTableCached && joinTableCached[i]); }
+	uint64_t fJoinCacheSize;
+	boost::scoped_array<uint64_t> joinTableIDs;
+	boost::scoped_array<bool> joinTableCached;
+	boost::scoped_array<uint64_t> joinTableKeySigs;
+	std::vector<uint64_t> joinTableDrops;
+	void addJoinerMsg(uint32_t joinerNum, uint32_t &pos, messageqcpp::ByteStream &bs);
+
 	/* OR hack */
 	uint8_t bop;   // BOP_AND or BOP_OR
 	bool    forHJ; // indicate if feeding a hashjoin, doJoin does not cover smallside
@@ -295,6 +319,7 @@ private:
 	bool hasSmallOuterJoin;
 
 	uint32_t _priority;
+	uint64_t cacheLBID;		// a block the next run reads; lets PrimProc pick a NUMA node
 
 	boost::uuids::uuid uuid;
 
@@ -20,13 +20,19 @@
 #include <unistd.h>
 //#define NDEBUG
 #include <cassert>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 using namespace std;
 
 #include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/uuid/uuid_io.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
 using namespace boost;
 
 #include "messagequeue.h"
@@ -40,6 +46,12 @@ using namespace logging;
 
 #include "calpontsystemcatalog.h"
 #include "constantcolumn.h"
+#include "constantfilter.h"
+#include "logicoperator.h"
+#include "parsetree.h"
+#include "pseudocolumn.h"
+#include "simplecolumn.h"
+#include "simplefilter.h"
 using namespace execplan;
 
 #include "rowgroup.h"
@@ -60,10 +72,10 @@ using namespace querytele;
 #include "libdrizzle-2.0/drizzle.h"
 #include "libdrizzle-2.0/drizzle_client.h"
 
-// wrapper for drizzle
-namespace
+namespace joblist
 {
 
+// wrapper for drizzle
 class DrizzleMySQL
 {
 public:
@@ -73,12 +85,14 @@ public:
 	// init:   host          port        username      passwd         db
 	int init(const char*, unsigned int, const char*, const char*, const char*);
 
-	// run the query
+	// run the query, buffering its whole result
 	int run(const char* q);
 
 	int getFieldCount()      { return drizzle_result_column_count(fDrzrp); }
-	int getRowCount()        { return drizzle_result_row_count(fDrzrp); }
+	uint64_t getRowCount()   { return drizzle_result_row_count(fDrzrp); }
 	char** nextRow()   { return drizzle_row_next(fDrzrp); }
+	// doesn't move the result's cursor, so a cached result can be read by several steps
+	char** getRow(uint64_t i) { return drizzle_row_index(fDrzrp, i); }
 	const string& getError() { return fErrStr; }
 
 private:
@@ -148,6 +162,11 @@ int DrizzleMySQL::run(const char* query)
 {
 	int ret = 0;
 	drizzle_return_t drzret;
+	if (fDrzrp)
+	{
+		drizzle_result_free(fDrzrp);
+		fDrzrp = NULL;
+	}
 	fDrzrp = drizzle_query_str(fDrzcp, fDrzrp, query, &drzret);
 	if (drzret == 0 && fDrzrp != NULL)
 	{
@@ -167,6 +186,225 @@ int DrizzleMySQL::run(const char* query)
 	return ret;
 }
 
+}
+
+
+namespace
+{
+using namespace joblist;
+
+// a table whose key range is narrower than this per connection isn't split
+const uint64_t minKeysPerConnection = 64 * 1024;
+
+bool parseInt(const char* s, int64_t& value)
+{
+	char* end;
+	errno = 0;
+	value = strtoll(s, &end, 10);
+	return (end != s && *end == '\0' && errno == 0);
+}
+
+/* Parses [-]digits[.digits] into an integer scaled by scale.  lost is set if nonzero
+   digits past the scale were dropped.  Returns false for anything else, or for more
+   than 18 digits, which are left to the general conversion. */
+bool parseScaled(const char* s, int32_t scale, int64_t& value, bool& lost)
+{
+	bool neg = false;
+	uint64_t v = 0;
+	int32_t digits = 0;
+	int32_t frac = 0;
+
+	if (*s == '-')
+	{
+		neg = true;
+		s++;
+	}
+	if (!isdigit(*s))
+		return false;
+	while (isdigit(*s))
+	{
+		if (++digits > 18)
+			return false;
+		v = v * 10 + (*s++ - '0');
+	}
+
+	lost = false;
+	if (*s == '.')
+	{
+		s++;
+		if (!isdigit(*s))
+			return false;
+		while (isdigit(*s))
+		{
+			if (frac < scale)
+			{
+				if (++digits > 18)
+					return false;
+				v = v * 10 + (*s - '0');
+				frac++;
+			}
+			else if (*s != '0')
+			{
+				lost = true;
+			}
+			s++;
+		}
+	}
+	if (*s != '\0')
+		return false;
+
+	for (; frac < scale; frac++)
+	{
+		if (++digits > 18)
+			return false;
+		v *= 10;
+	}
+
+	value = (neg ? -(int64_t) v : (int64_t) v);
+	return true;
+}
+
+bool parseUnsigned(const char* s, uint64_t& value)
+{
+	uint64_t v = 0;
+	int32_t digits = 0;
+
+	if (!isdigit(*s))
+		return false;
+	while (isdigit(*s))
+	{
+		if (++digits > 19)
+			return false;
+		v = v * 10 + (*s++ - '0');
+	}
+	if (*s != '\0')
+		return false;
+
+	value = v;
+	return true;
+}
+
+// a side of a filter that renders as SQL the foreign engine takes as is
+bool plainOperand(const ReturnedColumn* rc)
+{
+	const ConstantColumn* cc = dynamic_cast<const ConstantColumn*>(rc);
+	if (cc != NULL)
+		return (cc->type() != ConstantColumn::NULLDATA);
+
+	return (dynamic_cast<const SimpleColumn*>(rc) != NULL &&
+			dynamic_cast<const PseudoColumn*>(rc) == NULL);
+}
+
+/* Renders a one-table expression filter as SQL for the foreign engine.  Only the
+   shapes whose text is known to be valid there are rendered: column/constant
+   comparisons, the filters the connector wrote cross-engine text for, and AND/OR of
+   those.  Returns false for anything else. */
+bool filterSql(const ParseTree* n, string& sql)
+{
+	if (n == NULL || n->data() == NULL)
+		return false;
+
+	const LogicOperator* lo = dynamic_cast<const LogicOperator*>(n->data());
+	if (lo != NULL)
+	{
+		string op = algorithm::to_lower_copy(lo->data());
+		string l, r;
+		if ((op != "and" && op != "or") || !filterSql(n->left(), l) || !filterSql(n->right(), r))
+			return false;
+		sql = "(" + l + ") " + op + " (" + r + ")";
+		return true;
+	}
+
+	const SimpleFilter* sf = dynamic_cast<const SimpleFilter*>(n->data());
+	if (sf != NULL)
+	{
+		const string op = sf->op()->data();
+		if (op != "=" && op != "<>" && op != "!=" && op != "<" && op != "<=" &&
+			op != ">" && op != ">=")
+			return false;
+		if (!plainOperand(sf->lhs()) || !plainOperand(sf->rhs()))
+			return false;
+		sql = sf->data();
+		return true;
+	}
+
+	const ConstantFilter* cf = dynamic_cast<const ConstantFilter*>(n->data());
+	if (cf != NULL && !cf->data().empty())
+	{
+		sql = cf->data();
+		return true;
+	}
+
+	return false;
+}
+
+// the top-level conjuncts of a filter tree
+void conjuncts(const ParseTree* n, vector<const ParseTree*>& out)
+{
+	const LogicOperator* lo = (n ? dynamic_cast<const LogicOperator*>(n->data()) : NULL);
+	if (lo != NULL && algorithm::to_lower_copy(lo->data()) == "and")
+	{
+		conjuncts(n->left(), out);
+		conjuncts(n->right(), out);
+	}
+	else if (n != NULL)
+	{
+		out.push_back(n);
+	}
+}
+
+// runs one key range of a split fetch on its own connection
+struct Fetcher
+{
+	Fetcher(DrizzleMySQL* c, const string& h, unsigned int p, const string& u,
+			const string& w, const string& d, const string& q, int* r) :
+		conn(c), query(q), ret(r), host(h), user(u), passwd(w), schema(d), port(p) { }
+
+	void operator()()
+	{
+		try
+		{
+			*ret = conn->init(host.c_str(), port, user.c_str(), passwd.c_str(), schema.c_str());
+			if (*ret == 0)
+				*ret = conn->run(query.c_str());
+		}
+		catch (...)
+		{
+			*ret = -1;
+		}
+	}
+
+	DrizzleMySQL* conn;
+	string query;
+	int* ret;
+	string host, user, passwd, schema;
+	unsigned int port;
+};
+
+// reads the rows of the key ranges in order
+class ResultRows
+{
+public:
+	ResultRows(const vector<boost::shared_ptr<DrizzleMySQL> >& r) :
+		fResults(r), fResult(0), fRow(0) { }
+
+	char** next()
+	{
+		while (fResult < fResults.size())
+		{
+			if (fRow < fResults[fResult]->getRowCount())
+				return fResults[fResult]->getRow(fRow++);
+			fResult++;
+			fRow = 0;
+		}
+		return NULL;
+	}
+
+private:
+	const vector<boost::shared_ptr<DrizzleMySQL> >& fResults;
+	size_t fResult;
+	uint64_t fRow;
+};
 
 }
 
@@ -174,6 +412,17 @@ int DrizzleMySQL::run(const char* query)
 namespace joblist
 {
 
+boost::shared_ptr<CrossEngineCache::Fetch> CrossEngineCache::get(const string& query, bool& owner)
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	boost::shared_ptr<Fetch>& fetch = fFetches[query];
+	owner = !fetch;
+	if (owner)
+		fetch.reset(new Fetch());
+	return fetch;
+}
+
+
 CrossEngineStep::CrossEngineStep(
 	const string& schema,
 	const string& table,
@@ -189,7 +438,10 @@ CrossEngineStep::CrossEngineStep(
 		fSchema(schema),
 		fTable(table),
 		fAlias(alias),
+		fConnections(std::max(jobInfo.rm.getCrossEngineConnections(), 1U)),
+		fCache(jobInfo.crossEngineCache),
 		fColumnCount(0),
+		fFeFiltersPushed(false),
 		fFeInstance(funcexp::FuncExp::instance())
 {
 	fExtendedInfo = "CES: ";
@@ -269,34 +521,191 @@ void CrossEngineStep::makeMappings()
 		}
 
 		fFeMapping1 = makeMapping(fRowGroupFe1, fRowGroupOut);
+		makeConverters(fRowGroupFe1, fFe1Converters);
 	}
 
 	if (!fFeSelects.empty())
 		fFeMapping3 = makeMapping(fRowGroupOut, fRowGroupFe3);
+
+	makeConverters(fRowGroupOut, fConverters);
 }
 
 
-void CrossEngineStep::setField(int i, const char* value, Row& row)
+void CrossEngineStep::makeConverters(const RowGroup& rg, vector<FieldConverter>& converters)
 {
-	CalpontSystemCatalog::ColDataType colType = row.getColType(i);
+	Row row;
+	rg.initRow(&row);
+	converters.resize(row.getColumnCount());
 
-	if ((colType == CalpontSystemCatalog::CHAR || colType == CalpontSystemCatalog::VARCHAR) &&
-		row.getColumnWidth(i) > 8)
+	for (uint32_t i = 0; i < row.getColumnCount(); i++)
 	{
-		if (value != NULL)
-			row.setStringField(value, i);
-		else
-			row.setStringField("", i);
+		FieldConverter& c = converters[i];
+		c.ct.colDataType = row.getColType(i);
+		c.ct.colWidth = row.getColumnWidth(i);
+		c.ct.scale = row.getScale(i);
+		c.ct.precision = row.getPrecision(i);
+		c.nullValue = row.getSignedNullValue(i);
+		c.kind = FieldConverter::GENERIC;
+
+		switch (c.ct.colDataType)
+		{
+			case CalpontSystemCatalog::CHAR:
+			case CalpontSystemCatalog::VARCHAR:
+				if (c.ct.colWidth > 8)
+					c.kind = FieldConverter::STRING;
+				break;
+			case CalpontSystemCatalog::TINYINT:
+				c.kind = FieldConverter::SIGNED;
+				c.minValue = MIN_TINYINT;
+				c.maxValue = MAX_TINYINT;
+				break;
+			case CalpontSystemCatalog::SMALLINT:
+				c.kind = FieldConverter::SIGNED;
+				c.minValue = MIN_SMALLINT;
+				c.maxValue = MAX_SMALLINT;
+				break;
+			case CalpontSystemCatalog::MEDINT:
+			case CalpontSystemCatalog::INT:
+				c.kind = FieldConverter::SIGNED;
+				c.minValue = MIN_INT;
+				c.maxValue = MAX_INT;
+				break;
+			case CalpontSystemCatalog::BIGINT:
+				c.kind = FieldConverter::SIGNED;
+				c.minValue = MIN_BIGINT;
+				c.maxValue = MAX_BIGINT;
+				break;
+			case CalpontSystemCatalog::DECIMAL:
+				if (c.ct.scale < 0 || c.ct.precision < 1 || c.ct.precision > 18)
+					break;
+				c.kind = FieldConverter::SIGNED;
+				c.maxValue = 1;
+				for (int32_t p = 0; p < c.ct.precision; p++)
+					c.maxValue *= 10;
+				c.maxValue -= 1;
+				c.minValue = -c.maxValue;
+				if (c.ct.colWidth == CalpontSystemCatalog::ONE_BYTE)
+				{
+					c.minValue = std::max(c.minValue, MIN_TINYINT);
+					c.maxValue = std::min(c.maxValue, MAX_TINYINT);
+				}
+				else if (c.ct.colWidth == CalpontSystemCatalog::TWO_BYTE)
+				{
+					c.minValue = std::max(c.minValue, MIN_SMALLINT);
+					c.maxValue = std::min(c.maxValue, MAX_SMALLINT);
+				}
+				else if (c.ct.colWidth == CalpontSystemCatalog::FOUR_BYTE)
+				{
+					c.minValue = std::max(c.minValue, MIN_INT);
+					c.maxValue = std::min(c.maxValue, MAX_INT);
+				}
+				else
+				{
+					c.minValue = std::max(c.minValue, MIN_BIGINT);
+				}
+				break;
+			case CalpontSystemCatalog::UTINYINT:
+				c.kind = FieldConverter::UNSIGNED;
+				c.maxUValue = MAX_UTINYINT;
+				break;
+			case CalpontSystemCatalog::USMALLINT:
+				c.kind = FieldConverter::UNSIGNED;
+				c.maxUValue = MAX_USMALLINT;
+				break;
+			case CalpontSystemCatalog::UMEDINT:
+			case CalpontSystemCatalog::UINT:
+				c.kind = FieldConverter::UNSIGNED;
+				c.maxUValue = MAX_UINT;
+				break;
+			case CalpontSystemCatalog::UBIGINT:
+				c.kind = FieldConverter::UNSIGNED;
+				c.maxUValue = MAX_UBIGINT;
+				break;
+			case CalpontSystemCatalog::FLOAT:
+				c.kind = FieldConverter::FLOAT;
+				break;
+			case CalpontSystemCatalog::DOUBLE:
+				c.kind = FieldConverter::DOUBLE;
+				break;
+			default:
+				break;
+		}
 	}
-	else
+}
+
+
+/* The common forms of the numbers MySQL sends are converted here directly.  Anything
+   unusual (exponents, out-of-range floats, signs on unsigned types), and the types
+   with no converter of their own, go through convertValueNum(). */
+void CrossEngineStep::setField(int i, const char* value, Row& row, const FieldConverter& c)
+{
+	switch (c.kind)
 	{
-		CalpontSystemCatalog::ColType ct;
-		ct.colDataType = colType;
-		ct.colWidth = row.getColumnWidth(i);
-		ct.scale = row.getScale(i);
-		ct.precision = row.getPrecision(i);
-		row.setIntField(convertValueNum(value, ct, row.getSignedNullValue(i)), i);
+		case FieldConverter::STRING:
+			row.setStringField((value != NULL ? value : ""), i);
+			return;
+
+		case FieldConverter::SIGNED:
+		{
+			int64_t v;
+			bool lost;
+			// out of range values are treated as NULL, as in convertValueNum()
+			if (value != NULL && parseScaled(value, c.ct.scale, v, lost))
+			{
+				row.setIntField((lost || v < c.minValue || v > c.maxValue) ? c.nullValue : v, i);
+				return;
+			}
+			break;
+		}
+
+		case FieldConverter::UNSIGNED:
+		{
+			uint64_t v;
+			if (value != NULL && parseUnsigned(value, v))
+			{
+				row.setIntField((v > c.maxUValue) ? c.nullValue : (int64_t) v, i);
+				return;
+			}
+			break;
+		}
+
+		case FieldConverter::FLOAT:
+		{
+			char* end;
+			errno = 0;
+			float f = (value != NULL ? strtof(value, &end) : 0);
+			if (value != NULL && end != value && *end == '\0' && errno == 0 &&
+				!isnan(f) && !isinf(f))
+			{
+				int32_t bits;
+				memcpy(&bits, &f, sizeof(bits));
+				row.setIntField(bits, i);
+				return;
+			}
+			break;
+		}
+
+		case FieldConverter::DOUBLE:
+		{
+			char* end;
+			errno = 0;
+			double d = (value != NULL ? strtod(value, &end) : 0);
+			if (value != NULL && end != value && *end == '\0' && errno == 0 &&
+				!isnan(d) && !isinf(d))
+			{
+				int64_t bits;
+				memcpy(&bits, &d, sizeof(bits));
+				row.setIntField(bits, i);
+				return;
+			}
+			break;
+		}
+
+		default:
+			break;
 	}
+
+	row.setIntField(convertValueNum(value, c.ct, c.nullValue), i);
 }
 
 
@@ -481,8 +890,7 @@ void CrossEngineStep::join()
 
 void CrossEngineStep::execute()
 {
-	DrizzleMySQL drizzle;
-	int ret = 0;
+	vector<boost::shared_ptr<DrizzleMySQL> > results;
 	StepTeleStats sts;
 	sts.query_uuid = fQueryUuid;
 	sts.step_uuid = fStepUuid;
@@ -493,20 +901,66 @@ void CrossEngineStep::execute()
 		sts.total_units_of_work = 1;
 		postStepStartTele(sts);
 
-		ret = drizzle.init(fHost.c_str(), fPort, fUser.c_str(), fPasswd.c_str(), fSchema.c_str());
-		if (ret != 0)
-			handleMySqlError(drizzle.getError().c_str(), ret);
-
+		addFeFilterStr();
 		string query(makeQuery());
 		fLogger->logMessage(logging::LOG_TYPE_INFO, "QUERY to foreign engine: " + query);
 		if (traceOn())
 			cout << "QUERY: " << query << endl;
 
-		ret = drizzle.run(query.c_str());
-		if (ret != 0)
-			handleMySqlError(drizzle.getError().c_str(), ret);
+		bool owner = true;
+		boost::shared_ptr<CrossEngineCache::Fetch> cached;
+		if (fCache)
+			cached = fCache->get(query, owner);
+
+		if (owner)
+		{
+			int errCode = 0;
+			string errMsg;
+			try
+			{
+				fetch(query, results);
+			}
+			catch (IDBExcept& iex)
+			{
+				errCode = iex.errorCode();
+				errMsg = iex.what();
+			}
+			catch (const std::exception& ex)
+			{
+				errCode = ERR_CROSS_ENGINE_CONNECT;
+				errMsg = ex.what();
+			}
+			catch (...)
+			{
+				errCode = ERR_CROSS_ENGINE_CONNECT;
+				errMsg = "CrossEngineStep fetch caught an unknown exception";
+			}
 
-		int num_fields = drizzle.getFieldCount();
+			// the steps waiting on this query get what this one got
+			if (cached)
+			{
+				boost::mutex::scoped_lock lk(cached->mutex);
+				cached->results = results;
+				cached->errCode = errCode;
+				cached->errMsg = errMsg;
+				cached->ready = true;
+				cached->cond.notify_all();
+			}
+			if (errCode != 0)
+				throw IDBExcept(errMsg, errCode);
+		}
+		else
+		{
+			boost::mutex::scoped_lock lk(cached->mutex);
+			while (!cached->ready)
+				cached->cond.wait(lk);
+			if (cached->errCode != 0)
+				throw IDBExcept(cached->errMsg, cached->errCode);
+			results = cached->results;
+		}
+
+		int num_fields = results[0]->getFieldCount();
+		ResultRows rows(results);
 
 		char** rowIn;                            // input
 		//shared_array<uint8_t> rgDataDelivered;      // output
@@ -523,14 +977,14 @@ void CrossEngineStep::execute()
 
 		// Any functions to evaluate
 		makeMappings();
-		bool doFE1 = ((fFeFcnJoin.size() > 0) || (fFeFilters != NULL));
+		bool doFE1 = ((fFeFcnJoin.size() > 0) || (fFeFilters != NULL && !fFeFiltersPushed));
 		bool doFE3 =  (fFeSelects.size() > 0);
 		if (!doFE1 && !doFE3)
 		{
-			while ((rowIn = drizzle.nextRow()) && !cancelled())
+			while ((rowIn = rows.next()) && !cancelled())
 			{
 				for(int i = 0; i < num_fields; i++)
-					setField(i, rowIn[i], fRowDelivered);
+					setField(i, rowIn[i], fRowDelivered, fConverters[i]);
 
 				addRow(rgDataDelivered);
 			}
@@ -544,16 +998,17 @@ void CrossEngineStep::execute()
 			rgDataFe1.reset(new uint8_t[rowFe1.getSize()]);
 			rowFe1.setData(rgDataFe1.get());
 
-			while ((rowIn = drizzle.nextRow()) && !cancelled())
+			while ((rowIn = rows.next()) && !cancelled())
 			{
 				// Parse the columns used in FE1 first, the other column may not need be parsed.
 				for(int i = 0; i < num_fields; i++)
 				{
 					if (fFe1Column[i] != -1)
-						setField(fFe1Column[i], rowIn[i], rowFe1);
+						setField(fFe1Column[i], rowIn[i], rowFe1, fFe1Converters[fFe1Column[i]]);
 				}
 
-				if (fFeFilters && fFeInstance->evaluate(rowFe1, fFeFilters.get()) == false)
+				if (fFeFilters && !fFeFiltersPushed &&
+					fFeInstance->evaluate(rowFe1, fFeFilters.get()) == false)
 					continue;
 
 				// evaluate the FE join column
@@ -564,7 +1019,7 @@ void CrossEngineStep::execute()
 				for(int i = 0; i < num_fields; i++)
 				{
 					if (fFe1Column[i] == -1)
-						setField(i, rowIn[i], fRowDelivered);
+						setField(i, rowIn[i], fRowDelivered, fConverters[i]);
 				}
 
 				addRow(rgDataDelivered);
@@ -579,10 +1034,10 @@ void CrossEngineStep::execute()
 			rgDataFe3.reset(new uint8_t[rowFe3.getSize()]);
 			rowFe3.setData(rgDataFe3.get());
 
-			while ((rowIn = drizzle.nextRow()) && !cancelled())
+			while ((rowIn = rows.next()) && !cancelled())
 			{
 				for(int i = 0; i < num_fields; i++)
-					setField(i, rowIn[i], rowFe3);
+					setField(i, rowIn[i], rowFe3, fConverters[i]);
 
 				fFeInstance->evaluate(rowFe3, fFeSelects);
 				fFeInstance->evaluate(rowFe3, fFeSelects);
@@ -607,16 +1062,17 @@ void CrossEngineStep::execute()
 			rgDataFe3.reset(new uint8_t[rowFe3.getSize()]);
 			rowFe3.setData(rgDataFe3.get());
 
-			while ((rowIn = drizzle.nextRow()) && !cancelled())
+			while ((rowIn = rows.next()) && !cancelled())
 			{
 				// Parse the columns used in FE1 first, the other column may not need be parsed.
 				for(int i = 0; i < num_fields; i++)
 				{
 					if (fFe1Column[i] != -1)
-						setField(fFe1Column[i], rowIn[i], rowFe1);
+						setField(fFe1Column[i], rowIn[i], rowFe1, fFe1Converters[fFe1Column[i]]);
 				}
 
-				if (fFeFilters && fFeInstance->evaluate(rowFe1, fFeFilters.get()) == false)
+				if (fFeFilters && !fFeFiltersPushed &&
+					fFeInstance->evaluate(rowFe1, fFeFilters.get()) == false)
 					continue;
 
 				// evaluate the FE join column
@@ -627,7 +1083,7 @@ void CrossEngineStep::execute()
 				for(int i = 0; i < num_fields; i++)
 				{
 					if (fFe1Column[i] == -1)
-						setField(i, rowIn[i], rowFe3);
+						setField(i, rowIn[i], rowFe3, fConverters[i]);
 				}
 
 				fFeInstance->evaluate(rowFe3, fFeSelects);
@@ -639,7 +1095,8 @@ void CrossEngineStep::execute()
 
 		//INSERT_ADAPTER(fOutputDL, rgDataDelivered);
 		fOutputDL->insert(rgDataDelivered);
-		fRowsRetrieved = drizzle.getRowCount();
+		for (uint64_t i = 0; i < results.size(); i++)
+			fRowsRetrieved += results[i]->getRowCount();
 	}
 	catch (IDBExcept& iex)
 	{
@@ -754,6 +1211,133 @@ void CrossEngineStep::setProjectBPP(JobStep* jobStep1, JobStep*)
 }
 
 
+/* Expression filters are evaluated here on the UM, after every row has come over.  The
+   top-level conjuncts that render as SQL the foreign engine understands are added to
+   the query too, and if that's all of them the UM doesn't evaluate them again. */
+void CrossEngineStep::addFeFilterStr()
+{
+	if (fFeFilters == NULL)
+		return;
+
+	vector<const ParseTree*> parts;
+	conjuncts(fFeFilters.get(), parts);
+
+	string filterStr;
+	uint64_t pushed = 0;
+	for (uint64_t i = 0; i < parts.size(); i++)
+	{
+		string sql;
+		if (!filterSql(parts[i], sql))
+			continue;
+
+		if (!filterStr.empty())
+			filterStr += " AND ";
+		filterStr += "(" + sql + ")";
+		pushed++;
+	}
+
+	if (!filterStr.empty())
+	{
+		if (!fWhereClause.empty())
+			fWhereClause += " AND (" + filterStr + ")";
+		else
+			fWhereClause += " WHERE (" + filterStr + ")";
+	}
+
+	fFeFiltersPushed = (pushed == parts.size());
+}
+
+
+/* Runs query and buffers its results.  A big enough table with an integer primary key
+   is read over fConnections connections at once, one key range each. */
+void CrossEngineStep::fetch(const string& query, vector<boost::shared_ptr<DrizzleMySQL> >& results)
+{
+	boost::shared_ptr<DrizzleMySQL> first(new DrizzleMySQL());
+	int ret = first->init(fHost.c_str(), fPort, fUser.c_str(), fPasswd.c_str(), fSchema.c_str());
+	if (ret != 0)
+		handleMySqlError(first->getError().c_str(), ret);
+
+	vector<string> ranges;
+	if (fConnections > 1)
+		ranges = splitByKey(*first, fConnections);
+
+	if (ranges.empty())
+	{
+		ret = first->run(query.c_str());
+		if (ret != 0)
+			handleMySqlError(first->getError().c_str(), ret);
+		results.push_back(first);
+		return;
+	}
+
+	const string glue = (fWhereClause.empty() ? " WHERE " : " AND ");
+	vector<int> rets(ranges.size(), 0);
+	vector<boost::shared_ptr<boost::thread> > threads;
+	results.push_back(first);
+	for (uint64_t i = 1; i < ranges.size(); i++)
+	{
+		results.push_back(boost::shared_ptr<DrizzleMySQL>(new DrizzleMySQL()));
+		Fetcher f(results[i].get(), fHost, fPort, fUser, fPasswd, fSchema,
+					query + glue + ranges[i], &rets[i]);
+		threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(f)));
+	}
+
+	rets[0] = first->run((query + glue + ranges[0]).c_str());
+	for (uint64_t i = 0; i < threads.size(); i++)
+		threads[i]->join();
+
+	for (uint64_t i = 0; i < rets.size(); i++)
+		if (rets[i] != 0)
+			handleMySqlError(results[i]->getError().c_str(), rets[i]);
+}
+
+
+/* Returns the predicates that split the table into up to n ranges of its primary
+   key, or nothing if it has no integer one or is too small to be worth it.  The first
+   and last ranges are open, so rows added since the bounds were read aren't lost. */
+vector<string> CrossEngineStep::splitByKey(DrizzleMySQL& conn, uint32_t n)
+{
+	vector<string> ranges;
+	char** row;
+	int64_t lo, hi;
+
+	string q = "SHOW KEYS FROM `" + fTable + "` WHERE Key_name = 'PRIMARY' AND Seq_in_index = 1";
+	if (conn.run(q.c_str()) != 0 || conn.getRowCount() != 1 || conn.getFieldCount() < 5 ||
+		(row = conn.getRow(0)) == NULL || row[4] == NULL)
+		return ranges;
+	string col = string("`") + row[4] + "`";
+
+	q = "SELECT MIN(" + col + "), MAX(" + col + ") FROM `" + fTable + "`";
+	if (conn.run(q.c_str()) != 0 || conn.getRowCount() != 1 || (row = conn.getRow(0)) == NULL ||
+		row[0] == NULL || row[1] == NULL || !parseInt(row[0], lo) || !parseInt(row[1], hi) ||
+		hi <= lo)
+		return ranges;
+
+	uint64_t span = (uint64_t) hi - (uint64_t) lo;
+	n = std::min<uint64_t>(n, span / minKeysPerConnection + 1);
+	if (n < 2)
+		return ranges;
+
+	string qualified = ((fTable.compare(fAlias) != 0) ? fAlias : fTable) + "." + col;
+	uint64_t step = span / n + 1;
+	int64_t bound = lo;
+	for (uint32_t i = 0; i < n; i++)
+	{
+		ostringstream oss;
+		if (i > 0)
+			oss << qualified << " >= " << bound;
+		bound = (int64_t) ((uint64_t) lo + step * (i + 1));
+		if (i > 0 && i < n - 1)
+			oss << " AND ";
+		if (i < n - 1)
+			oss << qualified << " < " << bound;
+		ranges.push_back(oss.str());
+	}
+
+	return ranges;
+}
+
+
 string CrossEngineStep::makeQuery()
 {
 	ostringstream oss;
@@ -920,6 +1504,8 @@ void CrossEngineStep::formatMiniStats()
 		<< JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " "
 		<< fRowsReturned << " ";
 	fMiniInfo += oss.str();
+	profileSummary("CES", "UM", "-",
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), fRowsReturned);
 }
 
 
@@ -21,7 +21,10 @@
 #ifndef JOBLIST_CROSSENGINESTEP_H
 #define JOBLIST_CROSSENGINESTEP_H
 
+#include <map>
 #include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
 
 #include "jobstep.h"
 #include "primitivestep.h"
@@ -41,6 +44,39 @@ class FuncExp;
 namespace joblist
 {
 
+class DrizzleMySQL;   // a buffered result set from the foreign engine
+
+/** @brief the result sets of one statement's cross-engine queries, by query text
+ *
+ * A table referenced more than once with the same columns and filters is fetched
+ * once.  The first step to ask for a query fetches it; the others wait for that and
+ * then read the same buffered results, which stay unchanged once fetched.
+ */
+class CrossEngineCache
+{
+public:
+	struct Fetch
+	{
+		Fetch() : ready(false), errCode(0) { }
+
+		std::vector<boost::shared_ptr<DrizzleMySQL> > results;   // in key-range order
+		bool ready;
+		int errCode;
+		std::string errMsg;
+		boost::mutex mutex;
+		boost::condition cond;
+	};
+
+	/** @brief returns the fetch for query.  owner is set if the caller is the first
+	 *  to ask, and has to fill it in and set it ready.
+	 */
+	boost::shared_ptr<Fetch> get(const std::string& query, bool& owner);
+
+private:
+	boost::mutex fMutex;
+	std::map<std::string, boost::shared_ptr<Fetch> > fFetches;
+};
+
 /** @brief class CrossEngineStep
  *
  */
@@ -122,7 +158,24 @@ protected:
 	virtual void makeMappings();
 	virtual void addFilterStr(const std::vector<const execplan::Filter*>&, const std::string&);
 	virtual std::string makeQuery();
-	virtual void setField(int, const char*, rowgroup::Row&);
+	virtual void addFeFilterStr();
+	virtual void fetch(const std::string&, std::vector<boost::shared_ptr<DrizzleMySQL> >&);
+	virtual std::vector<std::string> splitByKey(DrizzleMySQL&, uint32_t);
+
+	// how a fetched field becomes a column value, worked out once per column
+	struct FieldConverter
+	{
+		enum Kind { STRING, SIGNED, UNSIGNED, FLOAT, DOUBLE, GENERIC };
+
+		Kind kind;
+		execplan::CalpontSystemCatalog::ColType ct;
+		int64_t minValue;      // SIGNED
+		int64_t maxValue;      // SIGNED
+		uint64_t maxUValue;    // UNSIGNED
+		int64_t nullValue;
+	};
+	void makeConverters(const rowgroup::RowGroup&, std::vector<FieldConverter>&);
+	virtual void setField(int, const char*, rowgroup::Row&, const FieldConverter&);
 	inline void addRow(rowgroup::RGData &);
 	//inline  void addRow(boost::shared_array<uint8_t>&);
 	virtual int64_t convertValueNum(
@@ -166,6 +219,8 @@ protected:
 	std::string  fTable;
 	std::string  fAlias;
 	unsigned int fPort;
+	uint32_t     fConnections;
+	boost::shared_ptr<CrossEngineCache> fCache;
 
 	// returned columns and primitive filters
 	std::string fWhereClause;
@@ -180,6 +235,9 @@ protected:
 	boost::scoped_array<int> fFe1Column;
 	boost::shared_array<int> fFeMapping1;
 	boost::shared_array<int> fFeMapping3;
+	bool fFeFiltersPushed;   // fFeFilters is all in fWhereClause, no need to evaluate it
+	std::vector<FieldConverter> fConverters;      // for fRowGroupOut
+	std::vector<FieldConverter> fFe1Converters;   // for fRowGroupFe1
 	rowgroup::RowGroup fRowGroupFe1;
 	rowgroup::RowGroup fRowGroupFe3;
 
@@ -538,6 +538,7 @@ void DiskJoinStep::reportStats()
 		units << " - - -------- -\n";
 
 	fMiniInfo = os2.str();
+	profileSummary("DJS", "UM", alias() + "-" + joiner->getTableName(), -1, -1);
 
 	if (traceOn())
 		logEnd(os1.str().c_str());
@@ -39,6 +39,8 @@ using namespace std;
 
 #include <boost/scoped_array.hpp>
 #include <boost/thread.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
 using namespace boost;
 
 #include "distributedenginecomm.h"
@@ -63,9 +65,13 @@ using namespace snmpmanager;
 using namespace oam;
 
 #include "jobstep.h"
+#include "jointabledirectory.h"
 using namespace joblist;
 
+#include "multicast.h"
+
 #include "atomicops.h"
+#include "metrics.h"
 
 namespace
 {
@@ -189,10 +195,29 @@ namespace joblist
 	fRm(rm),
 	fLBIDShift(fRm.getPsLBID_Shift()),
 	pmCount(0),
-    fIsExeMgr(isExeMgr)
+    fIsExeMgr(isExeMgr),
+	fMulticastMinSize(rm.getMulticastMinMsgSize()),
+	fMulticastMaxKept(rm.getMulticastMaxKeptSize()),
+	fMulticastSeq(0),
+	fMulticastSentBytes(0)
   {
 
     Setup();
+
+	if (fIsExeMgr && fRm.multicastEnabled()) {
+		try {
+			fMulticast.reset(new multicast::MulticastSender());
+		}
+		catch (std::exception &e) {
+			writeToLog(__FILE__, __LINE__, string("Multicast is disabled: ") + e.what(),
+			  LOG_TYPE_WARNING);
+		}
+		/* the PMs tell apart the UMs' messages by the high bits */
+		uuids::uuid u = uuids::random_generator()();
+		uint32_t salt;
+		memcpy(&salt, u.data, sizeof(salt));
+		fMulticastSeq = ((uint64_t) salt << 32);
+	}
   }
 
   DistributedEngineComm::~DistributedEngineComm()
@@ -278,9 +303,12 @@ void DistributedEngineComm::Setup()
             if (newClients[i]->isSameAddr(*fPmConnections[j]))
                 break;
         }
-        if (j == pmCount)
+        if (j == pmCount) {
+            // a PM that (re)joined has none of the cached join tables
+            JoinTableDirectory::reset();
             for (uint32_t k = 0; k < eventListeners.size(); k++)
                 eventListeners[k]->newPMOnline(i);
+        }
     }
     lock.unlock();
 
@@ -316,7 +344,15 @@ void DistributedEngineComm::Listen(boost::shared_ptr<MessageQueueClient> client,
 			//TODO: This call blocks so setting Busy() in another thread doesn't work here...
 			sbs = client->read(0, NULL, &stats);
 			if (sbs->length() != 0) {
-				addDataToOutput(sbs, connIndex, &stats);
+				ISMPacketHeader *ism = (ISMPacketHeader *) sbs->buf();
+				if (ism->Command == MULTICAST_NAK || ism->Command == MULTICAST_ACK)
+					multicastAnswer(*sbs, connIndex);
+				else {
+					// the step answers on the connection that asked
+					if (ism->Command == JOIN_TABLE_NAK)
+						ism->Interleave = connIndex;
+					addDataToOutput(sbs, connIndex, &stats);
+				}
 			}
 			else // got zero bytes on read, nothing more will come
 				goto Error;
@@ -369,6 +405,7 @@ Error:
 		fPmConnections.swap(tempConns);
 		pmCount = (pmCount == 0 ? 0 : pmCount - 1);
 		//cout << "PMCOUNT=" << pmCount << endl;
+		JoinTableDirectory::reset();
 
 		// send alarm & log it
 		SNMPManager alarmMgr;
@@ -725,8 +762,11 @@ void DistributedEngineComm::setFlowControl(bool enabled, uint32_t uniqueID, boos
 			case BATCH_PRIMITIVE_CREATE:
 				/* Disable flow control initially */
 				msg << (uint32_t) -1;
-			case BATCH_PRIMITIVE_DESTROY:
 			case BATCH_PRIMITIVE_ADD_JOINER:
+				if (fMulticast && pmCount > 1 && msg.length() >= fMulticastMinSize &&
+				  writeMulticast(msg, senderID))
+					return;
+			case BATCH_PRIMITIVE_DESTROY:
 			case BATCH_PRIMITIVE_END_JOINER:
 			case BATCH_PRIMITIVE_ABORT:
 			case DICT_CREATE_EQUALITY_FILTER:
@@ -756,6 +796,109 @@ void DistributedEngineComm::setFlowControl(bool enabled, uint32_t uniqueID, boos
 	}
   }
 
+bool DistributedEngineComm::writeMulticast(const ByteStream &msg, uint32_t senderID)
+{
+	const ISMPacketHeader *msgIsm = (const ISMPacketHeader *) msg.buf();
+	uint64_t seq;
+	uint32_t uniqueID = 0;
+	int reached = 0;
+
+	// it couldn't be kept for a PM that NAKs it
+	if (msg.length() > fMulticastMaxKept)
+		return false;
+
+	// unicast rather than wait for another transfer to finish
+	mutex::scoped_lock lk(fMulticastLock, try_to_lock);
+	if (!lk.owns_lock())
+		return false;
+
+	seq = fMulticastSeq++;
+	ByteStream mbs(msg.length() + sizeof(seq));
+	mbs << seq;
+	mbs.append(msg.buf(), msg.length());
+	try {
+		reached = fMulticast->send(mbs);
+	}
+	catch (std::exception &e) {
+		writeToLog(__FILE__, __LINE__, string("Multicast send failed: ") + e.what(),
+		  LOG_TYPE_WARNING);
+	}
+	lk.unlock();
+	if (reached == 0)
+		return false;
+
+	// oldest first, whatever is past a minute or over the budget
+	time_t now = time(0);
+	mutex::scoped_lock slk(fMulticastSentLock);
+	std::map<uint64_t, SentMulticast>::iterator it = fMulticastSent.begin();
+	while (it != fMulticastSent.end() && (now - it->second.sent > 60 ||
+	  fMulticastSentBytes + msg.length() > fMulticastMaxKept)) {
+		fMulticastSentBytes -= it->second.msg->length();
+		fMulticastSent.erase(it++);
+	}
+	SentMulticast &sent = fMulticastSent[seq];
+	sent.msg.reset(new ByteStream(msg));
+	sent.sent = now;
+	sent.unanswered = pmCount;
+	fMulticastSentBytes += msg.length();
+	slk.unlock();
+
+	// the PM queues the ref under the BPP's id as it would the joiner message itself,
+	// see BPPHandler::getUniqueID()
+	if (msgIsm->Command == BATCH_PRIMITIVE_ADD_JOINER &&
+	  msg.length() >= sizeof(ISMPacketHeader) + 3 * sizeof(uint32_t))
+		memcpy(&uniqueID, msg.buf() + sizeof(ISMPacketHeader) + 2 * sizeof(uint32_t),
+		  sizeof(uniqueID));
+
+	ByteStream ref(sizeof(ISMPacketHeader) + sizeof(seq) + sizeof(uniqueID));
+	ISMPacketHeader *ism = (ISMPacketHeader *) ref.getInputPtr();
+	memset(ism, 0, sizeof(ISMPacketHeader));
+	ism->Command = MULTICAST_REF;
+	ref.advanceInputPtr(sizeof(ISMPacketHeader));
+	ref << seq << uniqueID;
+	for (uint32_t i = 0; i < pmCount; i++)
+		writeToClient(i, ref, senderID);
+	return true;
+}
+
+void DistributedEngineComm::multicastAnswer(const ByteStream &answer, uint32_t connIndex)
+{
+	const ISMPacketHeader *ism = (const ISMPacketHeader *) answer.buf();
+	uint64_t seq;
+	SBS msg;
+
+	if (answer.length() < sizeof(ISMPacketHeader) + sizeof(seq))
+		return;
+	memcpy(&seq, answer.buf() + sizeof(ISMPacketHeader), sizeof(seq));
+
+	mutex::scoped_lock lk(fMulticastSentLock);
+	std::map<uint64_t, SentMulticast>::iterator it = fMulticastSent.find(seq);
+	if (it != fMulticastSent.end()) {
+		msg = it->second.msg;
+		if (--it->second.unanswered == 0) {
+			fMulticastSentBytes -= msg->length();
+			fMulticastSent.erase(it);
+		}
+	}
+	lk.unlock();
+
+	if (ism->Command == MULTICAST_ACK)
+		return;
+	if (!msg) {
+		ostringstream os;
+		os << "Multicast message " << seq << " was NAKed after it was discarded";
+		writeToLog(__FILE__, __LINE__, os.str(), LOG_TYPE_WARNING);
+		return;
+	}
+	// out of order; see writeMulticast()
+	try {
+		writeToClient(connIndex, *msg);
+	}
+	catch (std::exception &) {
+		// a dead connection; the reader finds out on its next read
+	}
+}
+
 void DistributedEngineComm::write(messageqcpp::ByteStream &msg, uint32_t connection)
 {
 	ISMPacketHeader *ism = (ISMPacketHeader *) msg.buf();
@@ -775,6 +918,12 @@ void DistributedEngineComm::write(messageqcpp::ByteStream &msg, uint32_t connect
 	newClients[connection]->write(msg, NULL, senderStats);
 }
 
+void DistributedEngineComm::write(uint32_t key, messageqcpp::ByteStream &msg, uint32_t connIndex)
+{
+	if (connIndex < fPmConnections.size())
+		writeToClient(connIndex, msg, key);
+}
+
   void DistributedEngineComm::StartClientListener(boost::shared_ptr<MessageQueueClient> cl, uint32_t connIndex)
   {
     boost::thread *thrd = new boost::thread(EngineCommRunner(this, cl, connIndex));
@@ -799,6 +948,18 @@ void DistributedEngineComm::write(messageqcpp::ByteStream &msg, uint32_t connect
  	mqe = map_tok->second;
 	lk.unlock();
 
+	static utils::LatencyHistogram *responseTime = utils::Metrics::instance()->histogram(
+		"idb_dec_request_response_usec", "", "Time from a request to the first PM response on its queue");
+	static utils::MetricCounter *msgsRecvd = utils::Metrics::instance()->counter(
+		"idb_dec_messages_received_total", "", "Messages received from the PMs");
+	static utils::MetricCounter *bytesRecvd = utils::Metrics::instance()->counter(
+		"idb_dec_bytes_received_total", "", "Bytes received from the PMs");
+	uint64_t sent = mqe->firstSend;
+	if (sent != 0 && atomicops::atomicCAS<uint64_t>(&mqe->firstSend, sent, 0))
+		responseTime->record(utils::monotonicUsec() - sent);
+	msgsRecvd->add();
+	bytesRecvd->add(sbs->length());
+
 	if (pmCount > 0) {
 		(void)atomicops::atomicInc(&mqe->unackedWork[connIndex % pmCount]);
 	}
@@ -839,6 +1000,8 @@ int DistributedEngineComm::writeToClient(size_t index, const ByteStream& bs, uin
 		it = fSessionMessages.find(sender);
 		if (it != fSessionMessages.end()) {
 			senderStats = &(it->second->stats);
+			if (it->second->firstSend == 0)
+				it->second->firstSend = utils::monotonicUsec();
 			if (doInterleaving)
 				interleaver = it->second->interleaver[index % it->second->pmCount]++;
 		}
@@ -950,7 +1113,7 @@ Stats DistributedEngineComm::getNetworkStats(uint32_t uniqueID)
 }
 
 DistributedEngineComm::MQE::MQE(uint32_t pCount) : ackSocketIndex(0), pmCount(pCount), hasBigMsgs(false),
-				targetQueueSize(targetRecvQueueSize)
+				targetQueueSize(targetRecvQueueSize), firstSend(0)
 {
 	unackedWork.reset(new volatile uint32_t[pmCount]);
 	interleaver.reset(new uint32_t[pmCount]);
@@ -41,6 +41,7 @@
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "bytestream.h"
 #include "primitivemsg.h"
@@ -63,6 +64,9 @@ namespace messageqcpp {
 namespace config {
 	class Config;
 }
+namespace multicast {
+	class MulticastSender;
+}
 
 /**
  * Namespace
@@ -143,6 +147,12 @@ public:
 	*/
 	EXPORT void write(messageqcpp::ByteStream &msg, uint32_t connection);
 
+	/** @brief Write a message of step key to the PM on connection connIndex, e.g.
+	 *  data that PM asked to have resent.  connIndex is the one Listen() put in the
+	 *  ISMPacketHeader of the request.
+	 */
+	EXPORT void write(uint32_t key, messageqcpp::ByteStream &msg, uint32_t connIndex);
+
 	/** @brief Shutdown this object
 	 *
 	 * Closes all the connections created during Setup() and cleans up other stuff.
@@ -212,6 +222,10 @@ private:
 		bool hasBigMsgs;
 
 		uint64_t targetQueueSize;
+
+		// When the first request since the last response was sent; 0 if none
+		// is outstanding.  Feeds the request/response latency histogram.
+		volatile uint64_t firstSend;
 	};
 
 	//The mapping of session ids to StepMsgQueueLists
@@ -270,6 +284,31 @@ private:
 	void doHasBigMsgs(boost::shared_ptr<MQE> mqe, uint64_t targetSize);
 	boost::mutex ackLock;
 
+	/* One-to-all messages by multicast (Multicast/Enabled).  The message goes out once
+	with a sequence number, then every PM gets a small MULTICAST_REF naming it over its
+	usual connection.  A PM that doesn't have it answers with a MULTICAST_NAK and gets
+	it resent there, behind whatever was sent after the REF; one that does answers with
+	a MULTICAST_ACK.  Neither keeps stream order; PrimProc doesn't need it, since its
+	BPP jobs reschedule until the create and joiner data they depend on have been
+	handled.  A message is kept until every PM has answered, for at most a minute and
+	fMulticastMaxKept bytes in all. */
+	bool writeMulticast(const messageqcpp::ByteStream &msg, uint32_t senderID);
+	void multicastAnswer(const messageqcpp::ByteStream &answer, uint32_t connIndex);
+
+	struct SentMulticast {
+		messageqcpp::SBS msg;
+		time_t sent;
+		uint32_t unanswered;	// PMs yet to ACK or NAK it
+	};
+	boost::scoped_ptr<multicast::MulticastSender> fMulticast;
+	boost::mutex fMulticastLock;		// one transfer at a time
+	uint64_t fMulticastMinSize;
+	uint64_t fMulticastMaxKept;
+	uint64_t fMulticastSeq;
+	std::map<uint64_t, SentMulticast> fMulticastSent;	// in seq order, i.e. oldest first
+	uint64_t fMulticastSentBytes;
+	boost::mutex fMulticastSentLock;
+
 };
 
 }
@@ -57,10 +57,110 @@ using namespace ordering;
 #include "jlf_common.h"
 #include "limitedorderby.h"
 
+namespace
+{
+// writes v in decimal so that it ends just before end, returns where it starts
+inline char* formatUint(uint64_t v, char* end)
+{
+	do
+	{
+		*--end = '0' + (v % 10);
+		v /= 10;
+	} while (v != 0);
+
+	return end;
+}
+
+// the same, with scale digits after the decimal point
+inline char* formatDecimal(uint64_t v, bool neg, int scale, char* end)
+{
+	for (int i = 0; i < scale; i++)
+	{
+		*--end = '0' + (v % 10);
+		v /= 10;
+	}
+
+	if (scale > 0)
+		*--end = '.';
+
+	end = formatUint(v, end);
+	if (neg)
+		*--end = '-';
+
+	return end;
+}
+
+const uint32_t minChunkSize = 64;
+const uint32_t maxChunkSize = 64 * 1024;
+}
+
+
 namespace joblist
 {
 
 
+// GroupConcatText class implementation
+void GroupConcatText::addChunk(size_t minSize)
+{
+	size_t size = (fTail == NULL ? minChunkSize : std::min(fTail->capacity * 2, maxChunkSize));
+	if (size < minSize)
+		size = std::min(minSize, (size_t) maxChunkSize);
+
+	Chunk* chunk;
+	try
+	{
+		chunk = (Chunk*) fArena.allocate(sizeof(Chunk) + size);
+	}
+	catch (std::bad_alloc&)
+	{
+		cerr << IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG)
+			 << " @" << __FILE__ << ":" << __LINE__;
+		throw IDBExcept(ERR_AGGREGATION_TOO_BIG);
+	}
+
+	chunk->next = NULL;
+	chunk->capacity = size;
+	chunk->used = 0;
+	if (fTail == NULL)
+		fHead = chunk;
+	else
+		fTail->next = chunk;
+	fTail = chunk;
+}
+
+
+void GroupConcatText::splice(GroupConcatText& other)
+{
+	if (other.fHead == NULL)
+		return;
+
+	if (fTail == NULL)
+		fHead = other.fHead;
+	else
+		fTail->next = other.fHead;
+	fTail = other.fTail;
+	fLength += other.fLength;
+
+	other.fHead = other.fTail = NULL;
+	other.fLength = 0;
+}
+
+
+size_t GroupConcatText::copyOut(uint8_t* buff, size_t max) const
+{
+	size_t copied = 0;
+
+	for (Chunk* c = fHead; c != NULL && copied < max; c = c->next)
+	{
+		size_t n = std::min((size_t) c->used, max - copied);
+		memcpy(buff + copied, c->data(), n);
+		copied += n;
+	}
+
+	return copied;
+}
+
+
 // GroupConcatInfo class implementation
 GroupConcatInfo::GroupConcatInfo()
 {
@@ -86,6 +186,7 @@ void GroupConcatInfo::prepGroupConcat(JobInfo& jobInfo)
 		groupConcat->fSize = gcc->resultType().colWidth;
 		groupConcat->fRm = &(jobInfo.rm);
 		groupConcat->fSessionMemLimit = jobInfo.umMemLimit;
+		groupConcat->fArena = jobInfo.queryArena;
 
 		int key = -1;
 		const vector<SRCP>& cols = rcp->columnVec();
@@ -393,11 +494,15 @@ void GroupConcator::initialize(const rowgroup::SP_GroupConcat& gcc)
 }
 
 
-void GroupConcator::outputRow(std::ostringstream& oss, const rowgroup::Row& row)
+template<typename Out>
+void GroupConcator::outputRow(Out& out, const rowgroup::Row& row)
 {
 	const CalpontSystemCatalog::ColDataType* types = row.getColTypes();
 	vector<uint32_t>::iterator i = fConcatColumns.begin();
 	vector<pair<string, uint32_t> >::iterator j = fConstCols.begin();
+	char buf[64];
+	char* end = buf + sizeof(buf);
+	char* start;
 
 	uint64_t groupColCount = fConcatColumns.size() + fConstCols.size();
 
@@ -405,7 +510,7 @@ void GroupConcator::outputRow(std::ostringstream& oss, const rowgroup::Row& row)
 	{
 		if (j != fConstCols.end() &&  k == j->second)
 		{
-			oss << j->first;
+			out.append(j->first.data(), j->first.length());
 			j++;
 			continue;
 		}
@@ -421,16 +526,9 @@ void GroupConcator::outputRow(std::ostringstream& oss, const rowgroup::Row& row)
             case CalpontSystemCatalog::UDECIMAL:
 			{
 				int64_t intVal = row.getIntField(*i);
-				int scale = (int) row.getScale(*i);
-				if (scale == 0)
-				{
-					oss << intVal;
-				}
-				else
-				{
-					long double dblVal = intVal / pow(10.0, (double)scale);
-					oss << fixed << setprecision(scale) << dblVal;
-				}
+				uint64_t absVal = (intVal < 0 ? -((uint64_t) intVal) : intVal);
+				start = formatDecimal(absVal, intVal < 0, row.getScale(*i), end);
+				out.append(start, end - start);
 				break;
 			}
 			case CalpontSystemCatalog::UTINYINT:
@@ -439,46 +537,42 @@ void GroupConcator::outputRow(std::ostringstream& oss, const rowgroup::Row& row)
 			case CalpontSystemCatalog::UINT:
 			case CalpontSystemCatalog::UBIGINT:
 			{
-				uint64_t uintVal = row.getUintField(*i);
-				int scale = (int) row.getScale(*i);
-				if (scale == 0)
-				{
-					oss << uintVal;
-				}
-				else
-				{
-					long double dblVal = uintVal / pow(10.0, (double)scale);
-					oss << fixed << setprecision(scale) << dblVal;
-				}
+				start = formatDecimal(row.getUintField(*i), false, row.getScale(*i), end);
+				out.append(start, end - start);
 				break;
 			}
             case CalpontSystemCatalog::CHAR:
 			case CalpontSystemCatalog::VARCHAR:
 			{
-				oss << row.getStringField(*i).c_str();
-				//oss << row.getStringField(*i);
+				// stop at a NUL, as the c_str() this replaced did
+				const char* str = (const char*) row.getStringPointer(*i);
+				out.append(str, strnlen(str, row.getStringLength(*i)));
 				break;
 			}
 			case CalpontSystemCatalog::DOUBLE:
             case CalpontSystemCatalog::UDOUBLE:
 			{
-				oss << setprecision(15) << row.getDoubleField(*i);
+				int len = snprintf(buf, sizeof(buf), "%.15g", row.getDoubleField(*i));
+				out.append(buf, len);
 				break;
 			}
 			case CalpontSystemCatalog::FLOAT:
             case CalpontSystemCatalog::UFLOAT:
 			{
-				oss << row.getFloatField(*i);
+				int len = snprintf(buf, sizeof(buf), "%g", row.getFloatField(*i));
+				out.append(buf, len);
 				break;
 			}
 			case CalpontSystemCatalog::DATE:
 			{
-				oss << DataConvert::dateToString(row.getUintField(*i));
+				DataConvert::dateToString(row.getUintField(*i), buf, sizeof(buf));
+				out.append(buf, strlen(buf));
 				break;
 			}
 			case CalpontSystemCatalog::DATETIME:
 			{
-				oss << DataConvert::datetimeToString(row.getUintField(*i));
+				DataConvert::datetimeToString(row.getUintField(*i), buf, sizeof(buf));
+				out.append(buf, strlen(buf));
 				break;
 			}
 			default:
@@ -811,8 +905,7 @@ void GroupConcatOrderBy::merge(GroupConcator* gc)
 
 void GroupConcatOrderBy::getResult(uint8_t* buff, const string &sep)
 {
-#if 1
-	ostringstream oss;
+	string out;
 	bool addSep = false;
 
 	// need to reverse the order
@@ -823,39 +916,23 @@ void GroupConcatOrderBy::getResult(uint8_t* buff, const string &sep)
 		fOrderByQueue.pop();
 	}
 
-	while (rowStack.size() > 0)
+	// the length estimates keep this close to the limit; stop formatting once past it
+	while (rowStack.size() > 0 && (int64_t) out.length() < fGroupConcatLen)
 	{
 		if (addSep)
-			oss << sep;
+			out.append(sep);
 		else
 			addSep = true;
 
 		const OrderByRow& topRow = rowStack.top();
 		fRow0.setData(topRow.fData);
-		outputRow(oss, fRow0);
+		outputRow(out, fRow0);
 		rowStack.pop();
 	}
 
-	strncpy((char*) buff, oss.str().c_str(), fGroupConcatLen);
-#else
-	ostringstream oss;
-	bool addSep = false;
-	priority_queue<OrderByRow>::reverse_iterator rit;
-	
-	for (rit = fOrderByQueue.rbegin(); rit != fOrderByQueue.rend(); ++rit) {
-		if (addSep)
-			oss << sep;
-		else
-			addSep = true;
-		
-		const OrderByRow &topRow = *rit;
-		fRow0.setData(topRow.fData);
-		outputRow(oss, fRow0);
-	}
-	fOrderByQueue.clear();
-	
-	strncpy((char *) buff, oss.str().c_str(), fGroupConcatLen);
-#endif
+	size_t len = min((size_t) fGroupConcatLen, out.length());
+	memcpy(buff, out.data(), len);
+	buff[len] = '\0';
 }
 
 uint8_t * GroupConcator::getResult(const string &sep)
@@ -884,16 +961,13 @@ const string GroupConcatOrderBy::toString() const
 
 
 // GroupConcatNoOrder class implementation
-GroupConcatNoOrder::GroupConcatNoOrder() :
-    fRowsPerRG(128), fErrorCode(ERR_AGGREGATION_TOO_BIG), fMemSize(0), fRm(NULL)
+GroupConcatNoOrder::GroupConcatNoOrder()
 {
 }
 
 
 GroupConcatNoOrder::~GroupConcatNoOrder()
 {
-	if (fRm)
-		fRm->returnMemory(fMemSize, fSessionMemLimit);
 }
 
 
@@ -901,112 +975,44 @@ void GroupConcatNoOrder::initialize(const rowgroup::SP_GroupConcat& gcc)
 {
 	GroupConcator::initialize(gcc);
 
-	fRowGroup = gcc->fRowGroup;
-	fRowsPerRG = 128;
-	fErrorCode = ERR_AGGREGATION_TOO_BIG;
-	fRm = gcc->fRm;
-	fSessionMemLimit = gcc->fSessionMemLimit;
+	fSeparator = gcc->fSeparator;
+	fArena = gcc->fArena;
+	fText.arena(fArena.get());
 
 	vector<std::pair<uint32_t, uint32_t> >::iterator i = gcc->fGroupCols.begin();
 	while (i != gcc->fGroupCols.end())
 		fConcatColumns.push_back((*(i++)).second);
-
-	uint64_t newSize = fRowsPerRG * fRowGroup.getRowSize();
-	if (!fRm->getMemory(newSize, fSessionMemLimit))
-	{
-		cerr << IDBErrorInfo::instance()->errorMsg(fErrorCode)
-			 << " @" << __FILE__ << ":" << __LINE__;
-		throw IDBExcept(fErrorCode);
-	}
-
-	fMemSize += newSize;
-	//fData.reset(new uint8_t[fRowGroup.getDataSize(fRowsPerRG)]);
-	fData.reinit(fRowGroup, fRowsPerRG);
-	fRowGroup.setData(&fData);
-	fRowGroup.resetRowGroup(0);
-	fRowGroup.initRow(&fRow);
-	fRowGroup.getRow(0, &fRow);
 }
 
 
 void GroupConcatNoOrder::processRow(const rowgroup::Row& row)
 {
-	// if the row count is less than the limit
-	if (fCurrentLength < fGroupConcatLen && concatColIsNull(row) == false)
-	{
-		copyRow(row, &fRow);
-		//memcpy(fRow.getData(), row.getData(), row.getSize());
-
-		// the RID is no meaning here, use it to store the estimated length.
-		int16_t estLen = lengthEstimate(fRow);
-		fRow.setRid(estLen);
-		fCurrentLength += estLen;
-		fRowGroup.incRowCount();
-		fRow.nextRow();
-
-		if (fRowGroup.getRowCount() >= fRowsPerRG)
-		{
-			uint64_t newSize = fRowsPerRG * fRowGroup.getRowSize();
-
-			if (!fRm->getMemory(newSize, fSessionMemLimit))
-			{
-				cerr << IDBErrorInfo::instance()->errorMsg(fErrorCode)
-					 << " @" << __FILE__ << ":" << __LINE__;
-				throw IDBExcept(fErrorCode);
-			}
-			fMemSize += newSize;
+	if (fText.length() >= fGroupConcatLen || concatColIsNull(row))
+		return;
 
-			fDataQueue.push(fData);
-			fData.reinit(fRowGroup, fRowsPerRG);
-			//fData.reset(new uint8_t[fRowGroup.getDataSize(fRowsPerRG)]);
-			fRowGroup.setData(&fData);
-			fRowGroup.resetRowGroup(0);
-			fRowGroup.getRow(0, &fRow);
-		}
-	}
+	if (fText.length() > 0)
+		fText.append(fSeparator.data(), fSeparator.length());
+	outputRow(fText, row);
 }
 
 
 void GroupConcatNoOrder::merge(GroupConcator* gc)
 {
 	GroupConcatNoOrder* in = dynamic_cast<GroupConcatNoOrder*>(gc);
-	while (in->fDataQueue.size() > 0)
-	{
-		fDataQueue.push(in->fDataQueue.front());
-		in->fDataQueue.pop();
-	}
 
-	fDataQueue.push(in->fData);
-	fMemSize += in->fMemSize;
-	in->fMemSize = 0;
+	if (in->fText.length() == 0 || fText.length() >= fGroupConcatLen)
+		return;
+
+	if (fText.length() > 0)
+		fText.append(fSeparator.data(), fSeparator.length());
+	fText.splice(in->fText);
 }
 
 
-void GroupConcatNoOrder::getResult(uint8_t* buff, const string &sep)
+void GroupConcatNoOrder::getResult(uint8_t* buff, const string&)
 {
-	ostringstream oss;
-	bool addSep = false;
-
-	fDataQueue.push(fData);
-	while (fDataQueue.size() > 0)
-	{
-		fRowGroup.setData(&fDataQueue.front());
-		fRowGroup.getRow(0, &fRow);
-		for (uint64_t i = 0; i < fRowGroup.getRowCount(); i++)
-		{
-			if (addSep)
-				oss << sep;
-			else
-				addSep = true;
-
-			outputRow(oss, fRow);
-			fRow.nextRow();
-		}
-
-		fDataQueue.pop();
-	}
-
-	strncpy((char*) buff, oss.str().c_str(), fGroupConcatLen);
+	size_t len = fText.copyOut(buff, fGroupConcatLen);
+	buff[len] = '\0';
 }
 
 
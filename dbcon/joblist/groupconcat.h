@@ -26,9 +26,12 @@
 #include <utility>
 #include <set>
 #include <vector>
+#include <algorithm>
+#include <cstring>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
 
+#include "queryarena.h"     // QueryArena
 #include "returnedcolumn.h" // SRCP
 #include "rowgroup.h"       // RowGroup
 #include "rowaggregation.h" // SP_GroupConcat
@@ -96,6 +99,60 @@ protected:
 };
 
 
+// The text of one GROUP_CONCAT result as it is built, in a chain of chunks taken
+// from the query arena.  Chunks double in size up to 64KB, so the many short results
+// stay small and long ones never get copied to grow.
+class GroupConcatText
+{
+public:
+	GroupConcatText() : fHead(NULL), fTail(NULL), fLength(0) { }
+
+	void arena(utils::QueryArena* arena) { fArena.reset(arena); }
+	int64_t length() const { return fLength; }
+
+	inline void append(const char* s, size_t len);
+
+	// moves all of other's text onto the end of this one without copying it
+	void splice(GroupConcatText& other);
+
+	// copies out up to max bytes, returns how many
+	size_t copyOut(uint8_t* buff, size_t max) const;
+
+private:
+	struct Chunk
+	{
+		Chunk*   next;
+		uint32_t capacity;
+		uint32_t used;
+		char*    data() { return (char*) (this + 1); }
+	};
+
+	void addChunk(size_t minSize);
+
+	Chunk*                                fHead;
+	Chunk*                                fTail;
+	int64_t                               fLength;
+	utils::QueryArena::Ref                fArena;
+};
+
+
+inline void GroupConcatText::append(const char* s, size_t len)
+{
+	while (len > 0)
+	{
+		if (fTail == NULL || fTail->used == fTail->capacity)
+			addChunk(len);
+
+		size_t n = std::min(len, (size_t) (fTail->capacity - fTail->used));
+		memcpy(fTail->data() + fTail->used, s, n);
+		fTail->used += n;
+		fLength += n;
+		s += n;
+		len -= n;
+	}
+}
+
+
 // GROUP_CONCAT base
 class GroupConcator
 {
@@ -114,7 +171,8 @@ public:
 
 protected:
 	virtual bool concatColIsNull(const rowgroup::Row&);
-	virtual void outputRow(std::ostringstream&, const rowgroup::Row&);
+	// Out is std::string or GroupConcatText
+	template<typename Out> void outputRow(Out&, const rowgroup::Row&);
 	virtual int64_t lengthEstimate(const rowgroup::Row&);
 
 	std::vector<uint32_t>                 fConcatColumns;
@@ -127,6 +185,8 @@ protected:
 
 
 // For GROUP_CONCAT withour distinct or orderby
+// Rows are formatted as they arrive, straight into the result text, and ignored
+// once it reaches group_concat_max_len.  Merging just joins the texts.
 class GroupConcatNoOrder : public GroupConcator
 {
 public:
@@ -142,15 +202,9 @@ public:
 	const std::string toString() const;
 
 protected:
-	rowgroup::RowGroup                    fRowGroup;
-	rowgroup::Row                         fRow;
-	rowgroup::RGData                      fData;
-	std::queue<rowgroup::RGData>          fDataQueue;
-	uint64_t                              fRowsPerRG;
-	uint64_t                              fErrorCode;
-	uint64_t                              fMemSize;
-	ResourceManager*                      fRm;
-	boost::shared_ptr<int64_t>			  fSessionMemLimit;
+	GroupConcatText                       fText;
+	std::string                           fSeparator;
+	boost::shared_ptr<utils::QueryArena>  fArena;
 };
 
 
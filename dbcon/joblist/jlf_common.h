@@ -47,6 +47,7 @@
 
 #include "resourcemanager.h"
 #include "rowgroup.h"
+#include "queryarena.h"
 
 // forward reference
 namespace execplan
@@ -58,6 +59,8 @@ class SimpleColumn;
 
 namespace joblist
 {
+class CrossEngineCache;
+
 // for output error messages to screen.
 const std::string boldStart = "\033[0;1m";
 const std::string boldStop = "\033[0;39m";
@@ -298,6 +301,9 @@ struct JobInfo
 	std::map<int, uint64_t> tableSize;
 	int64_t joinNum;
 
+	// extents of the join key columns, read once for the join planner
+	std::map<execplan::CalpontSystemCatalog::OID, std::vector<BRM::EMEntry> > keyExtents;
+
 	// for subquery
 	boost::shared_ptr<int> subCount;      // # of subqueries in the query statement
 	int                    subLevel;      // subquery level
@@ -359,6 +365,10 @@ struct JobInfo
 	/* Disk-based join vars */
 	boost::shared_ptr<int64_t> smallSideUsage;
 	boost::shared_ptr<int64_t> umMemLimit;
+	// UM operator memory charged to umMemLimit, freed when the last step using it goes
+	boost::shared_ptr<utils::QueryArena> queryArena;
+	// cross-engine results, shared by the steps that run the same foreign query
+	boost::shared_ptr<CrossEngineCache> crossEngineCache;
 	int64_t smallSideLimit;    // need to get these from a session var in execplan
 	int64_t largeSideLimit;
 	uint64_t partitionSize;
@@ -66,6 +66,7 @@ using namespace dataconvert;
 #include "tupleunion.h"
 #include "windowfunctionstep.h"
 #include "configcpp.h"
+#include "rowestimator.h"
 #include "jlf_tuplejoblist.h"
 using namespace joblist;
 
@@ -1858,10 +1859,13 @@ uint32_t getLargestTable(JobInfo& jobInfo, TableInfoMap& tableInfoMap, bool over
 	}
 
 	// Algorithm to dynamically determine the largest table.
-	uint64_t largestCardinality = 0;
+	// Every other table ends up on a small side and gets hashed, so stream the one that
+	// would cost the most to hash: estimated rows times the width of its rows.
+	uint64_t largestCost = 0;
 	uint64_t estimatedRowCount = 0;
+	ostringstream trace;
 
-	// Loop through the tables and find the one with the largest estimated cardinality.
+	// Loop through the tables and find the one with the largest estimated cost.
 	for (uint32_t i = 0; i < jobInfo.tableList.size(); i++)
 	{
 		jobInfo.tableSize[jobInfo.tableList[i]] = 0;
@@ -1879,10 +1883,16 @@ uint32_t getLargestTable(JobInfo& jobInfo, TableInfoMap& tableInfoMap, bool over
 				{
 					estimatedRowCount = tupleBPS->getEstimatedRowCount();
 					jobInfo.tableSize[jobInfo.tableList[i]] = estimatedRowCount;
-					if (estimatedRowCount > largestCardinality)
+					it->second.fEstRows = estimatedRowCount;
+					uint64_t width = max(it->second.fRowGroup.getRowSize(), 1U);
+					uint64_t cost = estimatedRowCount * width;
+					if (jobInfo.trace)
+						trace << "  " << it->second.fAlias << ": est rows-" << estimatedRowCount
+							  << " row width-" << width << " cost-" << cost << endl;
+					if (cost > largestCost)
 					{
 						ret = jobInfo.tableList[i];
-						largestCardinality = estimatedRowCount;
+						largestCost = cost;
 					}
 					break;
 				}
@@ -1897,10 +1907,73 @@ uint32_t getLargestTable(JobInfo& jobInfo, TableInfoMap& tableInfoMap, bool over
 		jobInfo.tableSize[ret] = numeric_limits<uint64_t>::max();
 	}
 
+	if (jobInfo.trace)
+		cout << boldStart << "\n====== join planner ======\n" << boldStop << trace.str()
+			 << "  large side: " << tableInfoMap[ret].fAlias
+			 << (overrideLargeSideEstimate ? " (hint)" : "") << endl << endl;
+
 	return ret;
 }
 
 
+// Distinct values of a join key from the extent map, bounded by rows.
+// Keys that aren't plain columns of InfiniDB tables are assumed unique.
+uint64_t estimateKeyDistinct(uint32_t key, uint64_t rows, JobInfo& jobInfo)
+{
+	const UniqId& id = jobInfo.keyInfo->tupleKeyVec[key];
+	if (rows == 0 || id.fId < 3000 || id.fPseudo != 0 ||
+		jobInfo.keyInfo->crossEngine[key] ||
+		jobInfo.keyInfo->functionJoinKeys.find(key) != jobInfo.keyInfo->functionJoinKeys.end() ||
+		jobInfo.keyInfo->tupleKeyVec[getTableKey(jobInfo, key)].fId < 3000)
+		return rows;
+
+	map<uint32_t, CalpontSystemCatalog::ColType>::iterator ct = jobInfo.keyInfo->colType.find(key);
+	if (ct == jobInfo.keyInfo->colType.end())
+		return rows;
+
+	map<CalpontSystemCatalog::OID, vector<BRM::EMEntry> >::iterator ex =
+		jobInfo.keyExtents.find(id.fId);
+	if (ex == jobInfo.keyExtents.end())
+	{
+		BRM::DBRM dbrm;
+		vector<BRM::EMEntry> extents;
+		if (dbrm.getExtents(id.fId, extents) != 0)
+			return rows;
+		ex = jobInfo.keyExtents.insert(make_pair(id.fId, extents)).first;
+	}
+
+	RowEstimator rowEstimator;
+	return rowEstimator.estimateDistinct(ex->second, ct->second, rows);
+}
+
+
+// Rows out of joining a small side to rows from the large side.  For an equi-join on a key
+// with d1 and d2 distinct values, each of the larger set of values matches a fraction of
+// the other side: large * small / max(d1, d2).  0 means unknown.
+uint64_t estimateJoinRows(uint64_t largeRows, const JoinInfo& small, JobInfo& jobInfo)
+{
+	uint64_t smallRows = small.fEstRows;
+	JoinType jt = small.fJoinData.fTypes.front();
+	if (largeRows == 0 || smallRows == 0)
+		return largeRows;
+	// at most one output row for each large side row
+	if (jt & (SEMI | ANTI | SCALAR))
+		return largeRows;
+
+	uint64_t d1 = estimateKeyDistinct(small.fJoinData.fRightKeys.front(), largeRows, jobInfo);
+	uint64_t d2 = estimateKeyDistinct(small.fJoinData.fLeftKeys.front(), smallRows, jobInfo);
+	double rows = (double) largeRows * smallRows / max(max(d1, d2), (uint64_t) 1);
+	if (jt & LARGEOUTER)
+		rows = max(rows, (double) largeRows);
+	if (jt & SMALLOUTER)
+		rows = max(rows, (double) smallRows);
+
+	if (rows >= (double) numeric_limits<uint64_t>::max())
+		return numeric_limits<uint64_t>::max();
+	return max((uint64_t) rows, (uint64_t) 1);
+}
+
+
 uint32_t getPrevLarge(uint32_t n, TableInfoMap& tableInfoMap)
 {
 	// root node : no previous node;
@@ -2015,6 +2088,7 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 
 				largeJoinInfo->fDl = tableInfoMap[large].fDl;
 				largeJoinInfo->fRowGroup = tableInfoMap[large].fRowGroup;
+				largeJoinInfo->fEstRows = tableInfoMap[large].fEstRows;
 
 				TableJoinMap::iterator mit = jobInfo.tableJoinMap.find(make_pair(large, cId));
 				if (mit == jobInfo.tableJoinMap.end())
@@ -2056,6 +2130,15 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 		sort(smallSides.begin(), smallSides.end(), joinInfoCompare);
 		int64_t lastJoinId = smallSides.back()->fJoinData.fJoinId;
 
+		// planner estimates of the small sides, and of what comes out of this join
+		vector<uint64_t> smallEstRows;
+		uint64_t joinEstRows = tableInfoMap[large].fEstRows;
+		for (vector<SP_JoinInfo>::iterator i = smallSides.begin(); i != smallSides.end(); i++)
+		{
+			smallEstRows.push_back((*i)->fEstRows);
+			joinEstRows = estimateJoinRows(joinEstRows, **i, jobInfo);
+		}
+
 		// get info to config the TupleHashjoin
 		DataListVec smallSideDLs;
 		vector<RowGroup> smallSideRGs;
@@ -2120,6 +2203,8 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 					<< (info->fJoinData.fTypeless ? " " : " !") << "typeless" << endl;
 				oss << "smallSideIndex-largeSideIndex :" << smallIndex.str() << " --"
 					<< largeIndex.str() << endl;
+				oss << "est rows: small side-" << info->fEstRows << " large side-"
+					<< tableInfoMap[large].fEstRows << endl;
 				oss << "small side RG" << endl << info->fRowGroup.toString() << endl;
 				traces.push_back(oss.str());
 			}
@@ -2166,6 +2251,7 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 			thjs->outputAssociation(outJsa);
 
 			thjs->configSmallSideRG(smallSideRGs, tableNames);
+			thjs->configSmallSideEstimates(smallEstRows);
 			thjs->configLargeSideRG(tableInfoMap[large].fRowGroup);
 			thjs->configJoinKeyIndex(jointypes, typeless, smallKeyIndices, largeKeyIndices);
 
@@ -2183,6 +2269,7 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 			thjs->setLargeSideDLIndex(inJsa.outSize() - 1);
 
 			thjs->addSmallSideRG(smallSideRGs, tableNames);
+			thjs->addSmallSideEstimates(smallEstRows);
 			thjs->addJoinKeyIndex(jointypes, typeless, smallKeyIndices, largeKeyIndices);
 		}
 
@@ -2190,11 +2277,13 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 		constructJoinedRowGroup(rg, link, prevLarge, root, tableSet, tableInfoMap, jobInfo);
 		thjs->setOutputRowGroup(rg);
 		tableInfoMap[large].fRowGroup = rg;
+		tableInfoMap[large].fEstRows = joinEstRows;
 		if (jobInfo.trace)
 		{
 			cout << boldStart  << "\n====== join info ======\n" << boldStop;
 			for (vector<string>::iterator t = traces.begin(); t != traces.end(); ++t)
 				cout << *t;
+			cout << "est rows of join result: " << joinEstRows << endl;
 			cout << "RowGroup join result: " << endl << rg.toString() << endl << endl;
 		}
 
@@ -2394,6 +2483,7 @@ SP_JoinInfo joinToLargeTable(uint32_t large, TableInfoMap& tableInfoMap,
 
 	joinInfo->fDl = tableInfoMap[large].fDl;
 	joinInfo->fRowGroup = tableInfoMap[large].fRowGroup;
+	joinInfo->fEstRows = tableInfoMap[large].fEstRows;
 
 	if (root == false)  // not root
 	{
@@ -44,7 +44,9 @@ struct JoinInfo
 	// @bug 1495 compound join
 	JoinData         fJoinData;
 
-	JoinInfo() : fTableOid(-1) {}
+	uint64_t         fEstRows;  // planner's row estimate, 0 if unknown
+
+	JoinInfo() : fTableOid(-1), fEstRows(0) {}
 };
 typedef boost::shared_ptr<JoinInfo> SP_JoinInfo;
 
@@ -87,8 +89,9 @@ struct TableInfo
 	AnyDataListSPtr           fDl;              // output data list
 	rowgroup::RowGroup        fRowGroup;        // output rowgroup meta data
 	std::set<uint32_t>        fJoinedTables;    // tables directly/indirectly joined to this table
+	uint64_t                  fEstRows;         // planner's row estimate, 0 if unknown
 
-	TableInfo() : fTableOid(-1), fVisited(false) {}
+	TableInfo() : fTableOid(-1), fVisited(false), fEstRows(0) {}
 };
 typedef std::map<uint32_t, TableInfo> TableInfoMap;
 
@@ -21,6 +21,10 @@
 #include "errorcodes.h"
 #include <iterator>
 #include <stdexcept>
+#include <sstream>
+#include <map>
+#include <set>
+#include <iomanip>
 //#define NDEBUG
 #include <cassert>
 using namespace std;
@@ -47,6 +51,52 @@ using namespace execplan;
 namespace joblist
 {
 
+namespace
+{
+typedef std::map<const AnyDataList*, JobStep*> ProducerMap;
+
+// Desc Mode Table Elapsed Rows, as the step's formatMiniStats() left them
+void profileLine(const JobStep* js, ostream& os)
+{
+	const JobStep::ProfileSummary& ps = js->profileSummary();
+
+	if (ps.desc.empty())
+		os << "step " << js->stepId();
+	else
+		os << ps.desc << " " << ps.mode << " " << ps.table;
+
+	if (ps.elapsed >= 0)
+		os << " elapsed-" << ps.elapsed / 1000000 << "." << setw(6) << setfill('0')
+			<< ps.elapsed % 1000000 << setfill(' ') << "s";
+	if (ps.rows >= 0)
+		os << " rows-" << ps.rows;
+
+	if (js->profileCpuTime() > 0)
+		os << " cpu-" << js->profileCpuTime() / 1000 << "ms";
+	os << js->profileDetail();
+}
+
+// Prints js, then the steps feeding its inputs one level deeper.
+void profileTree(JobStep* js, int depth, const ProducerMap& producers,
+	set<JobStep*>& printed, ostream& os)
+{
+	if (!printed.insert(js).second)
+		return;
+
+	os << string(depth * 2, ' ');
+	profileLine(js, os);
+	os << endl;
+
+	const JobStepAssociation& in = js->inputAssociation();
+	for (size_t i = 0; i < in.outSize(); i++)
+	{
+		ProducerMap::const_iterator it = producers.find(in.outAt(i).get());
+		if (it != producers.end())
+			profileTree(it->second, depth + 1, producers, printed, os);
+	}
+}
+}
+
 struct JSJoiner
 {
 	JSJoiner(JobStep *j): js(j) { }
@@ -315,6 +365,7 @@ void JobList::querySummary(bool extendedStats)
 			fStats += i->get()->queryStats();
 			fExtendedInfo += i->get()->extendedInfo();
 			fMiniInfo += i->get()->miniInfo();
+			fProfileInfo += i->get()->profileInfo();
 		}
 
 		JobStepVector::const_iterator qIter = fQuery.begin();
@@ -429,6 +480,9 @@ void JobList::querySummary(bool extendedStats)
 				++dsi;
 			}
 		}
+
+		if (extendedStats)
+			formatProfile();
 	}
 	catch (exception& ex)
 	{
@@ -444,6 +498,59 @@ void JobList::querySummary(bool extendedStats)
 	return;
 }
 
+//------------------------------------------------------------------------------
+// Append the steps of this joblist to fProfileInfo as a tree, each step above
+// the steps that feed it.  Uses the mini info, so only meaningful after
+// querySummary() has collected it.
+//------------------------------------------------------------------------------
+void JobList::formatProfile()
+{
+	vector<JobStep*> steps;
+	set<JobStep*> seen;
+	JobStepVector::const_iterator it;
+	for (it = fQuery.begin(); it != fQuery.end(); ++it)
+		if (seen.insert(it->get()).second)
+			steps.push_back(it->get());
+	for (it = fProject.begin(); it != fProject.end(); ++it)
+		if (seen.insert(it->get()).second)
+			steps.push_back(it->get());
+	for (DeliveredTableMap::iterator dsi = fDeliveredTables.begin(); dsi != fDeliveredTables.end(); ++dsi)
+		if (seen.insert(dsi->second.get()).second)
+			steps.push_back(dsi->second.get());
+
+	ProducerMap producers;
+	set<const AnyDataList*> consumed;
+	for (size_t i = 0; i < steps.size(); i++)
+	{
+		const JobStepAssociation& out = steps[i]->outputAssociation();
+		for (size_t j = 0; j < out.outSize(); j++)
+			producers[out.outAt(j).get()] = steps[i];
+		const JobStepAssociation& in = steps[i]->inputAssociation();
+		for (size_t j = 0; j < in.outSize(); j++)
+			consumed.insert(in.outAt(j).get());
+	}
+
+	ostringstream oss;
+	set<JobStep*> printed;
+
+	// the roots are the steps nobody reads from, normally just the delivery step
+	for (size_t i = 0; i < steps.size(); i++)
+	{
+		const JobStepAssociation& out = steps[i]->outputAssociation();
+		bool isRoot = true;
+		for (size_t j = 0; j < out.outSize() && isRoot; j++)
+			isRoot = (consumed.find(out.outAt(j).get()) == consumed.end());
+		if (isRoot)
+			profileTree(steps[i], 0, producers, printed, oss);
+	}
+
+	// anything not reachable from a root, e.g. steps feeding a PM join directly
+	for (size_t i = 0; i < steps.size(); i++)
+		profileTree(steps[i], 0, producers, printed, oss);
+
+	fProfileInfo += oss.str();
+}
+
 // @bug 828. Added additional information to the graph at the end of execution
 void JobList::graph(uint32_t sessionID)
 {
@@ -77,6 +77,7 @@ public:
 	virtual void PutEngineComm(const DistributedEngineComm*) __attribute__((deprecated)) { }
 	virtual const DeliveredTableMap& deliveredTables() const { return fDeliveredTables; }
 	virtual void querySummary(bool extendedStats);
+	void formatProfile();
 	virtual void graph(uint32_t sessionID);
 
 	virtual const SErrorInfo& errorInfo() const { return errInfo; }
@@ -102,6 +103,10 @@ public:
 	void extendedInfo(const std::string& extendedInfo) { fExtendedInfo = extendedInfo; }
 	const std::string& miniInfo() const { return fMiniInfo; }
 	void miniInfo(const std::string& miniInfo) { fMiniInfo = miniInfo; }
+	/** @brief per-step wall/CPU/wait times and row counts as an indented
+	 *  tree; filled in by querySummary(true).
+	 */
+	const std::string& profileInfo() const { return fProfileInfo; }
 
 	void addSubqueryJobList(const SJLP& sjl) { subqueryJoblists.push_back(sjl); }
 
@@ -141,6 +146,7 @@ protected:
 	querystats::QueryStats fStats;
 	std::string fExtendedInfo;
 	std::string fMiniInfo;
+	std::string fProfileInfo;
 	std::vector<SJLP> subqueryJoblists;
 
 	volatile uint32_t fAborted;
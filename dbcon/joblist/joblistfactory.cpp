@@ -32,6 +32,7 @@ using namespace std;
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/bind.hpp>
 #include <boost/uuid/uuid_io.hpp>
 using namespace boost;
 
@@ -78,6 +79,7 @@ using namespace logging;
 #include "tupleconstantstep.h"
 #include "tuplehavingstep.h"
 #include "windowfunctionstep.h"
+#include "crossenginestep.h"
 
 #include "jlf_common.h"
 #include "jlf_graphics.h"
@@ -1635,6 +1637,10 @@ SJLP makeJobList_(
 	jobInfo.partitionSize = csep->djsPartitionSize();
 	jobInfo.umMemLimit.reset(new int64_t);
 	*(jobInfo.umMemLimit) = csep->umMemLimit();
+	jobInfo.queryArena.reset(new utils::QueryArena(
+		boost::bind(&ResourceManager::getMemory, &jobInfo.rm, _1, jobInfo.umMemLimit, true),
+		boost::bind(&ResourceManager::returnMemory, &jobInfo.rm, _1, jobInfo.umMemLimit)));
+	jobInfo.crossEngineCache.reset(new CrossEngineCache());
 	jobInfo.isDML = csep->isDML();
 
 	jobInfo.smallSideUsage.reset(new int64_t);
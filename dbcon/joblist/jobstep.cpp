@@ -84,7 +84,8 @@ JobStep::JobStep(const JobInfo& j) :
         fLocalQuery(j.localQuery),
         fQueryUuid(j.uuid),
 		fProgress(0),
-		fStartTime(-1)
+		fStartTime(-1),
+		fProfCpuTime(0)
 {
 	QueryTeleServerParms tsp;
 	string teleServerHost(Config::makeConfig()->getConfig("QueryTele", "Host"));
@@ -44,6 +44,7 @@
 #include "querytele.h"
 
 #include "atomicops.h"
+#include "profileclock.h"
 
 #include "branchpred.h"
 
@@ -101,7 +102,7 @@ public:
 
     /** constructor
      */
-	JobStep() { }
+	JobStep() : fProfCpuTime(0) { }
     JobStep(const JobInfo&);
     /** destructor
      */
@@ -233,6 +234,29 @@ public:
 	bool onClauseFilter() const { return fOnClauseFilter; }
 	void onClauseFilter(bool b) { fOnClauseFilter = b;    }
 
+	// CPU time the step's threads spent working, in usec; see StepCpuTimer.
+	void addProfileCpu(uint64_t usec) { atomicops::atomicAdd(&fProfCpuTime, usec); }
+	uint64_t profileCpuTime() const { return fProfCpuTime; }
+	/** @brief step-specific counters appended to this step's line in the
+	 *  profile tree, e.g. the PM breakdown of a TupleBPS.
+	 */
+	virtual std::string profileDetail() const { return std::string(); }
+
+	/** @brief the head of this step's line in the profile tree, set by
+	 *  formatMiniStats() along with the mini info.  elapsed is in usec,
+	 *  elapsed and rows are -1 when the step doesn't time or count them.
+	 */
+	struct ProfileSummary
+	{
+		ProfileSummary() : elapsed(-1), rows(-1) { }
+		std::string desc;
+		std::string mode;
+		std::string table;
+		int64_t elapsed;
+		int64_t rows;
+	};
+	const ProfileSummary& profileSummary() const { return fProfileSummary; }
+
 protected:
 
 	//@bug6088, for telemetry posting
@@ -253,6 +277,16 @@ protected:
 			fLastStepTeleTime = crntTime;
 		}
 	}
+	void profileSummary(const std::string& desc, const std::string& mode,
+		const std::string& table, int64_t elapsed, int64_t rows)
+	{
+		fProfileSummary.desc = desc;
+		fProfileSummary.mode = mode;
+		fProfileSummary.table = table;
+		fProfileSummary.elapsed = elapsed;
+		fProfileSummary.rows = rows;
+	}
+
 	void postStepSummaryTele(querytele::StepTeleStats& sts)
 	{
 		sts.start_time = fStartTime;
@@ -298,6 +332,8 @@ protected:
 	uint64_t fProgress;
 	int64_t  fStartTime;
 	int64_t  fLastStepTeleTime;
+	volatile uint64_t fProfCpuTime;
+	ProfileSummary fProfileSummary;
 
 private:
     static boost::mutex fLogMutex;
@@ -306,6 +342,21 @@ private:
 };
 
 
+/** @brief adds the CPU time the current thread spends in the enclosing
+ *  scope to a step's profile.  Put one at the top of each worker thread's
+ *  entry point; don't nest them on the same thread.
+ */
+class StepCpuTimer
+{
+public:
+	explicit StepCpuTimer(JobStep* js) : fStep(js), fStart(utils::threadCpuUsec()) { }
+	~StepCpuTimer() { fStep->addProfileCpu(utils::threadCpuUsec() - fStart); }
+private:
+	JobStep* fStep;
+	uint64_t fStart;
+};
+
+
 class TupleJobStep
 {
 public:
@@ -0,0 +1,194 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <ctime>
+#include <cstring>
+using namespace std;
+
+#include <boost/thread/mutex.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+using namespace boost;
+
+#include "jointabledirectory.h"
+
+namespace
+{
+boost::mutex instanceLock;
+joblist::JoinTableDirectory* directoryInstance = 0;
+
+// tables not used for this long are dropped even if there's room for them
+const time_t maxIdleSeconds = 30 * 60;
+}
+
+namespace joblist
+{
+
+JoinTableDirectory::JoinTableDirectory(uint64_t maxMemory) :
+	fMaxMemory(maxMemory), fCurMemory(0)
+{
+	// Ids only have to be unique, but PMs are shared by every UM, and they have to
+	// stay unique across ExeMgr restarts.  The high half is random per process.
+	uuids::uuid u = uuids::random_generator()();
+	uint32_t salt;
+	memcpy(&salt, u.data, sizeof(salt));
+	fNextID = ((uint64_t) salt << 32) + 1;
+}
+
+JoinTableDirectory* JoinTableDirectory::instance(uint64_t maxMemory)
+{
+	mutex::scoped_lock lk(instanceLock);
+	if (!directoryInstance)
+		directoryInstance = new JoinTableDirectory(maxMemory);
+	return directoryInstance;
+}
+
+void JoinTableDirectory::reset()
+{
+	mutex::scoped_lock lk(instanceLock);
+	if (directoryInstance)
+		directoryInstance->clear();
+}
+
+uint64_t JoinTableDirectory::acquire(uint64_t fingerprint, uint32_t rows,
+	uint64_t keySignature, uint64_t bytes, bool *cached)
+{
+	time_t now = time(0);
+	LRU_t::iterator it;
+
+	*cached = false;
+	mutex::scoped_lock lk(fMutex);
+
+	Index_t::iterator fit = fByFingerprint.find(fingerprint);
+	if (fit != fByFingerprint.end()) {
+		it = fit->second;
+		// a query that's still sending it, or one that failed with it, owns it for now
+		if (!it->ready || it->doomed)
+			return 0;
+		// the fingerprints collide; neither small side gets cached
+		if (it->rows != rows || it->keySignature != keySignature) {
+			if (it->users == 0)
+				remove(it);
+			else
+				it->doomed = true;
+			return 0;
+		}
+		if (now - it->lastUse <= maxIdleSeconds || it->users > 0) {
+			it->users++;
+			it->lastUse = now;
+			fLRU.splice(fLRU.begin(), fLRU, it);
+			*cached = true;
+			return it->id;
+		}
+		remove(it);
+	}
+
+	if (bytes > fMaxMemory)
+		return 0;
+
+	/* make room, oldest first, skipping the ones in use */
+	LRU_t::iterator victim = fLRU.end();
+	while (fCurMemory + bytes > fMaxMemory && victim != fLRU.begin()) {
+		--victim;
+		if (victim->users == 0) {
+			LRU_t::iterator tmp = victim++;
+			remove(tmp);
+		}
+	}
+	if (fCurMemory + bytes > fMaxMemory)
+		return 0;
+
+	Entry e;
+	e.fingerprint = fingerprint;
+	e.id = fNextID++;
+	e.bytes = bytes;
+	e.keySignature = keySignature;
+	e.rows = rows;
+	e.users = 1;
+	e.ready = false;
+	e.doomed = false;
+	e.lastUse = now;
+	fLRU.push_front(e);
+	fByFingerprint[fingerprint] = fLRU.begin();
+	fByID[e.id] = fLRU.begin();
+	fCurMemory += bytes;
+	return e.id;
+}
+
+void JoinTableDirectory::release(uint64_t id, bool ok)
+{
+	mutex::scoped_lock lk(fMutex);
+
+	Index_t::iterator iit = fByID.find(id);
+	if (iit == fByID.end())
+		return;
+
+	LRU_t::iterator it = iit->second;
+	if (it->users > 0)
+		it->users--;
+	if (ok && !it->ready && !it->doomed)
+		it->ready = true;
+	else if (!ok)
+		it->doomed = true;
+
+	if (it->doomed && it->users == 0)
+		remove(it);
+}
+
+void JoinTableDirectory::takeDrops(vector<uint64_t> &out)
+{
+	mutex::scoped_lock lk(fMutex);
+	out.swap(fDrops);
+	fDrops.clear();
+}
+
+uint64_t JoinTableDirectory::memoryUsed()
+{
+	mutex::scoped_lock lk(fMutex);
+	return fCurMemory;
+}
+
+void JoinTableDirectory::remove(LRU_t::iterator it)
+{
+	fDrops.push_back(it->id);
+	fCurMemory -= it->bytes;
+	fByID.erase(it->id);
+	Index_t::iterator fit = fByFingerprint.find(it->fingerprint);
+	if (fit != fByFingerprint.end() && fit->second == it)
+		fByFingerprint.erase(fit);
+	fLRU.erase(it);
+}
+
+void JoinTableDirectory::clear()
+{
+	mutex::scoped_lock lk(fMutex);
+	LRU_t::iterator it = fLRU.begin();
+
+	/* The PMs that are still up keep their copies until they're told to drop them.
+	   Tables in use go when the queries using them finish. */
+	while (it != fLRU.end()) {
+		if (it->users == 0)
+			remove(it++);
+		else {
+			it->doomed = true;
+			++it;
+		}
+	}
+}
+
+}
+// vim:ts=4 sw=4:
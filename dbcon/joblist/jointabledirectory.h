@@ -0,0 +1,116 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef JOINTABLEDIRECTORY_H_
+#define JOINTABLEDIRECTORY_H_
+
+#include <list>
+#include <map>
+#include <vector>
+#include <ctime>
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+namespace joblist
+{
+
+/** @brief the UM's record of the join tables the PMs are keeping for it
+ *
+ * A PM join normally ships the whole small side to every PM, where it's turned into
+ * a hash table that is thrown away at the end of the query.  With HashJoin/PmJoinCacheSize
+ * set, the PMs keep those tables and a later query with an identical small side uses
+ * them instead.  Small sides are identified by a fingerprint of their contents (see
+ * TupleJoiner::canonicalizeSmallSide()), so DML and cpimport that change a dimension
+ * table simply produce a different fingerprint; a stale table is never used, it just
+ * ages out.  The row count and a signature of the key columns are kept with the
+ * fingerprint, and a table whose fingerprint matches but those don't is not used.
+ * The PMs check the same two things before using their copy.
+ *
+ * This class decides what the PMs keep.  Each cached table gets an id that is never
+ * reused.  The first query to use a small side stores its table under the id; it
+ * becomes usable once that query has finished successfully.  Tables are charged an
+ * estimate of their PM memory and evicted least recently used first, but never while
+ * a query is using them.  Evicted ids are handed to the next query to send to the PMs.
+ */
+class JoinTableDirectory
+{
+public:
+	/* maxMemory only matters on the first call */
+	static JoinTableDirectory* instance(uint64_t maxMemory);
+
+	/** @brief forget everything, e.g. because a PM restarted */
+	static void reset();
+
+	/** @brief returns the id a query should use for the small side with this
+	 *  fingerprint, row count and key signature, or 0 if it shouldn't be cached.
+	 *  cached is set to true if the PMs have it, false if the query should send it
+	 *  and have the PMs store it.  Every nonzero id returned has to be passed to
+	 *  release().
+	 */
+	uint64_t acquire(uint64_t fingerprint, uint32_t rows, uint64_t keySignature,
+		uint64_t bytes, bool *cached);
+
+	/** @brief the query is done with id.  ok is false if it failed, in which case
+	 *  the table isn't trusted to be on every PM and is dropped.
+	 */
+	void release(uint64_t id, bool ok);
+
+	/** @brief ids the PMs should drop */
+	void takeDrops(std::vector<uint64_t> &out);
+
+	/** @brief the estimated PM memory of the tables kept */
+	uint64_t memoryUsed();
+
+private:
+	explicit JoinTableDirectory(uint64_t maxMemory);
+	JoinTableDirectory(const JoinTableDirectory &);
+	JoinTableDirectory & operator=(const JoinTableDirectory &);
+
+	struct Entry {
+		uint64_t fingerprint;
+		uint64_t id;
+		uint64_t bytes;
+		uint64_t keySignature;
+		uint32_t rows;
+		uint32_t users;
+		bool ready;
+		bool doomed;		// drop when the last user releases it
+		time_t lastUse;
+	};
+	typedef std::list<Entry> LRU_t;
+	typedef std::map<uint64_t, LRU_t::iterator> Index_t;
+
+	void remove(LRU_t::iterator it);
+	void clear();
+
+	uint64_t fMaxMemory;
+	uint64_t fCurMemory;
+	uint64_t fNextID;
+	LRU_t fLRU;				// most recently used at the front
+	Index_t fByFingerprint;
+	Index_t fByID;
+	std::vector<uint64_t> fDrops;
+	boost::mutex fMutex;
+};
+
+}
+
+#endif
+// vim:ts=4 sw=4:
@@ -811,6 +811,8 @@ void pDictionaryScan::formatMiniStats()
 	    << JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " "
 		<< fRidResults << " ";
 	fMiniInfo += oss.str();
+	profileSummary("DSS", "PM", fAlias,
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), fRidResults);
 }
 
 
@@ -128,6 +128,10 @@ enum ISMPACKETCOMMAND
 	BATCH_PRIMITIVE_END_JOINER  = PRIM_LOCALBASE+11,
 	BATCH_PRIMITIVE_ACK			= PRIM_LOCALBASE+12,
 	BATCH_PRIMITIVE_ABORT		= PRIM_LOCALBASE+13,
+	MULTICAST_REF				= PRIM_LOCALBASE+14,	// process the message that came by multicast
+	MULTICAST_NAK				= PRIM_LOCALBASE+15,	// PM->UM, a multicast message didn't arrive
+	JOIN_TABLE_NAK				= PRIM_LOCALBASE+16,	// PM->UM, a cached join table is gone, resend the small side
+	MULTICAST_ACK				= PRIM_LOCALBASE+17,	// PM->UM, a multicast message arrived
 
 	//max of 100-50=50 commands
 	COL_RESULTS                 = PRIM_COLBASE+0,
@@ -772,6 +776,21 @@ struct LbidAtVer
 	uint32_t Ver;
 };
 
+/* Per-job profiling counters.  A rowgroup BPP appends one of these after
+ * the I/O counts of every counted response; the values cover the work done
+ * since the previous one.  Times are in usec. */
+struct BPPProfile
+{
+	uint64_t queueWait;		// time the job waited in the PrimProc thread pool
+	uint64_t filterTime;	// scan and filter commands
+	uint64_t joinTime;		// PM hash joins
+	uint64_t projectTime;	// projection, including F&E group 1
+	uint64_t aggTime;		// F&E group 2 and PM aggregation
+	uint64_t cpuTime;		// thread CPU time for all of the above
+	uint64_t rowsIn;		// rows that passed the filter steps
+	uint64_t rowsOut;		// rows put in the response(s)
+};
+
 #ifdef _MSC_VER
 #pragma warning (pop)
 #endif
@@ -935,6 +935,7 @@ public:
 	virtual uint64_t msgBytesIn    () const { return fMsgBytesIn; }
 	virtual uint64_t msgBytesOut   () const { return fMsgBytesOut;}
 	virtual uint64_t blockTouched  () const { return fBlockTouched;}
+	virtual std::string profileDetail() const;
 	uint32_t nextBand(messageqcpp::ByteStream &bs);
 
 	//...Currently only supported by pColStep and pColScanStep, so didn't bother
@@ -1096,6 +1097,8 @@ private:
 	uint64_t fMsgBytesIn;   // total byte count for incoming messages
 	uint64_t fMsgBytesOut;  // total byte count for outcoming messages
 	uint64_t fBlockTouched; // total blocks touched
+	BPPProfile fPMProfile;	// summed over all PM responses
+	uint64_t fUMWaitTime;	// usec the receive threads spent waiting for PM responses
     uint32_t fExtentsPerSegFile;//config num of Extents Per Segment File
     boost::shared_ptr<boost::thread> cThread;  //consumer thread
 	boost::shared_ptr<boost::thread> pThread;  //producer thread
@@ -1114,6 +1117,7 @@ private:
 
 	void serializeJoiner();
 	void serializeJoiner(uint32_t connectionNumber);
+	void resendJoiners(messageqcpp::ByteStream &nak);
 
 	void generateJoinResultSet(const std::vector<std::vector<rowgroup::Row::Pointer> > &joinerOutput,
 	  rowgroup::Row &baseRow, const std::vector<boost::shared_array<int> > &mappings,
@@ -333,6 +333,20 @@ bool ResourceManager::userPriorityEnabled() const
 	return "Y" == val;
 }
 
+bool ResourceManager::multicastEnabled() const
+{
+	std::string val(getStringVal("Multicast", "Enabled", "N" ));
+	boost::to_upper(val);
+	return "Y" == val;
+}
+
+bool ResourceManager::getEmShareCatalogCache() const
+{
+	std::string val(getStringVal(fExeMgrStr, "ShareCatalogCache", "Y" ));
+	boost::to_upper(val);
+	return "Y" == val;
+}
+
 bool ResourceManager::getMemory(int64_t amount, boost::shared_ptr<int64_t> sessionLimit, bool patience)
 {
 	bool ret1 = (atomicops::atomicSub(&totalUmMemLimit, amount) >= 0);
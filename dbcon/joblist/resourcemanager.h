@@ -98,6 +98,7 @@ namespace joblist
   const int defaultEMMaxPct = 95;
   const int defaultEMPriority = 21; // @Bug 3385
   const int defaultEMExecQueueSize = 20;
+  const uint64_t defaultEMResultCacheMaxMemory = 0;  // result cache off
 
 
   const uint64_t defaultInitialCapacity = 1024 * 1024;
@@ -118,11 +119,22 @@ namespace joblist
   /* HJ CP feedback, see bug #1465 */
   const uint32_t defaultHjCPUniqueLimit = 100;
 
+  /* PM join tables kept for reuse across queries, see JoinTableDirectory */
+  const uint64_t defaultHjPmJoinCacheSize = 0;  // off
+
   // Order By and Limit
   const uint64_t defaultOrderByLimitMaxMemory = 1 * 1024 * 1024 * 1024ULL;
 
   const uint64_t defaultDECThrottleThreshold = 200000000;  // ~200 MB
 
+  /* smaller one-to-all PM messages aren't worth a multicast transfer */
+  const uint64_t defaultMulticastMinMsgSize = 1024 * 1024;
+  /* multicast messages some PM hasn't answered for yet, kept to resend */
+  const uint64_t defaultMulticastMaxKeptSize = 256 * 1024 * 1024;
+
+  /* cross-engine tables are fetched over this many connections, split by primary key */
+  const uint32_t defaultCrossEngineConnections = 4;
+
   const uint8_t defaultUseCpimport = 1;
   /** @brief ResourceManager
    *	Returns requested values from Config
@@ -154,12 +166,14 @@ namespace joblist
     int  	getEmMaxPct() const { return  getUintVal(fExeMgrStr, "MaxPct", defaultEMMaxPct); }
     EXPORT int  	getEmPriority() const;
     int  	getEmExecQueueSize() const { return  getUintVal(fExeMgrStr, "ExecQueueSize", defaultEMExecQueueSize); }
+    uint64_t	getEmResultCacheMaxMemory() const { return  getUintVal(fExeMgrStr, "ResultCacheMaxMemory", defaultEMResultCacheMaxMemory); }
 
     int	      	getHjMaxBuckets() const { return  getUintVal(fHashJoinStr, "MaxBuckets", defaultHJMaxBuckets); }
     unsigned  	getHjNumThreads() const { return  fHjNumThreads; } //getUintVal(fHashJoinStr, "NumThreads", defaultNumThreads); }
     uint64_t  	getHjMaxElems()  const { return  getUintVal(fHashJoinStr, "MaxElems", defaultHJMaxElems); }
     uint32_t  	getHjFifoSizeLargeSide() const { return  getUintVal(fHashJoinStr, "FifoSizeLargeSide", defaultHJFifoSizeLargeSide); }
 	uint32_t 		getHjCPUniqueLimit() const { return getUintVal(fHashJoinStr, "CPUniqueLimit", defaultHjCPUniqueLimit); }
+    uint64_t	getHjPmJoinCacheSize() const { return getUintVal(fHashJoinStr, "PmJoinCacheSize", defaultHjPmJoinCacheSize); }
 	uint64_t	getPMJoinMemLimit() const { return pmJoinMemLimit; }
 
     uint32_t  	getJLFlushInterval() const { return  getUintVal(fJobListStr, "FlushInterval", defaultFlushInterval); }
@@ -223,6 +237,15 @@ namespace joblist
 	uint64_t	getDECThrottleThreshold() const
 	{ return getUintVal(fJobListStr, "DECThrottleThreshold", defaultDECThrottleThreshold); }
 
+	uint64_t	getMulticastMinMsgSize() const
+	{ return getUintVal("Multicast", "MinMsgSize", defaultMulticastMinMsgSize); }
+
+	uint64_t	getMulticastMaxKeptSize() const
+	{ return getUintVal("Multicast", "MaxKeptSize", defaultMulticastMaxKeptSize); }
+
+	uint32_t	getCrossEngineConnections() const
+	{ return getUintVal("CrossEngineSupport", "Connections", defaultCrossEngineConnections); }
+
     EXPORT void  emServerThreads();
     EXPORT void  emServerQueueSize();
     EXPORT void  emSecondsBetweenMemChecks();
@@ -329,6 +352,8 @@ namespace joblist
 	EXPORT bool getMysqldInfo(std::string& h, std::string& u, std::string& w, unsigned int& p) const;
 	EXPORT bool queryStatsEnabled() const;
 	EXPORT bool userPriorityEnabled() const;
+	EXPORT bool multicastEnabled() const;
+	EXPORT bool getEmShareCatalogCache() const;
 
 	uint64_t getConfiguredUMMemLimit() const { return configuredUmMemLimit; }
   private:
@@ -543,5 +543,72 @@ uint64_t RowEstimator::estimateRowsForNonCPColumn(ColumnCommandJL& colCmd)
 	return estimatedRows;
 }
 
+// The union of the valid casual partitioning ranges bounds the distinct values of the whole column.
+// Only integer and date types are handled, the ranges of the other types don't say much about how
+// many values are in between.
+uint64_t RowEstimator::estimateDistinct(const vector<EMEntry>& extents,
+					const CalpontSystemCatalog::ColType& ct,
+					uint64_t rows)
+{
+	bool isUnsigned = false;
+	switch (ct.colDataType)
+	{
+		case CalpontSystemCatalog::UTINYINT:
+		case CalpontSystemCatalog::USMALLINT:
+		case CalpontSystemCatalog::UMEDINT:
+		case CalpontSystemCatalog::UINT:
+		case CalpontSystemCatalog::UBIGINT:
+			isUnsigned = true;
+			break;
+		case CalpontSystemCatalog::TINYINT:
+		case CalpontSystemCatalog::SMALLINT:
+		case CalpontSystemCatalog::MEDINT:
+		case CalpontSystemCatalog::INT:
+		case CalpontSystemCatalog::BIGINT:
+		case CalpontSystemCatalog::DATE:
+		case CalpontSystemCatalog::DATETIME:
+			break;
+		default:
+			return rows;
+	}
+
+	// decimals are stored scaled, their ranges count the same as integers
+	if (ct.scale != 0 || extents.empty())
+		return rows;
+
+	uint64_t lo = 0, hi = 0;
+	for (uint32_t i = 0; i < extents.size(); i++)
+	{
+		const EMCasualPartition_t& cp = extents[i].partition.cprange;
+		// an extent without a valid range could hold anything
+		if (cp.isValid != BRM::CP_VALID)
+			return rows;
+
+		uint64_t elo = adjustValue(ct, cp.lo_val);
+		uint64_t ehi = adjustValue(ct, cp.hi_val);
+		if (i == 0)
+		{
+			lo = elo;
+			hi = ehi;
+		}
+		else if (isUnsigned || ct.colDataType == CalpontSystemCatalog::DATE ||
+				 ct.colDataType == CalpontSystemCatalog::DATETIME)
+		{
+			lo = std::min(lo, elo);
+			hi = std::max(hi, ehi);
+		}
+		else
+		{
+			lo = (uint64_t) std::min((int64_t) lo, (int64_t) elo);
+			hi = (uint64_t) std::max((int64_t) hi, (int64_t) ehi);
+		}
+	}
+
+	uint64_t distinct = hi - lo + 1;
+	if (distinct == 0 || distinct > rows)   // 0 is a wrapped full range
+		distinct = rows;
+	return (distinct > 0 ? distinct : 1);
+}
+
 } //namespace joblist
 
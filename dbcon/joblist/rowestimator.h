@@ -74,6 +74,19 @@ public:
 	*/
 	uint64_t estimateRowsForNonCPColumn(ColumnCommandJL& colCmd);
 
+	/** @brief Estimate the number of distinct values in a column from the casual partitioning
+	*          ranges of its extents.  Used by the join planner for join key columns.
+	*
+	* @param extents The column's extents.
+	* @param ct      The column type.
+	* @param rows    The estimated number of rows in the table, which bounds the result.
+	*
+	* Returns rows when the ranges can't tell anything, i.e. the keys are assumed unique.
+	*/
+	uint64_t estimateDistinct(const std::vector<BRM::EMEntry>& extents,
+				  const execplan::CalpontSystemCatalog::ColType& ct,
+				  uint64_t rows);
+
 private:
 	/** @brief adjusts column values so that they can be compared via ranges.
 	*
@@ -124,6 +124,8 @@ SJSTEP& SubQueryTransformer::makeSubQueryStep(execplan::CalpontSelectExecutionPl
 	fSubJobInfo->smallSideUsage = fOutJobInfo->smallSideUsage;
 	fSubJobInfo->partitionSize = fOutJobInfo->partitionSize;
 	fSubJobInfo->umMemLimit = fOutJobInfo->umMemLimit;
+	fSubJobInfo->queryArena = fOutJobInfo->queryArena;
+	fSubJobInfo->crossEngineCache = fOutJobInfo->crossEngineCache;
 	fSubJobInfo->isDML = fOutJobInfo->isDML;
 
 	// Update v-table's alias.
@@ -0,0 +1,184 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file
+ * JoinTableDirectory tests: what a query is told about the PM join tables.
+ */
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "jointabledirectory.h"
+using namespace joblist;
+
+namespace
+{
+
+const uint64_t maxMemory = 1000;
+
+JoinTableDirectory* directory()
+{
+	vector<uint64_t> drops;
+
+	JoinTableDirectory::reset();
+	JoinTableDirectory *dir = JoinTableDirectory::instance(maxMemory);
+	dir->takeDrops(drops);
+	return dir;
+}
+
+bool dropped(JoinTableDirectory *dir, uint64_t id)
+{
+	vector<uint64_t> drops;
+
+	dir->takeDrops(drops);
+	return find(drops.begin(), drops.end(), id) != drops.end();
+}
+
+}
+
+class JoinTableDirectoryTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(JoinTableDirectoryTest);
+
+CPPUNIT_TEST(jointable_reuse_1);
+CPPUNIT_TEST(jointable_failed_1);
+CPPUNIT_TEST(jointable_mismatch_1);
+CPPUNIT_TEST(jointable_evict_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+public:
+	/* the first query stores it, the next ones reuse it once it's done */
+	void jointable_reuse_1() {
+		JoinTableDirectory *dir = directory();
+		bool cached = true;
+		uint64_t id, id2;
+
+		id = dir->acquire(11, 100, 7, 200, &cached);
+		CPPUNIT_ASSERT(id != 0 && !cached);
+		CPPUNIT_ASSERT(dir->memoryUsed() == 200);
+
+		// still being sent
+		CPPUNIT_ASSERT(dir->acquire(11, 100, 7, 200, &cached) == 0);
+
+		dir->release(id, true);
+		id2 = dir->acquire(11, 100, 7, 200, &cached);
+		CPPUNIT_ASSERT(id2 == id && cached);
+		dir->release(id2, true);
+		CPPUNIT_ASSERT(dir->memoryUsed() == 200);
+		CPPUNIT_ASSERT(!dropped(dir, id));
+
+		// too big for the budget, never cached
+		CPPUNIT_ASSERT(dir->acquire(12, 100, 7, maxMemory + 1, &cached) == 0);
+	}
+
+	/* a failed query, or a PM that lost the table, gets it dropped everywhere */
+	void jointable_failed_1() {
+		JoinTableDirectory *dir = directory();
+		bool cached;
+		uint64_t id, id2;
+
+		id = dir->acquire(21, 100, 7, 200, &cached);
+		dir->release(id, false);
+		CPPUNIT_ASSERT(dropped(dir, id));
+		CPPUNIT_ASSERT(dir->memoryUsed() == 0);
+
+		// in use by a second query when the first finds it missing on a PM
+		id = dir->acquire(21, 100, 7, 200, &cached);
+		dir->release(id, true);
+		id = dir->acquire(21, 100, 7, 200, &cached);
+		id2 = dir->acquire(21, 100, 7, 200, &cached);
+		CPPUNIT_ASSERT(id == id2 && cached);
+		dir->release(id, false);
+		CPPUNIT_ASSERT(!dropped(dir, id));
+		CPPUNIT_ASSERT(dir->acquire(21, 100, 7, 200, &cached) == 0);
+		dir->release(id2, true);
+		CPPUNIT_ASSERT(dropped(dir, id));
+
+		// the next one stores it again under a new id
+		id2 = dir->acquire(21, 100, 7, 200, &cached);
+		CPPUNIT_ASSERT(id2 != 0 && id2 != id && !cached);
+		dir->release(id2, true);
+	}
+
+	/* equal fingerprints with a different row count or key columns aren't reused */
+	void jointable_mismatch_1() {
+		JoinTableDirectory *dir = directory();
+		bool cached;
+		uint64_t id;
+
+		id = dir->acquire(31, 100, 7, 200, &cached);
+		dir->release(id, true);
+
+		CPPUNIT_ASSERT(dir->acquire(31, 101, 7, 200, &cached) == 0);
+		CPPUNIT_ASSERT(dropped(dir, id));
+		CPPUNIT_ASSERT(dir->memoryUsed() == 0);
+
+		id = dir->acquire(31, 100, 7, 200, &cached);
+		CPPUNIT_ASSERT(id != 0 && !cached);
+		dir->release(id, true);
+		CPPUNIT_ASSERT(dir->acquire(31, 100, 8, 200, &cached) == 0);
+		CPPUNIT_ASSERT(dropped(dir, id));
+	}
+
+	/* least recently used first, never one in use */
+	void jointable_evict_1() {
+		JoinTableDirectory *dir = directory();
+		bool cached;
+		uint64_t a, b, c, d;
+
+		a = dir->acquire(41, 10, 7, 400, &cached);
+		b = dir->acquire(42, 10, 7, 400, &cached);
+		dir->release(b, true);
+		CPPUNIT_ASSERT(dir->memoryUsed() == 800);
+
+		// a is older but in use, so b goes
+		c = dir->acquire(43, 10, 7, 400, &cached);
+		CPPUNIT_ASSERT(c != 0);
+		CPPUNIT_ASSERT(dropped(dir, b));
+		CPPUNIT_ASSERT(dir->memoryUsed() == 800);
+
+		// nothing it could evict
+		d = dir->acquire(44, 10, 7, 400, &cached);
+		CPPUNIT_ASSERT(d == 0);
+		CPPUNIT_ASSERT(dir->memoryUsed() == 800);
+
+		dir->release(a, true);
+		dir->release(c, true);
+		d = dir->acquire(44, 10, 7, 400, &cached);
+		CPPUNIT_ASSERT(d != 0);
+		CPPUNIT_ASSERT(dropped(dir, a));
+		dir->release(d, true);
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( JoinTableDirectoryTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
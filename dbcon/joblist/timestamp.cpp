@@ -95,6 +95,12 @@ const string JSTimeStamp::tsdiffstr(const struct timeval& t2, const struct timev
 	return res;
 }
 
+/* static */
+int64_t JSTimeStamp::tsdiff(const struct timeval& t2, const struct timeval& t1)
+{
+	return (int64_t) (t2.tv_sec - t1.tv_sec) * 1000000 + (t2.tv_usec - t1.tv_usec);
+}
+
 /* static */
 const string JSTimeStamp::timeNow()
 {
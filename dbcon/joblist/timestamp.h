@@ -25,6 +25,7 @@
 
 #include <string>
 #include <ctime>
+#include <stdint.h>
 #include <sys/time.h>
 #include <unistd.h>
 
@@ -64,6 +65,9 @@ public:
 	//returns str rep of t2 - t1 in seconds
 	static const std::string tsdiffstr(const struct timeval& t2, const struct timeval& t1);
 
+	//returns t2 - t1 in usec
+	static int64_t tsdiff(const struct timeval& t2, const struct timeval& t1);
+
 	//returns str rep of tvbuf
 	static const std::string format(const struct timeval& tvbuf);
 
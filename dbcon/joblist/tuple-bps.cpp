@@ -220,6 +220,8 @@ TupleBPS::TupleBPS(const pColStep& rhs, const JobInfo& jobInfo) :
 	fMsgBytesIn = 0;
 	fMsgBytesOut = 0;
 	fBlockTouched = 0;
+	memset(&fPMProfile, 0, sizeof(fPMProfile));
+	fUMWaitTime = 0;
 	fExtentsPerSegFile = DEFAULT_EXTENTS_PER_SEG_FILE;
 	recvWaiting = 0;
 	fStepCount = 1;
@@ -302,6 +304,8 @@ TupleBPS::TupleBPS(const pColScanStep& rhs, const JobInfo& jobInfo) :
 	fMsgBytesIn = 0;
 	fMsgBytesOut = 0;
 	fBlockTouched = 0;
+	memset(&fPMProfile, 0, sizeof(fPMProfile));
+	fUMWaitTime = 0;
 	fExtentsPerSegFile = DEFAULT_EXTENTS_PER_SEG_FILE;
 	recvWaiting = 0;
 	fSwallowRows = false;
@@ -373,6 +377,8 @@ TupleBPS::TupleBPS(const PassThruStep& rhs, const JobInfo& jobInfo) :
 	fMsgBytesIn = 0;
 	fMsgBytesOut = 0;
 	fBlockTouched = 0;
+	memset(&fPMProfile, 0, sizeof(fPMProfile));
+	fUMWaitTime = 0;
 	fExtentsPerSegFile = DEFAULT_EXTENTS_PER_SEG_FILE;
 	recvExited = 0;
 	totalMsgs = 0;
@@ -446,6 +452,8 @@ TupleBPS::TupleBPS(const pDictionaryStep& rhs, const JobInfo& jobInfo) :
 	ridsRequested = 0;
 	fNumBlksSkipped = 0;
 	fBlockTouched = 0;
+	memset(&fPMProfile, 0, sizeof(fPMProfile));
+	fUMWaitTime = 0;
 	fMsgBytesIn = 0;
 	fMsgBytesOut = 0;
 	fExtentsPerSegFile = DEFAULT_EXTENTS_PER_SEG_FILE;
@@ -861,6 +869,25 @@ void TupleBPS::serializeJoiner(uint32_t conn)
 	}
 }
 
+/* a PM no longer has a join table it was told to reuse; send it that small side */
+void TupleBPS::resendJoiners(ByteStream &nak)
+{
+	boost::mutex::scoped_lock lk(serializeJoinerMutex);
+
+	ByteStream bs;
+	vector<uint32_t> joiners;
+	uint32_t conn, pos;
+
+	fBPP->joinTablesMissing(nak, &joiners, &conn);
+	for (uint32_t i = 0; i < joiners.size(); i++) {
+		pos = 0;
+		while (fBPP->resendJoinerMsg(joiners[i], pos, bs)) {
+			fDec->write(uniqueID, bs, conn);
+			bs.restart();
+		}
+	}
+}
+
 void TupleBPS::prepCasualPartitioning()
 {
 	uint32_t i;
@@ -1110,6 +1137,8 @@ void TupleBPS::run()
 	try {
 		fDec->addDECEventListener(this);
 		fBPP->priority(priority());
+		if (doJoin && tjoiners[0]->inPM())
+			fBPP->useJoinTableCache();
 		fBPP->createBPP(bs);
 		fDec->write(uniqueID, bs);
 		BPPIsAllocated = true;
@@ -1666,6 +1695,7 @@ void TupleBPS::makeJobs(vector<Job> *jobs)
 
 void TupleBPS::sendPrimitiveMessages()
 {
+	StepCpuTimer cpuTimer(this);
 	vector<Job> jobs;
 
 	idbassert(ffirstStepType == SCAN);
@@ -1711,6 +1741,7 @@ struct _CPInfo {
 
 void TupleBPS::receiveMultiPrimitiveMessages(uint32_t threadID)
 {
+	StepCpuTimer cpuTimer(this);
 	AnyDataListSPtr dl = fOutputJobStepAssociation.outAt(0);
 	RowGroupDL* dlp = (fDelivery ? deliveryDL.get() : dl->rowGroupDL());
 
@@ -1733,6 +1764,9 @@ void TupleBPS::receiveMultiPrimitiveMessages(uint32_t threadID)
 	uint32_t physIO_Thread = 0;
 	uint32_t touchedBlocks_Thread = 0;
 	int64_t ridsReturned_Thread = 0;
+	BPPProfile profile;
+	BPPProfile profile_Thread = BPPProfile();
+	uint64_t waitStart, waitTime_Thread = 0;
 	bool lastThread = false;
 	uint32_t i, j, k;
 	RowGroup local_primRG = primRowGroup;
@@ -1867,7 +1901,9 @@ try
 			break;
 
 		bool flowControlOn;
+		waitStart = utils::monotonicUsec();
 		fDec->read_some(uniqueID, fNumThreads, bsv, &flowControlOn);
+		waitTime_Thread += utils::monotonicUsec() - waitStart;
 		size = bsv.size();
 
 		// @bug 4562
@@ -1935,6 +1971,10 @@ try
 			// @bug 488. when PrimProc node is down. error out
 			//An error condition.  We are not going to do anymore.
 			ISMPacketHeader *hdr = (ISMPacketHeader*)(bs->buf());
+			if (bs->length() > 0 && hdr->Command == JOIN_TABLE_NAK) {
+				resendJoiners(*bs);
+				continue;
+			}
 			if (bs->length() == 0 || hdr->Status > 0)
 			{
 				/* PM errors mean this should abort right away instead of draining the PM backlog */
@@ -1960,7 +2000,15 @@ try
 
 			fromPrimProc.clear();
 			fBPP->getRowGroupData(*bs, &fromPrimProc, &validCPData, &lbid, &min, &max,
-				&cachedIO, &physIO, &touchedBlocks, &unused, threadID);
+				&cachedIO, &physIO, &touchedBlocks, &unused, &profile, threadID);
+			profile_Thread.queueWait += profile.queueWait;
+			profile_Thread.filterTime += profile.filterTime;
+			profile_Thread.joinTime += profile.joinTime;
+			profile_Thread.projectTime += profile.projectTime;
+			profile_Thread.aggTime += profile.aggTime;
+			profile_Thread.cpuTime += profile.cpuTime;
+			profile_Thread.rowsIn += profile.rowsIn;
+			profile_Thread.rowsOut += profile.rowsOut;
 
 			/* Another layer of messiness.  Need to refactor this fcn. */
 			while (!fromPrimProc.empty() && !cancelled()) {
@@ -2243,6 +2291,7 @@ out:
 				fBPP->destroyBPP(bs);
 				fDec->write(uniqueID, bs);
 				BPPIsAllocated = false;
+				fBPP->releaseJoinTables(!cancelled() && status() == 0);
 			}
 		}
 		// catch and do nothing. Let it continues with the clean up and profiling
@@ -2268,6 +2317,15 @@ out:
 	fPhysicalIO += physIO_Thread;
 	fCacheIO += cachedIO_Thread;
 	fBlockTouched += touchedBlocks_Thread;
+	fPMProfile.queueWait += profile_Thread.queueWait;
+	fPMProfile.filterTime += profile_Thread.filterTime;
+	fPMProfile.joinTime += profile_Thread.joinTime;
+	fPMProfile.projectTime += profile_Thread.projectTime;
+	fPMProfile.aggTime += profile_Thread.aggTime;
+	fPMProfile.cpuTime += profile_Thread.cpuTime;
+	fPMProfile.rowsIn += profile_Thread.rowsIn;
+	fPMProfile.rowsOut += profile_Thread.rowsOut;
+	fUMWaitTime += waitTime_Thread;
 	mutex.unlock();
 
 	if (fTableOid >= 3000 && lastThread)
@@ -2320,7 +2378,7 @@ out:
 			"; BlocksTouched-"<< fBlockTouched <<
 			"; BlockedFifoIn/Out-" << totalBlockedReadCount <<
 			"/" << totalBlockedWriteCount <<
-			"; output size-" << ridsReturned << endl <<
+			"; output size-" << ridsReturned << "; est rows-" << fEstimatedRows << endl <<
 			"\tPartitionBlocksEliminated-" << fNumBlksSkipped <<
 			"; MsgBytesIn-"  << msgBytesInKB  << "KB" <<
 			"; MsgBytesOut-" << msgBytesOutKB << "KB" <<
@@ -2499,6 +2557,9 @@ void TupleBPS::newPMOnline(uint32_t connectionNumber)
 {
 	ByteStream bs;
 
+	/* The new PM has none of the cached join tables, so stop using them and
+	   send it all of the small sides */
+	fBPP->releaseJoinTables(false);
 	fBPP->createBPP(bs);
 	try {
 		fDec->write(bs, connectionNumber);
@@ -2833,6 +2894,22 @@ void TupleBPS::formatMiniStats()
 		<< ridsReturned << " ";
 
 	fMiniInfo += oss.str();
+	profileSummary("BPS", "PM", alias(),
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), ridsReturned);
+}
+
+string TupleBPS::profileDetail() const
+{
+	ostringstream oss;
+	oss << "; UM wait-" << fUMWaitTime / 1000 << "ms"
+		<< "; PM queue-" << fPMProfile.queueWait / 1000 << "ms"
+		<< " filter-" << fPMProfile.filterTime / 1000 << "ms"
+		<< " join-" << fPMProfile.joinTime / 1000 << "ms"
+		<< " project-" << fPMProfile.projectTime / 1000 << "ms"
+		<< " fe/agg-" << fPMProfile.aggTime / 1000 << "ms"
+		<< " cpu-" << fPMProfile.cpuTime / 1000 << "ms"
+		<< " rows in/out-" << fPMProfile.rowsIn << "/" << fPMProfile.rowsOut;
+	return oss.str();
 }
 
 void TupleBPS::rgDataToDl(RGData &rgData, RowGroup& rg, RowGroupDL* dlp)
@@ -97,6 +97,7 @@ inline RowAggFunctionType functionIdMap(int planFuncId)
 		case AggregateColumn::BIT_OR:                   return ROWAGG_BIT_OR;
 		case AggregateColumn::BIT_XOR:                  return ROWAGG_BIT_XOR;
 		case AggregateColumn::GROUP_CONCAT:             return ROWAGG_GROUP_CONCAT;
+		case AggregateColumn::APPROX_COUNT_DISTINCT:    return ROWAGG_APPROX_COUNT_DISTINCT;
 		case AggregateColumn::CONSTANT:                 return ROWAGG_CONSTANT;
 		default:                                        return ROWAGG_FUNCT_UNDEFINE;
 	}
@@ -190,6 +191,7 @@ TupleAggregateStep::TupleAggregateStep(
 {
 	fRowGroupData.reinit(fRowGroupOut);
 	fRowGroupOut.setData(&fRowGroupData);
+	fAggregator->setArena(jobInfo.queryArena);
 	fAggregator->setInputOutput(fRowGroupIn, &fRowGroupOut);
 
 	// decide if this needs to be multi-threaded
@@ -266,6 +268,7 @@ void TupleAggregateStep::join()
 
 void TupleAggregateStep::doThreadedSecondPhaseAggregate(uint32_t threadID)
 {
+	StepCpuTimer cpuTimer(this);
     if (threadID >= fNumOfBuckets)
         return;
 
@@ -375,6 +378,13 @@ void TupleAggregateStep::doThreadedSecondPhaseAggregate(uint32_t threadID)
 			(iex.errorCode() == ERR_AGGREGATION_TOO_BIG ? LOG_TYPE_INFO : LOG_TYPE_CRITICAL));
 		caughtException = true;
 	}
+	catch (std::bad_alloc&)
+	{
+		// the query arena could not get more UM memory
+		catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+			ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+		caughtException = true;
+	}
 	catch(const std::exception& ex)
 	{
 		catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -402,6 +412,7 @@ void TupleAggregateStep::doThreadedSecondPhaseAggregate(uint32_t threadID)
 
 uint32_t TupleAggregateStep::nextBand_singleThread(messageqcpp::ByteStream &bs)
 {
+	StepCpuTimer cpuTimer(this);
 	uint32_t rowCount = 0;
 
 	try
@@ -442,6 +453,13 @@ uint32_t TupleAggregateStep::nextBand_singleThread(messageqcpp::ByteStream &bs)
 
 		fEndOfResult = true;
 	}
+	catch (std::bad_alloc&)
+	{
+		catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+			ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+
+		fEndOfResult = true;
+	}
 	catch(const std::exception& ex)
 	{
 		catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -649,6 +667,8 @@ SJSTEP TupleAggregateStep::prepAggregate(SJSTEP& step, JobInfo& jobInfo)
 	int64_t constKey = -1;
 	vector<ConstantAggData> constAggDataVec;
 
+	bool approxDistinct = false;
+
 	vector<std::pair<uint32_t, int> > returnedColVecOrig = jobInfo.returnedColVec;
 	for(uint32_t idx = 0; idx < jobInfo.returnedColVec.size(); idx++)
 	{
@@ -659,6 +679,10 @@ SJSTEP TupleAggregateStep::prepAggregate(SJSTEP& step, JobInfo& jobInfo)
 		{
 			distinctAgg = true;
 		}
+		else if (jobInfo.returnedColVec[idx].second == AggregateColumn::APPROX_COUNT_DISTINCT)
+		{
+			approxDistinct = true;
+		}
 
 		// Change COUNT_ASTERISK to CONSTANT if necessary.
 		// In joblistfactory, all aggregate(constant) are set to count(*) for easy process.
@@ -689,6 +713,14 @@ SJSTEP TupleAggregateStep::prepAggregate(SJSTEP& step, JobInfo& jobInfo)
 		}
 	}
 
+	// The distinct aggregators do not carry the sketch columns.
+	if (distinctAgg && approxDistinct)
+	{
+		string emsg("approx_count_distinct cannot be used with distinct aggregate functions.");
+		cerr << "prepAggregate: " << emsg << endl;
+		throw QueryDataExcept(emsg, aggregateFuncErr);
+	}
+
 	// If there are aggregate(constant) columns, but no count(*), add a count(*).
 	if (constAggDataVec.size() > 0 && jobInfo.cntStarPos < 0)
 	{
@@ -1208,6 +1240,17 @@ void TupleAggregateStep::prep1PhaseAggregate(
 			}
 			break;
 
+			case ROWAGG_APPROX_COUNT_DISTINCT:
+			{
+				oidsAgg.push_back(oidsProj[colProj]);
+				keysAgg.push_back(key);
+				scaleAgg.push_back(0);
+				precisionAgg.push_back(19);
+				typeAgg.push_back(CalpontSystemCatalog::BIGINT);
+				widthAgg.push_back(bigIntWidth);
+			}
+			break;
+
 			default:
 			{
 				ostringstream emsg;
@@ -1297,12 +1340,39 @@ void TupleAggregateStep::prep1PhaseAggregate(
 		++lastCol;
 	}
 
+	// add the sketch fields for approx_count_distinct
+	for (uint64_t i = 0; i < functionVec.size(); i++)
+	{
+		if (functionVec[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+			continue;
+
+		functionVec[i]->fAuxColumnIndex = lastCol++;
+		uint64_t j = functionVec[i]->fOutputColumnIndex;
+		oidsAgg.push_back(oidsAgg[j]);
+		keysAgg.push_back(keysAgg[j]);
+		scaleAgg.push_back(0);
+		precisionAgg.push_back(0);
+		typeAgg.push_back(CalpontSystemCatalog::VARBINARY);
+		widthAgg.push_back(ROWAGG_HLL_SKETCH_WIDTH);
+	}
+
+	// the sketches are updated in place, keep them out of the string table
+	vector<bool> inlineAgg;
+	for (uint64_t i = 0; i < functionVec.size(); i++)
+	{
+		if (functionVec[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+			continue;
+
+		inlineAgg.resize(oidsAgg.size(), false);
+		inlineAgg[functionVec[i]->fAuxColumnIndex] = true;
+	}
+
 	// calculate the offset and create the rowaggregation, rowgroup
 	posAgg.push_back(2);
 	for (uint64_t i = 0; i < oidsAgg.size(); i++)
 		posAgg.push_back(posAgg[i] + widthAgg[i]);
 	RowGroup aggRG(oidsAgg.size(), posAgg, oidsAgg, keysAgg, typeAgg, scaleAgg, precisionAgg,
-		jobInfo.stringTableThreshold);
+		jobInfo.stringTableThreshold, true, inlineAgg);
 	SP_ROWAGG_UM_t rowAgg(new RowAggregationUM(groupBy, functionVec, &jobInfo.rm, jobInfo.umMemLimit));
 	rowgroups.push_back(aggRG);
 	aggregators.push_back(rowAgg);
@@ -2642,6 +2712,28 @@ void TupleAggregateStep::prep2PhasesAggregate(
 				}
 				break;
 
+				case ROWAGG_APPROX_COUNT_DISTINCT:
+				{
+					// count(x), filled in by UM
+					oidsAggPm.push_back(oidsProj[colProj]);
+					keysAggPm.push_back(aggKey);
+					scaleAggPm.push_back(0);
+					precisionAggPm.push_back(19);
+					typeAggPm.push_back(CalpontSystemCatalog::BIGINT);
+					widthAggPm.push_back(bigIntWidth);
+					funct->fAuxColumnIndex = ++colAggPm;
+
+					// the partial sketch
+					oidsAggPm.push_back(oidsProj[colProj]);
+					keysAggPm.push_back(aggKey);
+					scaleAggPm.push_back(0);
+					precisionAggPm.push_back(0);
+					typeAggPm.push_back(CalpontSystemCatalog::VARBINARY);
+					widthAggPm.push_back(ROWAGG_HLL_SKETCH_WIDTH);
+					++colAggPm;
+				}
+				break;
+
 				default:
 				{
 					ostringstream emsg;
@@ -2910,6 +3002,41 @@ void TupleAggregateStep::prep2PhasesAggregate(
 			widthAggUm.push_back(sizeof(long double));
 			++lastCol;
 		}
+
+		// add the merged sketch fields for approx_count_distinct
+		for (uint64_t i = 0; i < functionVecUm.size(); i++)
+		{
+			if (functionVecUm[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+				continue;
+
+			functionVecUm[i]->fAuxColumnIndex = lastCol++;
+			uint64_t j = functionVecUm[i]->fOutputColumnIndex;
+			oidsAggUm.push_back(oidsAggUm[j]);
+			keysAggUm.push_back(keysAggUm[j]);
+			scaleAggUm.push_back(0);
+			precisionAggUm.push_back(0);
+			typeAggUm.push_back(CalpontSystemCatalog::VARBINARY);
+			widthAggUm.push_back(ROWAGG_HLL_SKETCH_WIDTH);
+		}
+	}
+
+	// the sketches are updated in place, keep them out of the string table
+	vector<bool> inlineAggUm, inlineAggPm;
+	for (uint64_t i = 0; i < functionVecUm.size(); i++)
+	{
+		if (functionVecUm[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+			continue;
+
+		inlineAggUm.resize(oidsAggUm.size(), false);
+		inlineAggUm[functionVecUm[i]->fAuxColumnIndex] = true;
+	}
+	for (uint64_t i = 0; i < functionVecPm.size(); i++)
+	{
+		if (functionVecPm[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+			continue;
+
+		inlineAggPm.resize(oidsAggPm.size(), false);
+		inlineAggPm[functionVecPm[i]->fAuxColumnIndex] = true;
 	}
 
 	// calculate the offset and create the rowaggregations, rowgroups
@@ -2917,7 +3044,7 @@ void TupleAggregateStep::prep2PhasesAggregate(
 	for (uint64_t i = 0; i < oidsAggUm.size(); i++)
 		posAggUm.push_back(posAggUm[i] + widthAggUm[i]);
 	RowGroup aggRgUm(oidsAggUm.size(), posAggUm, oidsAggUm, keysAggUm, typeAggUm, scaleAggUm,
-		precisionAggUm, jobInfo.stringTableThreshold);
+		precisionAggUm, jobInfo.stringTableThreshold, true, inlineAggUm);
 	SP_ROWAGG_UM_t rowAggUm(new RowAggregationUMP2(groupByUm, functionVecUm, &jobInfo.rm, jobInfo.umMemLimit));
 	rowgroups.push_back(aggRgUm);
 	aggregators.push_back(rowAggUm);
@@ -2926,7 +3053,7 @@ void TupleAggregateStep::prep2PhasesAggregate(
 	for (uint64_t i = 0; i < oidsAggPm.size(); i++)
 		posAggPm.push_back(posAggPm[i] + widthAggPm[i]);
 	RowGroup aggRgPm(oidsAggPm.size(), posAggPm, oidsAggPm, keysAggPm, typeAggPm, scaleAggPm,
-		precisionAggPm, jobInfo.stringTableThreshold);
+		precisionAggPm, jobInfo.stringTableThreshold, true, inlineAggPm);
 	SP_ROWAGG_PM_t rowAggPm(new RowAggregation(groupByPm, functionVecPm));
 	rowgroups.push_back(aggRgPm);
 	aggregators.push_back(rowAggPm);
@@ -4071,6 +4198,12 @@ void TupleAggregateStep::aggregateRowGroups()
 				(iex.errorCode() == ERR_AGGREGATION_TOO_BIG ? LOG_TYPE_INFO : LOG_TYPE_CRITICAL));
 			fEndOfResult = true;
 		}
+		catch (std::bad_alloc&)
+		{
+			catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+				ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+			fEndOfResult = true;
+		}
 		catch(const std::exception& ex)
 		{
 			catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -4099,6 +4232,7 @@ void TupleAggregateStep::aggregateRowGroups()
 
 void TupleAggregateStep::threadedAggregateRowGroups(uint32_t threadID)
 {
+	StepCpuTimer cpuTimer(this);
 	RGData rgData;
 	scoped_array<RowBucketVec> rowBucketVecs(new RowBucketVec[fNumOfBuckets]);
 	scoped_array<Row> distRow;
@@ -4340,6 +4474,12 @@ void TupleAggregateStep::threadedAggregateRowGroups(uint32_t threadID)
 				(iex.errorCode() == ERR_AGGREGATION_TOO_BIG ? LOG_TYPE_INFO : LOG_TYPE_CRITICAL));
 			caughtException = true;
 		}
+		catch (std::bad_alloc&)
+		{
+			catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+				ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+			caughtException = true;
+		}
 		catch(const std::exception& ex)
 		{
 			catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -4374,6 +4514,7 @@ void TupleAggregateStep::threadedAggregateRowGroups(uint32_t threadID)
 
 void TupleAggregateStep::doAggregate_singleThread()
 {
+	StepCpuTimer cpuTimer(this);
 	AnyDataListSPtr dl = fOutputJobStepAssociation.outAt(0);
 	RowGroupDL* dlp = dl->rowGroupDL();
 	RGData rgData;
@@ -4409,6 +4550,11 @@ void TupleAggregateStep::doAggregate_singleThread()
 		catchHandler(iex.what(), iex.errorCode(), fErrorInfo, fSessionId,
 			(iex.errorCode() == ERR_AGGREGATION_TOO_BIG ? LOG_TYPE_INFO : LOG_TYPE_CRITICAL));
 	}
+	catch (std::bad_alloc&)
+	{
+		catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+			ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+	}
 	catch(const std::exception& ex)
 	{
 		catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -4453,6 +4599,7 @@ void TupleAggregateStep::doAggregate()
 
 uint64_t TupleAggregateStep::doThreadedAggregate(ByteStream& bs, RowGroupDL* dlp)
 {
+	StepCpuTimer cpuTimer(this);
 	uint32_t i;
 	RGData rgData;
 	uint64_t rowCount = 0;
@@ -4625,6 +4772,12 @@ uint64_t TupleAggregateStep::doThreadedAggregate(ByteStream& bs, RowGroupDL* dlp
 			(iex.errorCode() == ERR_AGGREGATION_TOO_BIG ? LOG_TYPE_INFO : LOG_TYPE_CRITICAL));
 		fEndOfResult = true;
 	}
+	catch (std::bad_alloc&)
+	{
+		catchHandler(IDBErrorInfo::instance()->errorMsg(ERR_AGGREGATION_TOO_BIG),
+			ERR_AGGREGATION_TOO_BIG, fErrorInfo, fSessionId, LOG_TYPE_INFO);
+		fEndOfResult = true;
+	}
 	catch(const std::exception& ex)
 	{
 		catchHandler(ex.what(), tupleAggregateStepErr, fErrorInfo, fSessionId);
@@ -4718,6 +4871,8 @@ void TupleAggregateStep::formatMiniStats()
 		<< JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " "
 		<< fRowsReturned << " ";
 	fMiniInfo += oss.str();
+	profileSummary("TAS", "UM", "-",
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), fRowsReturned);
 }
 
 
@@ -272,6 +272,7 @@ uint32_t TupleAnnexStep::nextBand(messageqcpp::ByteStream &bs)
 
 void TupleAnnexStep::execute()
 {
+	StepCpuTimer cpuTimer(this);
 	if (fOrderBy)
 		executeWithOrderBy();
 	else if (fDistinct)
@@ -655,6 +656,8 @@ void TupleAnnexStep::formatMiniStats()
 		<< JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " "
 		<< fRowsReturned << " ";
 	fMiniInfo += oss.str();
+	profileSummary("TNS", "UM", "-",
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), fRowsReturned);
 }
 
 
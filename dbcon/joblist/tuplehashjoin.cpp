@@ -188,6 +188,7 @@ void TupleHashJoinStep::join()
 /* Index is which small input to read. */
 void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 {
+	StepCpuTimer cpuTimer(this);
 	uint64_t i;
 	bool more, flippedUMSwitch = false, gotMem;
 	RGData oneRG;
@@ -198,6 +199,9 @@ void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 	uint32_t smallIt;
 	RowGroup smallRG;
 	boost::shared_ptr<TupleJoiner> joiner;
+	RGData keyData;
+	RowGroup keyRG;
+	Row keyRow;
 
 	string extendedInfo;
 	extendedInfo += toString();  // is each small side supposed to have the whole THJS info?
@@ -219,6 +223,8 @@ void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 	}
 	joiner->setUniqueLimit(uniqueLimit);
 	joiner->setTableName(smallTableNames[index]);
+	if (!hasJoinFilter(index))
+		joiner->setKeyOnly();
 	joiners[index] = joiner;
 
 	/*
@@ -229,9 +235,13 @@ void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 	*/
 
 	smallRG.initRow(&r);
+	keyRG = smallRG;
+	keyRG.initRow(&keyRow);
 // 	cout << "reading smallDL" << endl;
 	more = smallDL->next(smallIt, &oneRG);
 	ostringstream oss;
+	uint64_t estRows = (index < smallEstRows.size() ? smallEstRows[index] : 0);
+	uint64_t actualRows = 0;
 	try
 	{
 		/* check for join types unsupported on the PM. */
@@ -244,6 +254,18 @@ void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 			extendedInfo += oss.str();
 			joiner->setInUM();
 		}
+		/* The planner expects this side to be well past the PM limit, don't build the
+		   PM hash table only to throw it away.  The estimates err on the high side, hence
+		   the margin. */
+		else if (estRows > 0 && estRows > 2 * pmMemLimit / smallRG.getRowSize()) {
+			flippedUMSwitch = true;
+			oss << "UM join (" << index << ") by estimate ";
+#ifdef JLF_DEBUG
+			cout << oss.str() << endl;
+#endif
+			extendedInfo += oss.str();
+			joiner->setInUM();
+		}
 
 		resourceManager.getMemory(joiner->getMemUsage(), sessionMemLimit, false);
 		(void)atomicops::atomicAdd(&totalUMMemoryUsage, joiner->getMemUsage());
@@ -260,12 +282,35 @@ void TupleHashJoinStep::smallRunnerFcn(uint32_t index)
 
 			memUseBefore = joiner->getMemUsage() + rgDataSize;
 
-			// TupleHJ owns the row memory
-			rgData[index].push_back(oneRG);
-			rgDataSize += smallRG.getSizeWithStrings();
-			for (i = 0; i < smallRG.getRowCount(); i++, r.nextRow()) {
-				//cout << "inserting " << r.toString() << endl;
-				joiner->insert(r);
+			actualRows += smallRG.getRowCount();
+			if (joiner->keyOnly()) {
+				/* A semi- or anti-join with no join filter only needs one row per key.
+				   Copy those into RGDatas of our own and let the input go. */
+				for (i = 0; i < smallRG.getRowCount(); i++, r.nextRow()) {
+					if (joiner->hasKey(r))
+						continue;
+					if (!keyData.rowData || keyRG.getRowCount() == 8192) {
+						keyData.reinit(keyRG);
+						keyRG.setData(&keyData);
+						keyRG.resetRowGroup(0);
+						keyRG.getRow(0, &keyRow);
+						rgData[index].push_back(keyData);
+						rgDataSize += keyRG.getMaxDataSize();
+					}
+					copyRow(r, &keyRow);
+					joiner->insert(keyRow);
+					keyRG.incRowCount();
+					keyRow.nextRow();
+				}
+			}
+			else {
+				// TupleHJ owns the row memory
+				rgData[index].push_back(oneRG);
+				rgDataSize += smallRG.getSizeWithStrings();
+				for (i = 0; i < smallRG.getRowCount(); i++, r.nextRow()) {
+					//cout << "inserting " << r.toString() << endl;
+					joiner->insert(r);
+				}
 			}
 			memUseAfter = joiner->getMemUsage() + rgDataSize;
 
@@ -334,6 +379,12 @@ next:
 		joiner->setInPM();
 	}
 
+	if (estRows > 0) {
+		ostringstream est;
+		est << "(" << index << ") est rows-" << estRows << " actual-" << actualRows << " ";
+		extendedInfo += est.str();
+	}
+
 	/* If there was an error or an abort drain the input DL,
 		do endOfInput on the output */
 	if (cancelled()) {
@@ -380,6 +431,7 @@ void TupleHashJoinStep::forwardCPData()
 
 void TupleHashJoinStep::djsRelayFcn()
 {
+	StepCpuTimer cpuTimer(this);
 	/*
 		read from largeDL
 		map to largeRG + outputRG format
@@ -427,6 +479,7 @@ next:
 
 void TupleHashJoinStep::djsReaderFcn(int index)
 {
+	StepCpuTimer cpuTimer(this);
 	/*
 		read from fifos[index]
 		   - incoming rgdata's have outputRG format
@@ -493,6 +546,7 @@ void TupleHashJoinStep::djsReaderFcn(int index)
 
 void TupleHashJoinStep::hjRunner()
 {
+	StepCpuTimer cpuTimer(this);
 	uint32_t i;
 
 	if (cancelled()) {
@@ -953,6 +1007,19 @@ void TupleHashJoinStep::configLargeSideRG(const RowGroup &rg)
 	largeRG = rg;
 }
 
+void TupleHashJoinStep::addSmallSideEstimates(const vector<uint64_t>& rows)
+{
+	// small sides added before the estimates were known count as unknown
+	smallEstRows.resize(smallRGs.size() - rows.size(), 0);
+	smallEstRows.insert(smallEstRows.end(), rows.begin(), rows.end());
+}
+
+void TupleHashJoinStep::configSmallSideEstimates(const vector<uint64_t>& rows)
+{
+	smallEstRows.insert(smallEstRows.begin(), rows.begin(), rows.end());
+	smallEstRows.resize(smallRGs.size(), 0);
+}
+
 void TupleHashJoinStep::configJoinKeyIndex(const vector<JoinType>& jt,
 											const vector<bool>& typeless,
 											const vector<vector<uint32_t> >& smallkey,
@@ -1052,6 +1119,10 @@ void TupleHashJoinStep::formatMiniStats(uint32_t index)
 		<< "-------- "
 		<< "-\n";
 	fMiniInfo += oss.str();
+	// the first joiner heads the step's line, as it does the mini info
+	if (index == 0)
+		profileSummary("HJS", joiners[index]->inUM() ? "UM" : "PM",
+			alias() + "-" + joiners[index]->getTableName(), -1, -1);
 }
 
 void TupleHashJoinStep::addJoinFilter(boost::shared_ptr<execplan::ParseTree> pt, uint32_t index)
@@ -1238,6 +1309,7 @@ void TupleHashJoinStep::finishSmallOuterJoin()
 
 void TupleHashJoinStep::joinRunnerFcn(uint32_t threadID)
 {
+	StepCpuTimer cpuTimer(this);
 	RowGroup local_inputRG, local_outputRG, local_joinFERG;
 	uint32_t smallSideCount = smallDLs.size();
 	vector<RGData> inputData, joinedRowData;
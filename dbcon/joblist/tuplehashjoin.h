@@ -111,6 +111,11 @@ public:
 						   const std::vector<std::string> &tableNames);
 	void configLargeSideRG(const rowgroup::RowGroup &rg);
 
+	/* Planner estimates of the small side row counts, in the same order as the
+	   small side rowgroups.  Used to pick UM joins up front and for tracing. */
+	void addSmallSideEstimates(const std::vector<uint64_t>& rows);
+	void configSmallSideEstimates(const std::vector<uint64_t>& rows);
+
 	void configJoinKeyIndex(const std::vector<JoinType>& jt,
 							const std::vector<bool>& typeless,
 							const std::vector<std::vector<uint32_t> >& smallkeys,
@@ -258,6 +263,7 @@ private:
 	TupleBPS* largeBPS;
 	rowgroup::RowGroup largeRG, outputRG;
 	std::vector<rowgroup::RowGroup> smallRGs;
+	std::vector<uint64_t> smallEstRows;	// 0 is unknown
 	uint64_t pmMemLimit;
 	uint64_t rgDataSize;
 
@@ -420,6 +420,8 @@ void TupleHavingStep::formatMiniStats()
 	fMiniInfo += "- ";
 	fMiniInfo += JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(),dlTimes.FirstReadTime()) + " ";
 	fMiniInfo += "- ";
+	profileSummary("THS", "UM", "-",
+		JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), -1);
 }
 
 
@@ -56,30 +56,47 @@ inline double pow10(double x)
 
 namespace joblist
 {
-inline uint64_t TupleUnion::Hasher::operator()(const RowPosition &p) const
-{
-	Row &row = ts->row;
-	if (p.group & RowPosition::normalizedFlag)
-		ts->normalizedData[p.group & ~RowPosition::normalizedFlag].getRow(p.row, &row);
-	else
-		ts->rowMemory[p.group].getRow(p.row, &row);
-	return row.hash();
-}
-
 inline bool TupleUnion::Eq::operator()(const RowPosition &d1, const RowPosition &d2) const
 {
-	Row &r1 = ts->row, &r2 = ts->row2;
+	if (d1.hash != d2.hash)
+		return false;
+
+	Row &r1 = part->row, &r2 = part->row2;
 	if (d1.group & RowPosition::normalizedFlag)
-		ts->normalizedData[d1.group & ~RowPosition::normalizedFlag].getRow(d1.row, &r1);
+		part->tu->normalizedData[d1.group & ~RowPosition::normalizedFlag].getRow(d1.row, &r1);
 	else
-		ts->rowMemory[d1.group].getRow(d1.row, &r1);
+		part->rowMemory[d1.group].getRow(d1.row, &r1);
 	if (d2.group & RowPosition::normalizedFlag)
-		ts->normalizedData[d2.group & ~RowPosition::normalizedFlag].getRow(d2.row, &r2);
+		part->tu->normalizedData[d2.group & ~RowPosition::normalizedFlag].getRow(d2.row, &r2);
 	else
-		ts->rowMemory[d2.group].getRow(d2.row, &r2);
+		part->rowMemory[d2.group].getRow(d2.row, &r2);
 	return r1.equals(r2);
 }
 
+void TupleUnion::Partition::init(TupleUnion *t)
+{
+	tu = t;
+	// the hash tables' bucket arrays go out-of-band at this size, as before the split
+	allocator = utils::STLPoolAllocator<RowPosition>(64*1024*1024/partitionCount + 1);
+	uniquer.reset(new Uniquer_t(10, Hasher(this), Eq(this), allocator));
+	rg = tu->outputRG;
+	rg.initRow(&outRow);
+	rg.initRow(&row);
+	rg.initRow(&row2);
+	current = RGData(rg);
+	rg.setData(&current);
+	rg.resetRowGroup(0);
+	rg.getRow(0, &outRow);
+	rowMemory.push_back(current);
+}
+
+void TupleUnion::Partition::clear()
+{
+	uniquer->clear();
+	rowMemory.clear();
+	current = RGData();
+}
+
 TupleUnion::TupleUnion(CalpontSystemCatalog::OID tableOID, const JobInfo& jobInfo) :
 	JobStep(jobInfo),
 	fTableOID(tableOID),
@@ -87,7 +104,6 @@ TupleUnion::TupleUnion(CalpontSystemCatalog::OID tableOID, const JobInfo& jobInf
 	outputIt(-1),
 	memUsage(0),
 	rm(jobInfo.rm),
-	allocator(64*1024*1024 + 1),
 	runnersDone(0),
 	distinctCount(0),
 	distinctDone(0),
@@ -96,7 +112,6 @@ TupleUnion::TupleUnion(CalpontSystemCatalog::OID tableOID, const JobInfo& jobInf
 	joinRan(false),
 	sessionMemLimit(jobInfo.umMemLimit)
 {
-	uniquer.reset(new Uniquer_t(10, Hasher(this), Eq(this), allocator));
 	fExtendedInfo = "TUN: ";
 	fQtc.stepParms().stepType = StepTeleStats::T_TUN;
 }
@@ -134,9 +149,9 @@ void TupleUnion::readInput(uint32_t which)
 	/* The handling of the output got a little kludgey with the string table enhancement.
 	 * When there is no distinct check, the outputs are all generated independently of
 	 * each other locally in this fcn.  When there is a distinct check, threads
-	 * share the output, which is built in the 'rowMemory' vector rather than in
-	 * thread-local memory.  Building the result in a common space allows us to
-	 * store 8-byte offsets in rowMemory rather than 16-bytes for absolute pointers.
+	 * share the output, which is built in the partitions' 'rowMemory' vectors rather
+	 * than in thread-local memory.  Building the result in a common space allows us to
+	 * store offsets in rowMemory rather than absolute pointers.
 	 */
 
 	RowGroupDL *dl = NULL;
@@ -147,6 +162,8 @@ void TupleUnion::readInput(uint32_t which)
 	Row inRow, outRow, tmpRow;
 	bool distinct;
 	uint64_t memUsageBefore, memUsageAfter, memDiff;
+	vector<uint32_t> hashes, order;
+	uint32_t partStart[partitionCount + 1];
 	StepTeleStats sts;
 	sts.query_uuid = fQueryUuid;
 	sts.step_uuid = fStepUuid;
@@ -208,25 +225,50 @@ void TupleUnion::readInput(uint32_t which)
 				  tmpRow.nextRow())
 					normalize(inRow, &tmpRow);
 
+				/* Hash the whole rowgroup, then counting-sort the row numbers by
+				   partition so each partition is visited once with all of its rows. */
+				uint32_t rowCount = l_tmpRG.getRowCount();
+				hashes.resize(rowCount);
+				order.resize(rowCount);
+				memset(partStart, 0, sizeof(partStart));
 				l_tmpRG.getRow(0, &tmpRow);
-				{
-					mutex::scoped_lock lk(uniquerMutex);
-					getOutput(&l_outputRG, &outRow, &outRGData);
-					memUsageBefore = allocator.getMemUsage();
-					for (uint32_t i = 0; i < l_tmpRG.getRowCount(); i++, tmpRow.nextRow()) {
+				for (uint32_t i = 0; i < rowCount; i++, tmpRow.nextRow()) {
+					hashes[i] = tmpRow.hash();
+					partStart[(hashes[i] >> (32 - partitionBits)) + 1]++;
+				}
+				for (uint32_t p = 1; p <= partitionCount; p++)
+					partStart[p] += partStart[p - 1];
+				for (uint32_t i = 0; i < rowCount; i++)
+					order[partStart[hashes[i] >> (32 - partitionBits)]++] = i;
+				// the scatter left each partStart[p] at the end of partition p
+				for (uint32_t p = partitionCount; p > 0; p--)
+					partStart[p] = partStart[p - 1];
+				partStart[0] = 0;
+
+				for (uint32_t p = 0; p < partitionCount; p++) {
+					if (partStart[p] == partStart[p + 1])
+						continue;
+					Partition &part = partitions[p];
+					mutex::scoped_lock lk(part.mutex);
+					memUsageBefore = part.allocator.getMemUsage();
+					for (uint32_t j = partStart[p]; j < partStart[p + 1]; j++) {
+						uint32_t i = order[j];
 						pair<Uniquer_t::iterator, bool> inserted;
-						inserted = uniquer->insert(RowPosition(which | RowPosition::normalizedFlag, i));
+						inserted = part.uniquer->insert(RowPosition(which | RowPosition::normalizedFlag,
+						  i, hashes[i]));
 						if (inserted.second) {
-							copyRow(tmpRow, &outRow);
-							const_cast<RowPosition &>(*(inserted.first)) = RowPosition(rowMemory.size()-1, l_outputRG.getRowCount());
-							memDiff += outRow.getRealSize();
-							addToOutput(&outRow, &l_outputRG, true, outRGData);
+							l_tmpRG.getRow(i, &tmpRow);
+							copyRow(tmpRow, &part.outRow);
+							const_cast<RowPosition &>(*(inserted.first)) =
+							  RowPosition(part.rowMemory.size()-1, part.rg.getRowCount(), hashes[i]);
+							memDiff += part.outRow.getRealSize();
+							addToOutput(&part.outRow, &part.rg, &part.rowMemory, part.current);
 						}
 					}
-					memUsageAfter = allocator.getMemUsage();
+					memUsageAfter = part.allocator.getMemUsage();
 					memDiff += (memUsageAfter - memUsageBefore);
-					memUsage += memDiff;
 				}
+				atomicops::atomicAdd(&memUsage, memDiff);
 				if (!rm.getMemory(memDiff, sessionMemLimit)) {
 					fLogger->logMessage(logging::LOG_TYPE_INFO, logging::ERR_UNION_TOO_BIG);
 					if (status() == 0) // preserve existing error code
@@ -241,7 +283,7 @@ void TupleUnion::readInput(uint32_t which)
 			else {
 				for (uint32_t i = 0; i < l_inputRG.getRowCount(); i++, inRow.nextRow()) {
 					normalize(inRow, &outRow);
-					addToOutput(&outRow, &l_outputRG, false, outRGData);
+					addToOutput(&outRow, &l_outputRG, NULL, outRGData);
 				}
 			}
 			more = dl->next(it, &inRGData);
@@ -265,15 +307,14 @@ void TupleUnion::readInput(uint32_t which)
 			more = dl->next(it, &inRGData);
 
 	{
-		mutex::scoped_lock lock1(uniquerMutex);
-		mutex::scoped_lock lock2(sMutex);
+		mutex::scoped_lock lock(sMutex);
 		if (!distinct && l_outputRG.getRowCount() > 0)
 			output->insert(outRGData);
-		if (distinct) {
-			getOutput(&l_outputRG, &outRow, &outRGData);
-			if (++distinctDone == distinctCount && l_outputRG.getRowCount() > 0)
-				output->insert(outRGData);
-		}
+		// the last distinct input to finish sends what's left in the partitions
+		if (distinct && ++distinctDone == distinctCount)
+			for (uint32_t p = 0; p < partitionCount; p++)
+				if (partitions[p].rg.getRowCount() > 0)
+					output->insert(partitions[p].current);
 		if (++runnersDone == fInputJobStepAssociation.outSize())
 		{
 			output->endOfInput();
@@ -330,27 +371,12 @@ uint32_t TupleUnion::nextBand(messageqcpp::ByteStream &bs)
 	return ret;
 }
 
-void TupleUnion::getOutput(RowGroup *rg, Row *row, RGData *data)
-{
-	if (UNLIKELY(rowMemory.empty())) {
-		*data = RGData(*rg);
-		rg->setData(data);
-		rg->resetRowGroup(0);
-		rowMemory.push_back(*data);
-	}
-	else {
-		*data = rowMemory.back();
-		rg->setData(data);
-	}
-	rg->getRow(rg->getRowCount(), row);
-}
-
-void TupleUnion::addToOutput(Row *r, RowGroup *rg, bool keepit,
+void TupleUnion::addToOutput(Row *r, RowGroup *rg, vector<RGData> *keep,
 	RGData &data)
 {
 	r->nextRow();
 	rg->incRowCount();
-	fRowsReturned++;
+	atomicops::atomicInc(&fRowsReturned);
 	if (rg->getRowCount() == 8192) {
 		{
 			mutex::scoped_lock lock(sMutex);
@@ -360,8 +386,8 @@ void TupleUnion::addToOutput(Row *r, RowGroup *rg, bool keepit,
 		rg->setData(&data);
 		rg->resetRowGroup(0);
 		rg->getRow(0, r);
-		if (keepit)
-			rowMemory.push_back(data);
+		if (keep)
+			keep->push_back(data);
 	}
 }
 
@@ -755,9 +781,6 @@ void TupleUnion::run()
 	if (fDelivery) {
 		outputIt = output->getIterator();
 	}
-	outputRG.initRow(&row);
-	outputRG.initRow(&row2);
-
 	distinctCount = 0;
 	normalizedData.reset(new RGData[inputs.size()]);
 	for (i = 0; i < inputs.size(); i++) {
@@ -766,6 +789,11 @@ void TupleUnion::run()
 			normalizedData[i].reinit(outputRG);
 		}
 	}
+	if (distinctCount > 0) {
+		partitions.reset(new Partition[partitionCount]);
+		for (i = 0; i < partitionCount; i++)
+			partitions[i].init(this);
+	}
 
 	for (i = 0; i < inputs.size(); i++) {
 		boost::shared_ptr<boost::thread> th(new boost::thread(Runner(this, i)));
@@ -777,7 +805,6 @@ void TupleUnion::join()
 {
 	uint32_t i;
 	mutex::scoped_lock lk(jlLock);
-	Uniquer_t::iterator it;
 
 	if (joinRan)
 		return;
@@ -787,8 +814,9 @@ void TupleUnion::join()
 	for (i = 0; i < runners.size(); i++)
 		runners[i]->join();
 	runners.clear();
-	uniquer->clear();
-	rowMemory.clear();
+	if (partitions)
+		for (i = 0; i < partitionCount; i++)
+			partitions[i].clear();
 	rm.returnMemory(memUsage, sessionMemLimit);
 	memUsage = 0;
 }
@@ -897,6 +925,8 @@ void TupleUnion::formatMiniStats()
         << JSTimeStamp::tsdiffstr(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()) << " "
         << fRowsReturned << " ";
     fMiniInfo += oss.str();
+    profileSummary("TUS", "UM", "-",
+        JSTimeStamp::tsdiff(dlTimes.EndOfInputTime(), dlTimes.FirstReadTime()), fRowsReturned);
 }
 
 }
@@ -81,18 +81,23 @@ public:
 
 private:
 
+	/* The row's hash is computed once, before the row is inserted, and kept here so
+	   the hash tables never rehash a row, and Eq only compares rows whose hashes match. */
 	struct RowPosition
 	{
 		uint64_t group : 48;
 		uint64_t row   : 16;
+		uint32_t hash;
 
-		inline RowPosition(uint64_t i = 0, uint64_t j = 0) : group(i), row(j) {};
+		inline RowPosition(uint64_t i = 0, uint64_t j = 0, uint32_t h = 0) :
+			group(i), row(j), hash(h) {};
 		static const uint64_t normalizedFlag = 0x800000000000ULL;   // 48th bit is set
 	};
 
-	void getOutput(rowgroup::RowGroup *rg, rowgroup::Row *row, rowgroup::RGData *data);
-	void addToOutput(rowgroup::Row *r, rowgroup::RowGroup *rg, bool keepit,
-		rowgroup::RGData &data);
+	struct Partition;
+
+	void addToOutput(rowgroup::Row *r, rowgroup::RowGroup *rg,
+		std::vector<rowgroup::RGData> *keep, rowgroup::RGData &data);
 	void normalize(const rowgroup::Row &in, rowgroup::Row *out);
 	void writeNull(rowgroup::Row *out, uint32_t col);
 	void readInput(uint32_t);
@@ -121,36 +126,54 @@ private:
 	std::vector<boost::shared_ptr<boost::thread> > runners;
 
 	struct Hasher {
-		TupleUnion *ts;
-		utils::Hasher_r h;
-		Hasher(TupleUnion *t) : ts(t) { }
-		uint64_t operator()(const RowPosition &) const;
+		Hasher(Partition *) { }
+		uint64_t operator()(const RowPosition &p) const { return p.hash; }
 	};
 	struct Eq {
-		TupleUnion *ts;
-		Eq(TupleUnion *t) : ts(t) { }
+		Partition *part;
+		Eq(Partition *p) : part(p) { }
 		bool operator()(const RowPosition &, const RowPosition &) const;
 	};
 
 	typedef std::tr1::unordered_set<RowPosition, Hasher, Eq,
 		utils::STLPoolAllocator<RowPosition> > Uniquer_t;
 
-	boost::scoped_ptr<Uniquer_t> uniquer;
-	std::vector<rowgroup::RGData> rowMemory;
-	boost::mutex sMutex, uniquerMutex;
-	uint64_t memUsage;
+	/* The distinct check is split by the top bits of the row hash into partitions
+	   that each have their own hash table, lock, and output.  An input thread hashes
+	   a whole rowgroup up front, groups its rows by partition, and then takes each
+	   partition's lock once for all of its rows there, so threads only wait on each
+	   other when they land in the same partition at the same time.  The unique rows
+	   are built in the partition's rowMemory, which the RowPositions in its table
+	   refer to. */
+	struct Partition {
+		TupleUnion *tu;
+		utils::STLPoolAllocator<RowPosition> allocator;
+		boost::scoped_ptr<Uniquer_t> uniquer;
+		std::vector<rowgroup::RGData> rowMemory;
+		rowgroup::RGData current;   // the last entry in rowMemory, being filled
+		rowgroup::RowGroup rg;
+		rowgroup::Row outRow, row, row2;
+		boost::mutex mutex;
+
+		void init(TupleUnion *t);
+		void clear();
+	};
+	static const uint32_t partitionBits = 4;
+	static const uint32_t partitionCount = 1 << partitionBits;
+	boost::scoped_array<Partition> partitions;
+
+	boost::mutex sMutex;
+	volatile uint64_t memUsage;
 	uint32_t rowLength;
-	rowgroup::Row row, row2;
 	std::vector<bool> distinctFlags;
 	ResourceManager& rm;
-	utils::STLPoolAllocator<RowPosition> allocator;
 	boost::scoped_array<rowgroup::RGData> normalizedData;
 
 	uint32_t runnersDone;
 	uint32_t distinctCount;
 	uint32_t distinctDone;
 
-	uint64_t fRowsReturned;
+	volatile uint64_t fRowsReturned;
 
 	// temporary hack to make sure JobList only calls run, join once
 	boost::mutex jlLock;
@@ -1639,6 +1639,15 @@ uint32_t setAggOp(AggregateColumn* ac, Item_sum* isp)
 				return HA_ERR_UNSUPPORTED;
 			return rc;
 		}
+		case Item_sum::UDF_SUM_FUNC:
+		{
+			// aggregate UDFs that are stubs for InfiniDB native aggregates
+			if (strcasecmp(isp->func_name(), "approx_count_distinct") == 0)
+				ac->aggOp(AggregateColumn::APPROX_COUNT_DISTINCT);
+			else
+				return HA_ERR_UNSUPPORTED;
+			return rc;
+		}
 		default:
 			return HA_ERR_UNSUPPORTED;
 	}
@@ -3229,7 +3238,8 @@ ReturnedColumn* buildAggregateColumn(Item* item, gp_walk_info& gwi)
 			ac->resultType(ct);
 		}
 		else if (isp->sum_func() == Item_sum::COUNT_FUNC ||
-				 isp->sum_func() == Item_sum::COUNT_DISTINCT_FUNC)
+				 isp->sum_func() == Item_sum::COUNT_DISTINCT_FUNC ||
+				 ac->aggOp() == AggregateColumn::APPROX_COUNT_DISTINCT)
 		{
 			CalpontSystemCatalog::ColType ct;
 			ct.colDataType = CalpontSystemCatalog::BIGINT;
@@ -143,6 +143,33 @@ using namespace funcexp;
 namespace cal_impl_if
 {
 	extern bool nonConstFunc(Item_func* ifp);
+
+/** @brief how one mysql field is filled from a RowGroup column */
+struct ColumnWriter
+{
+	typedef void (*WriteFn)(Field* f, const rowgroup::Row& row, uint32_t col,
+		const execplan::CalpontSystemCatalog::ColType& ct);
+
+	Field* field;
+	int rgPos;			// position in the rowgroup, -1 if not projected
+	bool checkNull;		// false for bit ops (precision == -16)
+	bool emptyOnNull;	// @2835 string columns store "" for NULL
+	WriteFn write;
+	execplan::CalpontSystemCatalog::ColType colType;
+};
+
+/** @brief conversion plan for one table scan
+ *
+ * Built on the first fetched row so that the per-row loop in fetchNextRow()
+ * does no column mapping or type dispatch.
+ */
+struct RowWriterPlan
+{
+	RowWriterPlan() : rowGroup(0) { }
+	std::vector<ColumnWriter> writers;
+	rowgroup::RowGroup* rowGroup;	// no ownership. the rowgroup the plan was built for
+	rowgroup::Row row;
+};
 }
 
 namespace
@@ -308,10 +335,328 @@ int vbin2hex(const uint8_t* p, const unsigned l, char* o)
 	return 0;
 }
 
+inline void clearNull(Field* f)
+{
+	if (f->null_ptr)
+		*f->null_ptr &= ~f->null_bit;
+}
+
+inline char* put2(char* p, unsigned v)
+{
+	p[0] = '0' + v / 10;
+	p[1] = '0' + v % 10;
+	return p + 2;
+}
+
+inline char* put4(char* p, unsigned v)
+{
+	p = put2(p, v / 100);
+	return put2(p, v % 100);
+}
+
+//
+// Field writers used by RowWriterPlan. Each one handles exactly one
+// (column type, field type) combination picked when the plan is built.
+//
+void writeDate(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	clearNull(f);
+	uint32_t v = row.getUintField<4>(s);
+	unsigned year = (v >> 16) & 0xffff;
+	char tmp[16];
+	if (year > 9999)
+	{
+		DataConvert::dateToString(v, tmp, 16);
+		f->store(tmp, strlen(tmp), f->charset());
+		return;
+	}
+	char* p = put4(tmp, year);
+	*p++ = '-';
+	p = put2(p, (v >> 12) & 0xf);
+	*p++ = '-';
+	p = put2(p, (v >> 6) & 0x3f);
+	f->store(tmp, p - tmp, f->charset());
+}
+
+void writeDatetime(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	clearNull(f);
+	uint64_t v = row.getUintField<8>(s);
+	unsigned year = (v >> 48) & 0xffff;
+	char tmp[32];
+	if (year > 9999)
+	{
+		DataConvert::datetimeToString(v, tmp, 32);
+		f->store(tmp, strlen(tmp), f->charset());
+		return;
+	}
+	char* p = put4(tmp, year);
+	*p++ = '-';
+	p = put2(p, (v >> 44) & 0xf);
+	*p++ = '-';
+	p = put2(p, (v >> 38) & 0x3f);
+	*p++ = ' ';
+	p = put2(p, (v >> 32) & 0x3f);
+	*p++ = ':';
+	p = put2(p, (v >> 26) & 0x3f);
+	*p++ = ':';
+	p = put2(p, (v >> 20) & 0x3f);
+	f->store(tmp, p - tmp, f->charset());
+}
+
+template<int len>
+void writeShortString(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	//make sure we don't send strlen off into the weeds...
+	uint64_t v = row.getUintField<len>(s);
+	const char* p = (const char*)&v;
+	f->store(p, strnlen(p, len), f->charset());
+	clearNull(f);
+}
+
+void writeString(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	// stop at the first NUL like the old strlen() on getStringField() did
+	const char* p = (const char*)row.getStringPointer(s);
+	f->store(p, strnlen(p, row.getStringLength(s)), f->charset());
+	clearNull(f);
+}
+
+void writeVarBinary(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	f->store((const char*)row.getVarBinaryField(s), row.getVarBinaryLength(s), f->charset());
+	clearNull(f);
+}
+
+void writeVarBinaryHex(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	uint32_t l;
+	const uint8_t* p = row.getVarBinaryField(l, s);
+	uint32_t ll = l * 2;
+	boost::scoped_array<char> sca(new char[ll]);
+	vbin2hex(p, l, sca.get());
+	f->store(sca.get(), ll, f->charset());
+	clearNull(f);
+}
+
+// integer column into an integer field: no intermediate formatting
+template<int len, bool isSigned>
+void writeInteger(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	clearNull(f);
+	longlong v = (isSigned ? (longlong)row.getIntField<len>(s) : (longlong)row.getUintField<len>(s));
+	f->store(v, f->unsigned_flag);
+}
+
+// integer or decimal column into a decimal, float, double or varchar field
+template<int len, bool isSigned>
+void writeNumeric(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType& ct)
+{
+	int64_t v = (isSigned ? row.getIntField<len>(s) : (int64_t)row.getUintField<len>(s));
+	storeNumericField(&f, v, const_cast<CalpontSystemCatalog::ColType&>(ct));
+}
+
+//In this case, we're trying to load a double output column with float data. This is the
+// case when you do sum(floatcol), e.g.
+void writeFloat(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	float dl = row.getFloatField(s);
+	if (dl == std::numeric_limits<float>::infinity())
+		return;
+	f->store(dl);
+	clearNull(f);
+}
+
+void writeDouble(Field* f, const Row& row, uint32_t s, const CalpontSystemCatalog::ColType&)
+{
+	double dl = row.getDoubleField(s);
+	if (dl == std::numeric_limits<double>::infinity())
+		return;
+	f->store(dl);
+	clearNull(f);
+}
+
+template<bool isSigned>
+ColumnWriter::WriteFn pickNumericWriter(Field* f, uint32_t width)
+{
+	bool intField = true;
+	switch (f->type())
+	{
+		case MYSQL_TYPE_NEWDECIMAL:
+		case MYSQL_TYPE_FLOAT:
+		case MYSQL_TYPE_DOUBLE:
+		case MYSQL_TYPE_VARCHAR:
+			intField = false;
+			break;
+		default:
+			break;
+	}
+
+	ColumnWriter::WriteFn fn;
+	switch (width)
+	{
+		case 1:
+			if (intField) fn = &writeInteger<1, isSigned>; else fn = &writeNumeric<1, isSigned>;
+			break;
+		case 2:
+			if (intField) fn = &writeInteger<2, isSigned>; else fn = &writeNumeric<2, isSigned>;
+			break;
+		case 4:
+			if (intField) fn = &writeInteger<4, isSigned>; else fn = &writeNumeric<4, isSigned>;
+			break;
+		default:
+			if (intField) fn = &writeInteger<8, isSigned>; else fn = &writeNumeric<8, isSigned>;
+			break;
+	}
+	return fn;
+}
+
+void buildWriterPlan(RowWriterPlan& plan, cal_table_info& ti)
+{
+	int num_attr = ti.msTablePtr->s->fields;
+	std::vector<CalpontSystemCatalog::ColType> &colTypes = ti.tpl_scan_ctx->ctp;
+	RowGroup *rowGroup = ti.tpl_scan_ctx->rowGroup;
+	bool tableMode = (ti.tpl_scan_ctx->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF);
+
+	// table mode mysql expects all columns of the table. mapping between columnoid and position in rowgroup
+	// set coltype.position to be the position in rowgroup.
+	if (tableMode)
+	{
+		for (uint32_t i = 0; i < rowGroup->getColumnCount(); i++)
+		{
+			int oid = rowGroup->getOIDs()[i];
+			int j = 0;
+			for (; j < num_attr; j++)
+			{
+				// mysql should haved eliminated duplicate projection columns
+				if (oid == colTypes[j].columnOID || oid == colTypes[j].ddn.dictOID)
+				{
+					colTypes[j].colPosition = i;
+					break;
+				}
+			}
+		}
+	}
+	// get coltype if not there yet
+	if (colTypes[0].colWidth == 0)
+	{
+		for (short c = 0; c < num_attr; c++)
+		{
+			colTypes[c].colPosition = c;
+			colTypes[c].colWidth = rowGroup->getColumnWidth(c);
+			colTypes[c].colDataType = rowGroup->getColTypes()[c];
+			colTypes[c].columnOID = rowGroup->getOIDs()[c];
+			colTypes[c].scale = rowGroup->getScale()[c];
+			colTypes[c].precision = rowGroup->getPrecision()[c];
+		}
+	}
+
+	plan.writers.clear();
+	plan.writers.reserve(num_attr);
+	plan.rowGroup = rowGroup;
+	rowGroup->initRow(&plan.row);
+
+	Field** f = ti.msTablePtr->field;
+	for (int p = 0; p < num_attr; p++, f++)
+	{
+		ColumnWriter cw;
+		cw.field = *f;
+		cw.colType = colTypes[p];
+		cw.rgPos = (tableMode ? cw.colType.colPosition : p);
+		// precision == -16 is borrowed as skip null check indicator for bit ops.
+		cw.checkNull = (cw.colType.precision != -16);
+		cw.emptyOnNull = false;
+
+		switch (cw.colType.colDataType)
+		{
+			case CalpontSystemCatalog::DATE:
+				cw.write = writeDate;
+				break;
+			case CalpontSystemCatalog::DATETIME:
+				cw.write = writeDatetime;
+				break;
+			case CalpontSystemCatalog::CHAR:
+			case CalpontSystemCatalog::VARCHAR:
+				cw.emptyOnNull = true;
+				switch (cw.colType.colWidth)
+				{
+					case 1: cw.write = writeShortString<1>; break;
+					case 2: cw.write = writeShortString<2>; break;
+					case 4: cw.write = writeShortString<4>; break;
+					case 8: cw.write = writeShortString<8>; break;
+					default: cw.write = writeString; break;
+				}
+				break;
+			case CalpontSystemCatalog::VARBINARY:
+				cw.emptyOnNull = true;
+				if (current_thd->variables.infinidb_varbin_always_hex)
+					cw.write = writeVarBinaryHex;
+				else
+					cw.write = writeVarBinary;
+				break;
+			case CalpontSystemCatalog::BIGINT:
+				cw.write = pickNumericWriter<true>(*f, 8);
+				break;
+			case CalpontSystemCatalog::UBIGINT:
+				cw.write = pickNumericWriter<false>(*f, 8);
+				break;
+			case CalpontSystemCatalog::INT:
+				cw.write = pickNumericWriter<true>(*f, 4);
+				break;
+			case CalpontSystemCatalog::UINT:
+				cw.write = pickNumericWriter<false>(*f, 4);
+				break;
+			case CalpontSystemCatalog::SMALLINT:
+				cw.write = pickNumericWriter<true>(*f, 2);
+				break;
+			case CalpontSystemCatalog::USMALLINT:
+				cw.write = pickNumericWriter<false>(*f, 2);
+				break;
+			case CalpontSystemCatalog::TINYINT:
+				cw.write = pickNumericWriter<true>(*f, 1);
+				break;
+			case CalpontSystemCatalog::UTINYINT:
+				cw.write = pickNumericWriter<false>(*f, 1);
+				break;
+			case CalpontSystemCatalog::FLOAT:
+			case CalpontSystemCatalog::UFLOAT:
+				// bug 3485, reserve enough space for the longest float value
+				// -3.402823466E+38 to -1.175494351E-38, 0, and
+				// 1.175494351E-38 to 3.402823466E+38.
+				(*f)->field_length = 40;
+				cw.write = writeFloat;
+				break;
+			case CalpontSystemCatalog::DOUBLE:
+			case CalpontSystemCatalog::UDOUBLE:
+				// bug 3483, reserve enough space for the longest double value
+				// -1.7976931348623157E+308 to -2.2250738585072014E-308, 0, and
+				// 2.2250738585072014E-308 to 1.7976931348623157E+308.
+				(*f)->field_length = 310;
+				cw.write = writeDouble;
+				break;
+			case CalpontSystemCatalog::DECIMAL:
+			case CalpontSystemCatalog::UDECIMAL:
+				// decimals always go through storeNumericField for the scale handling
+				switch (cw.colType.colWidth)
+				{
+					case 1: cw.write = writeNumeric<1, true>; break;
+					case 2: cw.write = writeNumeric<2, true>; break;
+					case 4: cw.write = writeNumeric<4, true>; break;
+					default: cw.write = writeNumeric<8, true>; break;
+				}
+				break;
+			default:	// treat as int64
+				cw.write = writeNumeric<8, false>;
+				break;
+		}
+
+		plan.writers.push_back(cw);
+	}
+}
+
 int fetchNextRow(uchar *buf, cal_table_info& ti, cal_connection_info* ci)
 {
 	int rc = HA_ERR_END_OF_FILE;
-	int num_attr = ti.msTablePtr->s->fields;
 	sm::status_t sm_stat;
 
 	try {
@@ -343,278 +688,39 @@ int fetchNextRow(uchar *buf, cal_table_info& ti, cal_connection_info* ci)
 
 	if (sm_stat == sm::STATUS_OK)
 	{
-		Field **f;
-		f = ti.msTablePtr->field;
 		//set all fields to null in null col bitmap
 		memset(buf, -1, ti.msTablePtr->s->null_bytes);
-		std::vector<CalpontSystemCatalog::ColType> &colTypes = ti.tpl_scan_ctx->ctp;
-		int64_t intColVal = 0;
-		uint64_t uintColVal = 0;
-		string stringColVal;
-		char tmp[256];
 
 		RowGroup *rowGroup = ti.tpl_scan_ctx->rowGroup;
-
-		// table mode mysql expects all columns of the table. mapping between columnoid and position in rowgroup
-		// set coltype.position to be the position in rowgroup. only set once.
-		if (ti.tpl_scan_ctx->rowsreturned == 0 &&
-			 (ti.tpl_scan_ctx->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF))
+		if (!ti.writerPlan || ti.writerPlan->rowGroup != rowGroup)
 		{
-			for (uint32_t i = 0; i < rowGroup->getColumnCount(); i++)
-			{
-				int oid = rowGroup->getOIDs()[i];
-				int j = 0;
-				for (; j < num_attr; j++)
-				{
-					// mysql should haved eliminated duplicate projection columns
-					if (oid == colTypes[j].columnOID || oid == colTypes[j].ddn.dictOID)
-					{
-						colTypes[j].colPosition = i;
-						break;
-					}
-				}
-			}
+			ti.writerPlan.reset(new RowWriterPlan());
+			buildWriterPlan(*ti.writerPlan, ti);
 		}
 
-		rowgroup::Row row;
-		rowGroup->initRow(&row);
+		rowgroup::Row& row = ti.writerPlan->row;
 		rowGroup->getRow(ti.tpl_scan_ctx->rowsreturned, &row);
-		int s;
-		for (int p = 0; p < num_attr; p++, f++)
+		std::vector<ColumnWriter>::const_iterator it = ti.writerPlan->writers.begin();
+		std::vector<ColumnWriter>::const_iterator end = ti.writerPlan->writers.end();
+		for (; it != end; ++it)
 		{
+			Field* f = it->field;
 			//This col is going to be written
-			bitmap_set_bit(ti.msTablePtr->write_set, (*f)->field_index);
-
-			// get coltype if not there yet
-			if (colTypes[0].colWidth == 0)
-			{
-				for (short c = 0; c < num_attr; c++)
-				{
-					colTypes[c].colPosition = c;
-					colTypes[c].colWidth = rowGroup->getColumnWidth(c);
-					colTypes[c].colDataType = rowGroup->getColTypes()[c];
-					colTypes[c].columnOID = rowGroup->getOIDs()[c];
-					colTypes[c].scale = rowGroup->getScale()[c];
-					colTypes[c].precision = rowGroup->getPrecision()[c];
-				}
-			}
-			CalpontSystemCatalog::ColType colType(colTypes[p]);
+			bitmap_set_bit(ti.msTablePtr->write_set, f->field_index);
 
-			// table mode handling
-			if (ti.tpl_scan_ctx->traceFlags & execplan::CalpontSelectExecutionPlan::TRACE_TUPLE_OFF)
-			{
-				if (colType.colPosition == -1) // not projected by tuplejoblist
-					continue;
-				else
-					s = colType.colPosition;
-			}
-			else
-			{
-				s = p;
-			}
+			// not projected by tuplejoblist
+			if (it->rgPos < 0)
+				continue;
 
-			// precision == -16 is borrowed as skip null check indicator for bit ops.
-			if (row.isNullValue(s) && colType.precision != -16)
+			if (it->checkNull && row.isNullValue(it->rgPos))
 			{
 				// @2835. Handle empty string and null confusion. store empty string for string column
-				if (colType.colDataType == CalpontSystemCatalog::CHAR ||
-					  colType.colDataType == CalpontSystemCatalog::VARCHAR ||
-					  colType.colDataType == CalpontSystemCatalog::VARBINARY)
-				{
-					Field_varstring* f2 = (Field_varstring*)*f;
-					f2->store(tmp, 0, f2->charset());
-				}
+				if (it->emptyOnNull)
+					f->store("", 0, f->charset());
 				continue;
 			}
 
-			// fetch and store data
-			switch (colType.colDataType)
-			{
-				case CalpontSystemCatalog::DATE:
-				{
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					intColVal = row.getUintField<4>(s);
-					DataConvert::dateToString(intColVal, tmp, 255);
-					Field_varstring* f2 = (Field_varstring*)*f;
-					f2->store(tmp, strlen(tmp), f2->charset());
-					break;
-				}
-				case CalpontSystemCatalog::DATETIME:
-				{
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					intColVal = row.getUintField<8>(s);
-					DataConvert::datetimeToString(intColVal, tmp, 255);
-					Field_varstring* f2 = (Field_varstring*)*f;
-					f2->store(tmp, strlen(tmp), f2->charset());
-					break;
-				}
-				case CalpontSystemCatalog::CHAR:
-				case CalpontSystemCatalog::VARCHAR:
-				{
-					Field_varstring* f2 = (Field_varstring*)*f;
-					switch (colType.colWidth)
-					{
-						case 1:
-							intColVal = row.getUintField<1>(s);
-							f2->store((char*)(&intColVal), strlen((char*)(&intColVal)), f2->charset());
-							break;
-						case 2:
-							intColVal = row.getUintField<2>(s);
-							f2->store((char*)(&intColVal), strlen((char*)(&intColVal)), f2->charset());
-							break;
-						case 4:
-							intColVal = row.getUintField<4>(s);
-							f2->store((char*)(&intColVal), strlen((char*)(&intColVal)), f2->charset());
-							break;
-						case 8:
-							//make sure we don't send strlen off into the weeds...
-							intColVal = row.getUintField<8>(s);
-							memcpy(tmp, &intColVal, 8);
-							tmp[8] = 0;
-							f2->store(tmp, strlen(tmp), f2->charset());
-							break;
-						default:
-							stringColVal = row.getStringField(s);
-							f2->store(stringColVal.c_str(), strlen(stringColVal.c_str()), f2->charset());
-					}
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					break;
-				}
-				case CalpontSystemCatalog::VARBINARY:
-				{
-					Field_varstring* f2 = (Field_varstring*)*f;
-
-					if (current_thd->variables.infinidb_varbin_always_hex)
-					{
-						uint32_t l;
-						const uint8_t* p = row.getVarBinaryField(l, s);
-						uint32_t ll = l * 2;
-						boost::scoped_array<char> sca(new char[ll]);
-						vbin2hex(p, l, sca.get());
-						f2->store(sca.get(), ll, f2->charset());
-					}
-					else
-						f2->store((const char*)row.getVarBinaryField(s), row.getVarBinaryLength(s), f2->charset());
-
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					break;
-				}
-				case CalpontSystemCatalog::BIGINT:
-				{
-					intColVal = row.getIntField<8>(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::UBIGINT:
-				{
-					uintColVal = row.getUintField<8>(s);
-					storeNumericField(f, uintColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::INT:
-				{
-					intColVal = row.getIntField<4>(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::UINT:
-				{
-					uintColVal = row.getUintField<4>(s);
-					storeNumericField(f, uintColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::SMALLINT:
-				{
-					intColVal = row.getIntField<2>(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::USMALLINT:
-				{
-					uintColVal = row.getUintField<2>(s);
-					storeNumericField(f, uintColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::TINYINT:
-				{
-					intColVal = row.getIntField<1>(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-				case CalpontSystemCatalog::UTINYINT:
-				{
-					uintColVal = row.getUintField<1>(s);
-					storeNumericField(f, uintColVal, colType);
-					break;
-				}
-				//In this case, we're trying to load a double output column with float data. This is the
-				// case when you do sum(floatcol), e.g.
-				case CalpontSystemCatalog::FLOAT:
-				case CalpontSystemCatalog::UFLOAT:
-				{
-					float dl = row.getFloatField(s);
-					if (dl == std::numeric_limits<float>::infinity())
-						continue;
-
-					//int64_t* icvp = (int64_t*)&dl;
-					//intColVal = *icvp;
-					Field_float* f2 = (Field_float*)*f;
-					// bug 3485, reserve enough space for the longest float value
-					// -3.402823466E+38 to -1.175494351E-38, 0, and
-					// 1.175494351E-38 to 3.402823466E+38.
-					(*f)->field_length = 40;
-					//float float_val = *(float*)(&value);
-					//f2->store(float_val);
-					f2->store(dl);
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					break;
-
-					//storeNumericField(f, intColVal, colType);
-					//break;
-				}
-				case CalpontSystemCatalog::DOUBLE:
-				case CalpontSystemCatalog::UDOUBLE:
-				{
-					double dl = row.getDoubleField(s);
-					if (dl == std::numeric_limits<double>::infinity())
-						continue;
-					Field_double* f2 = (Field_double*)*f;
-					// bug 3483, reserve enough space for the longest double value
-					// -1.7976931348623157E+308 to -2.2250738585072014E-308, 0, and
-					// 2.2250738585072014E-308 to 1.7976931348623157E+308.
-					(*f)->field_length = 310;
-					//double double_val = *(double*)(&value);
-					//f2->store(double_val);
-					f2->store(dl);
-					if ((*f)->null_ptr)
-						*(*f)->null_ptr &= ~(*f)->null_bit;
-					break;
-
-
-					//int64_t* icvp = (int64_t*)&dl;
-					//intColVal = *icvp;
-					//storeNumericField(f, intColVal, colType);
-					//break;
-				}
-				case CalpontSystemCatalog::DECIMAL:
-				case CalpontSystemCatalog::UDECIMAL:
-				{
-					intColVal = row.getIntField(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-				default:	// treat as int64
-				{
-					intColVal = row.getUintField<8>(s);
-					storeNumericField(f, intColVal, colType);
-					break;
-				}
-			}
+			it->write(f, row, it->rgPos, it->colType);
 		}
 
 		ti.tpl_scan_ctx->rowsreturned++;
@@ -2187,6 +2293,57 @@ my_bool calflushcache_init(UDF_INIT* initid, UDF_ARGS* args, char* message)
 	return 0;
 }
 
+/**
+ * APPROX_COUNT_DISTINCT
+ * Aggregate stub, the HyperLogLog estimate is only computed by InfiniDB.
+ */
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+my_bool approx_count_distinct_init(UDF_INIT* initid, UDF_ARGS* args, char* message)
+{
+	if (args->arg_count != 1)
+	{
+		strcpy(message,"APPROX_COUNT_DISTINCT() requires one argument");
+		return 1;
+	}
+
+	return 0;
+}
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+void approx_count_distinct_deinit(UDF_INIT* initid)
+{
+}
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+void approx_count_distinct_clear(UDF_INIT* initid, char* is_null, char* error)
+{
+}
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+void approx_count_distinct_add(UDF_INIT* initid, UDF_ARGS* args, char* is_null, char* error)
+{
+}
+
+#ifdef _MSC_VER
+__declspec(dllexport)
+#endif
+long long approx_count_distinct(UDF_INIT* initid, UDF_ARGS* args,
+							char* is_null, char* error)
+{
+	string msg("APPROX_COUNT_DISTINCT() is only supported on InfiniDB tables.");
+	setError(current_thd, HA_ERR_UNSUPPORTED, msg);
+	*error = 1;
+	return 0;
+}
+
 static const unsigned long TraceSize = 16 * 1024;
 
 //mysqld will call this with only 766 bytes available in result no matter what we asked for in calgettrace_init()
@@ -2733,6 +2890,7 @@ int ha_calpont_impl_rnd_init(TABLE* table)
 		// make sure rowgroup is null so the new meta data can be taken. This is for some case mysql
 		// call rnd_init for a table more than once.
 		ti.tpl_scan_ctx->rowGroup = NULL;
+		ti.writerPlan.reset();
 
 		try {
 			tableid = execplan::IDB_VTABLE_ID;
@@ -2874,8 +3032,8 @@ int ha_calpont_impl_rnd_next(uchar *buf, TABLE* table)
 
 	if (ci->alterTableState > 0) return HA_ERR_END_OF_FILE;
 
-	cal_table_info ti;
-	ti = ci->tableMap[table];
+	// work on the map entry in place; copying cal_table_info for every row is not free
+	cal_table_info& ti = ci->tableMap[table];
 	int rc = HA_ERR_END_OF_FILE;
 
 	if (!ti.tpl_ctx || !ti.tpl_scan_ctx)
@@ -2902,7 +3060,6 @@ int ha_calpont_impl_rnd_next(uchar *buf, TABLE* table)
 		CalpontSystemCatalog::removeCalpontSystemCatalog(tid2sid(thd->thread_id));
 		return HA_ERR_INTERNAL_ERROR;
 	}
-	ci->tableMap[table] = ti;
 
 	if (rc != 0 && rc != HA_ERR_END_OF_FILE)
 	{
@@ -3041,6 +3198,7 @@ int ha_calpont_impl_rnd_end(TABLE* table)
 			}
 		}
 		ti.tpl_scan_ctx.reset();
+		ti.writerPlan.reset();
 		try {
 			sm::tpl_close(ti.tpl_ctx, &hndl, ci->stats);
 			// set conn hndl back. could be changed in tpl_close
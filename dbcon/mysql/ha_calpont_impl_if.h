@@ -69,6 +69,7 @@ namespace cal_impl_if
 {
 class SubQuery;
 class View;
+struct RowWriterPlan;
 
 struct JoinInfo
 {
@@ -181,6 +182,7 @@ struct cal_table_info
 	gp_walk_info* condInfo;
 	execplan::SCSEP csep;
 	bool moreRows; //are there more rows to consume (b/c of limit)
+	boost::shared_ptr<RowWriterPlan> writerPlan; // per-scan field writers, built by fetchNextRow
 };
 
 typedef std::tr1::unordered_map<TABLE*, cal_table_info> CalTableMap;
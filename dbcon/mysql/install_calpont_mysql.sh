@@ -79,6 +79,7 @@ CREATE FUNCTION idbextentmin RETURNS STRING soname 'libcalmysql.so';
 CREATE FUNCTION idbextentmax RETURNS STRING soname 'libcalmysql.so';
 CREATE FUNCTION idbpartition RETURNS STRING soname 'libcalmysql.so';
 CREATE FUNCTION idblocalpm RETURNS INTEGER soname 'libcalmysql.so';
+CREATE AGGREGATE FUNCTION approx_count_distinct RETURNS INTEGER soname 'libcalmysql.so';
 
 CREATE DATABASE IF NOT EXISTS infinidb_vtable;
 CREATE DATABASE IF NOT EXISTS infinidb_querystats;
@@ -131,7 +131,10 @@ status_t tpl_scan_fetch_getband(cpsm_conhdl_t* hndl, sp_cpsm_tplsch_t& ntplsch,
 					t.tv_nsec = 0L;
 					if (killed && *killed)
 						return SQL_KILLED;
-					ntplsch->bs = hndl->exeMgr->read();
+					if (hndl->prefetching())
+						hndl->finishPrefetch(ntplsch->bs);
+					else
+						ntplsch->bs = hndl->exeMgr->read();
 
 					if (ntplsch->bs.length() != 0)
 					{
@@ -166,6 +169,13 @@ status_t tpl_scan_fetch_getband(cpsm_conhdl_t* hndl, sp_cpsm_tplsch_t& ntplsch,
 							ntplsch->setErrMsg();
 							return error;
 						}
+
+						// Start pulling the next band off the socket while mysql converts
+						// this one. Table mode may interleave scans on the connection, so
+						// only the vtable path prefetches.
+						if (hndl->bandPrefetch && ntplsch->getRowCount() > 0 &&
+						  !(ntplsch->traceFlags & CalpontSelectExecutionPlan::TRACE_TUPLE_OFF))
+							hndl->startPrefetch();
 					}
 					else // @todo error handling
 					{
@@ -264,6 +274,8 @@ tpl_open ( tableid_t tableid,
 				conn_hdl->queryState = QUERY_IN_PROCESS;
 		}
 
+		conn_hdl->stopPrefetch();
+
 		try {
 				// @bug 626. check saveFlag, if SAVED, do not project
 				if (ntplh->saveFlag != SAVED)
@@ -347,6 +359,11 @@ tpl_close ( cpsm_tplh_t* ntplh,
 #endif
 		delete ntplh;
 
+		// mysql may stop fetching before the last band (e.g. a join that is
+		// satisfied early). Nothing else may read the socket until the reader
+		// thread is gone.
+		hndl->stopPrefetch();
+
 		// determine end of result set and end of statement execution
 		if (hndl->queryState == QUERY_IN_PROCESS)
 		{
@@ -443,6 +460,81 @@ sm_cleanup ( cpsm_conhdl_t* conn_hdl )
 	return STATUS_OK;
 }
 
+// Reads one message from ExeMgr on behalf of cpsm_conhdl_t::startPrefetch().
+// Uses a timed read so stopPrefetch() can get the thread back even when
+// ExeMgr has nothing more to say.
+struct BandReader
+{
+	BandReader(cpsm_conhdl_t* h) : hndl(h) { }
+	void operator()()
+	{
+		try {
+			timespec t;
+			t.tv_sec = 1L;
+			t.tv_nsec = 0L;
+			bool timeout = true;
+			while (timeout && !hndl->prefetchStop)
+			{
+				timeout = false;
+				hndl->prefetchBs = hndl->exeMgr->getClient()->read(&t, &timeout);
+			}
+		} catch (std::exception& e) {
+			hndl->prefetchErr = e.what();
+			hndl->prefetchBs.reset();
+		} catch (...) {
+			hndl->prefetchErr = "unknown exception reading band";
+			hndl->prefetchBs.reset();
+		}
+	}
+	cpsm_conhdl_t* hndl;
+};
+
+void cpsm_conhdl_t::startPrefetch()
+{
+	idbassert(prefetchThread == 0);
+	if (exeMgr->getClient() == 0)
+		return;
+	prefetchStop = false;
+	prefetchErr.clear();
+	prefetchBs.reset();
+	prefetchThread = new boost::thread(BandReader(this));
+}
+
+void cpsm_conhdl_t::finishPrefetch(ByteStream& bs)
+{
+	idbassert(prefetchThread != 0);
+	prefetchThread->join();
+	delete prefetchThread;
+	prefetchThread = 0;
+
+	if (!prefetchErr.empty())
+	{
+		// same recovery ClientRotator::read() does for the inline read
+		exeMgr->resetClient();
+		string errmsg = "ClientRotator caught exception: " + prefetchErr;
+		prefetchErr.clear();
+		throw runtime_error(errmsg);
+	}
+
+	if (prefetchBs)
+		bs.swap(*prefetchBs);
+	else
+		bs.restart();
+	prefetchBs.reset();
+}
+
+void cpsm_conhdl_t::stopPrefetch()
+{
+	if (prefetchThread == 0)
+		return;
+	prefetchStop = true;
+	prefetchThread->join();
+	delete prefetchThread;
+	prefetchThread = 0;
+	prefetchBs.reset();
+	prefetchErr.clear();
+}
+
 void cpsm_conhdl_t::write(ByteStream bs)
 {
 #ifdef _MSC_VER
@@ -31,6 +31,8 @@
 #include <sys/time.h>
 #include <iostream>
 
+#include <boost/thread.hpp>
+
 #include "calpontsystemcatalog.h"
 #include "clientrotator.h"
 #include "rowgroup.h"
@@ -190,7 +192,8 @@ public:
 	cpsm_conhdl_t(time_t v, const uint32_t sid, bool infinidb_local_query) :
 	value(v), sessionID(sid), queryState (NO_QUERY),
 	exeMgr( new execplan::ClientRotator(sid, "ExeMgr", infinidb_local_query)),
-	tblinfo_idx(0), idxinfo_idx(0), curFetchTb (0)
+	tblinfo_idx(0), idxinfo_idx(0), curFetchTb (0), bandPrefetch(true),
+	prefetchThread(0), prefetchStop(false)
 	{ }
 
 
@@ -205,8 +208,32 @@ public:
 	EXPORT void write(messageqcpp::ByteStream bs);
 
 	~cpsm_conhdl_t() {
+			stopPrefetch();
 			delete exeMgr;
 	}
+
+/** @brief start reading the next band in the background
+ *
+ * Only called after a non-empty band has been received, so ExeMgr is
+ * guaranteed to send at least one more message (the next band or the
+ * empty end-of-result band).
+ */
+	EXPORT void startPrefetch();
+
+/** @brief wait for the band being prefetched and hand it to the caller
+ *
+ * Throws if the reader thread caught an exception. Returns an empty
+ * ByteStream if the connection was lost.
+ */
+	EXPORT void finishPrefetch(messageqcpp::ByteStream& bs);
+
+/** @brief abandon an outstanding prefetch. Must be done before the
+ *  connection is used for anything else or torn down.
+ */
+	EXPORT void stopPrefetch();
+
+	bool prefetching() const { return prefetchThread != 0; }
+
 	EXPORT const std::string toString() const;
 	time_t value;
 	uint32_t sessionID;
@@ -229,7 +256,13 @@ public:
 	std::string queryStats;
 	std::string extendedStats;
 	std::string miniStats;
+	bool bandPrefetch;	// overlap socket reads with row conversion
 private:
+	friend struct BandReader;
+	boost::thread* prefetchThread;
+	messageqcpp::SBS prefetchBs;
+	std::string prefetchErr;
+	volatile bool prefetchStop;
 };
 std::ostream& operator<<(std::ostream& output, const cpsm_conhdl_t& rhs);
 
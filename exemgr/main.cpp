@@ -92,6 +92,8 @@ using namespace querytele;
 
 #include "activestatementcounter.h"
 #include "femsghandler.h"
+#include "resultcache.h"
+#include "metrics.h"
 
 #include "utils_utf8.h"
 #include "boost/filesystem.hpp"
@@ -137,6 +139,8 @@ DistributedEngineComm *ec;
 
 ResourceManager rm(true);
 
+ResultCache* resultCache;
+
 int toInt(const string& val)
 {
 	if (val.length() == 0) return -1;
@@ -243,6 +247,7 @@ public:
 		fIos(ios), fEc(ec),
 		fRm(rm),
 		fStatsRetrieved(false),
+		fJobListUs(0),
 		fTeleClient(gTeleServerParms),
 		fOamCachePtr(oam::OamCache::makeOamCache())
 	{
@@ -257,6 +262,7 @@ private:
 
 	// Variables used to store return stats
 	bool       fStatsRetrieved;
+	int64_t    fJobListUs;		// time spent building the joblist
 
 	QueryTeleClient fTeleClient;
 
@@ -272,6 +278,7 @@ private:
 		fStats.fSessionID = sessionId;
 		fStats.fQuery = sqlText;
 		fStatsRetrieved  = false;
+		fJobListUs = 0;
 	}
 
 	//...Get % memory usage during latest query for sesssionId.
@@ -360,7 +367,8 @@ private:
 		os << "PartitionBlocksEliminated-" << fStats.fCPBlocksSkipped <<
 			"; MsgBytesIn-"    << roundBytes(fStats.fMsgBytesIn) <<
 			"; MsgBytesOut-"   << roundBytes(fStats.fMsgBytesOut) <<
-			"; Mode-"          << queryMode;
+			"; Mode-"          << queryMode <<
+			"; JobListStartup-" << (fJobListUs / 1000.0) << "ms";
 
 		return os.str();
 	}
@@ -517,6 +525,13 @@ public:
 		bool usingTuples = false;
 		bool stmtCounted = false;
 
+		// result cache state for the current statement
+		ResultCache::EntryPtr cached;		// serving from this entry
+		ResultCache::EntryPtr recording;	// recording the result into this entry
+		uint32_t cachedBand = 0;
+		string cacheKey;
+		vector<CalpontSystemCatalog::OID> cacheOids;
+
 		try
 		{
 			for (;;)
@@ -576,6 +591,9 @@ public:
 				}
 new_plan:
 				csep.unserialize(bs);
+				cached.reset();
+				recording.reset();
+				cachedBand = 0;
 
 				QueryTeleStats qts;
 				if ( !csep.isInternal() &&
@@ -654,15 +672,56 @@ new_plan:
 
 				statementsRunningCount->incr(stmtCounted);
 
-				if (tryTuples)
+				if (tryTuples && resultCache->enabled() &&
+					!(csep.traceFlags() & flagsWantOutput) &&
+					resultCache->cacheable(csep, cacheKey, cacheOids))
+				{
+					cached = resultCache->lookup(cacheKey);
+					// only record results that can't include anyone's uncommitted changes
+					if (!cached)
+						recording = resultCache->startEntry(cacheKey, cacheOids, csep.verID());
+				}
+
+				if (tryTuples && cached)
+				{
+					try // @bug2244: try/catch around fIos.write() calls
+					{
+						// Same handshake as below, with the rowgroup from the cache.
+						// There is no joblist, and nothing was read.
+						usingTuples = true;
+						fStatsRetrieved = true;
+						ByteStream tbs;
+						tbs << (ByteStream::quadbyte)0;
+						fIos.write(tbs);
+						tbs.restart();
+						tbs << string("NOERROR");
+						fIos.write(tbs);
+						fIos.write(cached->rowGroup);
+					}
+					catch (std::exception& ex)
+					{
+						ostringstream errMsg;
+						errMsg << "ExeMgr: error writing cached result "
+							"response; " <<  ex.what();
+						throw runtime_error( errMsg.str() );
+					}
+					if (gDebug)
+						cout << "### Serving session id " << csep.sessionID() << " from the result cache" << endl;
+				}
+				else if (tryTuples)
 				{
 					try // @bug2244: try/catch around fIos.write() calls responding to makeTupleList
 					{
 						string emsg("NOERROR");
 						ByteStream emsgBs;
 						ByteStream::quadbyte tflg = 0;
+						struct timeval jlStart, jlEnd;
+						gettimeofday(&jlStart, 0);
 						jl = JobListFactory::makeJobList(
 								&csep, fRm, true, true);
+						gettimeofday(&jlEnd, 0);
+						fJobListUs = (int64_t)(jlEnd.tv_sec - jlStart.tv_sec) * 1000000 +
+							(jlEnd.tv_usec - jlStart.tv_usec);
 						// assign query stats
 						jl->queryStats(fStats);
 
@@ -683,6 +742,8 @@ new_plan:
 							tbs.restart();
 							tbs << tjlp->getOutputRowGroup();
 							fIos.write(tbs);
+							if (recording)
+								recording->rowGroup = tbs;
 						}
 						else
 						{
@@ -741,7 +802,8 @@ new_plan:
 				}
 
 
-				jl->doQuery();
+				if (jl)
+					jl->doQuery();
 
 				CalpontSystemCatalog::OID tableOID;
 				bool swallowRows = false;
@@ -791,7 +853,10 @@ new_plan:
 							// super-secret flag indicating that the UM is going to scarf down all the rows in the
 							//   query.
 							swallowRows = true;
-							tm = jl->deliveredTables();
+							if (jl)
+								tm = jl->deliveredTables();
+							else
+								tm[100] = SJSTEP();
 							continue;
 						}
 						else if (qb == 2)
@@ -824,6 +889,11 @@ new_plan:
 								totalRowCount
 								);
 
+							// with tracing on, calgetstats() also shows the operator profile tree
+							if ((csep.traceFlags() & CalpontSelectExecutionPlan::TRACE_LOG) != 0 &&
+								!jl->profileInfo().empty())
+								statsString += "\nOperator Profile:\n" + jl->profileInfo();
+
 							bs.restart();
 							bs << statsString;
 							if ((csep.traceFlags() & CalpontSelectExecutionPlan::TRACE_LOG) != 0)
@@ -875,7 +945,7 @@ new_plan:
 					if (swallowRows) tm.erase(tableOID);
 
 					FEMsgHandler msgHandler(jl, &fIos);
-					if (tableOID == 100)
+					if (tableOID == 100 && jl)
 						msgHandler.start();
 
 					//...Loop serializing table bands projected for the tableOID
@@ -883,18 +953,38 @@ new_plan:
 					{
 						uint32_t rowCount;
 
-						rowCount = jl->projectTable(tableOID, bs);
+						if (cached)
+						{
+							// replay the bands exactly as they were first sent
+							if (cachedBand < cached->bands.size())
+							{
+								bs = cached->bands[cachedBand].bs;
+								rowCount = cached->bands[cachedBand].rowCount;
+								cachedBand++;
+							}
+							else
+							{
+								bs.restart();
+								rowCount = 0;
+							}
+						}
+						else
+							rowCount = jl->projectTable(tableOID, bs);
 
 						msgHandler.stop();
-						if (jl->status()) {
+						if (jl && jl->status()) {
 							IDBErrorInfo* errInfo = IDBErrorInfo::instance();
 
 							if (jl->errMsg().length() != 0)
 								bs << jl->errMsg();
 							else
 								bs << errInfo->errorMsg(jl->status());
+							recording.reset();
 						}
 
+						if (recording && !resultCache->addBand(recording, bs, rowCount))
+							recording.reset();
+
 						try // @bug2244: try/catch around fIos.write() calls projecting rows
 						{
 							if (csep.traceFlags() & CalpontSelectExecutionPlan::TRACE_NO_ROWS3)
@@ -918,9 +1008,12 @@ new_plan:
 								"; rowCnt: " << rowCount <<
 								"; prevTotRowCnt: " << totalRowCount <<
 								"; " << ex.what();
-							jl->abort();
-							while (rowCount)
-								rowCount = jl->projectTable(tableOID, bs);
+							if (jl)
+							{
+								jl->abort();
+								while (rowCount)
+									rowCount = jl->projectTable(tableOID, bs);
+							}
 							if (tableOID == 100 && msgHandler.aborted()) {
 								/* TODO: modularize the cleanup code, as well as
 								 * the rest of this fcn */
@@ -941,9 +1034,12 @@ new_plan:
 								"for tableOID: " <<
 								tableOID << "; rowCnt: " << rowCount <<
 								"; prevTotRowCnt: " << totalRowCount;
-							jl->abort();
-							while (rowCount)
-								rowCount = jl->projectTable(tableOID, bs);
+							if (jl)
+							{
+								jl->abort();
+								while (rowCount)
+									rowCount = jl->projectTable(tableOID, bs);
+							}
 							throw runtime_error( errMsg.str() );
 						}
 						totalRowCount += rowCount;
@@ -954,6 +1050,13 @@ new_plan:
 							msgHandler.stop();
 							// No more bands, table is done
 							bs.reset();
+							if (recording)
+							{
+								resultCache->insert(recording);
+								recording.reset();
+							}
+							if (cached)
+								fStats.fRows = totalRowCount;
 							// @bug 2083 decr active statement count here for table mode.
 							if (!usingTuples)
 								statementsRunningCount->decr(stmtCounted);
@@ -967,7 +1070,7 @@ new_plan:
 				} // End of loop to process tables
 
 				// @bug 828
-				if (csep.traceOn())
+				if (csep.traceOn() && jl)
 					jl->graph(csep.sessionID());
 
 				if (needDbProfEndStatementMsg)
@@ -1205,6 +1308,8 @@ void printTotalUmMemory(int sig)
 {
     int64_t num = rm.availableMemory();
     cout << "Total UM memory available: " << num << endl;
+    if (resultCache && resultCache->enabled())
+        resultCache->printStats(cout);
 }
 
 void setupSignalHandlers()
@@ -1343,6 +1448,8 @@ int main(int argc, char* argv[])
 
 	setupCwd(rm);
 
+	utils::Metrics::instance()->startDumper("ExeMgr");
+
 	cleanTempDir();
 
 	MsgMap msgMap;
@@ -1364,6 +1471,8 @@ int main(int argc, char* argv[])
 	MessageQueueServer* mqs;
 
 	statementsRunningCount = new ActiveStatementCounter(rm.getEmExecQueueSize());
+	resultCache = new ResultCache(rm.getEmResultCacheMaxMemory());
+	CalpontSystemCatalog::shareSessionCaches(rm.getEmShareCatalogCache());
 	for (;;)
 	{
 		try {
@@ -0,0 +1,365 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <iostream>
+#include <set>
+using namespace std;
+
+#include <boost/thread/mutex.hpp>
+#include <boost/uuid/nil_generator.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+using namespace boost;
+
+#include "calpontselectexecutionplan.h"
+#include "calpontsystemcatalog.h"
+#include "parsetree.h"
+#include "simplecolumn.h"
+#include "selectfilter.h"
+#include "existsfilter.h"
+#include "simplescalarfilter.h"
+using namespace execplan;
+
+#include "dbrm.h"
+using namespace BRM;
+
+using namespace messageqcpp;
+
+#include "resultcache.h"
+
+namespace
+{
+
+// SQL functions whose result depends on when or by whom the query runs.
+// A query mentioning any of these is never cached.
+const char* volatileFuncs[] =
+{
+	"now(", "sysdate(", "curdate(", "curtime(", "current_date", "current_time",
+	"current_timestamp", "localtime", "utc_date", "utc_time", "unix_timestamp(",
+	"rand(", "uuid(", "connection_id(", "user(", "last_insert_id(", "idbpm(",
+	"idbdbroot(", "idbextentid(", "idbsegment(", "idblocalpm(", 0
+};
+
+struct ScrubState
+{
+	set<CalpontSystemCatalog::TableName> tables;
+	set<CalpontSystemCatalog::OID> columns;
+	bool ok;
+};
+
+void scrubPlan(CalpontSelectExecutionPlan* csep, ScrubState& state);
+
+void scrubFilter(ParseTree* n, void* obj)
+{
+	ScrubState* state = reinterpret_cast<ScrubState*>(obj);
+	TreeNode* tn = n->data();
+	CalpontSelectExecutionPlan* sub = 0;
+
+	if (SelectFilter* sf = dynamic_cast<SelectFilter*>(tn))
+		sub = sf->sub().get();
+	else if (ExistsFilter* ef = dynamic_cast<ExistsFilter*>(tn))
+		sub = ef->sub().get();
+	else if (SimpleScalarFilter* ssf = dynamic_cast<SimpleScalarFilter*>(tn))
+		sub = ssf->sub().get();
+
+	if (sub)
+		scrubPlan(sub, *state);
+}
+
+void scrubList(const CalpontSelectExecutionPlan::SelectList& l, ScrubState& state)
+{
+	for (uint32_t i = 0; i < l.size(); i++)
+		scrubPlan(dynamic_cast<CalpontSelectExecutionPlan*>(l[i].get()), state);
+}
+
+// Clear everything in the plan that differs between two executions of the
+// same statement, and collect the tables it reads.
+void scrubPlan(CalpontSelectExecutionPlan* csep, ScrubState& state)
+{
+	if (!csep)
+		return;
+
+	csep->sessionID(0);
+	csep->txnID(0);
+	csep->verID(BRM::QueryContext());
+	csep->statementID(0);
+	csep->uuid(boost::uuids::nil_uuid());
+
+	CalpontSelectExecutionPlan::RMParmVec parms = csep->rmParms();
+	for (uint32_t i = 0; i < parms.size(); i++)
+		parms[i].sessionId = 0;
+	csep->rmParms(parms);
+
+	const CalpontSelectExecutionPlan::TableList& tl = csep->tableList();
+	for (uint32_t i = 0; i < tl.size(); i++)
+	{
+		// cross engine tables are outside the extent map
+		if (!tl[i].fIsInfiniDB)
+			state.ok = false;
+		// an empty schema is a derived table, picked up below
+		else if (!tl[i].schema.empty())
+			state.tables.insert(CalpontSystemCatalog::TableName(tl[i]));
+	}
+
+	// columns of derived tables have no OID, their own plans have the real ones
+	const CalpontSelectExecutionPlan::ColumnMap& cm = csep->columnMap();
+	CalpontSelectExecutionPlan::ColumnMap::const_iterator c;
+	for (c = cm.begin(); c != cm.end(); ++c)
+	{
+		const SimpleColumn* sc = dynamic_cast<const SimpleColumn*>(c->second.get());
+		if (sc && sc->oid() > 0 && !sc->schemaName().empty())
+			state.columns.insert(sc->oid());
+	}
+
+	if (csep->filters())
+		csep->filters()->walk(scrubFilter, &state);
+	if (csep->having())
+		csep->having()->walk(scrubFilter, &state);
+
+	scrubList(csep->subSelects(), state);
+	scrubList(csep->unionVec(), state);
+	scrubList(csep->derivedTableList(), state);
+}
+
+inline void fnv(uint64_t& h, uint64_t v)
+{
+	for (int i = 0; i < 8; i++, v >>= 8)
+	{
+		h ^= (v & 0xff);
+		h *= 0x100000001b3ULL;
+	}
+}
+
+const uint64_t fnvBasis = 0xcbf29ce484222325ULL;
+
+}
+
+uint64_t ResultCache::columnHash(CalpontSystemCatalog::OID oid)
+{
+	DBRM dbrm;
+	vector<EMEntry> entries;
+	uint64_t h = fnvBasis;
+
+	if (dbrm.getExtents(oid, entries, false, false, true) != 0)
+		return 0;
+
+	fnv(h, oid);
+	fnv(h, entries.size());
+	for (uint32_t j = 0; j < entries.size(); j++)
+	{
+		const EMEntry& e = entries[j];
+		fnv(h, e.range.start);
+		fnv(h, e.HWM);
+		fnv(h, ((uint64_t)e.partitionNum << 32) | ((uint64_t)e.segmentNum << 16) | e.dbRoot);
+		fnv(h, ((uint64_t)(uint16_t)e.status << 32) | (uint32_t)e.partition.cprange.sequenceNum);
+		fnv(h, e.partition.cprange.isValid);
+	}
+	return (h == 0 ? 1 : h);
+}
+
+ResultCache::ResultCache(uint64_t maxMemory) :
+	fMaxMemory(maxMemory),
+	fMaxEntrySize(maxMemory / 4),
+	fCurMemory(0),
+	fHits(0),
+	fMisses(0),
+	fInvalidations(0),
+	fEvictions(0),
+	fInserts(0)
+{
+}
+
+bool ResultCache::cacheable(const CalpontSelectExecutionPlan& csep, string& key,
+	vector<CalpontSystemCatalog::OID>& oids)
+{
+	if (!enabled() || csep.isInternal() || csep.queryType() != "SELECT")
+		return false;
+
+	string sql = boost::algorithm::to_lower_copy(csep.data());
+	for (int i = 0; volatileFuncs[i]; i++)
+		if (sql.find(volatileFuncs[i]) != string::npos)
+			return false;
+
+	// Work on a copy. The serialized form of the scrubbed plan is the key.
+	CalpontSelectExecutionPlan copy;
+	ByteStream bs;
+	csep.serialize(bs);
+	copy.unserialize(bs);
+
+	ScrubState state;
+	state.ok = true;
+	scrubPlan(&copy, state);
+	if (!state.ok || state.tables.empty())
+		return false;
+
+	bs.restart();
+	copy.serialize(bs);
+	key.assign((const char*)bs.buf(), bs.length());
+
+	// the columns the plan reads of each table, all of them if it reads none
+	oids.clear();
+	boost::shared_ptr<CalpontSystemCatalog> csc =
+		CalpontSystemCatalog::makeCalpontSystemCatalog(csep.sessionID());
+	set<CalpontSystemCatalog::TableName>::const_iterator it;
+	for (it = state.tables.begin(); it != state.tables.end(); ++it)
+	{
+		CalpontSystemCatalog::RIDList rids = csc->columnRIDs(*it, true);
+		size_t first = oids.size();
+		for (uint32_t i = 0; i < rids.size(); i++)
+			if (state.columns.count(rids[i].objnum))
+				oids.push_back(rids[i].objnum);
+		if (oids.size() == first)
+			for (uint32_t i = 0; i < rids.size(); i++)
+				oids.push_back(rids[i].objnum);
+	}
+
+	return !oids.empty();
+}
+
+bool ResultCache::quiescent(CalpontSystemCatalog::SCN scn)
+{
+	DBRM dbrm;
+	QueryContext now = dbrm.verID();
+	return (now.currentTxns->empty() && now.currentScn == scn);
+}
+
+ResultCache::EntryPtr ResultCache::lookup(const string& key)
+{
+	EntryPtr e;
+	{
+		mutex::scoped_lock lk(fMutex);
+		Index_t::iterator it = fIndex.find(key);
+		if (it == fIndex.end())
+		{
+			fMisses++;
+			return EntryPtr();
+		}
+		e = *it->second;
+	}
+
+	// talk to BRM without holding the lock
+	bool valid = true;
+	for (uint32_t i = 0; valid && i < e->oids.size(); i++)
+		valid = (columnHash(e->oids[i]) == e->hashes[i]);
+
+	mutex::scoped_lock lk(fMutex);
+	Index_t::iterator it = fIndex.find(key);
+	if (!valid)
+	{
+		if (it != fIndex.end() && *it->second == e)
+			remove(it);
+		fInvalidations++;
+		fMisses++;
+		return EntryPtr();
+	}
+
+	if (it != fIndex.end() && *it->second == e)
+		fLRU.splice(fLRU.begin(), fLRU, it->second);
+	fHits++;
+	return e;
+}
+
+ResultCache::EntryPtr ResultCache::startEntry(const string& key,
+	const vector<CalpontSystemCatalog::OID>& oids, const QueryContext& verID)
+{
+	if (!enabled() || !verID.currentTxns->empty())
+		return EntryPtr();
+
+	vector<uint64_t> hashes;
+	for (uint32_t i = 0; i < oids.size(); i++)
+	{
+		hashes.push_back(columnHash(oids[i]));
+		if (hashes.back() == 0)
+			return EntryPtr();
+	}
+
+	// Checked after the hashes: a transaction that started after the
+	// snapshot, whether or not it has committed, shows up here.
+	if (!quiescent(verID.currentScn))
+		return EntryPtr();
+
+	EntryPtr e(new Entry());
+	e->key = key;
+	e->oids = oids;
+	e->hashes = hashes;
+	e->scn = verID.currentScn;
+	e->bytes = key.length();
+	return e;
+}
+
+bool ResultCache::addBand(EntryPtr& e, const ByteStream& bs, uint32_t rowCount)
+{
+	if (!e)
+		return false;
+
+	e->bytes += bs.length();
+	if (e->bytes > fMaxEntrySize)
+	{
+		e.reset();
+		return false;
+	}
+
+	e->bands.push_back(Band());
+	e->bands.back().bs = bs;
+	e->bands.back().rowCount = rowCount;
+	return true;
+}
+
+void ResultCache::insert(EntryPtr& e)
+{
+	if (!e)
+		return;
+
+	e->bytes += e->rowGroup.length();
+	if (e->bytes > fMaxEntrySize || !quiescent(e->scn))
+		return;
+
+	mutex::scoped_lock lk(fMutex);
+	Index_t::iterator it = fIndex.find(e->key);
+	if (it != fIndex.end())
+		remove(it);
+
+	while (!fLRU.empty() && fCurMemory + e->bytes > fMaxMemory)
+	{
+		remove(fIndex.find(fLRU.back()->key));
+		fEvictions++;
+	}
+
+	fLRU.push_front(e);
+	fIndex[e->key] = fLRU.begin();
+	fCurMemory += e->bytes;
+	fInserts++;
+}
+
+void ResultCache::remove(Index_t::iterator it)
+{
+	fCurMemory -= (*it->second)->bytes;
+	fLRU.erase(it->second);
+	fIndex.erase(it);
+}
+
+void ResultCache::printStats(ostream& os)
+{
+	mutex::scoped_lock lk(fMutex);
+	os << "Result cache: entries-" << fLRU.size() <<
+		"; bytes-" << fCurMemory << "/" << fMaxMemory <<
+		"; hits-" << fHits <<
+		"; misses-" << fMisses <<
+		"; invalidations-" << fInvalidations <<
+		"; evictions-" << fEvictions <<
+		"; inserts-" << fInserts << endl;
+}
+// vim:ts=4 sw=4:
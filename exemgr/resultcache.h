@@ -0,0 +1,146 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef RESULTCACHE_H_
+#define RESULTCACHE_H_
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <iosfwd>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "bytestream.h"
+#include "calpontselectexecutionplan.h"
+#include "calpontsystemcatalog.h"
+
+/** @brief opt-in cache of complete tuple-mode result sets
+ *
+ * Entries are keyed by a canonical serialization of the CSEP with all of the
+ * per-statement fields (session, txn, SCN, statement id, uuid) cleared, so the
+ * same SQL from any session maps to the same entry. Each entry carries a hash
+ * of the extent map state of every column the plan reads, or of every column
+ * of a table it reads none of (count(*)). cpimport moves HWMs and adds
+ * extents, DML marks the touched extents' casual partition info invalid, DDL
+ * adds/drops OIDs; all of those change a hash, so a stale entry is never
+ * served.
+ *
+ * A result is only recorded while BRM is quiescent: no active transactions,
+ * and the current SCN still the query's snapshot SCN, both when the
+ * fingerprint is taken and when the entry is published. Otherwise a
+ * transaction could change a column after the snapshot but before the
+ * fingerprint, and the entry would outlive its data.
+ *
+ * cpimport doesn't move the SCN, so every lookup re-reads the columns, and
+ * stops at the first one that changed.
+ *
+ * Memory is bounded by ExeMgr1/ResultCacheMaxMemory; 0 (the default) turns
+ * the cache off.
+ */
+class ResultCache
+{
+public:
+	/** @brief one table band as it was sent to the FE */
+	struct Band
+	{
+		messageqcpp::ByteStream bs;
+		uint32_t rowCount;
+	};
+
+	/** @brief a complete result: the output rowgroup header plus all bands */
+	struct Entry
+	{
+		Entry() : bytes(0) { }
+		std::string key;
+		execplan::CalpontSystemCatalog::SCN scn;
+		std::vector<execplan::CalpontSystemCatalog::OID> oids;
+		std::vector<uint64_t> hashes;		// extent hash of each of oids
+		messageqcpp::ByteStream rowGroup;
+		std::vector<Band> bands;
+		uint64_t bytes;
+	};
+	typedef boost::shared_ptr<Entry> EntryPtr;
+
+	explicit ResultCache(uint64_t maxMemory);
+
+	bool enabled() const { return fMaxMemory > 0; }
+
+	/** @brief true if this plan may be cached. Fills in the key and the
+	 *  column OIDs an entry's validity is checked against.
+	 */
+	bool cacheable(const execplan::CalpontSelectExecutionPlan& csep,
+		std::string& key, std::vector<execplan::CalpontSystemCatalog::OID>& oids);
+
+	/** @brief extent map hash of one column; 0 if BRM couldn't say */
+	static uint64_t columnHash(execplan::CalpontSystemCatalog::OID oid);
+
+	/** @brief true if no transaction is active and none has started since scn */
+	static bool quiescent(execplan::CalpontSystemCatalog::SCN scn);
+
+	/** @brief returns the entry for key if it is still valid; drops it otherwise */
+	EntryPtr lookup(const std::string& key);
+
+	/** @brief begins recording a result of a query run at verID. Returns
+	 *  null if BRM isn't quiescent at that snapshot.
+	 */
+	EntryPtr startEntry(const std::string& key,
+		const std::vector<execplan::CalpontSystemCatalog::OID>& oids,
+		const BRM::QueryContext& verID);
+
+	/** @brief add a band to an entry being recorded. Returns false once the
+	 *  entry gets too big to keep, at which point the caller should stop recording.
+	 */
+	bool addBand(EntryPtr& e, const messageqcpp::ByteStream& bs, uint32_t rowCount);
+
+	/** @brief publish a completely recorded entry, unless a transaction
+	 *  started while it was being recorded
+	 */
+	void insert(EntryPtr& e);
+
+	void printStats(std::ostream& os);
+
+private:
+	ResultCache(const ResultCache&);
+	ResultCache& operator=(const ResultCache&);
+
+	typedef std::list<EntryPtr> LRU_t;
+	typedef std::map<std::string, LRU_t::iterator> Index_t;
+
+	void remove(Index_t::iterator it);
+
+	uint64_t fMaxMemory;
+	uint64_t fMaxEntrySize;
+	uint64_t fCurMemory;
+	LRU_t fLRU;				// most recently used at the front
+	Index_t fIndex;
+	boost::mutex fMutex;
+
+	uint64_t fHits;
+	uint64_t fMisses;
+	uint64_t fInvalidations;
+	uint64_t fEvictions;
+	uint64_t fInserts;
+};
+
+#endif /* RESULTCACHE_H_ */
+// vim:ts=4 sw=4:
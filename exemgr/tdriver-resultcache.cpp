@@ -0,0 +1,148 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file
+ * ResultCache tests against a running system: entries have to go when
+ * cpimport appends to a table they read.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+using namespace std;
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "calpontselectexecutionplan.h"
+#include "simplecolumn.h"
+using namespace execplan;
+
+#include "dbrm.h"
+#include "installdir.h"
+#include "resultcache.h"
+
+namespace
+{
+
+const string schema = "rctest";
+const string table = "rc1";
+
+int sql(const string& stmt)
+{
+	string installDir = startup::StartUp::installDir();
+	string cmd = installDir + "/mysql/bin/mysql --defaults-file=" + installDir +
+		"/mysql/my.cnf -u root -e \"" + stmt + "\" > /dev/null 2>&1";
+	return system(cmd.c_str());
+}
+
+// appends rows rows to the table with cpimport
+int load(int rows)
+{
+	string file = "/tmp/" + schema + "_" + table + ".tbl";
+	ofstream out(file.c_str());
+	for (int i = 0; i < rows; i++)
+		out << i << "|" << i * 1000LL << "|row " << i << endl;
+	out.close();
+
+	string cmd = startup::StartUp::installDir() + "/bin/cpimport " + schema + " " + table +
+		" " + file + " > /dev/null 2>&1";
+	return system(cmd.c_str());
+}
+
+// a narrow column and a wide one, the query reads only the narrow one
+void makeTable()
+{
+	sql("create database if not exists " + schema);
+	sql("drop table if exists " + schema + "." + table);
+	CPPUNIT_ASSERT(sql("create table " + schema + "." + table +
+		" (a int, b bigint, c char(40)) engine=infinidb") == 0);
+	CPPUNIT_ASSERT(load(10000) == 0);
+}
+
+// select a from rctest.rc1
+CalpontSelectExecutionPlan plan()
+{
+	CalpontSelectExecutionPlan csep;
+	CalpontSelectExecutionPlan::ReturnedColumnList cols;
+	CalpontSelectExecutionPlan::ColumnMap colMap;
+	CalpontSelectExecutionPlan::TableList tables;
+
+	SRCP a(new SimpleColumn(schema, table, "a"));
+	cols.push_back(a);
+	colMap.insert(CalpontSelectExecutionPlan::ColumnMap::value_type("a", a));
+	tables.push_back(make_aliastable(schema, table, table));
+
+	csep.returnedCols(cols);
+	csep.columnMapNonStatic(colMap);
+	csep.tableList(tables);
+	csep.data("select a from " + schema + "." + table);
+	return csep;
+}
+
+}
+
+class ResultCacheTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(ResultCacheTest);
+
+CPPUNIT_TEST(resultcache_append_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+public:
+	/* cpimport doesn't move the SCN, the columns the query reads tell */
+	void resultcache_append_1() {
+		ResultCache rc(64 * 1024 * 1024);
+		ResultCache::EntryPtr e;
+		vector<CalpontSystemCatalog::OID> oids;
+		messageqcpp::ByteStream band;
+		string key;
+		BRM::DBRM dbrm;
+
+		makeTable();
+		CPPUNIT_ASSERT(rc.cacheable(plan(), key, oids));
+		CPPUNIT_ASSERT(oids.size() == 1);
+
+		e = rc.startEntry(key, oids, dbrm.verID());
+		CPPUNIT_ASSERT(e);
+		band << (uint32_t) 10000;
+		CPPUNIT_ASSERT(rc.addBand(e, band, 10000));
+		rc.insert(e);
+		CPPUNIT_ASSERT(rc.lookup(key) == e);
+
+		CPPUNIT_ASSERT(load(10000) == 0);
+		CPPUNIT_ASSERT(!rc.lookup(key));
+		CPPUNIT_ASSERT(!rc.lookup(key));
+
+		sql("drop table " + schema + "." + table);
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( ResultCacheTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
@@ -40,9 +40,10 @@ BlockRequestProcessor::BlockRequestProcessor(uint32_t numBlcks,
 		int thrCount,
 		int blocksPerRead,
 		uint32_t deleteBlocks,
-		uint32_t blckSz) :
+		uint32_t blckSz,
+		int numaNode) :
 	fbMgr(numBlcks, blckSz, deleteBlocks),
-	fIOMgr(fbMgr, fBRPRequestQueue, thrCount, blocksPerRead)
+	fIOMgr(fbMgr, fBRPRequestQueue, thrCount, blocksPerRead, numaNode)
 {
 	//pthread_mutex_init(&check_mutex, NULL);
 	config::Config* fConfig=config::Config::makeConfig();
@@ -54,7 +54,7 @@ public:
 	 * @brief default ctor
 	 **/
     BlockRequestProcessor(uint32_t numBlcks, int thrCount, int blocksPerRead, uint32_t deleteBlocks=0,
-		uint32_t blckSz=BLOCK_SIZE);
+		uint32_t blckSz=BLOCK_SIZE, int numaNode=-1);
 
 	/**
 	 * @brief default dtor
@@ -100,6 +100,8 @@ using namespace compress;
 #include "IDBDataFile.h"
 #include "IDBPolicy.h"
 #include "IDBLogger.h"
+#include "metrics.h"
+#include "numatopology.h"
 using namespace idbdatafile;
 
 typedef tr1::unordered_set<BRM::OID_t> USOID;
@@ -789,6 +791,9 @@ void* thr_popper(ioManager *arg) {
 		uint32_t bytesRead=0;
 		uint32_t compressedBytesRead=0; // @Bug 3149.  IOMTrace was not reporting bytesRead correctly for compressed columns.
 		uint32_t jend = blocksRequested/iom->blocksPerRead;
+		uint64_t readStart;
+		static utils::LatencyHistogram *readTime = utils::Metrics::instance()->histogram(
+			"idb_primproc_block_read_usec", "", "Time to read (and decompress) one blocksPerRead unit from disk");
 		if (iom->IOTrace())
 			clock_gettime(CLOCK_REALTIME, &tm);
 		ostringstream errMsg;
@@ -811,6 +816,7 @@ void* thr_popper(ioManager *arg) {
 			int retryReadHeadersCount = 0;
 
 decompRetry:
+			readStart = utils::monotonicUsec();
 			blocksThisRead = std::min(dlen, iom->blocksPerRead);
 			readSize = blocksThisRead * BLOCK_SIZE;
 
@@ -999,6 +1005,7 @@ retryReadHeaders:
 			}
 
 			blocksRead+=blocksThisRead;
+			readTime->record(utils::monotonicUsec() - readStart);
 
 			if (iom->IOTrace())
 				clock_gettime(CLOCK_REALTIME, &tm2);
@@ -1244,10 +1251,12 @@ void purgeFDCache(std::vector<BRM::FileInfo>& files)
 ioManager::ioManager(FileBufferMgr& fbm,
 					 fileBlockRequestQueue& fbrq,
 					 int thrCount,
-					 int bsPerRead):
+					 int bsPerRead,
+					 int numaNode):
 	blocksPerRead(bsPerRead),
 	fIOMfbMgr(fbm),
 	fIOMRequestQueue(fbrq),
+	fNumaNode(numaNode),
 	fFileOp(false)
 {
 	if (thrCount<=0)
@@ -1340,6 +1349,10 @@ struct LambdaKludge {
 	}
 	ioManager *iom;
 	void operator()() {
+		/* The readers fill the cache, so binding them to a node puts the cache's
+		   blocks in that node's memory as well. */
+		if (iom->numaNode() >= 0)
+			utils::NumaTopology::instance()->bindThread(iom->numaNode());
 		thr_popper(iom);
 	}
 };
@@ -52,10 +52,12 @@ class ioManager {
 public:
 	
     ioManager(FileBufferMgr& fbm, fileBlockRequestQueue& fbrq, int thrCount, 
-		int bsPerRead);
+		int bsPerRead, int numaNode = -1);
 	//ioManager(FileBufferMgr& fbm, int thrCount);
 	~ioManager();
 	int readerCount() const {return fThreadCount;}
+	// the NUMA node the reader threads run on, -1 for no binding
+	int numaNode() const {return fNumaNode;}
 	fileRequest* getNextRequest();
 	void go(void);
 	void stop();
@@ -106,6 +108,7 @@ private:
 	FileBufferMgr& fIOMfbMgr;
 	fileBlockRequestQueue& fIOMRequestQueue;
 	int fThreadCount;
+	int fNumaNode;
 	boost::thread_group fThreadArr;
 	void createReaders();
 	config::Config* fConfig;
@@ -155,6 +155,9 @@ bool isLike(const char *val, const idb_regex_t *regex)
 	if (!regex)
 		throw runtime_error("PrimitiveProcessor::isLike: Missing regular expression for LIKE operator");
 
+	if (regex->kind != idb_regex_t::REGEX)
+		return regex->match((const uint8_t *) val, strlen(val));
+
 #ifdef POSIX_REGEX
 	return (regexec(&regex->regex, val, 0, NULL, 0) == 0);
 #else
@@ -507,7 +510,7 @@ inline bool colCompare(int64_t val1, int64_t val2, uint8_t COP, uint8_t rf, int
 
 	else if ( (type == CalpontSystemCatalog::CHAR || type == CalpontSystemCatalog::VARCHAR) && !isNull )
 	{
-		if (!regex.used && !rf)
+		if (!regex.used && regex.kind == idb_regex_t::REGEX && !rf)
 			return colCompare_(order_swap(val1), order_swap(val2), COP);
 		else
 			return colStrCompare_(order_swap(val1), order_swap(val2), COP, rf, &regex);
@@ -20,6 +20,7 @@
  */
 
 #include <iostream>
+#include <cstring>
 #include <boost/scoped_array.hpp>
 #include <sys/types.h>
 using namespace std;
@@ -41,6 +42,30 @@ const int nullStringLen = 0;
 namespace
 {
 const char* signatureNotFound = joblist::CPSTRNOTFOUND.c_str();
+
+// memmem() on top of memchr() and memcmp(), which libc vectorizes
+inline const uint8_t* findSegment(const uint8_t* hay, uint32_t len, const string& seg)
+{
+	uint32_t segLen = seg.length();
+
+	if (segLen == 0)
+		return hay;
+	if (segLen > len)
+		return NULL;
+
+	const uint8_t* last = hay + len - segLen;
+	const uint8_t first = seg[0];
+	while (hay <= last)
+	{
+		hay = (const uint8_t*) memchr(hay, first, last - hay + 1);
+		if (!hay)
+			return NULL;
+		if (memcmp(hay + 1, seg.data() + 1, segLen - 1) == 0)
+			return hay;
+		hay++;
+	}
+	return NULL;
+}
 }
 
 namespace primitives
@@ -558,8 +583,113 @@ inline bool PrimitiveProcessor::isEscapedChar(char c)
 	return ('%' == c || '_' == c);
 }
 
+/* Splits a LIKE pattern into the literal pieces between its '%'s.  Escapes are
+   read the same way convertToRegexp() reads them.  Returns false if the pattern
+   has a '_', which only the regex handles. */
+static bool compileLike(idb_regex_t *regex, const p_DataValue *str)
+{
+	vector<string> segments;
+	string cur;
+	bool anchorStart = true, anchorEnd = true;
+	int i;
+	char c;
+
+	for (i = 0; i < str->len; i++) {
+		c = (char) str->data[i];
+		if (c == '%') {
+			if (i == 0)
+				anchorStart = false;
+			if (i == str->len - 1)
+				anchorEnd = false;
+			if (!cur.empty()) {
+				segments.push_back(cur);
+				cur.clear();
+			}
+		}
+		else if (c == '_')
+			return false;
+		else if (c == backslash && i + 1 < str->len &&
+		  ('%' == str->data[i+1] || '_' == str->data[i+1] || backslash == str->data[i+1]))
+			cur += (char) str->data[++i];
+		else
+			cur += c;
+	}
+	if (!cur.empty() || segments.empty())
+		segments.push_back(cur);
+
+	regex->segments.swap(segments);
+	regex->anchorStart = anchorStart;
+	regex->anchorEnd = anchorEnd;
+	if (regex->segments.size() > 1)
+		regex->kind = idb_regex_t::SEGMENTS;
+	else if (anchorStart && anchorEnd)
+		regex->kind = idb_regex_t::EXACT;
+	else if (anchorStart)
+		regex->kind = idb_regex_t::PREFIX;
+	else if (anchorEnd)
+		regex->kind = idb_regex_t::SUFFIX;
+	else
+		regex->kind = idb_regex_t::CONTAINS;
+	return true;
+}
+
+bool idb_regex_t::match(const uint8_t *data, uint32_t len) const
+{
+	const string &front = segments.front();
+	const string &back = segments.back();
+
+	switch (kind) {
+		case EXACT:
+			return (len == front.length() && memcmp(data, front.data(), len) == 0);
+		case PREFIX:
+			return (len >= front.length() && memcmp(data, front.data(), front.length()) == 0);
+		case SUFFIX:
+			return (len >= back.length() &&
+			  memcmp(data + len - back.length(), back.data(), back.length()) == 0);
+		case CONTAINS:
+			return (findSegment(data, len, front) != NULL);
+		case SEGMENTS:
+			break;
+		default:
+			return false;
+	}
+
+	// the anchored ends first, then the middle pieces left to right, leftmost match each
+	uint32_t pos = 0, end = len;
+	uint32_t first = 0, last = segments.size();
+	const uint8_t *found;
+
+	if (anchorStart) {
+		if (len < front.length() || memcmp(data, front.data(), front.length()) != 0)
+			return false;
+		pos = front.length();
+		first = 1;
+	}
+	if (anchorEnd) {
+		if (end - pos < back.length() ||
+		  memcmp(data + len - back.length(), back.data(), back.length()) != 0)
+			return false;
+		end = len - back.length();
+		last--;
+	}
+	for (uint32_t i = first; i < last; i++) {
+		found = findSegment(data + pos, end - pos, segments[i]);
+		if (!found)
+			return false;
+		pos = (found - data) + segments[i].length();
+	}
+	return true;
+}
+
 //FIXME: copy/pasted to dataconvert.h: refactor
 int PrimitiveProcessor::convertToRegexp(idb_regex_t *regex, const p_DataValue *str)
+{
+	if (compileLike(regex, str))
+		return 0;
+	return likeToRegexp(regex, str);
+}
+
+int PrimitiveProcessor::likeToRegexp(idb_regex_t *regex, const p_DataValue *str)
 {
 	//In the worst case, every char is quadrupled, plus some leading/trailing cruft...
 	char* cBuf = (char*)alloca(((4 * str->len) + 3) * sizeof(char));
@@ -639,6 +769,9 @@ int PrimitiveProcessor::convertToRegexp(idb_regex_t *regex, const p_DataValue *s
 
 bool PrimitiveProcessor::isLike(const p_DataValue *dict, const idb_regex_t *regex) throw()
 {
+	if (regex->kind != idb_regex_t::REGEX)
+		return regex->match(dict->data, dict->len);
+
 #ifdef POSIX_REGEX
 	char cBuf[dict->len + 1];
 	memcpy(cBuf, dict->data, dict->len);
@@ -43,6 +43,8 @@
 #include <boost/regex.hpp>
 #endif
 #include <cstddef>
+#include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/shared_array.hpp>
 
@@ -92,7 +94,20 @@ struct idb_regex_t
 	boost::regex regex;
 #endif
 	bool used;
-	idb_regex_t() : used(false) { }
+
+	/* LIKE patterns without '_' don't need the regex.  They are the literal pieces
+	   between the '%'s, which have to appear in order; the first one at the start
+	   unless the pattern begins with '%', the last one at the end unless it ends
+	   with '%'. */
+	enum Kind { REGEX, EXACT, PREFIX, SUFFIX, CONTAINS, SEGMENTS };
+	Kind kind;
+	std::vector<std::string> segments;
+	bool anchorStart;
+	bool anchorEnd;
+
+	bool match(const uint8_t *data, uint32_t len) const;
+
+	idb_regex_t() : used(false), kind(REGEX), anchorStart(true), anchorEnd(true) { }
 	~idb_regex_t() {
 #ifdef POSIX_REGEX
 		if (used)
@@ -280,6 +295,8 @@ public:
 
 
 	static int convertToRegexp(idb_regex_t *regex, const p_DataValue *str);
+	/* always builds the regex, even where convertToRegexp() wouldn't need one */
+	static int likeToRegexp(idb_regex_t *regex, const p_DataValue *str);
 	inline static bool isEscapedChar(char c);
 	boost::shared_array<idb_regex_t> makeLikeFilter(const DictFilterElement *inputMsg, uint32_t count);
 	void setLikeFilter(boost::shared_array<idb_regex_t> filter) { parsedLikeFilter = filter; }
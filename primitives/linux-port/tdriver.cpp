@@ -158,6 +158,10 @@ CPPUNIT_TEST(p_Dictionary_like_6);	// "%NIT%ING%D%"
 CPPUNIT_TEST(p_Dictionary_like_7);	// "UNI%TES"
 CPPUNIT_TEST(p_Dictionary_like_8);	// "%TH_OP%"
 
+// LIKE patterns without '_' skip the regex; check them against it
+CPPUNIT_TEST(p_Dictionary_like_fastpath_1);
+CPPUNIT_TEST(p_Col_like_char8_1);
+
 // CPPUNIT_TEST(p_Dictionary_like_prefixbench_1);
 // CPPUNIT_TEST(p_Dictionary_like_substrbench_1);
 
@@ -4408,6 +4412,93 @@ void p_Dictionary_like_8()
 	}
 }
 
+void p_Dictionary_like_fastpath_1()
+{
+	PrimitiveProcessor pp;
+	const char *patterns[] = { "", "%", "%%", "a", "abc", "abc%", "%abc", "%abc%",
+		"a%c", "a%b%c", "%a%b%c%", "ab%%cd", "%b%b%", "a\\%c", "%\\%%", "a\\\\b%",
+		"x.y%", "%(a)%", "a\\b", "%c%c" };
+	const char *values[] = { "", "a", "abc", "abcd", "xabc", "xabcx", "ac", "abbc",
+		"aXbXc", "abcdcd", "a%c", "a\\b", "a\\bz", "x.yz", "xzyz", "((a))", "ccc" };
+	const uint32_t patternCount = sizeof(patterns) / sizeof(patterns[0]);
+	const uint32_t valueCount = sizeof(values) / sizeof(values[0]);
+	uint32_t i, j, checked = 0;
+
+	for (i = 0; i < patternCount; i++) {
+		p_DataValue pattern;
+		pattern.len = strlen(patterns[i]);
+		pattern.data = (const uint8_t *) patterns[i];
+
+		idb_regex_t fast, slow;
+		CPPUNIT_ASSERT(PrimitiveProcessor::convertToRegexp(&fast, &pattern) == 0);
+		CPPUNIT_ASSERT(PrimitiveProcessor::likeToRegexp(&slow, &pattern) == 0);
+		CPPUNIT_ASSERT(fast.kind != idb_regex_t::REGEX && !fast.used);
+		CPPUNIT_ASSERT(slow.kind == idb_regex_t::REGEX && slow.used);
+
+		for (j = 0; j < valueCount; j++) {
+			p_DataValue value;
+			value.len = strlen(values[j]);
+			value.data = (const uint8_t *) values[j];
+			if (pp.isLike(&value, &fast) != pp.isLike(&value, &slow))
+				cerr << "p_Dictionary_like_fastpath_1: '" << values[j] << "' LIKE '"
+					<< patterns[i] << "' differs" << endl;
+			CPPUNIT_ASSERT(pp.isLike(&value, &fast) == pp.isLike(&value, &slow));
+			checked++;
+		}
+	}
+	CPPUNIT_ASSERT(checked == 340);
+}
+
+/* CHAR(8) LIKE and NOT LIKE with a pattern that doesn't need the regex */
+void p_Col_like_char8_1()
+{
+	PrimitiveProcessor pp;
+	uint8_t input[BLOCK_SIZE], output[4*BLOCK_SIZE], block[BLOCK_SIZE];
+	NewColRequestHeader *in;
+	NewColResultHeader *out;
+	ColArgs *args;
+	const char *values[] = { "ABC", "XABC", "ABCD", "ZZZ" };
+	uint16_t *results;
+	uint32_t written, i;
+	int cop;
+
+	memset(block, 0, BLOCK_SIZE);
+	for (i = 0; i < BLOCK_SIZE / 8; i++)
+		memcpy(&block[i * 8], values[i % 4], strlen(values[i % 4]));
+
+	for (cop = 0; cop < 2; cop++) {
+		memset(input, 0, BLOCK_SIZE);
+		memset(output, 0, 4*BLOCK_SIZE);
+
+		in = reinterpret_cast<NewColRequestHeader *>(input);
+		out = reinterpret_cast<NewColResultHeader *>(output);
+		args = reinterpret_cast<ColArgs *>(&in[1]);
+
+		in->DataSize = 8;
+		in->DataType = CalpontSystemCatalog::CHAR;
+		in->OutputType = OT_RID;
+		in->NOPS = 1;
+		in->BOP = BOP_NONE;
+		in->NVALS = 0;
+
+		args->COP = (cop == 0 ? COMPARE_LIKE : COMPARE_NLIKE);
+		memcpy(args->val, "ABC%", 4);
+
+		pp.setBlockPtr((int*) block);
+		pp.p_Col(in, out, 4*BLOCK_SIZE, &written);
+
+		results = reinterpret_cast<uint16_t *>(&output[sizeof(NewColResultHeader)]);
+		CPPUNIT_ASSERT(out->NVALS == BLOCK_SIZE / 16);
+		for (i = 0; i < out->NVALS; i++) {
+			uint32_t v = results[i] % 4;
+			if (cop == 0)
+				CPPUNIT_ASSERT(v == 0 || v == 2);
+			else
+				CPPUNIT_ASSERT(v == 1 || v == 3);
+		}
+	}
+}
+
 void p_Dictionary_like_prefixbench_1()
 {
 	PrimitiveProcessor pp;
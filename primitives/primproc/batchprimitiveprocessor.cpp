@@ -51,6 +51,7 @@ using namespace boost;
 #include "fixedallocator.h"
 #include "blockcacheclient.h"
 #include "MonitorProcMem.h"
+#include "profileclock.h"
 
 #define MAX64 0x7fffffffffffffffLL
 #define MIN64 0x8000000000000000LL
@@ -107,10 +108,12 @@ BatchPrimitiveProcessor::BatchPrimitiveProcessor() :
 	prefetchThreshold(0),
 	hasDictStep(false),
 	sockIndex(0),
-	endOfJoinerRan(false)
+	endOfJoinerRan(false),
+	joinTableWait(false)
 {
 	pp.setLogicalBlockMode(true);
 	pp.setBlockPtr((int *) blockData);
+	memset(&profile, 0, sizeof(profile));
 }
 
 BatchPrimitiveProcessor::BatchPrimitiveProcessor(ByteStream &b, double prefetch,
@@ -147,10 +150,12 @@ BatchPrimitiveProcessor::BatchPrimitiveProcessor(ByteStream &b, double prefetch,
 	prefetchThreshold(prefetch),
 	hasDictStep(false),
 	sockIndex(0),
-	endOfJoinerRan(false)
+	endOfJoinerRan(false),
+	joinTableWait(false)
 {
 	pp.setLogicalBlockMode(true);
 	pp.setBlockPtr((int *) blockData);
+	memset(&profile, 0, sizeof(profile));
 	sendThread = bppst;
 	initBPP(b);
 // 	cerr << "made a BPP\n";
@@ -280,6 +285,27 @@ void BatchPrimitiveProcessor::initBPP(ByteStream &bs)
 					tlJoiners[i].reset(new TLJoiner(10, TupleJoiner::hasher()));
 				}
 			}
+
+			joinTableIDs.reset(new uint64_t[joinerCount]);
+			joinTableCached.reset(new bool[joinerCount]);
+			joinTableKeySigs.reset(new uint64_t[joinerCount]);
+			joinTableRows.reset(new uint32_t[joinerCount]);
+			joinTables.reset(new JoinTableCache::SJoinTable[joinerCount]);
+			for (i = 0; i < joinerCount; i++) {
+				bs >> joinTableIDs[i];
+				bs >> tmp8;
+				joinTableCached[i] = (bool) tmp8;
+				bs >> joinTableKeySigs[i];
+				joinTableRows[i] = tJoinerSizes[i];	// before the typeless NULLs come off
+				if (joinTableIDs[i] != 0 && !joinTableCached[i])
+					JoinTableCache::instance()->expect(joinTableIDs[i]);
+			}
+			/* tables the UM no longer wants kept */
+			vector<uint64_t> drops;
+			deserializeVector<uint64_t>(bs, drops);
+			if (!drops.empty())
+				JoinTableCache::instance()->drop(drops);
+
 			if (hasJoinFEFilters) {
 				joinFERG.reset(new RowGroup());
 				bs >> *joinFERG;
@@ -295,7 +321,8 @@ void BatchPrimitiveProcessor::initBPP(ByteStream &bs)
 				ssrdPos.reset(new uint64_t[joinerCount]);
 				for (i = 0; i < joinerCount; i++) {
 					smallSideRowLengths[i] = smallSideRGs[i].getRowSize();;
-					smallSideRowData[i] = RGData(smallSideRGs[i], tJoinerSizes[i]);
+					smallSideRowData[i] = RGData(smallSideRGs[i],
+					  (joinTableCached[i] ? 0 : tJoinerSizes[i]));
 //					smallSideRowData[i].reset(new uint8_t[
 //					  smallSideRGs[i].getEmptySize() +
 //					  (uint64_t) smallSideRowLengths[i] * tJoinerSizes[i]]);
@@ -317,6 +344,7 @@ void BatchPrimitiveProcessor::initBPP(ByteStream &bs)
 				bs >> joinedRG;
 // 				cout << "got the joined Rowgroup: " << joinedRG.toString() << "\n";
 			}
+			getCachedJoinTables(false);
 		}
 		else {
 			bs >> tmp8;
@@ -394,8 +422,8 @@ void BatchPrimitiveProcessor::resetBPP(ByteStream &bs, const SP_UM_MUTEX& w,
 	sock = s;
 	newConnection = true;
 
-	// skip the header, sessionID, stepID, uniqueID, and priority
-	bs.advance(sizeof(ISMPacketHeader) + 16);
+	// skip the header, sessionID, stepID, uniqueID, priority, and cache LBID
+	bs.advance(sizeof(ISMPacketHeader) + 24);
 	bs >> dbRoot;
 	bs >> count;
 	bs >> ridCount;
@@ -531,6 +559,133 @@ void BatchPrimitiveProcessor::addToJoiner(ByteStream &bs)
 	addToJoinerLock.unlock();
 }
 
+void BatchPrimitiveProcessor::getCachedJoinTables(bool final)
+{
+	uint32_t i;
+	JoinTableCache::SJoinTable t;
+	JoinTableCache::Status status;
+
+	joinTableWait = false;
+	for (i = 0; i < joinerCount; i++) {
+		if (joinTableIDs[i] == 0 || !joinTableCached[i] || joinTables[i])
+			continue;
+
+		status = JoinTableCache::instance()->lookup(joinTableIDs[i], &t);
+		if (status == JoinTableCache::PENDING && !final) {
+			joinTableWait = true;
+			continue;
+		}
+		// not the table the UM means
+		if (status == JoinTableCache::FOUND && (t->rows != joinTableRows[i] ||
+		  t->keySignature != joinTableKeySigs[i]))
+			status = JoinTableCache::MISSING;
+		if (status != JoinTableCache::FOUND) {
+			/* Dropped, evicted, or never stored.  Build it like an uncached one from
+			   the small side the UM resends on the JOIN_TABLE_NAK. */
+			joinTableIDs[i] = 0;
+			joinTableCached[i] = false;
+			if (getTupleJoinRowGroupData) {
+				smallSideRowData[i] = RGData(smallSideRGs[i], tJoinerSizes[i]);
+				smallSideRGs[i].setData(&smallSideRowData[i]);
+				smallSideRGs[i].resetRowGroup(0);
+				ssrdPos[i] = smallSideRGs[i].getEmptySize();
+			}
+			joinTableNaks.push_back(i);
+			continue;
+		}
+
+		joinTables[i] = t;
+		if (typelessJoin[i])
+			tlJoiners[i] = t->tlJoiner;
+		else {
+			tJoiners[i] = t->tJoiner;
+			_pools[i] = t->pool;
+		}
+		tJoinerSizes[i] = t->size;
+		doMatchNulls[i] = t->matchNulls;
+		if (getTupleJoinRowGroupData && t->hasRowData) {
+			smallSideRowData[i] = t->rowData;
+			smallSideRGs[i].setData(&smallSideRowData[i]);
+		}
+	}
+}
+
+bool BatchPrimitiveProcessor::storesJoinTables() const
+{
+	if (!doJoin || ot != ROW_GROUP)
+		return false;
+	for (uint32_t i = 0; i < joinerCount; i++)
+		if (joinTableIDs[i] != 0 && !joinTableCached[i])
+			return true;
+	return false;
+}
+
+void BatchPrimitiveProcessor::storeJoinTables()
+{
+	uint32_t i;
+
+	if (!doJoin || ot != ROW_GROUP)
+		return;
+
+	for (i = 0; i < joinerCount; i++) {
+		if (joinTableIDs[i] == 0 || joinTableCached[i])
+			continue;
+
+		JoinTableCache::SJoinTable t(new JoinTable());
+		if (typelessJoin[i]) {
+			t->tlJoiner = tlJoiners[i];
+			t->keyAllocators = storedKeyAllocators;
+		}
+		else {
+			t->tJoiner = tJoiners[i];
+			t->pool = _pools[i];
+		}
+		t->size = tJoinerSizes[i];
+		t->rows = joinTableRows[i];
+		t->keySignature = joinTableKeySigs[i];
+		t->matchNulls = doMatchNulls[i];
+		// hash table nodes and keys, as the UM estimates it
+		t->bytes = (uint64_t) t->size * (48 + (typelessJoin[i] ? tlKeyLengths[i] : 0));
+		if (getTupleJoinRowGroupData) {
+			t->hasRowData = true;
+			t->rowData = smallSideRowData[i];
+			t->bytes += (uint64_t) t->size * smallSideRowLengths[i];
+		}
+		JoinTableCache::instance()->store(joinTableIDs[i], t);
+	}
+}
+
+bool BatchPrimitiveProcessor::joinTableNak(ByteStream &bs)
+{
+	if (joinTableNaks.empty())
+		return false;
+
+	ISMPacketHeader ism;
+	PrimitiveHeader ph;
+
+	memset(&ism, 0, sizeof(ism));
+	memset(&ph, 0, sizeof(ph));
+	ism.Command = JOIN_TABLE_NAK;
+	ph.SessionID = sessionID;
+	ph.StepID = stepID;
+	ph.UniqueID = uniqueID;
+	bs.restart();
+	bs.append((uint8_t *) &ism, sizeof(ism));
+	bs.append((uint8_t *) &ph, sizeof(ph));
+	serializeVector<uint32_t>(bs, joinTableNaks);
+	joinTableNaks.clear();
+	return true;
+}
+
+void BatchPrimitiveProcessor::abandonJoinTables()
+{
+	if (!doJoin || ot != ROW_GROUP)
+		return;
+	for (uint32_t i = 0; i < joinerCount; i++)
+		if (joinTableIDs[i] != 0 && !joinTableCached[i])
+			JoinTableCache::instance()->abandon(joinTableIDs[i]);
+}
+
 int BatchPrimitiveProcessor::endOfJoiner()
 {
 	/* Wait for all joiner elements to be added */
@@ -1000,6 +1155,9 @@ void BatchPrimitiveProcessor::execute()
 #endif
 {
 	uint32_t i, j;
+	uint64_t phaseStart = utils::monotonicUsec();
+	uint64_t cpuStart = utils::threadCpuUsec();
+	uint64_t joinStart, now;
 
 	try
 	{
@@ -1100,6 +1258,11 @@ void BatchPrimitiveProcessor::execute()
 		stopwatch->start("BatchPrimitiveProcessor::execute third part");
 #endif
 
+		now = utils::monotonicUsec();
+		profile.filterTime += now - phaseStart;
+		profile.rowsIn += ridCount;
+		phaseStart = now;
+
 		if (doJoin && ot != ROW_GROUP)
 		{
 #ifdef PRIMPROC_STOPWATCH
@@ -1109,6 +1272,9 @@ void BatchPrimitiveProcessor::execute()
 #else
 			executeJoin();
 #endif
+			now = utils::monotonicUsec();
+			profile.joinTime += now - phaseStart;
+			phaseStart = now;
 		}
 
 		if (projectCount > 0 || ot == ROW_GROUP)
@@ -1220,6 +1386,7 @@ void BatchPrimitiveProcessor::execute()
 #endif
 					}
 
+				joinStart = utils::monotonicUsec();
 #ifdef PRIMPROC_STOPWATCH
 				stopwatch->start("-- executeTupleJoin()");
 				executeTupleJoin();
@@ -1227,6 +1394,10 @@ void BatchPrimitiveProcessor::execute()
 #else
 				executeTupleJoin();
 #endif
+				// charge the join to its own bucket, not to projection
+				now = utils::monotonicUsec();
+				profile.joinTime += now - joinStart;
+				phaseStart += now - joinStart;
 
 				/* project the non-key columns */
 				for (j = 0; j < projectCount; ++j)
@@ -1244,6 +1415,10 @@ void BatchPrimitiveProcessor::execute()
 				}
 			}
 
+			now = utils::monotonicUsec();
+			profile.projectTime += now - phaseStart;
+			phaseStart = now;
+
 			/* The RowGroup is fully joined at this point.
 			Add additional RowGroup processing here.
 			TODO:  Try to clean up all of the switching */
@@ -1281,6 +1456,7 @@ void BatchPrimitiveProcessor::execute()
 					}
 					RowGroup &nextRG = (fe2 ? fe2Output : joinedRG);
 					nextRG.setDBRoot(dbRoot);
+					profile.rowsOut += nextRG.getRowCount();
 					if (fAggregator) {
 						fAggregator->addRowGroup(&nextRG);
 
@@ -1331,6 +1507,7 @@ void BatchPrimitiveProcessor::execute()
 						fe2Out.nextRow();
 					}
 				}
+				profile.rowsOut += fe2Output.getRowCount();
 				if (!fAggregator) {
 					*serialized << (uint8_t) 1;  // the "count this msg" var
 					fe2Output.setDBRoot(dbRoot);
@@ -1363,6 +1540,9 @@ void BatchPrimitiveProcessor::execute()
 				}                                                         // @bug4507, 8k
 			}
 
+			if (!fe2 && !(doJoin && fAggregator))
+				profile.rowsOut += outputRG.getRowCount();
+
 			if (!fAggregator && !fe2) {
 				*serialized << (uint8_t) 1;  // the "count this msg" var
 				outputRG.setDBRoot(dbRoot);
@@ -1401,6 +1581,20 @@ void BatchPrimitiveProcessor::execute()
 			touchedBlocks = 0;
 // 		cout << "sent physIO=" << physIO << " cachedIO=" << cachedIO <<
 // 			" touchedBlocks=" << touchedBlocks << endl;
+			if (ot == ROW_GROUP) {
+				profile.aggTime += utils::monotonicUsec() - phaseStart;
+				profile.cpuTime += utils::threadCpuUsec() - cpuStart;
+				// field by field, in BatchPrimitiveProcessorJL::getRowGroupData()'s order
+				*serialized << profile.queueWait;
+				*serialized << profile.filterTime;
+				*serialized << profile.joinTime;
+				*serialized << profile.projectTime;
+				*serialized << profile.aggTime;
+				*serialized << profile.cpuTime;
+				*serialized << profile.rowsIn;
+				*serialized << profile.rowsOut;
+				memset(&profile, 0, sizeof(profile));
+			}
 		}
 
 #ifdef PRIMPROC_STOPWATCH
@@ -1878,6 +2072,11 @@ SBPP BatchPrimitiveProcessor::duplicate()
 			bpp->tlJoiners = tlJoiners;
 			bpp->tlKeyLengths = tlKeyLengths;
 			bpp->storedKeyAllocators = storedKeyAllocators;
+			bpp->joinTableIDs = joinTableIDs;
+			bpp->joinTableCached = joinTableCached;
+			bpp->joinTableKeySigs = joinTableKeySigs;
+			bpp->joinTableRows = joinTableRows;
+			bpp->joinTables = joinTables;
 			bpp->joinNullValues = joinNullValues;
 			bpp->doMatchNulls = doMatchNulls;
 			bpp->hasJoinFEFilters = hasJoinFEFilters;
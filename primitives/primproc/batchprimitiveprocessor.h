@@ -52,6 +52,7 @@
 #include "rowaggregation.h"
 #include "funcexpwrapper.h"
 #include "bppsendthread.h"
+#include "jointablecache.h"
 
 namespace primitiveprocessor
 {
@@ -92,6 +93,19 @@ class BatchPrimitiveProcessor
 		void addToJoiner(messageqcpp::ByteStream &);
 		int endOfJoiner();
 		int operator()();
+
+		/* Join tables cached in JoinTableCache.  joinTablesPending() is true if a table
+			this BPP should use is still being built by another query; primproc retries
+			the creation later, or calls getCachedJoinTables(true) to give up waiting.
+			A table that isn't there, or doesn't match what the UM sent, is built from
+			data the UM resends; joinTableNak() gives the message that asks for it.
+			storeJoinTables() is called once all join data has arrived. */
+		void getCachedJoinTables(bool final);
+		bool joinTablesPending() const { return joinTableWait; }
+		bool joinTableNak(messageqcpp::ByteStream &bs);
+		bool storesJoinTables() const;
+		void storeJoinTables();
+		void abandonJoinTables();
 		void setLBIDForScan(uint64_t rid);
 
 		/* Duplicate() returns a deep copy of this object as it was init'd by initBPP.
@@ -117,6 +131,9 @@ class BatchPrimitiveProcessor
 		uint32_t CachedIOCount() const { return cachedIO;}
 		uint32_t BlocksTouchedCount() const { return touchedBlocks;}
 
+		// time the current job spent queued; reported with the next response
+		void addQueueWait(uint64_t usec) { profile.queueWait += usec; }
+
 		void setError(const std::string& error, logging::ErrorCodeValues errorCode) {}
 
 		// these two functions are used by BPPV to create BPP instances
@@ -195,6 +212,7 @@ class BatchPrimitiveProcessor
 		uint32_t busyLoaderCount;
 
 		uint32_t physIO, cachedIO, touchedBlocks;
+		BPPProfile profile;
 
 		SP_UM_IOSOCK sock;
 		messageqcpp::SBS serialized;
@@ -234,12 +252,8 @@ class BatchPrimitiveProcessor
 		bool hasRowGroup;
 
 		/* Rowgroups + join */
-		typedef std::tr1::unordered_multimap<uint64_t, uint32_t,
-				joiner::TupleJoiner::hasher, std::equal_to<uint64_t>,
-				utils::SimpleAllocator<std::pair<const uint64_t, uint32_t> > > TJoiner;
-
-		typedef std::tr1::unordered_multimap<joiner::TypelessData,
-				uint32_t, joiner::TupleJoiner::hasher> TLJoiner;
+		typedef JoinTable::TJoiner TJoiner;
+		typedef JoinTable::TLJoiner TLJoiner;
 
 		bool generateJoinedRowGroup(rowgroup::Row &baseRow, const uint32_t depth = 0);
 		/* generateJoinedRowGroup helper fcns & vars */
@@ -299,6 +313,17 @@ class BatchPrimitiveProcessor
 		//boost::scoped_array<uint8_t> fAggRowGroupData;
 		boost::shared_array<boost::shared_ptr<utils::SimplePool> > _pools;
 
+		/* Join table caching.  joinTableIDs[i] == 0 means joiner i isn't cached,
+			otherwise joinTableCached[i] says whether to use the table stored under that
+			id or to store this one there.  joinTables keeps the tables in use alive. */
+		boost::shared_array<uint64_t> joinTableIDs;
+		boost::shared_array<bool> joinTableCached;
+		boost::shared_array<uint64_t> joinTableKeySigs;
+		boost::shared_array<uint32_t> joinTableRows;
+		boost::shared_array<JoinTableCache::SJoinTable> joinTables;
+		std::vector<uint32_t> joinTableNaks;
+		bool joinTableWait;
+
 		/* OR hacks */
 		uint8_t bop;   // BOP_AND or BOP_OR
 		bool hasPassThru;
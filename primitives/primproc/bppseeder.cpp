@@ -44,6 +44,8 @@ typedef int pthread_t;
 #include "errorcodes.h"
 #include "calpontsystemcatalog.h"
 #include "blockcacheclient.h"
+#include "profileclock.h"
+#include "metrics.h"
 
 using namespace messageqcpp;
 using namespace std;
@@ -97,17 +99,21 @@ BPPSeeder::BPPSeeder(const SBS &b,
 	sessionID = *((uint32_t *) &buf[pos]); pos += 4;
 	stepID = *((uint32_t *) &buf[pos]); pos += 4;
 	uniqueID = *((uint32_t *) &buf[pos]); pos +=4;
-	_priority = *((uint32_t *) &buf[pos]);
+	_priority = *((uint32_t *) &buf[pos]); pos += 4;
+	// error messages end before it
+	_cacheLBID = (b->length() >= pos + 8 ? *((uint64_t *) &buf[pos]) : 0);
 
 	dieTime = boost::posix_time::second_clock::universal_time() +
                 boost::posix_time::seconds(100);
+	queuedAt = utils::monotonicUsec();
 }
 
 BPPSeeder::BPPSeeder(const BPPSeeder &b)
 					: bs(b.bs), writelock(b.writelock), sock(b.sock),
 					fPMThreads(b.fPMThreads), fTrace(b.fTrace), uniqueID(b.uniqueID),
 					sessionID(b.sessionID), stepID(b.stepID), failCount(b.failCount), bpp(b.bpp),
-					firstRun(b.firstRun), _priority(b._priority)
+					firstRun(b.firstRun), queuedAt(b.queuedAt), _priority(b._priority),
+					_cacheLBID(b._cacheLBID)
 {
 }
 
@@ -192,6 +198,7 @@ int BPPSeeder::operator()()
 		}
 		gotBPP = true;
 		bpp->resetBPP(*bs, writelock, sock);
+		bpp->addQueueWait(utils::monotonicUsec() - queuedAt);
 		firstRun = false;
 	}   // firstRun
 
@@ -243,6 +250,9 @@ int BPPSeeder::operator()()
 	uint32_t retries = 0;
 restart:
 	try {
+		static utils::LatencyHistogram *execTime = utils::Metrics::instance()->histogram(
+			"idb_primproc_bpp_exec_usec", "", "Time to run one BatchPrimitiveProcessor job");
+		utils::ScopedLatency timer(execTime);
 		ret = (*bpp)();
 	}
 	catch (NeedToRestartJob &e) {
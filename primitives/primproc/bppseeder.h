@@ -71,6 +71,9 @@ class BPPSeeder : public threadpool::PriorityThreadPool::Functor
 		void priority(uint32_t p) { _priority = p; }
 		uint32_t priority() { return _priority; }
 
+		// a block this run will read, 0 if the UM didn't say
+		uint64_t cacheLBID() { return _cacheLBID; }
+
 	private:
 		BPPSeeder();
 		void catchHandler(const std::string& s, uint32_t uniqueID, uint32_t step);
@@ -89,8 +92,10 @@ class BPPSeeder : public threadpool::PriorityThreadPool::Functor
 		SBPPV bppv;
 		bool firstRun;
 		boost::posix_time::ptime dieTime;
+		uint64_t queuedAt;		// monotonic usec when the job was created
 
 		uint32_t _priority;
+		uint64_t _cacheLBID;
 };
 
 };
@@ -0,0 +1,171 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <ctime>
+using namespace std;
+
+#include <boost/thread/mutex.hpp>
+using namespace boost;
+
+#include "jointablecache.h"
+
+namespace
+{
+boost::mutex instanceLock;
+primitiveprocessor::JoinTableCache* cacheInstance = 0;
+
+// The UM forgets a table after 30 minutes without a use; this only catches the tables
+// of a UM that restarted and won't send the drops.
+const time_t maxIdleSeconds = 2 * 60 * 60;
+
+const uint64_t defaultMaxMemory = 1024ULL * 1024 * 1024;
+}
+
+namespace primitiveprocessor
+{
+
+JoinTableCache::JoinTableCache() : fMaxMemory(defaultMaxMemory), fCurMemory(0)
+{
+}
+
+JoinTableCache* JoinTableCache::instance()
+{
+	mutex::scoped_lock lk(instanceLock);
+	if (!cacheInstance)
+		cacheInstance = new JoinTableCache();
+	return cacheInstance;
+}
+
+void JoinTableCache::setMaxMemory(uint64_t bytes)
+{
+	mutex::scoped_lock lk(fMutex);
+	fMaxMemory = bytes;
+	makeRoom(0);
+}
+
+uint64_t JoinTableCache::memoryUsed()
+{
+	mutex::scoped_lock lk(fMutex);
+	return fCurMemory;
+}
+
+void JoinTableCache::expect(uint64_t id)
+{
+	mutex::scoped_lock lk(fMutex);
+	Entry &e = fTables[id];
+	e.lastUse = time(0);
+}
+
+void JoinTableCache::abandon(uint64_t id)
+{
+	mutex::scoped_lock lk(fMutex);
+	Map_t::iterator it = fTables.find(id);
+	if (it != fTables.end() && !it->second.table)
+		fTables.erase(it);
+}
+
+void JoinTableCache::store(uint64_t id, const SJoinTable &t)
+{
+	time_t now = time(0);
+
+	mutex::scoped_lock lk(fMutex);
+	expireIdle(now);
+	Map_t::iterator it = fTables.find(id);
+	if (it != fTables.end())
+		remove(it);
+	// a BPP that wants it later gets MISSING and has the UM send it
+	if (!makeRoom(t->bytes))
+		return;
+	Entry &e = fTables[id];
+	e.table = t;
+	e.lastUse = now;
+	fCurMemory += t->bytes;
+}
+
+JoinTableCache::Status JoinTableCache::lookup(uint64_t id, SJoinTable *out)
+{
+	time_t now = time(0);
+
+	mutex::scoped_lock lk(fMutex);
+	Map_t::iterator it = fTables.find(id);
+	if (it == fTables.end())
+		return MISSING;
+	if (!it->second.table)
+		return PENDING;
+	it->second.lastUse = now;
+	*out = it->second.table;
+	return FOUND;
+}
+
+void JoinTableCache::drop(const vector<uint64_t> &ids)
+{
+	mutex::scoped_lock lk(fMutex);
+	Map_t::iterator it;
+	for (uint32_t i = 0; i < ids.size(); i++) {
+		it = fTables.find(ids[i]);
+		if (it != fTables.end())
+			remove(it);
+	}
+}
+
+void JoinTableCache::expireIdle(time_t now)
+{
+	Map_t::iterator it = fTables.begin();
+	while (it != fTables.end()) {
+		if (now - it->second.lastUse > maxIdleSeconds)
+			remove(it++);
+		else
+			++it;
+	}
+}
+
+/* Evicts the least recently used stored tables until bytes more fit.  Pending ones,
+   and the ones a BPP holds, stay.  Evicts nothing if that isn't enough. */
+bool JoinTableCache::makeRoom(uint64_t bytes)
+{
+	Map_t::iterator it, victim;
+	uint64_t freeable = 0;
+
+	if (bytes > fMaxMemory)
+		return false;
+	for (it = fTables.begin(); it != fTables.end(); ++it)
+		if (it->second.table && it->second.table.unique())
+			freeable += it->second.table->bytes;
+	if (fCurMemory - freeable + bytes > fMaxMemory)
+		return false;
+	while (fCurMemory + bytes > fMaxMemory) {
+		victim = fTables.end();
+		for (it = fTables.begin(); it != fTables.end(); ++it)
+			if (it->second.table && it->second.table.unique() &&
+			  (victim == fTables.end() || it->second.lastUse < victim->second.lastUse))
+				victim = it;
+		if (victim == fTables.end())
+			return false;
+		remove(victim);
+	}
+	return true;
+}
+
+void JoinTableCache::remove(Map_t::iterator it)
+{
+	if (it->second.table)
+		fCurMemory -= it->second.table->bytes;
+	fTables.erase(it);
+}
+
+}
+// vim:ts=4 sw=4:
@@ -0,0 +1,138 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef JOINTABLECACHE_H_
+#define JOINTABLECACHE_H_
+
+#include <map>
+#include <vector>
+#include <ctime>
+#ifdef _MSC_VER
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "tuplejoiner.h"
+#include "rowgroup.h"
+#include "simpleallocator.h"
+#include "poolallocator.h"
+
+namespace primitiveprocessor
+{
+
+/** @brief the hash table a BPP built for one small side, and what it needs to use it */
+struct JoinTable
+{
+	typedef std::tr1::unordered_multimap<uint64_t, uint32_t,
+			joiner::TupleJoiner::hasher, std::equal_to<uint64_t>,
+			utils::SimpleAllocator<std::pair<const uint64_t, uint32_t> > > TJoiner;
+
+	typedef std::tr1::unordered_multimap<joiner::TypelessData,
+			uint32_t, joiner::TupleJoiner::hasher> TLJoiner;
+
+	JoinTable() : size(0), rows(0), keySignature(0), bytes(0), matchNulls(false),
+		hasRowData(false) { }
+
+	boost::shared_ptr<TJoiner> tJoiner;
+	boost::shared_ptr<utils::SimplePool> pool;
+	boost::shared_ptr<TLJoiner> tlJoiner;
+	boost::shared_array<utils::PoolAllocator> keyAllocators;	// holds the keys in tlJoiner
+	uint32_t size;
+	uint32_t rows;						// small side rows, as the UM counts them
+	uint64_t keySignature;				// what the keys are made of, from the UM
+	uint64_t bytes;						// estimated footprint
+	bool matchNulls;
+	bool hasRowData;
+	rowgroup::RGData rowData;
+};
+
+/** @brief PM join tables kept for later queries
+ *
+ * The UM decides what is cached.  It gives each small side it wants kept a unique id,
+ * has the first query that uses it tell the PM to store its table under that id, and
+ * has later queries with an identical small side (see TupleJoiner::canonicalizeSmallSide())
+ * tell the PM to use the stored table instead of sending the data again.  The UM also
+ * owns the memory budget and tells the PM which ids to drop.  The ids are never reused,
+ * so a store, a use, and a drop of one table can't be confused with another table's.
+ *
+ * An id is "pending" between the storing BPP's creation and the end of its join data.
+ * A BPP that wants a pending table has to wait for it.  Tables nobody has used in
+ * a long time are dropped here too, in case the UM that owns them went away.
+ *
+ * Every UM has its own budget, so the PM has one too (PrimitiveServers/JoinTableCacheSize).
+ * Storing a table evicts the least recently used ones no BPP is using to make room; a
+ * table that still doesn't fit isn't stored.  A BPP told to use a table that isn't here
+ * asks the UM for the small side instead (see BatchPrimitiveProcessor::joinTableNak()).
+ */
+class JoinTableCache
+{
+public:
+	typedef boost::shared_ptr<JoinTable> SJoinTable;
+
+	enum Status {
+		FOUND,
+		PENDING,
+		MISSING
+	};
+
+	static JoinTableCache* instance();
+
+	/** @brief the most memory the stored tables may take, by JoinTable::bytes */
+	void setMaxMemory(uint64_t bytes);
+	uint64_t memoryUsed();
+
+	/** @brief a BPP will store a table under id once it has all of the data */
+	void expect(uint64_t id);
+
+	/** @brief the BPP that was going to store id went away before it could */
+	void abandon(uint64_t id);
+
+	void store(uint64_t id, const SJoinTable &t);
+	Status lookup(uint64_t id, SJoinTable *out);
+	void drop(const std::vector<uint64_t> &ids);
+
+private:
+	JoinTableCache();
+	JoinTableCache(const JoinTableCache &);
+	JoinTableCache & operator=(const JoinTableCache &);
+
+	struct Entry {
+		SJoinTable table;		// null while pending
+		time_t lastUse;
+	};
+	typedef std::map<uint64_t, Entry> Map_t;
+
+	void expireIdle(time_t now);
+	bool makeRoom(uint64_t bytes);
+	void remove(Map_t::iterator it);
+
+	Map_t fTables;
+	uint64_t fMaxMemory;
+	uint64_t fCurMemory;
+	boost::mutex fMutex;
+};
+
+}
+
+#endif
+// vim:ts=4 sw=4:
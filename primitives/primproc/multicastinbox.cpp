@@ -0,0 +1,127 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <ctime>
+#include <string>
+#include <stdexcept>
+#include <unistd.h>
+using namespace std;
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+using namespace boost;
+
+#include "multicast.h"
+#include "pp_logger.h"
+using namespace messageqcpp;
+
+#include "multicastinbox.h"
+
+namespace
+{
+boost::mutex instanceLock;
+primitiveprocessor::MulticastInbox* inboxInstance = 0;
+
+// A message whose REF hasn't come by now never will; the UM has already resent
+// it over TCP.
+const time_t maxHoldSeconds = 60;
+}
+
+namespace primitiveprocessor
+{
+
+MulticastInbox::MulticastInbox()
+{
+}
+
+MulticastInbox* MulticastInbox::instance()
+{
+	mutex::scoped_lock lk(instanceLock);
+	if (!inboxInstance)
+		inboxInstance = new MulticastInbox();
+	return inboxInstance;
+}
+
+void MulticastInbox::start()
+{
+	mutex::scoped_lock lk(fMutex);
+	if (!fThread)
+		fThread.reset(new boost::thread(boost::bind(&MulticastInbox::receiveLoop, this)));
+}
+
+void MulticastInbox::receiveLoop()
+{
+	multicast::MulticastReceiver receiver;
+	string lastError;
+	SBS bs;
+	uint64_t seq;
+	time_t now;
+	map<uint64_t, Entry>::iterator it;
+
+	while (true) {
+		try {
+			bs = receiver.receive();
+		}
+		catch (std::exception &e) {
+			/* The UM falls back to TCP for whatever we miss, so keep trying quietly.
+			   A fixed Multicast/ReceiverPort another PrimProc on this host holds
+			   stays taken. */
+			if (lastError != e.what()) {
+				lastError = e.what();
+				Logger log;
+				log.logMessage(string("MulticastInbox: ") + lastError, false);
+			}
+			sleep(5);
+			continue;
+		}
+		// a damaged one is as good as missed; its REF gets a NAK
+		if (!bs || bs->length() < sizeof(seq))
+			continue;
+		*bs >> seq;
+
+		now = time(0);
+		mutex::scoped_lock lk(fMutex);
+		it = fMsgs.begin();
+		while (it != fMsgs.end()) {
+			if (now - it->second.arrived > maxHoldSeconds)
+				fMsgs.erase(it++);
+			else
+				++it;
+		}
+		Entry &e = fMsgs[seq];
+		e.msg = bs;
+		e.arrived = now;
+	}
+}
+
+SBS MulticastInbox::take(uint64_t seq)
+{
+	SBS ret;
+	map<uint64_t, Entry>::iterator it;
+
+	mutex::scoped_lock lk(fMutex);
+	it = fMsgs.find(seq);
+	if (it != fMsgs.end()) {
+		ret = it->second.msg;
+		fMsgs.erase(it);
+	}
+	return ret;
+}
+
+}
+// vim:ts=4 sw=4:
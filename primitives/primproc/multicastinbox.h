@@ -0,0 +1,74 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef MULTICASTINBOX_H_
+#define MULTICASTINBOX_H_
+
+#include <map>
+#include <ctime>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "bytestream.h"
+
+namespace primitiveprocessor
+{
+
+/** @brief holds the messages the UMs multicast until their MULTICAST_REFs arrive
+ *
+ * With Multicast/Enabled, the UM sends big one-to-all messages (createBPP, PM join
+ * small sides) once by multicast instead of once per PM.  Each one carries a sequence
+ * number, and the UM follows it with a MULTICAST_REF naming that number on its
+ * connection to each PM.  The REF becomes an OOBPool job that takes the message from
+ * here and handles it as if it had been read from the socket.
+ */
+class MulticastInbox
+{
+public:
+	static MulticastInbox* instance();
+
+	/** @brief start the thread that receives the multicast messages */
+	void start();
+
+	/** @brief returns the message with this sequence number, or a null SBS if
+	 *  it hasn't finished arriving.
+	 */
+	messageqcpp::SBS take(uint64_t seq);
+
+private:
+	MulticastInbox();
+	MulticastInbox(const MulticastInbox &);
+	MulticastInbox & operator=(const MulticastInbox &);
+
+	void receiveLoop();
+
+	struct Entry {
+		messageqcpp::SBS msg;
+		time_t arrived;
+	};
+	std::map<uint64_t, Entry> fMsgs;
+	boost::mutex fMutex;
+	boost::scoped_ptr<boost::thread> fThread;
+};
+
+}
+
+#endif
+// vim:ts=4 sw=4:
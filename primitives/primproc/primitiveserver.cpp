@@ -75,6 +75,7 @@ using namespace config;
 #include "bppseeder.h"
 #include "primitiveprocessor.h"
 #include "pp_logger.h"
+#include "multicastinbox.h"
 using namespace primitives;
 
 #include "errorcodes.h"
@@ -1157,11 +1158,15 @@ struct BPPHandler
 	};
 
 	struct Create : public BPPHandlerFunctor {
-		Create(BPPHandler *r, SBS b) : BPPHandlerFunctor(r, b) { }
+		Create(BPPHandler *r, SBS b, SP_UM_IOSOCK i, SP_UM_MUTEX w) :
+		  BPPHandlerFunctor(r, b), ios(i), writeLock(w) { }
 		int operator()() {
-			rt->createBPP(*bs);
-			return 0;
+			return rt->createBPP(*bs, dieTime, ios, writeLock);
 		}
+
+		// where to ask for the small sides of cached join tables that are gone
+		SP_UM_IOSOCK ios;
+		SP_UM_MUTEX writeLock;
 	};
 
 	struct Destroy : public BPPHandlerFunctor {
@@ -1185,6 +1190,67 @@ struct BPPHandler
 		}
 	};
 
+	/* A MULTICAST_REF.  Reschedules until the message it names is in the
+	   MulticastInbox, ACKs it so the UM can let it go, then handles it the way its
+	   own command would.  If it hasn't arrived by nakTime, asks the UM to resend it
+	   over this connection. */
+	struct MulticastRef : public BPPHandlerFunctor {
+		MulticastRef(BPPHandler *r, SBS b, SP_UM_IOSOCK i, SP_UM_MUTEX w) :
+		  BPPHandlerFunctor(r, b), ios(i), writeLock(w)
+		{
+			bs->advance(sizeof(ISMPacketHeader));
+			*bs >> seq;
+			// the UM sends the ref once the transfer is done, so it's here or nearly
+			nakTime = posix_time::microsec_clock::universal_time() + posix_time::milliseconds(500);
+		}
+		int operator()() {
+			if (!msgHandler) {
+				SBS msg = MulticastInbox::instance()->take(seq);
+				if (!msg) {
+					if (posix_time::microsec_clock::universal_time() < nakTime)
+						return -1;
+					multicastAnswer(MULTICAST_NAK, seq, ios, writeLock);
+					return 0;
+				}
+				multicastAnswer(MULTICAST_ACK, seq, ios, writeLock);
+				if (msg->length() < sizeof(ISMPacketHeader))
+					return 0;
+				const ISMPacketHeader *ism = (const ISMPacketHeader *) msg->buf();
+				if (ism->Command == BATCH_PRIMITIVE_CREATE)
+					msgHandler.reset(new Create(rt, msg, ios, writeLock));
+				else if (ism->Command == BATCH_PRIMITIVE_ADD_JOINER)
+					msgHandler.reset(new AddJoiner(rt, msg));
+				else {
+					std::ostringstream os;
+					Logger log;
+					os << "unexpected multicast primitive cmd: " << ism->Command;
+					log.logMessage(os.str());
+					return 0;
+				}
+			}
+			return (*msgHandler)();
+		}
+
+		uint64_t seq;
+		SP_UM_IOSOCK ios;
+		SP_UM_MUTEX writeLock;
+		posix_time::ptime nakTime;
+		boost::shared_ptr<PriorityThreadPool::Functor> msgHandler;
+	};
+
+	static void multicastAnswer(uint8_t command, uint64_t seq, SP_UM_IOSOCK ios,
+	  SP_UM_MUTEX writeLock)
+	{
+		ByteStream answer(sizeof(ISMPacketHeader) + sizeof(seq));
+		ISMPacketHeader *ism = (ISMPacketHeader *) answer.getInputPtr();
+		memset(ism, 0, sizeof(ISMPacketHeader));
+		ism->Command = command;
+		answer.advanceInputPtr(sizeof(ISMPacketHeader));
+		answer << seq;
+		mutex::scoped_lock lk(*writeLock);
+		ios->write(answer);
+	}
+
 	int doAbort(ByteStream &bs, const posix_time::ptime &dieTime)
 	{
 		uint32_t key;
@@ -1196,6 +1262,8 @@ struct BPPHandler
 		it = bppMap.find(key);
 		if (it != bppMap.end()) {
 			it->second->abort();
+			if (!it->second->get().empty())
+				it->second->get()[0]->abandonJoinTables();
 			bppMap.erase(it);
 		}
 		else {
@@ -1231,17 +1299,32 @@ struct BPPHandler
 			return -1;
 	}
 
-	void createBPP(ByteStream &bs)
+	int createBPP(ByteStream &bs, const posix_time::ptime &dieTime, SP_UM_IOSOCK ios,
+	  SP_UM_MUTEX writeLock)
 	{
 		uint32_t i;
 		uint32_t key, initMsgsLeft;
 		SBPP bpp;
 		SBPPV bppv;
+		ByteStream nak;
 
 		// make the new BPP object
 		bppv.reset(new BPPV());
 		bpp.reset(new BatchPrimitiveProcessor(bs, fPrimitiveServerPtr->prefetchThreshold(),
 											  bppv->getSendThread()));
+
+		/* A join table it should reuse is still being built by another query.  Try
+		   again later, and if it never shows up, have the UM send the small side. */
+		if (bpp->joinTablesPending()) {
+			if (posix_time::second_clock::universal_time() <= dieTime) {
+#ifndef __FreeBSD__
+				bpp->unlock();
+#endif
+				bs.rewind();
+				return -1;
+			}
+			bpp->getCachedJoinTables(true);
+		}
 		if (bs.length() > 0)
 			bs >> initMsgsLeft;
 		else {
@@ -1279,6 +1362,14 @@ struct BPPHandler
 				cerr << "warning: createBPP() tried to clobber a BPP with duplicate sessionID & stepID.  sessionID=" <<
 					 bpp->getSessionID() << " stepID=" << bpp->getStepID()<< endl;
 		}
+
+		/* The join data isn't complete until the UM resends the tables that aren't
+		   here; lastJoinerMsg() waits for it. */
+		if (bpp->joinTableNak(nak)) {
+			mutex::scoped_lock lk(*writeLock);
+			ios->write(nak);
+		}
+		return 0;
 	}
 
 	SBPPV grabBPPs(uint32_t uniqueID)
@@ -1373,6 +1464,8 @@ struct BPPHandler
 			}
 		}
 
+		bppv->get()[0]->storeJoinTables();
+
 		/* Note: some of the duplicate/run/join sync was moved to the BPPV class to do
 		more intelligent scheduling.  Once the join data is received, BPPV will
 		start letting jobs run and create more BPP instances on demand. */
@@ -1397,7 +1490,17 @@ struct BPPHandler
 
 		it = bppMap.find(uniqueID);
 		if (it != bppMap.end()) {
+			/* A table this query builds for the join table cache has to be stored
+			   before the BPP goes away; the UM already counts on it. */
+			if (!it->second->joinDataReceived && !it->second->get().empty() &&
+			  it->second->get()[0]->storesJoinTables() &&
+			  posix_time::second_clock::universal_time() <= dieTime) {
+				bs.rewind();
+				return -1;
+			}
 			it->second->abort();
+			if (!it->second->get().empty())
+				it->second->get()[0]->abandonJoinTables();
 			bppMap.erase(it);
 		}
 		else {
@@ -1452,6 +1555,9 @@ struct BPPHandler
 		case BATCH_PRIMITIVE_END_JOINER:
 		case BATCH_PRIMITIVE_DESTROY:
 			return *((uint32_t *) &buf[sizeof(ISMPacketHeader) + 2*sizeof(uint32_t)]);
+		case MULTICAST_REF:
+			// the UM copies it from the message it names, 0 for a create
+			return *((uint32_t *) &buf[sizeof(ISMPacketHeader) + sizeof(uint64_t)]);
 		default:
 			return 0;
 		}
@@ -1815,6 +1921,7 @@ struct ReadThread
 						job.id = bpps->getID();
 						job.weight = ismHdr->Size;
 						job.priority = bpps->priority();
+						job.node = fPrimitiveServerPtr->numaNode(bpps->cacheLBID());
 						if (bpps->isSysCat()) {
 							//boost::thread t(*bpps);
 							// using already-existing threads may cut latency
@@ -1829,7 +1936,8 @@ struct ReadThread
 					}
 					case BATCH_PRIMITIVE_CREATE: {
 						PriorityThreadPool::Job job;
-						job.functor = boost::shared_ptr<PriorityThreadPool::Functor>(new BPPHandler::Create(&fBPPHandler, bs));
+						job.functor = boost::shared_ptr<PriorityThreadPool::Functor>(new BPPHandler::Create(&fBPPHandler,
+						  bs, outIosDefault, writeLockDefault));
 						OOBPool->addJob(job);
 						//fBPPHandler.createBPP(*bs);
 						break;
@@ -1842,6 +1950,16 @@ struct ReadThread
 						//fBPPHandler.addJoinerToBPP(*bs);
 						break;
 					}
+					case MULTICAST_REF: {
+						// waits for the multicast message in OOBPool, not here
+						PriorityThreadPool::Job job;
+						// read it before MulticastRef moves past the header
+						job.id = fBPPHandler.getUniqueID(bs, ismHdr->Command);
+						job.functor = boost::shared_ptr<PriorityThreadPool::Functor>(new BPPHandler::MulticastRef(&fBPPHandler,
+						  bs, outIosDefault, writeLockDefault));
+						OOBPool->addJob(job);
+						break;
+					}
 					case BATCH_PRIMITIVE_END_JOINER: {
 						// lastJoinerMsg can block; must do this in a different thread
 						//OOBPool->invoke(BPPHandler::LastJoiner(&fBPPHandler, bs));  // needs a threadpool that can resched
@@ -1996,7 +2114,8 @@ PrimitiveServer::PrimitiveServer(int serverThreads,
 								 uint32_t deleteBlocks,
 								 bool ptTrace,
 								 double prefetch,
-								 uint64_t smallSide
+								 uint64_t smallSide,
+								 uint32_t numaNodes
 								):
 	fServerThreads(serverThreads),
 	fServerQueueSize(serverQueueSize),
@@ -2007,18 +2126,19 @@ PrimitiveServer::PrimitiveServer(int serverThreads,
 	fRotatingDestination(rotatingDestination),
 	fPTTrace(ptTrace),
 	fPrefetchThreshold(prefetch),
-	fPMSmallSide(smallSide)
+	fPMSmallSide(smallSide),
+	fNumaNodes(numaNodes > 0 ? numaNodes : 1)
 {
 	fCacheCount=cacheCount;
 	fServerpool.setMaxThreads(fServerThreads);
 	fServerpool.setQueueSize(fServerQueueSize);
 
 	fProcessorPool.reset(new threadpool::PriorityThreadPool(fProcessorWeight, highPriorityThreads,
-						 medPriorityThreads, lowPriorityThreads, 0));
+						 medPriorityThreads, lowPriorityThreads, 0, fNumaNodes, "processor"));
 
 	// We're not using either the priority or the job-clustering features, just need a threadpool
 	// that can reschedule jobs, and an unlimited non-blocking queue
-	OOBPool.reset(new threadpool::PriorityThreadPool(1, 5, 0, 0, 1));
+	OOBPool.reset(new threadpool::PriorityThreadPool(1, 5, 0, 0, 1, 1, "oob"));
 
 	asyncCounter = 0;
 
@@ -2029,7 +2149,8 @@ PrimitiveServer::PrimitiveServer(int serverThreads,
 	{
 		for (int i = 0; i < fCacheCount; i++)
 			BRPp[i] = new BlockRequestProcessor(BRPBlocks/fCacheCount, BRPThreads/fCacheCount,
-												fMaxBlocksPerRead, deleteBlocks/fCacheCount);
+												fMaxBlocksPerRead, deleteBlocks/fCacheCount, BLOCK_SIZE,
+												(fNumaNodes > 1 ? (int) (i % fNumaNodes) : -1));
 	}
 	catch (...)
 	{
@@ -2044,6 +2165,13 @@ PrimitiveServer::~PrimitiveServer()
 {
 }
 
+int PrimitiveServer::numaNode(uint64_t lbid) const
+{
+	if (fNumaNodes <= 1 || lbid == 0)
+		return -1;
+	return cacheNum(lbid) % fNumaNodes;
+}
+
 void PrimitiveServer::start()
 {
 	// start all the server threads
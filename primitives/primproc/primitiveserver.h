@@ -127,7 +127,8 @@ namespace primitiveprocessor
 						uint32_t deleteBlocks = 0,
 						bool ptTrace=false,
 						double prefetchThreshold = 0,
-						uint64_t pmSmallSide = 0);
+						uint64_t pmSmallSide = 0,
+						uint32_t numaNodes = 1);
 
 			/** @brief dtor
 			*/
@@ -148,6 +149,12 @@ namespace primitiveprocessor
 			bool PTTrace() const {return fPTTrace;}
 			double prefetchThreshold() const { return fPrefetchThreshold; }
 			uint32_t ProcessorThreads() const { return highPriorityThreads + medPriorityThreads + lowPriorityThreads; }
+
+			/** @brief the NUMA node whose threads should run a job reading lbid, -1 for any
+			 *
+			 * Block cache partition i belongs to node i % numaNodes.
+			 */
+			int numaNode(uint64_t lbid) const;
 		protected:
 
 		private:
@@ -171,6 +178,7 @@ namespace primitiveprocessor
 			bool fPTTrace;
 			double fPrefetchThreshold;
 			uint64_t fPMSmallSide;
+			uint32_t fNumaNodes;
 	};
 
 
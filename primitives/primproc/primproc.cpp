@@ -69,6 +69,10 @@ using namespace oam;
 using namespace idbdatafile;
 
 #include "cgroupconfigurator.h"
+#include "metrics.h"
+#include "numatopology.h"
+#include "multicastinbox.h"
+#include "jointablecache.h"
 
 namespace primitiveprocessor
 {
@@ -297,6 +301,8 @@ int main(int argc, char* argv[])
 
 	int rc;
 	rc = setupResources();
+
+	utils::Metrics::instance()->startDumper("PrimProc");
 	if (rc) {
 		Message::Args args;
 		args.add(rc);
@@ -311,6 +317,7 @@ int main(int argc, char* argv[])
 	uint32_t BRPBlocks = 1887437;
 	int BRPThreads = 16;
 	int cacheCount = 1;
+	uint32_t numaNodes = 1;
 	int maxBlocksPerRead = 256;  // 1MB
 	bool rotatingDestination = false;
 	uint32_t deleteBlocks = 128;
@@ -439,6 +446,15 @@ int main(int argc, char* argv[])
 	if (temp > 0)
 		cacheCount = temp;
 
+	// NUMA mode gives every node its own block cache partitions and worker threads.
+	// Each node needs at least one partition.
+	strVal = cf->getConfig(primitiveServers, "NUMAMode");
+	if ((strVal == "y") || (strVal == "Y")) {
+		numaNodes = utils::NumaTopology::instance()->nodeCount();
+		if (numaNodes > 1 && cacheCount % numaNodes != 0)
+			cacheCount += numaNodes - (cacheCount % numaNodes);
+	}
+
 	temp = toInt(cf->getConfig(dbbc, "NumDeleteBlocks"));
 	if (temp > 0)
 		deleteBlocks = temp;
@@ -570,6 +586,11 @@ int main(int argc, char* argv[])
 	if (temp > 0)
 		BRPThreads = temp;
 
+	// the join tables kept for the UMs, all of them together
+	strVal = cf->getConfig(primitiveServers, "JoinTableCacheSize");
+	if (!strVal.empty())
+		JoinTableCache::instance()->setMaxMemory(Config::uFromText(strVal));
+
 #ifndef _MSC_VER
 	// @bug4598, switch for O_DIRECT to support gluster fs.
 	// directIOFlag == O_DIRECT, by default
@@ -589,11 +610,16 @@ int main(int argc, char* argv[])
 		 ", nb = " << BRPBlocks << ", nt = " << BRPThreads << ", nc = " << cacheCount <<
 		 ", ra = " << blocksReadAhead <<  ", db = " << deleteBlocks << ", mb = " << maxBlocksPerRead <<
 		 ", rd = " << rotatingDestination << ", tr = " << PTTrace <<
-		 ", ss = " << PMSmallSide << ", bp = " << BPPCount << endl;
+		 ", ss = " << PMSmallSide << ", bp = " << BPPCount << ", nn = " << numaNodes << endl;
 
 	PrimitiveServer server(serverThreads, serverQueueSize, processorWeight, processorQueueSize,
 						   rotatingDestination, BRPBlocks, BRPThreads, cacheCount, maxBlocksPerRead, blocksReadAhead,
-						   deleteBlocks, PTTrace, prefetchThreshold, PMSmallSide);
+						   deleteBlocks, PTTrace, prefetchThreshold, PMSmallSide, numaNodes);
+
+	// the UMs may send the big one-to-all messages by multicast
+	strVal = cf->getConfig("Multicast", "Enabled");
+	if ((strVal == "y") || (strVal == "Y"))
+		MulticastInbox::instance()->start();
 
 #ifdef QSIZE_DEBUG
 	thread* qszMonThd;
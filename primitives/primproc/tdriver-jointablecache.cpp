@@ -0,0 +1,146 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file
+ * JoinTableCache tests: the join tables a PM keeps for the UMs.
+ */
+
+#include <vector>
+using namespace std;
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "jointablecache.h"
+using namespace primitiveprocessor;
+
+namespace
+{
+
+JoinTableCache::SJoinTable table(uint64_t bytes)
+{
+	JoinTableCache::SJoinTable t(new JoinTable());
+	t->size = 10;
+	t->rows = 10;
+	t->bytes = bytes;
+	return t;
+}
+
+// a cache of its own to every test, ids are never reused
+JoinTableCache* cache(uint64_t maxMemory, uint64_t firstID, uint32_t count)
+{
+	JoinTableCache *c = JoinTableCache::instance();
+	vector<uint64_t> ids;
+
+	for (uint32_t i = 0; i < count; i++)
+		ids.push_back(firstID + i);
+	c->drop(ids);
+	c->setMaxMemory(maxMemory);
+	return c;
+}
+
+}
+
+class JoinTableCacheTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(JoinTableCacheTest);
+
+CPPUNIT_TEST(jointablecache_lookup_1);
+CPPUNIT_TEST(jointablecache_bound_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+public:
+	void jointablecache_lookup_1() {
+		JoinTableCache *c = cache(1000, 100, 3);
+		JoinTableCache::SJoinTable t, out;
+
+		CPPUNIT_ASSERT(c->lookup(100, &out) == JoinTableCache::MISSING);
+
+		c->expect(100);
+		CPPUNIT_ASSERT(c->lookup(100, &out) == JoinTableCache::PENDING);
+		c->abandon(100);
+		CPPUNIT_ASSERT(c->lookup(100, &out) == JoinTableCache::MISSING);
+
+		c->expect(101);
+		t = table(300);
+		c->store(101, t);
+		CPPUNIT_ASSERT(c->lookup(101, &out) == JoinTableCache::FOUND);
+		CPPUNIT_ASSERT(out == t);
+		CPPUNIT_ASSERT(c->memoryUsed() == 300);
+
+		// abandon() only clears pending ones
+		c->abandon(101);
+		CPPUNIT_ASSERT(c->lookup(101, &out) == JoinTableCache::FOUND);
+
+		c->drop(vector<uint64_t>(1, 101));
+		CPPUNIT_ASSERT(c->lookup(101, &out) == JoinTableCache::MISSING);
+		CPPUNIT_ASSERT(c->memoryUsed() == 0);
+	}
+
+	/* tables no BPP holds go least recently used first; what doesn't fit isn't kept */
+	void jointablecache_bound_1() {
+		JoinTableCache *c = cache(1000, 200, 5);
+		JoinTableCache::SJoinTable held, out;
+
+		c->store(200, table(400));
+		c->store(201, table(400));
+		CPPUNIT_ASSERT(c->memoryUsed() == 800);
+		CPPUNIT_ASSERT(c->lookup(200, &held) == JoinTableCache::FOUND);
+
+		// 200 is held by a BPP, so 201 goes
+		c->store(202, table(400));
+		CPPUNIT_ASSERT(c->lookup(201, &out) == JoinTableCache::MISSING);
+		CPPUNIT_ASSERT(c->lookup(202, &out) == JoinTableCache::FOUND);
+		out.reset();
+		CPPUNIT_ASSERT(c->memoryUsed() == 800);
+
+		// nothing it can evict
+		c->expect(203);
+		c->store(203, table(1001));
+		CPPUNIT_ASSERT(c->lookup(203, &out) == JoinTableCache::MISSING);
+		c->store(204, table(1000));
+		CPPUNIT_ASSERT(c->lookup(204, &out) == JoinTableCache::MISSING);
+		CPPUNIT_ASSERT(c->memoryUsed() == 800);
+
+		// once it's let go it can be evicted
+		held.reset();
+		c->store(204, table(1000));
+		CPPUNIT_ASSERT(c->lookup(204, &out) == JoinTableCache::FOUND);
+		CPPUNIT_ASSERT(c->lookup(200, &held) == JoinTableCache::MISSING);
+		CPPUNIT_ASSERT(c->memoryUsed() == 1000);
+
+		// a smaller budget evicts right away
+		out.reset();
+		c->setMaxMemory(500);
+		CPPUNIT_ASSERT(c->lookup(204, &out) == JoinTableCache::MISSING);
+		CPPUNIT_ASSERT(c->memoryUsed() == 0);
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( JoinTableCacheTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
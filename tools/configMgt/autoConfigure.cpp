@@ -482,12 +482,14 @@ int main(int argc, char *argv[])
 	string Port = "3306";
 	string User = "";
 	string Password = "";
+	string Connections = "";
 
 	try {
 		Host = sysConfigOld->getConfig("CrossEngineSupport", "Host");
 		Port = sysConfigOld->getConfig("CrossEngineSupport", "Port");
 		User = sysConfigOld->getConfig("CrossEngineSupport", "User");
 		Password = sysConfigOld->getConfig("CrossEngineSupport", "Password");
+		Connections = sysConfigOld->getConfig("CrossEngineSupport", "Connections");
 	}
 	catch(...)
 	{
@@ -495,6 +497,7 @@ int main(int argc, char *argv[])
 		Port = "3306";
 		User = "";
 		Password = "";
+		Connections = "";
 	}
 
 	try {
@@ -502,6 +505,8 @@ int main(int argc, char *argv[])
 		sysConfigNew->setConfig("CrossEngineSupport", "Port", Port);
 		sysConfigNew->setConfig("CrossEngineSupport", "User", User);
 		sysConfigNew->setConfig("CrossEngineSupport", "Password", Password);
+		if (!Connections.empty())
+			sysConfigNew->setConfig("CrossEngineSupport", "Connections", Connections);
 	}
 	catch(...)
 	{}
@@ -1646,6 +1651,25 @@ int main(int argc, char *argv[])
 	catch(...)
 	{}
 
+	// NetworkCompression Codec
+	try {
+		NetworkCompression = sysConfigOld->getConfig("NetworkCompression", "Codec");
+
+		if ( !NetworkCompression.empty() )
+		{
+			try {
+				sysConfigNew->setConfig("NetworkCompression", "Codec", NetworkCompression);
+			}
+			catch(...)
+			{
+				cout << "ERROR: Problem setting NetworkCompression in the Calpont System Configuration file" << endl;
+				exit(-1);
+			}
+		}
+	}
+	catch(...)
+	{}
+
 	// CoreFile Flag
 	try {
 		CoreFileFlag = sysConfigOld->getConfig("Installation", "CoreFileFlag");
@@ -0,0 +1,604 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/*
+* $Id$
+*/
+
+/* Microbenchmarks for the primitive kernels and the UM operators.
+ *
+ * Everything runs on synthetic column blocks and RowGroups built in memory,
+ * so no running system is needed (LimitedOrderBy still reads Calpont.xml
+ * through the ResourceManager).  Results go to stdout as CSV, one line per
+ * benchmark, so they can be collected and compared across releases on the
+ * same hardware.
+ */
+
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+using namespace std;
+
+#include <boost/shared_ptr.hpp>
+#include <boost/shared_array.hpp>
+#include <boost/scoped_array.hpp>
+
+#include "primitivemsg.h"
+#include "primitiveprocessor.h"
+using namespace primitives;
+
+#include "calpontsystemcatalog.h"
+using namespace execplan;
+
+#include "bytestream.h"
+using namespace messageqcpp;
+
+#include "rowgroup.h"
+#include "rowaggregation.h"
+using namespace rowgroup;
+
+#include "jlf_common.h"
+#include "limitedorderby.h"
+#include "resourcemanager.h"
+using namespace joblist;
+
+#include "tuplejoiner.h"
+using namespace joiner;
+
+#include "idbcompress.h"
+using namespace compress;
+
+#include "profileclock.h"
+
+namespace
+{
+
+const uint32_t ROWS_PER_RG = 8192;
+
+struct BenchResult
+{
+	BenchResult(const string& n) : name(n), iterations(0), items(0), bytes(0), usec(0) { }
+	string name;
+	uint64_t iterations;
+	uint64_t items;		// values, rows or strings processed
+	uint64_t bytes;		// input bytes processed
+	uint64_t usec;
+};
+
+typedef void (*BenchFcn)(uint32_t scale, vector<BenchResult>& results);
+
+// Fixed-seed generator so every run sees the same data
+class Rand
+{
+public:
+	Rand() : fState(0x2545F4914F6CDD1DULL) { }
+	uint64_t next()
+	{
+		fState ^= fState << 13;
+		fState ^= fState >> 7;
+		fState ^= fState << 17;
+		return fState;
+	}
+	int64_t range(int64_t n) { return (int64_t)(next() % (uint64_t)n); }
+private:
+	uint64_t fState;
+};
+
+// All-BIGINT RowGroup
+RowGroup makeRowGroup(uint32_t colCount)
+{
+	vector<uint32_t> pos, oids, keys, scale, precision;
+	vector<CalpontSystemCatalog::ColDataType> types;
+
+	pos.push_back(2);
+	for (uint32_t i = 0; i < colCount; i++)
+	{
+		pos.push_back(pos.back() + 8);
+		oids.push_back(3000 + i);
+		keys.push_back(i);
+		types.push_back(CalpontSystemCatalog::BIGINT);
+		scale.push_back(0);
+		precision.push_back(19);
+	}
+	return RowGroup(colCount, pos, oids, keys, types, scale, precision, 20, false);
+}
+
+// Fills one RGData with ROWS_PER_RG rows.  Column 0 is drawn from [0, keyRange),
+// the rest are random.
+void fillRowGroup(RowGroup& rg, RGData& data, Rand& rand, int64_t keyRange)
+{
+	Row row;
+
+	data.reinit(rg, ROWS_PER_RG);
+	rg.setData(&data);
+	rg.resetRowGroup(0);
+	rg.initRow(&row);
+	rg.getRow(0, &row);
+	for (uint32_t i = 0; i < ROWS_PER_RG; i++, row.nextRow())
+	{
+		row.setIntField(rand.range(keyRange), 0);
+		for (uint32_t j = 1; j < rg.getColumnCount(); j++)
+			row.setIntField(rand.range(1000000), j);
+	}
+	rg.setRowCount(ROWS_PER_RG);
+}
+
+//------------------------------------------------------------------------------
+// p_Col: a range filter over a block of BIGINT and an equality filter over a
+// block of INT, the way ColumnCommand drives it (pre-parsed filter, RID output)
+//------------------------------------------------------------------------------
+template<int W>
+void colScan(const string& name, CalpontSystemCatalog::ColDataType type,
+	const vector<int8_t>& cops, const vector<int64_t>& vals, uint8_t bop,
+	uint32_t scale, vector<BenchResult>& results)
+{
+	PrimitiveProcessor pp;
+	Rand rand;
+	const uint32_t valsPerBlock = BLOCK_SIZE / W;
+	const uint32_t filterSize = 2 + W;
+	boost::scoped_array<int64_t> block(new int64_t[BLOCK_SIZE / 8]);
+	boost::scoped_array<uint8_t> input(new uint8_t[sizeof(NewColRequestHeader) + cops.size() * filterSize]);
+	boost::scoped_array<uint8_t> output(new uint8_t[sizeof(NewColResultHeader) + valsPerBlock * (2 + W)]);
+	NewColRequestHeader* in = reinterpret_cast<NewColRequestHeader*>(input.get());
+	NewColResultHeader* out = reinterpret_cast<NewColResultHeader*>(output.get());
+	uint32_t written;
+
+	for (uint32_t i = 0; i < valsPerBlock; i++)
+	{
+		int64_t v = rand.range(1000000);
+		memcpy(reinterpret_cast<uint8_t*>(block.get()) + i * W, &v, W);
+	}
+
+	memset(in, 0, sizeof(NewColRequestHeader));
+	in->DataSize = W;
+	in->DataType = type;
+	in->OutputType = OT_RID;
+	in->BOP = bop;
+	in->NOPS = cops.size();
+	in->NVALS = 0;
+	for (uint32_t i = 0; i < cops.size(); i++)
+	{
+		ColArgs* args = reinterpret_cast<ColArgs*>(&input[sizeof(NewColRequestHeader) + i * filterSize]);
+		args->COP = cops[i];
+		args->rf = 0;
+		memcpy(args->val, &vals[i], W);
+	}
+
+	pp.setParsedColumnFilter(parseColumnFilter(&input[sizeof(NewColRequestHeader)], W, type,
+		cops.size(), bop));
+	pp.setBlockPtr(reinterpret_cast<int*>(block.get()));
+
+	BenchResult r(name);
+	r.iterations = 20000 * scale;
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < r.iterations; i++)
+		pp.p_Col(in, out, sizeof(NewColResultHeader) + valsPerBlock * (2 + W), &written);
+	r.usec = utils::monotonicUsec() - start;
+	r.items = r.iterations * valsPerBlock;
+	r.bytes = r.iterations * BLOCK_SIZE;
+	results.push_back(r);
+}
+
+void benchColumn(uint32_t scale, vector<BenchResult>& results)
+{
+	vector<int8_t> cops;
+	vector<int64_t> vals;
+
+	cops.push_back(COMPARE_GT);
+	vals.push_back(250000);
+	cops.push_back(COMPARE_LT);
+	vals.push_back(750000);
+	colScan<8>("p_Col_bigint_range", CalpontSystemCatalog::BIGINT, cops, vals, BOP_AND,
+		scale, results);
+
+	cops.clear();
+	vals.clear();
+	cops.push_back(COMPARE_EQ);
+	vals.push_back(4242);
+	colScan<4>("p_Col_int_eq", CalpontSystemCatalog::INT, cops, vals, BOP_AND,
+		scale, results);
+}
+
+//------------------------------------------------------------------------------
+// p_Dictionary: full scan of one dictionary block with an equality filter and
+// with a LIKE filter
+//------------------------------------------------------------------------------
+
+// Builds a dictionary block the way the write engine lays it out: an 8-byte
+// continuation pointer, 2 bytes of free space, then the offset array that
+// starts with the end of the block and is terminated by 0xffff.  Strings are
+// stored back to front from the end of the block.
+uint32_t makeDictBlock(uint8_t* block, Rand& rand)
+{
+	static const char* words[] = { "alpha", "bravo", "charlie", "delta", "echo", "foxtrot",
+		"golf", "hotel", "india", "juliet", "kilo", "lima" };
+	uint16_t* offsets = reinterpret_cast<uint16_t*>(&block[10]);
+	uint32_t count = 0;
+	uint32_t end = BLOCK_SIZE;
+
+	memset(block, 0, BLOCK_SIZE);
+	offsets[0] = BLOCK_SIZE;
+	while (true)
+	{
+		ostringstream os;
+		os << words[rand.range(12)] << "_" << rand.range(100000) << "_" << words[rand.range(12)];
+		string s = os.str();
+		// room for this string, its offset and the terminator
+		if (end - s.length() < 10 + (count + 3) * 2)
+			break;
+		end -= s.length();
+		memcpy(&block[end], s.data(), s.length());
+		offsets[++count] = end;
+	}
+	offsets[count + 1] = 0xffff;
+	return count;
+}
+
+void dictScan(const string& name, uint8_t cop, const string& arg, uint32_t scale,
+	vector<BenchResult>& results)
+{
+	PrimitiveProcessor pp;
+	Rand rand;
+	boost::scoped_array<int64_t> block(new int64_t[BLOCK_SIZE / 8]);
+	uint32_t count = makeDictBlock(reinterpret_cast<uint8_t*>(block.get()), rand);
+	boost::scoped_array<uint8_t> input(new uint8_t[sizeof(DictInput) + sizeof(DictFilterElement) + arg.length()]);
+	DictInput* in = reinterpret_cast<DictInput*>(input.get());
+	DictFilterElement* filter = reinterpret_cast<DictFilterElement*>(&input[sizeof(DictInput)]);
+	vector<uint8_t> out;
+
+	memset(in, 0, sizeof(DictInput));
+	in->BOP = BOP_AND;
+	in->OutputType = OT_TOKEN;
+	in->NOPS = 1;
+	in->NVALS = 0;
+	filter->COP = cop;
+	filter->len = arg.length();
+	memcpy(filter->data, arg.data(), arg.length());
+
+	if (cop & COMPARE_LIKE)
+		pp.setLikeFilter(pp.makeLikeFilter(filter, 1));
+	pp.setBlockPtr(reinterpret_cast<int*>(block.get()));
+
+	BenchResult r(name);
+	r.iterations = 20000 * scale;
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < r.iterations; i++)
+		pp.p_Dictionary(in, &out, false, true, boost::shared_ptr<DictEqualityFilter>(), 0);
+	r.usec = utils::monotonicUsec() - start;
+	r.items = r.iterations * count;
+	r.bytes = r.iterations * BLOCK_SIZE;
+	results.push_back(r);
+}
+
+void benchDictionary(uint32_t scale, vector<BenchResult>& results)
+{
+	dictScan("p_Dictionary_eq", COMPARE_EQ, "delta_4242_echo", scale, results);
+	dictScan("p_Dictionary_like", COMPARE_LIKE, "%42%echo", scale, results);
+}
+
+//------------------------------------------------------------------------------
+// TupleJoiner: UM hash table build and probe on a BIGINT key
+//------------------------------------------------------------------------------
+void benchJoiner(uint32_t scale, vector<BenchResult>& results)
+{
+	RowGroup smallRG = makeRowGroup(2), largeRG = makeRowGroup(4);
+	uint32_t smallRGs = 16 * scale, probes = 8 * scale;
+	int64_t keyRange = (int64_t)smallRGs * ROWS_PER_RG;
+	vector<RGData> smallData(smallRGs);
+	RGData largeData;
+	Rand rand;
+	Row row;
+
+	for (uint32_t i = 0; i < smallRGs; i++)
+		fillRowGroup(smallRG, smallData[i], rand, keyRange);
+	// half of the probes find a match
+	fillRowGroup(largeRG, largeData, rand, keyRange * 2);
+
+	TupleJoiner tj(smallRG, largeRG, 0, 0, INNER);
+	tj.setInUM();
+
+	BenchResult build("TupleJoiner_insert");
+	build.iterations = 1;
+	uint64_t start = utils::monotonicUsec();
+	for (uint32_t i = 0; i < smallRGs; i++)
+	{
+		smallRG.setData(&smallData[i]);
+		smallRG.initRow(&row);
+		smallRG.getRow(0, &row);
+		for (uint32_t j = 0; j < ROWS_PER_RG; j++, row.nextRow())
+			tj.insert(row);
+	}
+	tj.doneInserting();
+	build.usec = utils::monotonicUsec() - start;
+	build.items = (uint64_t)smallRGs * ROWS_PER_RG;
+	build.bytes = build.items * smallRG.getRowSize();
+	results.push_back(build);
+
+	vector<Row::Pointer> matches;
+	uint64_t found = 0;
+	BenchResult probe("TupleJoiner_probe");
+	probe.iterations = probes;
+	largeRG.setData(&largeData);
+	largeRG.initRow(&row);
+	start = utils::monotonicUsec();
+	for (uint32_t i = 0; i < probes; i++)
+	{
+		largeRG.getRow(0, &row);
+		for (uint32_t j = 0; j < ROWS_PER_RG; j++, row.nextRow())
+		{
+			tj.match(row, j, 0, &matches);
+			found += matches.size();
+		}
+	}
+	probe.usec = utils::monotonicUsec() - start;
+	probe.items = (uint64_t)probes * ROWS_PER_RG;
+	probe.bytes = probe.items * largeRG.getRowSize();
+	results.push_back(probe);
+
+	if (found == 0)
+		cerr << "TupleJoiner_probe: no matches" << endl;
+}
+
+//------------------------------------------------------------------------------
+// RowAggregation: GROUP BY a 1000-value key with SUM and COUNT, as the PM
+// side of a grouped aggregate does it
+//------------------------------------------------------------------------------
+void benchAggregation(uint32_t scale, vector<BenchResult>& results)
+{
+	RowGroup inRG = makeRowGroup(2), outRG = makeRowGroup(3);
+	RGData inData, outData;
+	Rand rand;
+	vector<SP_ROWAGG_GRPBY_t> groupBy;
+	vector<SP_ROWAGG_FUNC_t> functions;
+
+	fillRowGroup(inRG, inData, rand, 1000);
+	groupBy.push_back(SP_ROWAGG_GRPBY_t(new RowAggGroupByCol(0, 0)));
+	functions.push_back(SP_ROWAGG_FUNC_t(new RowAggFunctionCol(ROWAGG_SUM, ROWAGG_FUNCT_UNDEFINE, 1, 1)));
+	functions.push_back(SP_ROWAGG_FUNC_t(new RowAggFunctionCol(ROWAGG_COUNT_COL_NAME, ROWAGG_FUNCT_UNDEFINE, 1, 2)));
+
+	RowAggregation agg(groupBy, functions);
+	outData.reinit(outRG);
+	outRG.setData(&outData);
+	agg.setInputOutput(inRG, &outRG);
+
+	BenchResult r("RowAggregation_addRowGroup");
+	r.iterations = 50 * scale;
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < r.iterations; i++)
+		agg.addRowGroup(&inRG);
+	agg.endOfInput();
+	r.usec = utils::monotonicUsec() - start;
+	r.items = r.iterations * ROWS_PER_RG;
+	r.bytes = r.items * inRG.getRowSize();
+	results.push_back(r);
+}
+
+//------------------------------------------------------------------------------
+// LimitedOrderBy: ORDER BY col DESC LIMIT 1000
+//------------------------------------------------------------------------------
+void benchOrderBy(uint32_t scale, vector<BenchResult>& results)
+{
+	RowGroup rg = makeRowGroup(4);
+	RGData data;
+	Rand rand;
+	Row row;
+	ResourceManager rm;
+	JobInfo jobInfo(rm);
+
+	fillRowGroup(rg, data, rand, numeric_limits<int32_t>::max());
+	jobInfo.umMemLimit.reset(new int64_t(numeric_limits<int64_t>::max()));
+	jobInfo.orderByColVec.push_back(make_pair(0U, false));
+	jobInfo.limitStart = 0;
+	jobInfo.limitCount = 1000;
+
+	LimitedOrderBy orderBy;
+	orderBy.initialize(rg, jobInfo);
+
+	BenchResult r("LimitedOrderBy_processRow");
+	r.iterations = 50 * scale;
+	rg.initRow(&row);
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < r.iterations; i++)
+	{
+		rg.getRow(0, &row);
+		for (uint32_t j = 0; j < ROWS_PER_RG; j++, row.nextRow())
+			orderBy.processRow(row);
+	}
+	orderBy.finalize();
+	r.usec = utils::monotonicUsec() - start;
+	r.items = r.iterations * ROWS_PER_RG;
+	r.bytes = r.items * rg.getRowSize();
+	results.push_back(r);
+}
+
+//------------------------------------------------------------------------------
+// ByteStream/RGData: serialize a full RowGroup and read it back, as every
+// PM->UM and UM->FE band does
+//------------------------------------------------------------------------------
+void benchSerialize(uint32_t scale, vector<BenchResult>& results)
+{
+	RowGroup rg = makeRowGroup(8);
+	RGData data;
+	Rand rand;
+	ByteStream bs;
+
+	fillRowGroup(rg, data, rand, 1000000);
+
+	BenchResult r("RGData_serialize_roundtrip");
+	r.iterations = 500 * scale;
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < r.iterations; i++)
+	{
+		RGData copy;
+		bs.restart();
+		rg.serializeRGData(bs);
+		r.bytes += bs.length();
+		copy.deserialize(bs);
+	}
+	r.usec = utils::monotonicUsec() - start;
+	r.items = r.iterations * ROWS_PER_RG;
+	results.push_back(r);
+}
+
+//------------------------------------------------------------------------------
+// IDBCompressInterface: compress and decompress one 4MB chunk of column data
+//------------------------------------------------------------------------------
+void benchCompression(uint32_t scale, vector<BenchResult>& results)
+{
+	const uint32_t chunkSize = 4 * 1024 * 1024;
+	IDBCompressInterface compressor;
+	boost::scoped_array<int64_t> chunk(new int64_t[chunkSize / 8]);
+	uint64_t maxOut = IDBCompressInterface::maxCompressedSize(chunkSize);
+	boost::scoped_array<unsigned char> compressed(new unsigned char[maxOut]);
+	boost::scoped_array<unsigned char> uncompressed(new unsigned char[chunkSize]);
+	unsigned int compressedLen = 0, outLen;
+	Rand rand;
+
+	// a slowly increasing key with some noise compresses about as well as
+	// typical fact table columns
+	for (uint32_t i = 0; i < chunkSize / 8; i++)
+		chunk[i] = i / 16 + rand.range(64);
+
+	BenchResult c("IDBCompress_compress");
+	c.iterations = 20 * scale;
+	uint64_t start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < c.iterations; i++)
+	{
+		compressedLen = maxOut;
+		if (compressor.compressBlock(reinterpret_cast<const char*>(chunk.get()), chunkSize,
+		  compressed.get(), compressedLen) != 0)
+			throw runtime_error("compressBlock failed");
+	}
+	c.usec = utils::monotonicUsec() - start;
+	c.items = c.iterations;
+	c.bytes = c.iterations * chunkSize;
+	results.push_back(c);
+
+	BenchResult u("IDBCompress_uncompress");
+	u.iterations = 20 * scale;
+	start = utils::monotonicUsec();
+	for (uint64_t i = 0; i < u.iterations; i++)
+	{
+		outLen = chunkSize;
+		if (compressor.uncompressBlock(reinterpret_cast<const char*>(compressed.get()),
+		  compressedLen, uncompressed.get(), outLen) != 0)
+			throw runtime_error("uncompressBlock failed");
+	}
+	u.usec = utils::monotonicUsec() - start;
+	u.items = u.iterations;
+	u.bytes = u.iterations * chunkSize;
+	results.push_back(u);
+}
+
+struct Benchmark
+{
+	const char* name;
+	BenchFcn fcn;
+};
+
+const Benchmark benchmarks[] =
+{
+	{ "p_Col", benchColumn },
+	{ "p_Dictionary", benchDictionary },
+	{ "TupleJoiner", benchJoiner },
+	{ "RowAggregation", benchAggregation },
+	{ "LimitedOrderBy", benchOrderBy },
+	{ "RGData", benchSerialize },
+	{ "IDBCompress", benchCompression },
+	{ 0, 0 }
+};
+
+void usage()
+{
+	cout << "Usage: idbbench [-s scale] [-b name] [-l] [-h]" << endl
+		<< "  Runs microbenchmarks on synthetic data and prints one CSV line per result." << endl
+		<< "  -s scale  multiply the work done by each benchmark (default 1)" << endl
+		<< "  -b name   run only the benchmarks whose name starts with 'name'" << endl
+		<< "  -l        list the benchmarks" << endl
+		<< "  -h        display this help" << endl;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t scale = 1;
+	string only;
+	int c;
+
+	opterr = 0;
+	while ((c = getopt(argc, argv, "s:b:lh")) != EOF)
+		switch (c)
+		{
+		case 's':
+			scale = atoi(optarg);
+			if (scale == 0)
+				scale = 1;
+			break;
+		case 'b':
+			only = optarg;
+			break;
+		case 'l':
+			for (int i = 0; benchmarks[i].name; i++)
+				cout << benchmarks[i].name << endl;
+			return 0;
+		case 'h':
+		case '?':
+		default:
+			usage();
+			return (c == 'h' ? 0 : 1);
+		}
+
+	cout << "benchmark,iterations,items,bytes,usec,items_per_sec,mb_per_sec" << endl;
+
+	int rc = 0;
+	for (int i = 0; benchmarks[i].name; i++)
+	{
+		if (!only.empty() && string(benchmarks[i].name).compare(0, only.length(), only) != 0)
+			continue;
+
+		vector<BenchResult> results;
+		try
+		{
+			benchmarks[i].fcn(scale, results);
+		}
+		catch (exception& e)
+		{
+			cerr << benchmarks[i].name << ": " << e.what() << endl;
+			rc = 1;
+			continue;
+		}
+
+		for (uint32_t j = 0; j < results.size(); j++)
+		{
+			const BenchResult& r = results[j];
+			double secs = (r.usec ? r.usec : 1) / 1000000.0;
+			cout << r.name << "," << r.iterations << "," << r.items << "," << r.bytes << ","
+				<< r.usec << "," << (uint64_t)(r.items / secs) << ","
+				<< (r.bytes / secs) / (1024 * 1024) << endl;
+		}
+	}
+
+	return rc;
+}
+// vim:ts=4 sw=4:
@@ -0,0 +1,264 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+using namespace std;
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include "configcpp.h"
+
+#include "metrics.h"
+
+namespace
+{
+const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+
+// name{labels,extra} with the braces left out when there are no labels
+void writeSeries(ostream& os, const string& name, const string& labels,
+	const string& extra = "")
+{
+	os << name;
+	if (!labels.empty() || !extra.empty())
+	{
+		os << "{" << labels;
+		if (!labels.empty() && !extra.empty())
+			os << ",";
+		os << extra << "}";
+	}
+	os << " ";
+}
+
+boost::mutex instanceLock;
+utils::Metrics* metricsInstance = 0;
+}
+
+namespace utils
+{
+
+LatencyHistogram::LatencyHistogram() : fSum(0)
+{
+	for (uint32_t i = 0; i < BUCKETS; i++)
+		fCounts[i] = 0;
+}
+
+uint64_t LatencyHistogram::bucketMax(uint32_t b)
+{
+	if (b < SUB_COUNT)
+		return b;
+	uint32_t mag = (b - SUB_COUNT) / SUB_COUNT + SUB_BITS;
+	uint64_t sub = (b - SUB_COUNT) % SUB_COUNT;
+	uint32_t shift = mag - SUB_BITS;
+	return ((SUB_COUNT + sub) << shift) + ((1ULL << shift) - 1);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+	uint64_t ret = 0;
+	for (uint32_t i = 0; i < BUCKETS; i++)
+		ret += fCounts[i];
+	return ret;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+	uint64_t counts[BUCKETS];
+	uint64_t total = 0;
+	uint32_t i;
+
+	// work from one snapshot so the total and the walk agree
+	for (i = 0; i < BUCKETS; i++)
+		total += (counts[i] = fCounts[i]);
+	if (total == 0)
+		return 0;
+
+	uint64_t target = (uint64_t) (q * total + 0.5);
+	if (target == 0)
+		target = 1;
+	uint64_t seen = 0;
+	for (i = 0; i < BUCKETS; i++)
+	{
+		seen += counts[i];
+		if (seen >= target)
+			return bucketMax(i);
+	}
+	return bucketMax(BUCKETS - 1);
+}
+
+Metrics::Metrics() : fDumpInterval(0)
+{
+}
+
+Metrics* Metrics::instance()
+{
+	boost::mutex::scoped_lock lk(instanceLock);
+	if (!metricsInstance)
+		metricsInstance = new Metrics();
+	return metricsInstance;
+}
+
+LatencyHistogram* Metrics::histogram(const string& name, const string& labels,
+	const string& help)
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	Family& f = fFamilies[name];
+	f.isCounter = false;
+	if (f.help.empty())
+		f.help = help;
+	boost::shared_ptr<LatencyHistogram>& h = f.histograms[labels];
+	if (!h)
+		h.reset(new LatencyHistogram());
+	return h.get();
+}
+
+MetricCounter* Metrics::counter(const string& name, const string& labels,
+	const string& help)
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	Family& f = fFamilies[name];
+	f.isCounter = true;
+	if (f.help.empty())
+		f.help = help;
+	boost::shared_ptr<MetricCounter>& c = f.counters[labels];
+	if (!c)
+		c.reset(new MetricCounter());
+	return c.get();
+}
+
+void Metrics::writePrometheus(ostream& os)
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	map<string, Family>::const_iterator fit;
+
+	for (fit = fFamilies.begin(); fit != fFamilies.end(); ++fit)
+	{
+		const string& name = fit->first;
+		const Family& f = fit->second;
+
+		if (!f.help.empty())
+			os << "# HELP " << name << " " << f.help << "\n";
+		os << "# TYPE " << name << (f.isCounter ? " counter" : " summary") << "\n";
+
+		if (f.isCounter)
+		{
+			map<string, boost::shared_ptr<MetricCounter> >::const_iterator it;
+			for (it = f.counters.begin(); it != f.counters.end(); ++it)
+			{
+				writeSeries(os, name, it->first);
+				os << it->second->value() << "\n";
+			}
+			continue;
+		}
+
+		map<string, boost::shared_ptr<LatencyHistogram> >::const_iterator it;
+		for (it = f.histograms.begin(); it != f.histograms.end(); ++it)
+		{
+			const LatencyHistogram& h = *it->second;
+			for (uint32_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++)
+			{
+				ostringstream q;
+				q << "quantile=\"" << quantiles[i] << "\"";
+				writeSeries(os, name, it->first, q.str());
+				os << h.percentile(quantiles[i]) << "\n";
+			}
+			writeSeries(os, name + "_sum", it->first);
+			os << h.sum() << "\n";
+			writeSeries(os, name + "_count", it->first);
+			os << h.count() << "\n";
+		}
+	}
+}
+
+void Metrics::startDumper(const string& processName)
+{
+	config::Config* cf = config::Config::makeConfig();
+	string val = cf->getConfig("Metrics", "DumpInterval");
+	if (val.empty() || atoi(val.c_str()) <= 0)
+		return;
+
+	string dir = cf->getConfig("Metrics", "DumpDir");
+	if (dir.empty())
+#ifdef _MSC_VER
+		dir = "C:/Calpont/log/metrics";
+#else
+		dir = "/var/log/Calpont/metrics";
+#endif
+
+	boost::mutex::scoped_lock lk(fMutex);
+	if (fDumpInterval > 0)
+		return;
+	fDumpInterval = atoi(val.c_str());
+	fDumpDir = dir;
+	fDumpFile = dir + "/" + processName + ".prom";
+	boost::thread t(boost::bind(&Metrics::dumpLoop, this));
+}
+
+void Metrics::dumpLoop()
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	uint32_t interval = fDumpInterval;
+	lk.unlock();
+
+	while (true)
+	{
+		sleep(interval);
+		dump();
+	}
+}
+
+void Metrics::dump()
+{
+	boost::mutex::scoped_lock lk(fMutex);
+	string dir = fDumpDir;
+	string file = fDumpFile;
+	lk.unlock();
+
+	if (file.empty())
+		return;
+
+	// the default dir isn't made by the install, and someone may clean it out
+	try
+	{
+		boost::filesystem::create_directories(dir);
+	}
+	catch (std::exception&)
+	{
+		return;
+	}
+
+	// write a temp file and rename it so readers never see a partial dump
+	string tmpName = file + ".tmp";
+	{
+		ofstream out(tmpName.c_str());
+		if (!out)
+			return;
+		writePrometheus(out);
+		if (!out)
+			return;
+	}
+	rename(tmpName.c_str(), file.c_str());
+}
+
+}
+// vim:ts=4 sw=4:
@@ -0,0 +1,181 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef COMMON_METRICS_H__
+#define COMMON_METRICS_H__
+
+#include <stdint.h>
+#include <string>
+#include <map>
+#include <iosfwd>
+#include <boost/thread/mutex.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "atomicops.h"
+#include "profileclock.h"
+
+#if defined(_MSC_VER) && defined(xxxMETRICS_DLLEXPORT)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+namespace utils
+{
+
+/** @brief A fixed-size log-linear latency histogram.
+ *
+ * Values below 16 get a bucket each; above that every power of two is split
+ * into 16 linear sub-buckets, so any recorded value is reported to within
+ * 1/16th (about 6%) of itself.  record() is a couple of atomic adds and never
+ * locks, so it can sit in hot paths.  Readers see a slightly fuzzy snapshot
+ * while writers are active, which is fine for monitoring.
+ */
+class LatencyHistogram
+{
+public:
+	EXPORT LatencyHistogram();
+
+	/** @brief add one sample, normally in usec */
+	inline void record(uint64_t value)
+	{
+		atomicops::atomicInc(&fCounts[bucketFor(value)]);
+		atomicops::atomicAdd(&fSum, value);
+	}
+
+	EXPORT uint64_t count() const;
+	uint64_t sum() const { return fSum; }
+
+	/** @brief the smallest value v such that a fraction q of the samples are <= v,
+	 *  rounded up to its bucket's upper bound.  0 if there are no samples.
+	 */
+	EXPORT uint64_t percentile(double q) const;
+
+private:
+	LatencyHistogram(const LatencyHistogram&);
+	LatencyHistogram& operator=(const LatencyHistogram&);
+
+	enum {
+		SUB_BITS = 4,
+		SUB_COUNT = 1 << SUB_BITS,
+		BUCKETS = SUB_COUNT + (64 - SUB_BITS) * SUB_COUNT
+	};
+
+	static inline uint32_t bucketFor(uint64_t v)
+	{
+		if (v < SUB_COUNT)
+			return v;
+#ifdef __GNUC__
+		uint32_t mag = 63 - __builtin_clzll(v);
+#else
+		uint32_t mag = 63;
+		while (!(v >> mag))
+			mag--;
+#endif
+		return SUB_COUNT + (mag - SUB_BITS) * SUB_COUNT +
+			((v >> (mag - SUB_BITS)) & (SUB_COUNT - 1));
+	}
+	static uint64_t bucketMax(uint32_t b);
+
+	volatile uint64_t fCounts[BUCKETS];
+	volatile uint64_t fSum;
+};
+
+/** @brief a monotonically increasing count */
+class MetricCounter
+{
+public:
+	MetricCounter() : fValue(0) { }
+	inline void add(uint64_t n = 1) { atomicops::atomicAdd(&fValue, n); }
+	uint64_t value() const { return fValue; }
+private:
+	volatile uint64_t fValue;
+};
+
+/** @brief Times the enclosing scope into a histogram, in usec. */
+class ScopedLatency
+{
+public:
+	explicit ScopedLatency(LatencyHistogram* h) : fHist(h), fStart(monotonicUsec()) { }
+	~ScopedLatency() { fHist->record(monotonicUsec() - fStart); }
+private:
+	LatencyHistogram* fHist;
+	uint64_t fStart;
+};
+
+/** @brief The per-process registry of histograms and counters.
+ *
+ * Metrics are created on first use and live for the life of the process, so
+ * callers should look them up once and keep the pointer.  A metric is
+ * identified by its name plus an optional Prometheus label set, e.g.
+ * histogram("idb_threadpool_queue_wait_usec", "pool=\"oob\",priority=\"high\"").
+ *
+ * If Metrics/DumpInterval is set in Calpont.xml, startDumper() writes all
+ * metrics every that many seconds to <Metrics/DumpDir>/<process>.prom in the
+ * Prometheus text format, replacing the file atomically and creating the
+ * directory if it's missing.  That is the format
+ * node_exporter's textfile collector reads.  Histograms are exported as
+ * summaries with the 0.5, 0.9, 0.99 and 0.999 quantiles.
+ */
+class Metrics
+{
+public:
+	EXPORT static Metrics* instance();
+
+	EXPORT LatencyHistogram* histogram(const std::string& name, const std::string& labels = "",
+		const std::string& help = "");
+	EXPORT MetricCounter* counter(const std::string& name, const std::string& labels = "",
+		const std::string& help = "");
+
+	EXPORT void writePrometheus(std::ostream& os);
+
+	/** @brief start the periodic dump thread, if it is configured */
+	EXPORT void startDumper(const std::string& processName);
+
+	/** @brief write the dump file now */
+	EXPORT void dump();
+
+private:
+	Metrics();
+	Metrics(const Metrics&);
+	Metrics& operator=(const Metrics&);
+
+	void dumpLoop();
+
+	struct Family
+	{
+		std::string help;
+		bool isCounter;
+		std::map<std::string, boost::shared_ptr<LatencyHistogram> > histograms;
+		std::map<std::string, boost::shared_ptr<MetricCounter> > counters;
+	};
+
+	boost::mutex fMutex;
+	std::map<std::string, Family> fFamilies;
+	std::string fDumpDir;
+	std::string fDumpFile;
+	uint32_t fDumpInterval;
+};
+
+}
+
+#undef EXPORT
+
+#endif
+// vim:ts=4 sw=4:
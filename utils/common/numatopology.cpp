@@ -0,0 +1,112 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#ifndef _MSC_VER
+#include <pthread.h>
+#include <sched.h>
+#endif
+using namespace std;
+
+#include <boost/thread/mutex.hpp>
+
+#define NUMATOPOLOGY_DLLEXPORT
+#include "numatopology.h"
+#undef NUMATOPOLOGY_DLLEXPORT
+
+namespace
+{
+boost::mutex instanceLock;
+utils::NumaTopology* topologyInstance = 0;
+
+// parses a sysfs cpulist, e.g. "0-7,16-23"
+void parseCpuList(const string& s, vector<uint32_t>& out)
+{
+	istringstream is(s);
+	string range;
+
+	while (getline(is, range, ','))
+	{
+		if (range.empty())
+			continue;
+		string::size_type dash = range.find('-');
+		uint32_t first = strtoul(range.c_str(), 0, 10);
+		uint32_t last = (dash == string::npos ? first : strtoul(range.c_str() + dash + 1, 0, 10));
+		for (uint32_t cpu = first; cpu <= last; cpu++)
+			out.push_back(cpu);
+	}
+}
+}
+
+namespace utils
+{
+
+NumaTopology::NumaTopology()
+{
+#ifndef _MSC_VER
+	// node numbers are dense in practice; stop at the first one missing
+	for (uint32_t node = 0; ; node++)
+	{
+		ostringstream filename;
+		filename << "/sys/devices/system/node/node" << node << "/cpulist";
+		ifstream in(filename.str().c_str());
+		string line;
+		if (!in || !getline(in, line))
+			break;
+
+		vector<uint32_t> cpus;
+		parseCpuList(line, cpus);
+		// memory-only nodes have no CPUs to run on
+		if (!cpus.empty())
+			fNodeCpus.push_back(cpus);
+	}
+#endif
+	if (fNodeCpus.empty())
+		fNodeCpus.resize(1);
+}
+
+NumaTopology* NumaTopology::instance()
+{
+	boost::mutex::scoped_lock lk(instanceLock);
+	if (!topologyInstance)
+		topologyInstance = new NumaTopology();
+	return topologyInstance;
+}
+
+bool NumaTopology::bindThread(uint32_t node) const
+{
+#ifdef _MSC_VER
+	return false;
+#else
+	if (node >= fNodeCpus.size() || fNodeCpus[node].empty())
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (uint32_t i = 0; i < fNodeCpus[node].size(); i++)
+		if (fNodeCpus[node][i] < CPU_SETSIZE)
+			CPU_SET(fNodeCpus[node][i], &set);
+
+	return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0);
+#endif
+}
+
+}
+// vim:ts=4 sw=4:
@@ -0,0 +1,71 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef COMMON_NUMATOPOLOGY_H__
+#define COMMON_NUMATOPOLOGY_H__
+
+#include <stdint.h>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(xxxNUMATOPOLOGY_DLLEXPORT)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+namespace utils
+{
+
+/** @brief The NUMA nodes of this machine and the CPUs that belong to each.
+ *
+ * Read once from /sys/devices/system/node.  Where that isn't available (non-Linux,
+ * or a kernel without NUMA support) the machine looks like a single node and
+ * bindThread() does nothing.
+ *
+ * Memory placement relies on the kernel's first-touch policy: a page is backed by
+ * the node of the thread that first writes it, so memory filled by threads bound
+ * to a node stays on that node.
+ */
+class NumaTopology
+{
+public:
+	EXPORT static NumaTopology* instance();
+
+	uint32_t nodeCount() const { return fNodeCpus.size(); }
+	const std::vector<uint32_t>& cpus(uint32_t node) const { return fNodeCpus[node]; }
+
+	/** @brief restrict the calling thread to the CPUs of node.  Returns false
+	 *  if it couldn't be done, in which case the thread is left as it was.
+	 */
+	EXPORT bool bindThread(uint32_t node) const;
+
+private:
+	NumaTopology();
+	NumaTopology(const NumaTopology&);
+	NumaTopology& operator=(const NumaTopology&);
+
+	std::vector<std::vector<uint32_t> > fNodeCpus;
+};
+
+}
+
+#undef EXPORT
+
+#endif
+// vim:ts=4 sw=4:
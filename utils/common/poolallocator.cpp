@@ -25,37 +25,87 @@
 #include <cassert>
 
 #include "poolallocator.h"
+#include "queryarena.h"
 
 using namespace std;
 using namespace boost;
 
+namespace
+{
+// arena memory is owned by the arena
+struct NullDeleter
+{
+	void operator()(uint8_t *) { }
+};
+}
+
 namespace utils
 {
 
 PoolAllocator & PoolAllocator::operator=(const PoolAllocator &v)
 {
+	deallocateAll();
+	if (allocSize != v.allocSize)
+		freeWindows.clear();
 	allocSize = v.allocSize;
 	tmpSpace = v.tmpSpace;
-	deallocateAll();
+	setArena(v.arena.get());
 	return *this;
 }
 
+void PoolAllocator::setArena(QueryArena *q)
+{
+	if (q != arena.get()) {
+		freeWindows.clear();
+		freeOOB.clear();
+	}
+	arena.reset(q);
+}
+
 void PoolAllocator::deallocateAll()
 {
 	capacityRemaining = 0;
 	nextAlloc = NULL;
 	memUsage = 0;
+	if (arena.get()) {
+		for (uint32_t i = 0; i < mem.size(); i++)
+			freeWindows.push_back(mem[i].get());
+		for (OutOfBandMap::iterator it = oob.begin(); it != oob.end(); ++it)
+			freeOOB.insert(pair<uint64_t, uint8_t *>(it->second.size, it->second.mem.get()));
+	}
 	mem.clear();
 	oob.clear();
 }
 
+// an out-of-band chunk from the arena; a free one up to twice the size will do
+void * PoolAllocator::arenaOOB(uint64_t *size)
+{
+	multimap<uint64_t, uint8_t *>::iterator it = freeOOB.lower_bound(*size);
+	void *ret;
+
+	if (it != freeOOB.end() && it->first / 2 <= *size) {
+		*size = it->first;
+		ret = (void *) it->second;
+		freeOOB.erase(it);
+		return ret;
+	}
+	return arena.allocate(*size);
+}
+
 void PoolAllocator::newBlock()
 {
 	shared_array<uint8_t> next;
 
 	capacityRemaining = allocSize;
 	if (!tmpSpace || mem.size() == 0) {
-		next.reset(new uint8_t[allocSize]);
+		if (arena.get() && !freeWindows.empty()) {
+			next.reset(freeWindows.back(), NullDeleter());
+			freeWindows.pop_back();
+		}
+		else if (arena.get())
+			next.reset((uint8_t *) arena.allocate(allocSize), NullDeleter());
+		else
+			next.reset(new uint8_t[allocSize]);
 		mem.push_back(next);
 		nextAlloc = next.get();
 	}
@@ -70,8 +120,11 @@ void * PoolAllocator::allocate(uint64_t size)
 	if (size > allocSize) {
 		OOBMemInfo memInfo;
 		
+		if (arena.get())
+			memInfo.mem.reset((uint8_t *) arenaOOB(&size), NullDeleter());
+		else
+			memInfo.mem.reset(new uint8_t[size]);
 		memUsage += size;
-		memInfo.mem.reset(new uint8_t[size]);
 		memInfo.size = size;
 		ret = (void *) memInfo.mem.get();
 		oob[ret] = memInfo;
@@ -94,6 +147,8 @@ void PoolAllocator::deallocate(void *p)
 	if (it == oob.end())
 		return;
 	memUsage -= it->second.size;
+	if (arena.get())
+		freeOOB.insert(pair<uint64_t, uint8_t *>(it->second.size, it->second.mem.get()));
 	oob.erase(it);
 }
 
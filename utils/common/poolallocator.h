@@ -32,6 +32,8 @@
 #include <map>
 #include <boost/shared_array.hpp>
 
+#include "queryarena.h"
+
 namespace utils {
 
 class PoolAllocator
@@ -50,7 +52,8 @@ public:
 		tmpSpace(p.tmpSpace),
 		capacityRemaining(0),
 		memUsage(0),
-		nextAlloc(0) { }
+		nextAlloc(0),
+		arena(p.arena.get()) { }
 	virtual ~PoolAllocator() {}
 
 	PoolAllocator & operator=(const PoolAllocator &);
@@ -62,6 +65,14 @@ public:
 	inline uint64_t getMemUsage() const { return memUsage; }
 	unsigned getWindowSize() const { return allocSize; }
 
+	/* Take windows and out-of-band chunks from the calling thread's arena in q instead of
+	   the heap.  They are charged to the query's budget by the arena and only freed when
+	   it is released, so deallocate() and deallocateAll() keep them on this allocator's
+	   free lists for its later allocations, and getMemUsage() no longer needs to be
+	   accounted separately.  Set it before the first allocation. */
+	void setArena(QueryArena *q);
+	QueryArena * getArena() const { return arena.get(); }
+
 private:
 	void newBlock();
 
@@ -71,6 +82,10 @@ private:
 	unsigned capacityRemaining;
 	uint64_t memUsage;
 	uint8_t *nextAlloc;
+	QueryArena::Ref arena;
+	std::vector<uint8_t *> freeWindows;				// arena memory to reuse
+	std::multimap<uint64_t, uint8_t *> freeOOB;		// by size
+	void *arenaOOB(uint64_t *size);
 	
 	struct OOBMemInfo {
 		boost::shared_array<uint8_t> mem;
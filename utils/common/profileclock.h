@@ -0,0 +1,55 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef COMMON_PROFILECLOCK_H__
+#define COMMON_PROFILECLOCK_H__
+
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace utils
+{
+
+/** @brief wall clock in usec from an arbitrary fixed point; for intervals only */
+inline uint64_t monotonicUsec()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/** @brief CPU time consumed by the calling thread, in usec.  Always 0 where
+ *  the platform has no per-thread CPU clock.
+ */
+inline uint64_t threadCpuUsec()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+	return 0;
+#endif
+}
+
+}
+
+#endif
+// vim:ts=4 sw=4:
@@ -0,0 +1,121 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/******************************************************************************************
+* $Id$
+*
+******************************************************************************************/
+
+#include <new>
+
+#define QUERYARENA_DLLEXPORT
+#include "queryarena.h"
+#undef QUERYARENA_DLLEXPORT
+
+using namespace std;
+using namespace boost;
+
+namespace utils
+{
+
+QueryArena::ThreadArena::~ThreadArena()
+{
+	for (uint32_t i = 0; i < blocks.size(); i++)
+		delete [] blocks[i];
+}
+
+void * QueryArena::ThreadArena::newBlock(uint64_t size)
+{
+	uint8_t *block;
+	uint64_t blockSize = parent->blockSize;
+
+	/* Big requests get a block of their own so the rest of the current block
+	   isn't thrown away. */
+	bool dedicated = (size > blockSize / 2);
+	if (dedicated)
+		blockSize = size;
+
+	if (!parent->reserve(blockSize)) {
+		parent->giveBack(blockSize);
+		throw bad_alloc();
+	}
+	try {
+		block = new uint8_t[blockSize];
+		blocks.push_back(block);
+	}
+	catch (...) {
+		parent->giveBack(blockSize);
+		throw;
+	}
+	reserved += blockSize;
+
+	if (!dedicated) {
+		nextAlloc = block + size;
+		capacityRemaining = blockSize - size;
+	}
+	return (void *) block;
+}
+
+QueryArena::QueryArena(const Reserve &r, const Release &rel, unsigned bs) :
+	reserve(r), giveBack(rel), blockSize(bs)
+{
+}
+
+QueryArena::~QueryArena()
+{
+	release();
+}
+
+QueryArena::ThreadArena * QueryArena::threadArena()
+{
+	mutex::scoped_lock lk(arenaLock);
+	ThreadArena *&ret = arenas[this_thread::get_id()];
+
+	if (!ret)
+		ret = new ThreadArena(this);
+	return ret;
+}
+
+void QueryArena::release()
+{
+	uint64_t total = 0;
+	ArenaMap::iterator it;
+
+	mutex::scoped_lock lk(arenaLock);
+	for (it = arenas.begin(); it != arenas.end(); ++it) {
+		total += it->second->reserved;
+		delete it->second;
+	}
+	arenas.clear();
+	lk.unlock();
+
+	if (total > 0)
+		giveBack(total);
+}
+
+uint64_t QueryArena::getMemUsage()
+{
+	uint64_t ret = 0;
+	ArenaMap::iterator it;
+
+	mutex::scoped_lock lk(arenaLock);
+	for (it = arenas.begin(); it != arenas.end(); ++it)
+		ret += it->second->reserved;
+	return ret;
+}
+
+}
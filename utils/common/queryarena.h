@@ -0,0 +1,157 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/******************************************************************************************
+* $Id$
+*
+******************************************************************************************/
+
+/* A per-query arena.  Every thread that allocates from it gets its own ThreadArena,
+   a bump allocator over large blocks, so allocations never contend with each other.
+   Nothing is freed individually; all blocks go back at once when the query's arena
+   is released or destroyed.
+
+   Blocks are charged against a memory budget through the reserve callback as they
+   are created, and the exact total is handed back through the release callback at the
+   end.  The callbacks follow ResourceManager::getMemory()/returnMemory(): reserve charges
+   the amount even when it fails, so the arena returns it before throwing bad_alloc.
+*/
+
+#ifndef QUERYARENA_H_
+#define QUERYARENA_H_
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#if defined(_MSC_VER) && defined(xxxQUERYARENA_DLLEXPORT)
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+namespace utils {
+
+class QueryArena
+{
+public:
+	typedef boost::function<bool (int64_t)> Reserve;
+	typedef boost::function<void (int64_t)> Release;
+
+	EXPORT static const unsigned DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+	class ThreadArena
+	{
+	public:
+		inline void *allocate(uint64_t size);
+		uint64_t getMemUsage() const { return reserved; }
+
+	private:
+		friend class QueryArena;
+		explicit ThreadArena(QueryArena *q) :
+			parent(q), nextAlloc(0), capacityRemaining(0), reserved(0) { }
+		~ThreadArena();
+		ThreadArena(const ThreadArena &);
+		ThreadArena & operator=(const ThreadArena &);
+
+		void *newBlock(uint64_t size);
+
+		QueryArena *parent;
+		std::vector<uint8_t *> blocks;
+		uint8_t *nextAlloc;
+		uint64_t capacityRemaining;
+		uint64_t reserved;
+	};
+
+	EXPORT QueryArena(const Reserve &r, const Release &rel, unsigned blockSize = DEFAULT_BLOCK_SIZE);
+	EXPORT ~QueryArena();
+
+	/* The calling thread's arena.  Hot paths should look it up once and keep it,
+	   e.g. in a Ref. */
+	EXPORT ThreadArena * threadArena();
+	void *allocate(uint64_t size) { return threadArena()->allocate(size); }
+
+	/* For an allocator that's used by one thread at a time: keeps the ThreadArena
+	   and only looks it up again when a different thread allocates. */
+	class Ref
+	{
+	public:
+		Ref() : query(0), arena(0) { }
+		explicit Ref(QueryArena *q) : query(q), arena(0) { }
+
+		void reset(QueryArena *q) { query = q; arena = 0; }
+		QueryArena * get() const { return query; }
+
+		inline void *allocate(uint64_t size);
+
+	private:
+		QueryArena *query;
+		ThreadArena *arena;
+		boost::thread::id owner;
+	};
+
+	/* Frees every block of every thread and returns the budget.  Nothing allocated
+	   from this arena may be used afterward. */
+	EXPORT void release();
+
+	EXPORT uint64_t getMemUsage();
+	unsigned getBlockSize() const { return blockSize; }
+
+private:
+	QueryArena(const QueryArena &);
+	QueryArena & operator=(const QueryArena &);
+
+	typedef std::map<boost::thread::id, ThreadArena *> ArenaMap;
+	ArenaMap arenas;
+	boost::mutex arenaLock;
+	Reserve reserve;
+	Release giveBack;
+	unsigned blockSize;
+};
+
+inline void * QueryArena::Ref::allocate(uint64_t size)
+{
+	boost::thread::id me = boost::this_thread::get_id();
+
+	if (!arena || owner != me) {
+		arena = query->threadArena();
+		owner = me;
+	}
+	return arena->allocate(size);
+}
+
+inline void * QueryArena::ThreadArena::allocate(uint64_t size)
+{
+	void *ret;
+
+	size = (size + 7) & ~((uint64_t) 7);
+	if (size > capacityRemaining)
+		return newBlock(size);
+	ret = (void *) nextAlloc;
+	nextAlloc += size;
+	capacityRemaining -= size;
+	return ret;
+}
+
+}
+
+#undef EXPORT
+
+#endif
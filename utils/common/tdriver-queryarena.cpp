@@ -0,0 +1,181 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file
+ * QueryArena tests, and PoolAllocator on top of one.
+ */
+
+#include <new>
+using namespace std;
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "queryarena.h"
+#include "poolallocator.h"
+using namespace utils;
+
+namespace
+{
+
+const unsigned blockSize = 64 * 1024;
+
+// stands in for ResourceManager::getMemory()/returnMemory()
+struct Budget
+{
+	Budget(int64_t l) : limit(l), used(0) { }
+
+	bool reserve(int64_t amount) { used += amount; return used <= limit; }
+	void release(int64_t amount) { used -= amount; }
+
+	int64_t limit;
+	int64_t used;
+};
+
+QueryArena *newArena(Budget &b)
+{
+	return new QueryArena(boost::bind(&Budget::reserve, &b, _1),
+		boost::bind(&Budget::release, &b, _1), blockSize);
+}
+
+void allocateOne(QueryArena::Ref *r)
+{
+	r->allocate(64);
+}
+
+}
+
+class QueryArenaTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(QueryArenaTest);
+
+CPPUNIT_TEST(queryarena_budget_1);
+CPPUNIT_TEST(queryarena_ref_1);
+CPPUNIT_TEST(queryarena_pool_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+public:
+	/* blocks are charged as they're made, the total goes back at the end */
+	void queryarena_budget_1() {
+		Budget b(3 * blockSize);
+		QueryArena *q = newArena(b);
+
+		q->allocate(100);
+		q->allocate(100);
+		CPPUNIT_ASSERT(b.used == blockSize);
+		q->allocate(blockSize);			// a dedicated block
+		CPPUNIT_ASSERT(b.used == 2 * blockSize);
+		CPPUNIT_ASSERT(q->getMemUsage() == 2 * blockSize);
+
+		bool thrown = false;
+		try {
+			q->allocate(2 * blockSize);
+		}
+		catch (bad_alloc &) {
+			thrown = true;
+		}
+		CPPUNIT_ASSERT(thrown);
+		CPPUNIT_ASSERT(b.used == 2 * blockSize);
+
+		q->release();
+		CPPUNIT_ASSERT(b.used == 0);
+		delete q;
+		CPPUNIT_ASSERT(b.used == 0);
+	}
+
+	/* a Ref allocates from the arena of whichever thread uses it */
+	void queryarena_ref_1() {
+		Budget b(10 * blockSize);
+		QueryArena *q = newArena(b);
+		QueryArena::Ref r(q);
+
+		r.allocate(64);
+		r.allocate(64);
+		CPPUNIT_ASSERT(q->getMemUsage() == blockSize);
+
+		boost::thread t(allocateOne, &r);
+		t.join();
+		CPPUNIT_ASSERT(q->getMemUsage() == 2 * blockSize);
+
+		r.allocate(64);
+		CPPUNIT_ASSERT(q->getMemUsage() == 2 * blockSize);
+		delete q;
+		CPPUNIT_ASSERT(b.used == 0);
+	}
+
+	/* what a PoolAllocator frees it reuses instead of taking more of the arena */
+	void queryarena_pool_1() {
+		Budget b(100 * blockSize);
+		QueryArena *q = newArena(b);
+		PoolAllocator pa(4096);
+		uint64_t usage;
+		void *big, *big2;
+		int i, round;
+
+		pa.setArena(q);
+		for (round = 0; round < 5; round++) {
+			for (i = 0; i < 100; i++)
+				pa.allocate(1000);
+			if (round == 0)
+				usage = q->getMemUsage();
+			CPPUNIT_ASSERT(q->getMemUsage() == usage);
+			pa.deallocateAll();
+		}
+
+		big = pa.allocate(3 * blockSize);
+		usage = q->getMemUsage();
+		pa.deallocate(big);
+		big2 = pa.allocate(3 * blockSize - 100);
+		CPPUNIT_ASSERT(big2 == big);
+		CPPUNIT_ASSERT(q->getMemUsage() == usage);
+		pa.deallocate(big2);
+
+		// too small to stand in for a bigger one
+		big = pa.allocate(7 * blockSize);
+		CPPUNIT_ASSERT(big != big2);
+		CPPUNIT_ASSERT(q->getMemUsage() > usage);
+		pa.deallocateAll();
+
+		// another arena, the free lists go
+		Budget b2(100 * blockSize);
+		QueryArena *q2 = newArena(b2);
+		pa.setArena(q2);
+		pa.allocate(1000);
+		CPPUNIT_ASSERT(q2->getMemUsage() > 0);
+
+		delete q;
+		delete q2;
+		CPPUNIT_ASSERT(b.used == 0 && b2.used == 0);
+	}
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( QueryArenaTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
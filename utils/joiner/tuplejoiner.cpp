@@ -42,7 +42,8 @@ TupleJoiner::TupleJoiner(
 	uint32_t largeJoinColumn,
 	JoinType jt) :
 	smallRG(smallInput), largeRG(largeInput), joinAlg(INSERTING), joinType(jt),
-	threadCount(1), typelessJoin(false), bSignedUnsignedJoin(false), uniqueLimit(100), finished(false)
+	threadCount(1), typelessJoin(false), bSignedUnsignedJoin(false), uniqueLimit(100), finished(false),
+	keyOnlyMode(false)
 {
 	if (smallRG.usesStringTable()) {
 		STLPoolAllocator<pair<const int64_t, Row::Pointer> > alloc(64*1024*1024 + 1);
@@ -93,7 +94,7 @@ TupleJoiner::TupleJoiner(
 	smallRG(smallInput), largeRG(largeInput), joinAlg(INSERTING),
 	joinType(jt), threadCount(1), typelessJoin(true),
 	smallKeyColumns(smallJoinColumns), largeKeyColumns(largeJoinColumns),
-	bSignedUnsignedJoin(false), uniqueLimit(100), finished(false)
+	bSignedUnsignedJoin(false), uniqueLimit(100), finished(false), keyOnlyMode(false)
 {
 	STLPoolAllocator<pair<const TypelessData, Row::Pointer> > alloc(64*1024*1024 + 1);
 	_pool = alloc.getPoolAllocator();
@@ -137,7 +138,7 @@ TupleJoiner::TupleJoiner(
 	}
 }
 
-TupleJoiner::TupleJoiner() { }
+TupleJoiner::TupleJoiner() : keyOnlyMode(false) { }
 
 TupleJoiner::TupleJoiner(const TupleJoiner &j)
 {
@@ -167,7 +168,7 @@ void TupleJoiner::insert(Row &r, bool zeroTheRid)
 	if (zeroTheRid)
 		r.zeroRid();
 	updateCPData(r);
-	if (joinAlg == UM) {
+	if (useHashTables()) {
 		if (typelessJoin) {
                 ht->insert(pair<TypelessData, Row::Pointer>
                   (makeTypelessKey(r, smallKeyColumns, keyLength, &storedKeyAlloc),
@@ -192,9 +193,41 @@ void TupleJoiner::insert(Row &r, bool zeroTheRid)
 				sth->insert(pair<int64_t, Row::Pointer>(smallKey, r.getPointer()));
 		}
     }
-	else {
+	if (joinAlg != UM)
         rows.push_back(r.getPointer());
-    }
+}
+
+void TupleJoiner::setKeyOnly()
+{
+	if ((semiJoin() || antiJoin()) && !(joinType & (SCALAR | LARGEOUTER | SMALLOUTER | WITHFCNEXP)))
+		keyOnlyMode = true;
+}
+
+bool TupleJoiner::hasKey(const Row &r)
+{
+	if (typelessJoin) {
+		TypelessData key = makeTypelessKey(r, smallKeyColumns, keyLength, &storedKeyAlloc);
+		bool ret = (ht->find(key) != ht->end());
+		// insert() will make it again if it's new
+		storedKeyAlloc.truncateBy(key.len);
+		return ret;
+	}
+	else if (!smallRG.usesStringTable()) {
+		int64_t smallKey;
+		if (r.isUnsigned(smallKeyColumns[0]))
+			smallKey = (int64_t)(r.getUintField(smallKeyColumns[0]));
+		else
+			smallKey = r.getIntField(smallKeyColumns[0]);
+		if (UNLIKELY(smallKey == nullValueForJoinColumn))
+			smallKey = getJoinNullValue();
+		return (h->find(smallKey) != h->end());
+	}
+	else {
+		int64_t smallKey = r.getIntField(smallKeyColumns[0]);
+		if (UNLIKELY(smallKey == nullValueForJoinColumn))
+			smallKey = getJoinNullValue();
+		return (sth->find(smallKey) != sth->end());
+	}
 }
 
 void TupleJoiner::match(rowgroup::Row &largeSideRow, uint32_t largeRowIndex, uint32_t threadID,
@@ -224,6 +257,10 @@ void TupleJoiner::match(rowgroup::Row &largeSideRow, uint32_t largeRowIndex, uin
 			it = ht->find(largeKey);
 			if (it == ht->end() && !(joinType & (LARGEOUTER | MATCHNULLS)))
 				return;
+			if (keyOnlyMode && it != ht->end()) {
+				matches->push_back(it->second);
+				return;
+			}
 			range = ht->equal_range(largeKey);
 			for (; range.first != range.second; ++range.first)
 				matches->push_back(range.first->second);
@@ -242,6 +279,10 @@ void TupleJoiner::match(rowgroup::Row &largeSideRow, uint32_t largeRowIndex, uin
             it = h->find(largeKey);
             if (it == end() && !(joinType & (LARGEOUTER | MATCHNULLS)))
                 return;
+            if (keyOnlyMode && it != end()) {
+                matches->push_back(it->second);
+                return;
+            }
             range = h->equal_range(largeKey);
             //smallRG.initRow(&r);
             for (; range.first != range.second; ++range.first) {
@@ -260,6 +301,10 @@ void TupleJoiner::match(rowgroup::Row &largeSideRow, uint32_t largeRowIndex, uin
 			it = sth->find(largeKey);
 			if (it == sth->end() && !(joinType & (LARGEOUTER | MATCHNULLS)))
 				return;
+			if (keyOnlyMode && it != sth->end()) {
+				matches->push_back(it->second);
+				return;
+			}
 			range = sth->equal_range(largeKey);
 			//smallRG.initRow(&r);
 			for (; range.first != range.second; ++range.first) {
@@ -292,19 +337,28 @@ void TupleJoiner::match(rowgroup::Row &largeSideRow, uint32_t largeRowIndex, uin
 		if (!typelessJoin) {
 			if (!smallRG.usesStringTable()) {
 				iterator it;
-				for (it = h->begin(); it != h->end(); ++it)
+				for (it = h->begin(); it != h->end(); ++it) {
 					matches->push_back(it->second);
+					if (keyOnlyMode)
+						break;
+				}
 			}
 			else {
 				sthash_t::iterator it;
-				for (it = sth->begin(); it != sth->end(); ++it)
+				for (it = sth->begin(); it != sth->end(); ++it) {
 					matches->push_back(it->second);
+					if (keyOnlyMode)
+						break;
+				}
 			}
 		}
 		else {
 			thIterator it;
-			for (it = ht->begin(); it != ht->end(); ++it)
+			for (it = ht->begin(); it != ht->end(); ++it) {
 				matches->push_back(it->second);
+				if (keyOnlyMode)
+					break;
+			}
 		}
 	}
 }
@@ -389,6 +443,12 @@ void TupleJoiner::doneInserting()
 
 void TupleJoiner::setInPM()
 {
+	// the PM builds its own table; the key set isn't needed anymore
+	if (keyOnlyMode && joinAlg == INSERTING) {
+		resetHashTables();
+		if (typelessJoin)
+			storedKeyAlloc.deallocateAll();
+	}
 	joinAlg = PM;
 }
 
@@ -401,19 +461,24 @@ void TupleJoiner::setInUM()
 	if (joinAlg == UM)
 		return;
 
-	joinAlg = UM;
-	size = rows.size();
-	smallRG.initRow(&smallRow);
+	// in key-only mode the hash tables already have every row
+	if (keyOnlyMode && joinAlg == INSERTING)
+		joinAlg = UM;
+	else {
+		joinAlg = UM;
+		size = rows.size();
+		smallRG.initRow(&smallRow);
 #ifdef TJ_DEBUG
-	cout << "converting array to hash, size = " << size << "\n";
+		cout << "converting array to hash, size = " << size << "\n";
 #endif
-	for (i = 0; i < size; i++) {
-		smallRow.setPointer(rows[i]);
-		insert(smallRow);
-	}
+		for (i = 0; i < size; i++) {
+			smallRow.setPointer(rows[i]);
+			insert(smallRow);
+		}
 #ifdef TJ_DEBUG
-	cout << "done\n";
+		cout << "done\n";
 #endif
+	}
 	rows.swap(empty);
 	if (typelessJoin) {
 		tmpKeyAlloc.reset(new FixedAllocator[threadCount]);
@@ -524,12 +589,79 @@ void TupleJoiner::getUnmarkedRows(vector<Row::Pointer> *out)
 	}
 }
 
+namespace {
+struct RowHashLess {
+	bool operator()(const pair<uint64_t, Row::Pointer> &a, const pair<uint64_t, Row::Pointer> &b) const
+	{ return a.first < b.first; }
+};
+}
+
+bool TupleJoiner::canonicalizeSmallSide(uint64_t *fingerprint)
+{
+	Row r1, r2;
+	vector<pair<uint64_t, Row::Pointer> > hashed;
+	vector<uint32_t> allCols;
+	messageqcpp::ByteStream bs;
+	uint32_t i;
+
+	idbassert(inPM());
+	smallRG.initRow(&r1);
+	smallRG.initRow(&r2);
+	for (i = 0; i < smallRG.getColumnCount(); i++)
+		allCols.push_back(i);
+
+	/* Row::hash() is 32 bits; two seeds make the collisions rare enough to sort on */
+	hashed.reserve(rows.size());
+	for (i = 0; i < rows.size(); i++) {
+		r1.setPointer(rows[i]);
+		hashed.push_back(pair<uint64_t, Row::Pointer>(
+		  (r1.hash(allCols, 0) << 32) | r1.hash(allCols, 0x9e3779b9), rows[i]));
+	}
+	sort(hashed.begin(), hashed.end(), RowHashLess());
+
+	/* Identical rows are interchangeable, different rows with the same hash are not */
+	for (i = 1; i < hashed.size(); i++)
+		if (hashed[i].first == hashed[i-1].first) {
+			r1.setPointer(hashed[i-1].second);
+			r2.setPointer(hashed[i].second);
+			if (!r1.equals(r2))
+				return false;
+		}
+
+	/* The layout of the rows and the join parameters the PM keys are made from.  The
+	   tuple keys in smallRG are assigned per query so the RowGroup itself isn't used. */
+	messageqcpp::serializeVector<uint32_t>(bs, smallRG.getOffsets());
+	for (i = 0; i < smallRG.getColumnCount(); i++) {
+		bs << (uint32_t) smallRG.getColTypes()[i];
+		bs << smallRG.getScale()[i];
+		bs << smallRG.getPrecision()[i];
+	}
+	bs << (uint8_t) smallRG.usesStringTable();
+	bs << (uint32_t) (joinType & ~WITHFCNEXP);
+	bs << (uint8_t) typelessJoin;
+	bs << (uint32_t) (typelessJoin ? keyLength : 0);
+	messageqcpp::serializeVector<uint32_t>(bs, smallKeyColumns);
+	for (i = 0; i < largeKeyColumns.size(); i++)
+		bs << (uint8_t) largeRG.isUnsigned(largeKeyColumns[i]);
+	bs << (uint64_t) hashed.size();
+	for (i = 0; i < hashed.size(); i++) {
+		rows[i] = hashed[i].second;
+		bs << hashed[i].first;
+	}
+
+	*fingerprint = Hasher128()((const char *) bs.buf(), bs.length());
+	return true;
+}
+
 uint64_t TupleJoiner::getMemUsage() const
 {
 	if (inUM() && typelessJoin)
 		return _pool->getMemUsage() + storedKeyAlloc.getMemUsage();
 	else if (inUM())
 		return _pool->getMemUsage();
+	else if (useHashTables())
+		return _pool->getMemUsage() + (typelessJoin ? storedKeyAlloc.getMemUsage() : 0) +
+		  (rows.size() * sizeof(Row::Pointer));
 	else
 		return (rows.size() * sizeof(Row::Pointer));
 }
@@ -797,7 +929,7 @@ void TupleJoiner::setTableName(const string &tname)
 
 /* Disk based join support */
 
-void TupleJoiner::clearData()
+void TupleJoiner::resetHashTables()
 {
 	STLPoolAllocator<pair<const TypelessData, Row::Pointer> > alloc(64*1024*1024 + 1);
 	_pool = alloc.getPoolAllocator();
@@ -808,6 +940,11 @@ void TupleJoiner::clearData()
 		sth.reset(new sthash_t(10, hasher(), sthash_t::key_equal(), alloc));
 	else
 		h.reset(new hash_t(10, hasher(), hash_t::key_equal(), alloc));
+}
+
+void TupleJoiner::clearData()
+{
+	resetHashTables();
 
 	std::vector<rowgroup::Row::Pointer> empty;
 	rows.swap(empty);
@@ -830,6 +967,7 @@ boost::shared_ptr<TupleJoiner> TupleJoiner::copyForDiskJoin()
 	ret->keyLength = keyLength;
 	ret->bSignedUnsignedJoin = bSignedUnsignedJoin;
 	ret->fe = fe;
+	ret->keyOnlyMode = keyOnlyMode;
 
 	ret->nullValueForJoinColumn = nullValueForJoinColumn;
 	ret->uniqueLimit = uniqueLimit;
@@ -167,6 +167,13 @@ public:
 
 	uint64_t getMemUsage() const;
 
+	/* For reusing the PM's hash table across queries.  Sorts the PM small side into an
+		order that depends only on its contents and returns a fingerprint of the contents
+		and of everything that affects the table the PM builds from them.  Returns false
+		if the order can't be made canonical, which happens only on a hash collision
+		between two different rows. */
+	bool canonicalizeSmallSide(uint64_t *fingerprint);
+
 	/* Typeless join interface */
 	inline bool isTypelessJoin() { return typelessJoin; }
     inline bool isSignedUnsignedJoin() { return bSignedUnsignedJoin; }
@@ -179,6 +186,14 @@ public:
 	inline const boost::scoped_array<std::vector<int64_t> > &getCPData() { return cpValues; }
 	inline void setUniqueLimit(uint32_t limit) { uniqueLimit = limit; }
 
+	/* Key-only mode, for semi- and anti-joins with no join filter and no scalar check.
+		Those only ask whether the small side has a key, so the caller inserts only rows
+		for which hasKey() is false, and match() returns at most one row.  Has to be set
+		before the first insert(), and the joiner can't get a join filter afterward. */
+	void setKeyOnly();
+	inline bool keyOnly() const { return keyOnlyMode; }
+	bool hasKey(const rowgroup::Row &r);
+
 	/* Semi-join interface */
 	inline bool semiJoin() { return ((joinType & joblist::SEMI) != 0); }
 	inline bool antiJoin() { return ((joinType & joblist::ANTI) != 0); }
@@ -214,6 +229,9 @@ private:
 	iterator begin() { return h->begin(); }
 	iterator end() { return h->end(); }
 
+	void resetHashTables();
+	inline bool useHashTables() const { return joinAlg == UM || (keyOnlyMode && joinAlg == INSERTING); }
+
 
 	rowgroup::RGData smallNullMemory;
 
@@ -266,6 +284,10 @@ private:
 	boost::scoped_array<std::vector<int64_t> > cpValues;    // if !discreteValues, [0] has min, [1] has max
 	uint32_t uniqueLimit;
 	bool finished;
+
+	/* In key-only mode the hash tables double as the set of keys seen while inserting,
+	   whichever side the join ends up on. */
+	bool keyOnlyMode;
 };
 
 }
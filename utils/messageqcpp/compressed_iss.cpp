@@ -49,18 +49,77 @@
 #include <fcntl.h>
 #endif
 
+#include <boost/algorithm/string/predicate.hpp>
+
 #include "compressed_iss.h"
 #include "iosocket.h"
 #include "configcpp.h"
+#include "metrics.h"
+#include "zlibcodec.h"
 
 using namespace std;
 using namespace boost;
 using namespace compress;
 
+namespace
+{
+using messageqcpp::CompressedInetStreamSocket;
+
+const uint32_t minCompressLen = 512;
+const uint32_t probeInterval = 64;
+// smaller writes mostly time the copy into the socket buffer, not the network
+const uint32_t minTimedWrite = 64 * 1024;
+// deflate can't do better than this, so a zlib length claiming more is garbage
+const uint64_t maxZlibRatio = 1032;
+
+const char* const codecNames[] = { "none", "snappy", "zlib" };
+
+struct CodecCounters
+{
+	explicit CodecCounters(CompressedInetStreamSocket::Codec codec)
+	{
+		utils::Metrics *m = utils::Metrics::instance();
+		string labels = string("codec=\"") + codecNames[codec] + "\"";
+
+		bytesIn = m->counter("idb_net_compress_input_bytes_total", labels,
+			"Bytes given to the network compressor, including samples sent uncompressed");
+		bytesSaved = m->counter("idb_net_compress_saved_bytes_total", labels,
+			"Bytes kept off the network by compressing messages");
+		compressUsec = m->counter("idb_net_compress_usec_total", labels,
+			"Time spent compressing network messages");
+		uncompressUsec = m->counter("idb_net_uncompress_usec_total", labels,
+			"Time spent uncompressing network messages");
+	}
+
+	utils::MetricCounter *bytesIn, *bytesSaved, *compressUsec, *uncompressUsec;
+};
+
+CodecCounters& counters(CompressedInetStreamSocket::Codec codec)
+{
+	static CodecCounters snappy(CompressedInetStreamSocket::SNAPPY);
+	static CodecCounters zlib(CompressedInetStreamSocket::ZLIB);
+	return (codec == CompressedInetStreamSocket::ZLIB ? zlib : snappy);
+}
+
+utils::MetricCounter* skippedBytes()
+{
+	static utils::MetricCounter *skipped = utils::Metrics::instance()->counter(
+		"idb_net_compress_skipped_bytes_total", "",
+		"Bytes sent uncompressed because compressing them wasn't expected to pay off");
+	return skipped;
+}
+
+inline void average(double &avg, double sample)
+{
+	avg = (avg == 0 ? sample : avg + (sample - avg) / 8);
+}
+}
+
 namespace messageqcpp
 {
 
-CompressedInetStreamSocket::CompressedInetStreamSocket()
+CompressedInetStreamSocket::CompressedInetStreamSocket() :
+	adaptive(false), fixedCodec(SNAPPY), fSendUsecPerByte(0), fSinceProbe(0), fNextProbe(SNAPPY)
 {
 	config::Config *config = config::Config::makeConfig();
 	string val;
@@ -74,6 +133,24 @@ CompressedInetStreamSocket::CompressedInetStreamSocket()
 		useCompression = true;
 	else
 		useCompression = false;
+
+	val.clear();
+	try {
+		val = config->getConfig("NetworkCompression", "Codec");
+	}
+	catch(...) { }
+
+	/* Anything but Snappy sends messages an older peer can't read, so those are
+	   opt-in until the whole system is upgraded. */
+	if (iequals(val, "auto"))
+		adaptive = true;
+	else if (iequals(val, "zlib"))
+		fixedCodec = ZLIB;
+
+	for (int i = 0; i < CODEC_COUNT; i++) {
+		fEstimate[i].ratio = (i == NONE ? 1 : 0);
+		fEstimate[i].usecPerByte = 0;
+	}
 }
 	
 Socket * CompressedInetStreamSocket::clone() const
@@ -92,6 +169,26 @@ const SBS CompressedInetStreamSocket::read(const struct timespec* timeout, bool*
 	if (readBS->length() == 0 || fMagicBuffer == BYTESTREAM_MAGIC)
 		return readBS;
 
+	uint64_t start = utils::monotonicUsec();
+
+	if (fMagicBuffer == ZLIB_BYTESTREAM_MAGIC) {
+		uint32_t len;
+
+		if (readBS->length() < sizeof(len))
+			return SBS(new ByteStream(0));
+		*readBS >> len;
+		if (len > readBS->length() * maxZlibRatio)
+			return SBS(new ByteStream(0));
+		ret.reset(new ByteStream(len));
+		uncompressedSize = len;
+		if (!zlibUncompress(readBS->buf(), readBS->length(), ret->getInputPtr(), &uncompressedSize) ||
+		  uncompressedSize != len)
+			return SBS(new ByteStream(0));
+		ret->advanceInputPtr(len);
+		counters(ZLIB).uncompressUsec->add(utils::monotonicUsec() - start);
+		return ret;
+	}
+
 	err = alg.getUncompressedSize((char *) readBS->buf(), readBS->length(), &uncompressedSize);
 	if (!err)
 		return SBS(new ByteStream(0));
@@ -99,24 +196,114 @@ const SBS CompressedInetStreamSocket::read(const struct timespec* timeout, bool*
 	ret.reset(new ByteStream(uncompressedSize));
 	alg.uncompress((char *) readBS->buf(), readBS->length(), (char *) ret->getInputPtr());
 	ret->advanceInputPtr(uncompressedSize);
+	counters(SNAPPY).uncompressUsec->add(utils::monotonicUsec() - start);
 	
 	return ret;
 }
 
+CompressedInetStreamSocket::Codec CompressedInetStreamSocket::chooseCodec(uint32_t len)
+{
+	if (!adaptive)
+		return fixedCodec;
+
+	if (++fSinceProbe >= probeInterval || fEstimate[SNAPPY].usecPerByte == 0 ||
+	  fEstimate[ZLIB].usecPerByte == 0) {
+		Codec ret = fNextProbe;
+		fSinceProbe = 0;
+		fNextProbe = (fNextProbe == SNAPPY ? ZLIB : SNAPPY);
+		return ret;
+	}
+
+	/* Until a big enough write has timed the connection, assume it's the bottleneck,
+	   which is what we always assumed before. */
+	if (fSendUsecPerByte == 0)
+		return (fEstimate[SNAPPY].ratio < 1 ? SNAPPY : NONE);
+
+	/* The remote's uncompress time is left out; it's a fraction of the compress time
+	   for both codecs and overlaps with the next message being sent. */
+	Codec best = NONE;
+	double bestCost = fSendUsecPerByte;
+	for (int i = SNAPPY; i < CODEC_COUNT; i++) {
+		double cost = fEstimate[i].usecPerByte + fEstimate[i].ratio * fSendUsecPerByte;
+		if (cost < bestCost) {
+			best = (Codec) i;
+			bestCost = cost;
+		}
+	}
+	return best;
+}
+
+bool CompressedInetStreamSocket::compressMsg(Codec codec, const ByteStream &msg, ByteStream &out)
+{
+	uint32_t len = msg.length();
+	size_t outLen = 0;
+	uint64_t start = utils::monotonicUsec();
+
+	if (codec == ZLIB) {
+		size_t zLen = zlibBound(len);
+
+		out << len;
+		out.needAtLeast(zLen);
+		if (!zlibCompress(msg.buf(), len, out.getInputPtr(), &zLen))
+			return false;
+		outLen = zLen + sizeof(len);
+		out.advanceInputPtr(zLen);
+	}
+	else {
+		out.needAtLeast(alg.maxCompressedSize(len));
+		alg.compress((char *) msg.buf(), len, (char *) out.getInputPtr(), &outLen);
+		out.advanceInputPtr(outLen);
+	}
+
+	uint64_t elapsed = utils::monotonicUsec() - start;
+	CodecCounters &c = counters(codec);
+	c.bytesIn->add(len);
+	c.compressUsec->add(elapsed);
+
+	Estimate &e = fEstimate[codec];
+	average(e.ratio, (double) outLen / len);
+	average(e.usecPerByte, (double) (elapsed ? elapsed : 1) / len);
+
+	if (outLen >= len)
+		return false;
+	c.bytesSaved->add(len - outLen);
+	return true;
+}
+
+void CompressedInetStreamSocket::timedWrite(const ByteStream &msg, uint32_t magic, Stats *stats)
+{
+	uint32_t len = msg.length();
+
+	if (len < minTimedWrite) {
+		do_write(msg, magic, stats);
+		return;
+	}
+
+	uint64_t start = utils::monotonicUsec();
+	do_write(msg, magic, stats);
+	uint64_t elapsed = utils::monotonicUsec() - start;
+	average(fSendUsecPerByte, (double) (elapsed ? elapsed : 1) / len);
+}
+
 void CompressedInetStreamSocket::write(const ByteStream &msg, Stats *stats)
 {
-	size_t outLen=0;
 	uint32_t len = msg.length();
 	
-	if (useCompression && (len > 512)) {
-		ByteStream smsg(alg.maxCompressedSize(len));
-	
-		alg.compress((char *) msg.buf(), len, (char *) smsg.getInputPtr(), &outLen);
-		smsg.advanceInputPtr(outLen);
-		if (outLen < len)
-			do_write(smsg, COMPRESSED_BYTESTREAM_MAGIC, stats);
+	if (useCompression && (len > minCompressLen)) {
+		Codec codec = chooseCodec(len);
+
+		if (codec == NONE) {
+			skippedBytes()->add(len);
+			timedWrite(msg, BYTESTREAM_MAGIC, stats);
+			return;
+		}
+
+		ByteStream smsg(0);
+		if (compressMsg(codec, msg, smsg))
+			timedWrite(smsg, (codec == ZLIB ? ZLIB_BYTESTREAM_MAGIC :
+			  COMPRESSED_BYTESTREAM_MAGIC), stats);
 		else
-			InetStreamSocket::write(msg, stats);
+			timedWrite(msg, BYTESTREAM_MAGIC, stats);
 	}
 	else
 		InetStreamSocket::write(msg, stats);
@@ -37,9 +37,27 @@
 
 namespace messageqcpp {
 
+/** @brief An InetStreamSocket that compresses what it sends when that pays off.
+ *
+ * Each message goes out with the magic of the codec it was sent with, so the reader
+ * decodes message by message and the two ends never have to agree on anything
+ * beyond the codecs this version knows.
+ *
+ * NetworkCompression/Codec picks the codec.  Snappy, the default, or Zlib use that
+ * one for every message over 512 bytes, as long as it makes the message smaller.
+ * Auto keeps per-connection estimates of each codec's ratio and speed and of how
+ * fast this connection drains, and sends each message the way that should get it
+ * to the other end soonest, which may be uncompressed.  Every 64th candidate
+ * message is compressed regardless to keep the estimates current.
+ *
+ * Releases before Zlib and Auto existed can't read zlib messages, so those two are only
+ * safe once every UM and PM has been upgraded.
+ */
 class CompressedInetStreamSocket : public InetStreamSocket
 {
 public:
+	enum Codec { NONE, SNAPPY, ZLIB, CODEC_COUNT };
+
 	CompressedInetStreamSocket();
 
 	virtual Socket * clone() const;
@@ -50,8 +68,24 @@ public:
 	virtual const IOSocket accept(const struct timespec *timeout);
 	virtual void connect(const sockaddr *addr);
 private:
+	Codec chooseCodec(uint32_t len);
+	bool compressMsg(Codec codec, const ByteStream &msg, ByteStream &out);
+	void timedWrite(const ByteStream &msg, uint32_t magic, Stats *stats);
+
 	compress::IDBCompressInterface alg;
 	bool useCompression;
+	bool adaptive;
+	Codec fixedCodec;
+
+	/* Running averages for this connection.  usecPerByte is 0 until measured. */
+	struct Estimate {
+		double ratio;			// compressed size / original size
+		double usecPerByte;		// time to compress
+	};
+	Estimate fEstimate[CODEC_COUNT];
+	double fSendUsecPerByte;
+	uint32_t fSinceProbe;
+	Codec fNextProbe;
 };
 
 } //namespace messageqcpp
@@ -326,7 +326,8 @@ bool InetStreamSocket::readToMagic(long msecs, bool* isTimeOut, Stats *stats) co
 	pfd[0].fd = fSocketParms.sd();
 	pfd[0].events = POLLIN;
 	
-	while ((fMagicBuffer != BYTESTREAM_MAGIC) && (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC)) {
+	while ((fMagicBuffer != BYTESTREAM_MAGIC) && (fMagicBuffer != COMPRESSED_BYTESTREAM_MAGIC) &&
+	  (fMagicBuffer != ZLIB_BYTESTREAM_MAGIC)) {
 
 		if (msecs >= 0) {
 			pfd[0].revents = 0;
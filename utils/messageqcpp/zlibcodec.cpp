@@ -0,0 +1,51 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+#include <zlib.h>
+
+#include "zlibcodec.h"
+
+namespace messageqcpp
+{
+
+size_t zlibBound(size_t len)
+{
+	return compressBound(len);
+}
+
+bool zlibCompress(const uint8_t* in, size_t len, uint8_t* out, size_t* outLen)
+{
+	uLongf zLen = *outLen;
+
+	if (compress2(out, &zLen, in, len, Z_BEST_SPEED) != Z_OK)
+		return false;
+	*outLen = zLen;
+	return true;
+}
+
+bool zlibUncompress(const uint8_t* in, size_t len, uint8_t* out, size_t* outLen)
+{
+	uLongf zLen = *outLen;
+
+	if (uncompress(out, &zLen, in, len) != Z_OK)
+		return false;
+	*outLen = zLen;
+	return true;
+}
+
+}
+// vim:ts=4 sw=4:
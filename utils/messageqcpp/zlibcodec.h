@@ -0,0 +1,46 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file */
+
+#ifndef MESSAGEQCPP_ZLIBCODEC_H
+#define MESSAGEQCPP_ZLIBCODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* zlib declares a global compress(), which can't coexist with the compress namespace,
+   so zlib is only ever included by zlibcodec.cpp. */
+
+namespace messageqcpp
+{
+
+/** @brief the most zlibCompress() can turn len bytes into */
+size_t zlibBound(size_t len);
+
+/** @brief compress len bytes of in at zlib's fastest level.  *outLen is the space
+ *  at out going in and the compressed size coming out.
+ */
+bool zlibCompress(const uint8_t* in, size_t len, uint8_t* out, size_t* outLen);
+
+/** @brief the reverse of zlibCompress() */
+bool zlibUncompress(const uint8_t* in, size_t len, uint8_t* out, size_t* outLen);
+
+}
+
+#endif
+// vim:ts=4 sw=4:
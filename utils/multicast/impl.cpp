@@ -28,6 +28,9 @@
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
 #include <cerrno>
+#include <stdexcept>
+#include <sstream>
+#include <cstring>
 #include <pthread.h>
 using namespace std;
 
@@ -420,8 +423,8 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 
 	s = socket(PF_INET, SOCK_DGRAM, 0);
 	if (s < 0) {
-	    perror("make socket");
-	    exit(1);
+	    free(net_if);
+	    throw runtime_error(string("udpc_getNetIf: socket() failed: ") + strerror(errno));
 	}	
 
 	ifc.ifc_len = sizeof(ibuf);
@@ -429,8 +432,10 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 
 	if (ioctl(s, SIOCGIFCONF, (char *)&ifc) < 0 ||
             ifc.ifc_len < (signed int)sizeof(struct ifreq)) {
-                perror("udpcast: SIOCGIFCONF: ");
-                exit(1);
+                string err = strerror(errno);
+                close(s);
+                free(net_if);
+                throw runtime_error("udpc_getNetIf: SIOCGIFCONF failed: " + err);
         }
 
 	ifend = (struct ifreq *)((char *)ibuf + ifc.ifc_len);
@@ -514,8 +519,9 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 
 
 	if(!chosen) {
-	    fprintf(stderr, "No suitable network interface found\n");
-	    fprintf(stderr, "The following interfaces are available:\n");
+	    ostringstream os;
+	    os << "udpc_getNetIf: no suitable network interface" <<
+	      (wanted ? " for " : "") << (wanted ? wanted : "") << "; available:";
 
 	    for (ifrp = ibuf ; ifrp < ifend;
 #ifdef IFREQ_SIZE
@@ -529,11 +535,12 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 		if(ifrp->ifr_addr.sa_family != PF_INET)
 		    continue;
 
-		fprintf(stderr, "\t%s\t%s\n",
-			ifrp->ifr_name, 
-			udpc_getIpString((struct sockaddr_in *)&ifrp->ifr_addr, buffer));
+		os << " " << ifrp->ifr_name << "=" <<
+		  udpc_getIpString((struct sockaddr_in *)&ifrp->ifr_addr, buffer);
 	    }
-	    exit(1);
+	    close(s);
+	    free(net_if);
+	    throw runtime_error(os.str());
 	}
 
 	net_if->name = strdup(chosen->ifr_name);
@@ -563,8 +570,8 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 	/* WINSOCK initialization */	
 	wVersionRequested = MAKEWORD(2, 0); /* Request Winsock v2.0 */
 	if (WSAStartup(wVersionRequested, &wsaData) != 0) /* Load Winsock DLL */ {
-	    fprintf(stderr,"WSAStartup() failed");
-	    exit(1);
+	    free(net_if);
+	    throw runtime_error("udpc_getNetIf: WSAStartup() failed");
 	}
 	/* End WINSOCK initialization */
 	
@@ -657,9 +664,9 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 	}
 	
 	if(!chosen) {
-	    fprintf(stderr, "No suitable network interface found%s%s\n", 
-		    wanted ? " for " : "", wanted ? wanted : "");
-	    fprintf(stderr, "The following interfaces are available:\n");
+	    ostringstream os;
+	    os << "udpc_getNetIf: no suitable network interface" <<
+	      (wanted ? " for " : "") << (wanted ? wanted : "") << "; available:";
 
 	    for(i=0; i<iptab->dwNumEntries; i++) {
 		char buffer[16];
@@ -670,13 +677,14 @@ net_if_t *udpc_getNetIf(const char *wanted) {
 		addr.sin_addr.s_addr = iprow->dwAddr;
 		ifrow = getIfRow(iftab, iprow->dwIndex);
 		name = fmtName(ifrow);
-		fprintf(stderr, " %15s  %s\n",
-			udpc_getIpString(&addr, buffer),
-			name ? name : "");
+		os << " " << udpc_getIpString(&addr, buffer) << "=" << (name ? name : "");
 		if(name)
 		    free(name);
 	    }
-	    exit(1);
+	    free(iftab);
+	    free(iptab);
+	    free(net_if);
+	    throw runtime_error(os.str());
 	}
 
 	net_if->bcast.s_addr = net_if->addr.s_addr = chosen->dwAddr;
@@ -716,10 +724,8 @@ int mcastOp(int sock, net_if_t *net_if, struct in_addr addr,
     
     fillMreq(net_if, addr, &mreq);
     r = setsockopt(sock, SOL_IP, code, (char*)&mreq, sizeof(mreq));
-    if(r < 0) {
-	perror(message);
-	exit(1);
-    }
+    if(r < 0)
+	throw runtime_error(string(message) + ": " + strerror(errno));
     return 0;
 }
 
@@ -794,15 +800,20 @@ int udpc_makeSocket(addr_type_t addr_type,
 #endif
 
     s = socket(PF_INET, SOCK_DGRAM, 0);
-    if (s < 0) {
-	perror("make socket");
-	exit(1);
-    }
+    if (s < 0)
+	throw runtime_error("udpc_makeSocket: socket() failed");
 
     if(addr_type == ADDR_TYPE_MCAST && tmpl != NULL) {
 	ip = tmpl->sin_addr.s_addr;
     }
 
+    /* Every receiver on a host binds the broadcast and multicast sockets to the same
+       port; the kernel hands each of them a copy. */
+    if(addr_type == ADDR_TYPE_BCAST || addr_type == ADDR_TYPE_MCAST) {
+	int on = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char *)&on, sizeof(on));
+    }
+
     ret = initSockAddress(addr_type, net_if, ip, port, &myaddr);
 	//TODO: FIXME
     //if(ret < 0)
@@ -818,14 +829,15 @@ if (addr_type == ADDR_TYPE_BCAST)
       return -1;
     }
     ret = bind(s, (struct sockaddr *) &myaddr, sizeof(myaddr));
-	//TODO: FIXME
-//    if (ret < 0) {
-//	char buffer[16];
-//	udpc_fatal(1, "bind socket to %s:%d (%s)\n",
-//		   udpc_getIpString(&myaddr, buffer), 
-//		   udpc_getPort(&myaddr),
-//		   strerror(errno));
-//    }
+    if (ret < 0) {
+	/* most likely another receiver on this host has the port */
+	char buffer[16];
+	ostringstream os;
+	os << "udpc_makeSocket: can't bind to " << udpc_getIpString(&myaddr, buffer) << ":" <<
+	  ntohs(myaddr.sin_port) << ": " << strerror(errno);
+	closesocket(s);
+	throw runtime_error(os.str());
+    }
 
     if(addr_type == ADDR_TYPE_MCAST)
 	mcastListen(s, net_if, &myaddr);
@@ -843,16 +855,10 @@ int udpc_setSocketToBroadcast(int sock) {
 
 int udpc_getBroadCastAddress(net_if_t *net_if, struct sockaddr_in *addr, 
 			short port){
-    int r= initSockAddress(ADDR_TYPE_BCAST, net_if, INADDR_ANY, port, addr);
-    if(addr->sin_addr.s_addr == 0) {
-      /* Quick hack to make it work for loopback */
-      struct sockaddr_in ucast;
-      initSockAddress(ADDR_TYPE_UCAST, net_if, INADDR_ANY, port, &ucast);
-
-      if((ntohl(ucast.sin_addr.s_addr) & 0xff000000) == 0x7f000000)
-	addr->sin_addr.s_addr = ucast.sin_addr.s_addr;
-    }
-    return r;
+    /* Loopback has no broadcast address.  This used to stand in the interface's
+       own address, which reaches only one receiver; leaving it 0 makes the
+       caller use multicast instead. */
+    return initSockAddress(ADDR_TYPE_BCAST, net_if, INADDR_ANY, port, addr);
 }
 
 int safe_inet_aton(const char *address, struct in_addr *ip) {
@@ -934,6 +940,10 @@ int udpc_ipIsEqual(struct sockaddr_in *left, struct sockaddr_in *right) {
     return getSinAddr(left).s_addr == getSinAddr(right).s_addr;
 }
 
+int udpc_isAddressEqual(struct sockaddr_in *a, struct sockaddr_in *b) {
+    return !memcmp((char *) a, (char *)b, 8);
+}
+
 void udpc_closeSock(int *socks, int nr, int target) {
     int i;
     int sock = socks[target];
@@ -972,8 +982,10 @@ int doReceive(int s, void *message, size_t len,
     r = recvfrom(s, message, len, 0, (struct sockaddr *)from, &slen);
     if (r < 0)
 	return r;
+    /* receivers send from their receiverPort, which can be anything; the receiver
+       checks that what it gets comes from the sender's port */
     port = ntohs(from->sin_port);
-    if(port != RECEIVER_PORT(portBase) && port != SENDER_PORT(portBase)) {
+    if(port == 0) {
 	return -1;
     }
 /*    flprintf("recv: %08x %d\n", *(int*) message, r);*/
@@ -997,7 +1009,7 @@ int udpc_lookupParticipant(struct participantsDb *db, struct sockaddr_in *addr)
     int i;
     for (i=0; i < MAX_CLIENTS; i++) {
 	if (db->clientTable[i].used && 
-	    udpc_ipIsEqual(&db->clientTable[i].addr, addr)) {
+	    udpc_isAddressEqual(&db->clientTable[i].addr, addr)) {
 	    return i;
 	}
     }
@@ -1172,6 +1184,11 @@ int mainDispatcher(int *fd, int nr,
 #endif
     }
 
+    /* Start as soon as the last receiver has connected rather than on the
+       next hello timeout */
+    if (firstConnected && checkClientWait(db, net_config, firstConnected))
+	return 1;
+
     while(!startNow) {
 	struct timeval tv;
 	struct timeval *tvp;
@@ -2749,9 +2766,6 @@ int processReqAck(struct clientState *clst,
     return 0;
 }
 
-int udpc_isAddressEqual(struct sockaddr_in *a, struct sockaddr_in *b) {
-    return !memcmp((char *) a, (char *)b, 8);
-}
 int dispatchMessage(struct clientState *clst)
 {
     int ret;
@@ -3044,6 +3058,8 @@ MulticastImpl::MulticastImpl(int min_receivers, const string& ifName, int portBa
 	fNet_config.retriesUntilDrop = 200;
 
 	fNet_config.rehelloOffset = 50;
+	fNet_config.startTimeout = 0;
+	fNet_config.receiverPort = RECEIVER_PORT(portBase);
 
 	fStat_config.log = 0;
 	fStat_config.bwPeriod = 0;
@@ -3061,6 +3077,7 @@ MulticastImpl::MulticastImpl(int min_receivers, const string& ifName, int portBa
 	fSock[0] = -1;
 	fSock[1] = -1;
 	fSock[2] = -1;
+	udpc_zeroSockArray(fClient_config.socks, NR_CLIENT_SOCKS);
 }
 
 MulticastImpl::~MulticastImpl()
@@ -3075,6 +3092,11 @@ MulticastImpl::~MulticastImpl()
 			close(fSock[i]);
 		}
 	}
+
+	// a receiver's sockets; a new session gets new ones
+	for (int i=0; i<NR_CLIENT_SOCKS; i++)
+		if (fClient_config.socks[i] != -1)
+			udpc_closeSock(fClient_config.socks, NR_CLIENT_SOCKS, i);
 }
 
 void MulticastImpl::startSender()
@@ -3185,6 +3207,11 @@ void MulticastImpl::startSender()
 	//doTransfer(fSock[0], fDb, &fNet_config, &fStat_config);
 }
 
+int MulticastImpl::participants() const
+{
+	return (fDb ? udpc_nrParticipants(fDb) : 0);
+}
+
 void MulticastImpl::doTransfer(const uint8_t* buf, uint32_t len)
 {
     int i;
@@ -3198,8 +3225,7 @@ void MulticastImpl::doTransfer(const uint8_t* buf, uint32_t len)
 	if(udpc_isParticipantValid(fDb, i)) {
 	    unsigned int pRcvBuf = udpc_getParticipantRcvBuf(fDb, i);
 	    if(isPtP)
-		udpc_copyIpFrom(&fNet_config.dataMcastAddr, 
-			   udpc_getParticipantIp(fDb,i));
+		fNet_config.dataMcastAddr = *udpc_getParticipantIp(fDb,i);
 	    fNet_config.capabilities &= 
 		udpc_getParticipantCapabilities(fDb, i);
 	    if(pRcvBuf != 0 && 
@@ -3243,27 +3269,28 @@ void MulticastImpl::startReceiver()
     fClient_config.sender_is_newgen = 0;
 
     fNet_config.net_if = udpc_getNetIf(fIfName.c_str());
-{
-fprintf(stderr, "net_if:\n\taddr = 0x%x\n\tbcast = 0x%x\n\tname = %s\n\tindex = %d\n", fNet_config.net_if->addr.s_addr, fNet_config.net_if->bcast.s_addr, fNet_config.net_if->name, fNet_config.net_if->index);
-}
 
     udpc_zeroSockArray(fClient_config.socks, NR_CLIENT_SOCKS);
 
     fClient_config.S_UCAST = udpc_makeSocket(ADDR_TYPE_UCAST,
 				       fNet_config.net_if,
-				       0, RECEIVER_PORT(fNet_config.portBase));
+				       0, fNet_config.receiverPort);
 //cerr << "S_UCAST = " << fClient_config.S_UCAST << endl;
     fClient_config.S_BCAST = udpc_makeSocket(ADDR_TYPE_BCAST,
 				       fNet_config.net_if,
 				       0, RECEIVER_PORT(fNet_config.portBase));
 //cerr << "S_BCAST = " << fClient_config.S_BCAST << endl;
 
+    fNet_config.controlMcastAddr.sin_addr.s_addr = 0;
     if(fNet_config.ttl == 1 && fNet_config.mcastRdv == NULL) {
 	udpc_getBroadCastAddress(fNet_config.net_if,
 			    &fNet_config.controlMcastAddr,
 			    SENDER_PORT(fNet_config.portBase));
 	udpc_setSocketToBroadcast(fClient_config.S_UCAST);
-    } else {
+    }
+
+    /* same as the sender: multicast where there's no broadcast */
+    if(fNet_config.controlMcastAddr.sin_addr.s_addr == 0) {
 	udpc_getMcastAllAddress(&fNet_config.controlMcastAddr,
 			   fNet_config.mcastRdv,
 			   SENDER_PORT(fNet_config.portBase));
@@ -3307,18 +3334,14 @@ fprintf(stderr, "net_if:\n\taddr = 0x%x\n\tbcast = 0x%x\n\tname = %s\n\tindex =
 	sock = udpc_selectSock(fClient_config.socks, NR_CLIENT_SOCKS,
 			       fNet_config.startTimeout);
 //cerr << "got something" << endl;
-	if(sock < 0) {
-		//TODO: FIXME
-	}
+	if(sock < 0)
+		throw runtime_error("MulticastImpl::startReceiver: select failed");
 
 	// len = sizeof(server);
 	msglen=RECV(sock, 
 		    Msg, fClient_config.serverAddr, fNet_config.portBase);
-	if (msglen < 0) {
-		//TODO: FIXME
-	    //perror("recvfrom to locate server");
-	    //exit(1);
-	}
+	if (msglen < 0)
+		continue;
 	
 	if(udpc_getPort(&fClient_config.serverAddr) != 
 	   SENDER_PORT(fNet_config.portBase))
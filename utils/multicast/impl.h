@@ -49,6 +49,8 @@ public:
 
 	void startSender();
 	void doTransfer(const uint8_t* buf, uint32_t len);
+	/* the receivers taking part; ones that drop out of a transfer are removed */
+	int participants() const;
 
 	void startReceiver();
 	void receive(messageqcpp::SBS obs);
@@ -21,6 +21,7 @@
  *****************************************************************************/
 
 #include <string>
+#include <cstring>
 #include <stdint.h>
 #include <iostream>
 #include <stdexcept>
@@ -32,7 +33,24 @@ using namespace messageqcpp;
 #include "configcpp.h"
 using namespace config;
 
+#include "hasher.h"
+
 #include "multicast.h"
+#ifndef _MSC_VER
+#include <boost/scoped_ptr.hpp>
+#include "impl.h"
+#endif
+
+namespace
+{
+/* udpcast has no end-to-end check, and it has handed back damaged data, so every
+   transfer starts with the payload's length and hash. */
+struct TransferHeader
+{
+	uint64_t length;
+	uint64_t hash;
+};
+}
 
 namespace multicast
 {
@@ -41,7 +59,9 @@ Multicast::Multicast() :
 	fPMCount(1),
 	fIFName("eth0"),
 	fPortBase(9000),
-	fBufSize(8 * 1024 * 1024)
+	fReceiverPort(0),
+	fBufSize(8 * 1024 * 1024),
+	fConnectTimeout(500)
 {
 	int tmp;
 	string stmp;
@@ -57,12 +77,19 @@ Multicast::Multicast() :
 	tmp = Config::fromText(cf->getConfig("Multicast", "PortBase"));
 	if (tmp > 0) fPortBase = tmp;
 
+	/* Leave it 0 to run more than one receiver on a host.  A fixed port (for a
+	   firewall) allows only one. */
+	tmp = Config::fromText(cf->getConfig("Multicast", "ReceiverPort"));
+	if (tmp > 0) fReceiverPort = tmp;
+
 	tmp = Config::fromText(cf->getConfig("Multicast", "BufSize"));
 	if (tmp > 0) fBufSize = tmp;
+
+	tmp = Config::fromText(cf->getConfig("Multicast", "ConnectTimeout"));
+	if (tmp > 0) fConnectTimeout = tmp;
 }
 
-MulticastReceiver::MulticastReceiver() :
-	fPimpl(0)
+MulticastReceiver::MulticastReceiver()
 {
 }
 
@@ -70,14 +97,36 @@ MulticastReceiver::~MulticastReceiver()
 {
 }
 
+#ifdef _MSC_VER
 SBS MulticastReceiver::receive()
 {
 	throw runtime_error("Multicast is not available");
-	return fByteStream;
 }
+#else
+SBS MulticastReceiver::receive()
+{
+	/* The udpcast protocol is one file per session, so every message is a new
+	   session with new sockets. */
+	boost::scoped_ptr<MulticastImpl> impl(new MulticastImpl(1, iFName(), portBase(), bufSize()));
+	SBS bs(new ByteStream());
+	TransferHeader hdr;
+
+	impl->fNet_config.receiverPort = receiverPort();
+	impl->startReceiver();
+	impl->receive(bs);
+
+	if (bs->length() < sizeof(hdr))
+		return SBS();
+	memcpy(&hdr, bs->buf(), sizeof(hdr));
+	bs->advance(sizeof(hdr));
+	if (hdr.length != bs->length() ||
+	  hdr.hash != utils::Hasher128()((const char *) bs->buf(), bs->length()))
+		return SBS();
+	return bs;
+}
+#endif
 
-MulticastSender::MulticastSender() :
-	fPimpl(0)
+MulticastSender::MulticastSender()
 {
 }
 
@@ -85,10 +134,36 @@ MulticastSender::~MulticastSender()
 {
 }
 
-void MulticastSender::send(const ByteStream& msg)
+#ifdef _MSC_VER
+int MulticastSender::send(const ByteStream& msg)
 {
-	throw runtime_error("Multicast is not available");
+	return 0;
+}
+#else
+int MulticastSender::send(const ByteStream& msg)
+{
+	const int helloInterval = 50;	// ms
+	boost::scoped_ptr<MulticastImpl> impl(new MulticastImpl(PMCount(), iFName(), portBase(), bufSize()));
+
+	/* Wait for every PM to join, but give up on the stragglers after connectTimeout()
+	   and send to the ones that did. */
+	impl->fNet_config.rexmit_hello_interval = helloInterval;
+	impl->fNet_config.autostart = max(connectTimeout() / helloInterval, 1);
+	impl->startSender();
+	if (impl->participants() == 0)
+		return 0;
+
+	TransferHeader hdr;
+	ByteStream xfer(sizeof(hdr) + msg.length());
+
+	hdr.length = msg.length();
+	hdr.hash = utils::Hasher128()((const char *) msg.buf(), msg.length());
+	xfer.append((const uint8_t *) &hdr, sizeof(hdr));
+	xfer.append(msg.buf(), msg.length());
+	impl->doTransfer(xfer.buf(), xfer.length());
+	return impl->participants();
 }
+#endif
 
 } //namespace multicast
 
@@ -36,8 +36,6 @@ namespace multicast
   * Wrapper for multicast proto
   */
 
-class MulticastImpl;
-
 class Multicast
 {
 public:
@@ -55,13 +53,17 @@ public:
 	int PMCount() const { return fPMCount; }
 	std::string iFName() const { return fIFName; }
 	int portBase() const { return fPortBase; }
+	int receiverPort() const { return fReceiverPort; }
 	int bufSize() const { return fBufSize; }
+	int connectTimeout() const { return fConnectTimeout; }
 
 private:
 	int fPMCount;
 	std::string fIFName;
 	int fPortBase;
+	int fReceiverPort;	// a receiver's unicast port; 0 takes any free one
 	int fBufSize;
+	int fConnectTimeout;	// ms a sender waits for the receivers to join a transfer
 
 };
 
@@ -75,16 +77,17 @@ public:
 
 	~MulticastReceiver();
 	
+	/** @brief receive
+	* 
+	* Waits for the next transfer from a sender and returns it, or a null
+	* SBS if it arrived damaged.  Throws on a socket error.
+	*/
 	messageqcpp::SBS receive();
 
 private:
 	// not copyable
 	MulticastReceiver(const MulticastReceiver& rhs);
 	MulticastReceiver& operator=(const MulticastReceiver& rhs);
-
-	messageqcpp::SBS fByteStream;
-
-	MulticastImpl* fPimpl;
 };
 
 
@@ -99,18 +102,19 @@ public:
 
 	~MulticastSender();
 
-	/** @brief receive 
+	/** @brief send
 	* 
+	* Sends bs to every receiver that joins within connectTimeout() ms, retransmitting
+	* as they ask.  Returns the number of receivers that got all of it; the caller has to
+	* get it to the rest some other way.  Only one send at a time per PortBase.
 	* @param bytestream to send
 	*/
-	void send(const messageqcpp::ByteStream& bs);
+	int send(const messageqcpp::ByteStream& bs);
 
 private:
 	//Not copyable
 	MulticastSender(const MulticastSender& rhs);
 	MulticastSender& operator=(const MulticastSender& rhs);
-
-	MulticastImpl* fPimpl;
 };
 
 } //namespace
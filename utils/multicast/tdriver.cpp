@@ -0,0 +1,118 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/*****************************************************************************
+ * $Id$
+ *
+ ****************************************************************************/
+
+/** @file
+ * Multicast tests.  These run a sender and several receivers on loopback, the
+ * way PrimProcs sharing a host would.
+ */
+
+#include <iostream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "bytestream.h"
+#include "configcpp.h"
+#include "multicast.h"
+
+using namespace std;
+using namespace messageqcpp;
+using namespace config;
+using namespace multicast;
+
+class MulticastTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(MulticastTest);
+
+CPPUNIT_TEST(multicast_loopback_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+private:
+	/* What MulticastInbox does in each PrimProc; the exit status says how it went */
+	static int receiveOne(const ByteStream& expected)
+	{
+		try {
+			MulticastReceiver receiver;
+			SBS bs = receiver.receive();
+			return (bs && *bs == expected ? 0 : 1);
+		}
+		catch (std::exception& e) {
+			cerr << "receiver: " << e.what() << endl;
+			return 2;
+		}
+	}
+
+public:
+	void multicast_loopback_1() {
+		const int receivers = 3;
+		Config* cf = Config::makeConfig();
+		ByteStream msg;
+		pid_t pids[receivers];
+		int i, status;
+
+		cf->setConfig("PrimitiveServers", "Count", "3");
+		cf->setConfig("Multicast", "Interface", "lo");
+		cf->setConfig("Multicast", "PortBase", "9400");
+		cf->setConfig("Multicast", "ReceiverPort", "0");
+
+		// 1.2MB, so dozens of slices
+		for (i = 0; i < 300000; i++)
+			msg << (uint32_t) i;
+
+		// one process each, like the PrimProcs
+		for (i = 0; i < receivers; i++) {
+			pids[i] = fork();
+			CPPUNIT_ASSERT(pids[i] >= 0);
+			if (pids[i] == 0)
+				_exit(receiveOne(msg));
+		}
+		usleep(200000);
+
+		MulticastSender sender;
+		CPPUNIT_ASSERT(sender.send(msg) == receivers);
+
+		for (i = 0; i < receivers; i++) {
+			CPPUNIT_ASSERT(waitpid(pids[i], &status, 0) == pids[i]);
+			CPPUNIT_ASSERT(WIFEXITED(status));
+			CPPUNIT_ASSERT(WEXITSTATUS(status) == 0);
+		}
+	}
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( MulticastTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
@@ -106,6 +106,9 @@ struct net_config {
 
     int startTimeout; /* Timeout at start */
 
+    int receiverPort; /* Port the receiver's unicast socket binds.  Receivers on
+		       * one host need different ones; 0 picks a free port */
+
     /* FEC config */
 #ifdef BB_FEATURE_UDPCAST_FEC
     int fec_redundancy; /* how much fec blocks are added per group */
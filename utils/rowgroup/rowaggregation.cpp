@@ -48,6 +48,7 @@
 #include "rowaggregation.h"
 #include "calpontsystemcatalog.h"
 #include "utils_utf8.h"
+#include "hasher.h"
 
 //..comment out NDEBUG to enable assertions, uncomment NDEBUG to disable
 //#define NDEBUG
@@ -186,6 +187,72 @@ inline string getStringNullValue()
 	return joblist::CPNULLSTRMARK;
 }
 
+
+// HyperLogLog helpers for APPROX_COUNT_DISTINCT.
+// The top ROWAGG_HLL_PRECISION bits of the hash pick the register, the register
+// keeps the max position of the first 1 bit in the remaining bits.
+inline void hllAdd(uint8_t* regs, uint64_t hash)
+{
+	uint32_t idx = (uint32_t) (hash >> (64 - rowgroup::ROWAGG_HLL_PRECISION));
+	uint64_t w = hash << rowgroup::ROWAGG_HLL_PRECISION;
+	uint8_t rank = 1;
+	const uint8_t maxRank = 64 - rowgroup::ROWAGG_HLL_PRECISION + 1;
+	while (rank < maxRank && (w & 0x8000000000000000ULL) == 0)
+	{
+		w <<= 1;
+		rank++;
+	}
+
+	if (regs[idx] < rank)
+		regs[idx] = rank;
+}
+
+
+inline void hllMerge(uint8_t* regs, const uint8_t* in)
+{
+	for (uint32_t i = 0; i < rowgroup::ROWAGG_HLL_REGISTERS; i++)
+		if (regs[i] < in[i])
+			regs[i] = in[i];
+}
+
+
+uint64_t hllEstimate(const uint8_t* regs)
+{
+	const double m = rowgroup::ROWAGG_HLL_REGISTERS;
+	double sum = 0.0;
+	uint32_t zeros = 0;
+	for (uint32_t i = 0; i < rowgroup::ROWAGG_HLL_REGISTERS; i++)
+	{
+		sum += ldexp(1.0, -((int) regs[i]));
+		if (regs[i] == 0)
+			zeros++;
+	}
+
+	double alpha = 0.7213 / (1.0 + 1.079 / m);
+	double est = alpha * m * m / sum;
+
+	// small range correction, linear counting
+	if (est <= 2.5 * m && zeros > 0)
+		est = m * log(m / zeros);
+
+	return (uint64_t) (est + 0.5);
+}
+
+
+// The sketch sits inline in the row: 2-byte length, then the registers.
+// A zero length means nothing has been added yet.
+inline uint8_t* hllRegisters(rowgroup::Row& row, int64_t col)
+{
+	uint8_t* p = row.getData() + row.getOffset(col);
+	if (*((uint16_t*) p) == 0)
+	{
+		*((uint16_t*) p) = rowgroup::ROWAGG_HLL_REGISTERS;
+		memset(p + 2, 0, rowgroup::ROWAGG_HLL_REGISTERS);
+	}
+
+	return p + 2;
+}
+
 }
 
 
@@ -624,7 +691,7 @@ RowAggregation::RowAggregation(const vector<SP_ROWAGG_GRPBY_t>& rowAggGroupByCol
 RowAggregation::RowAggregation(const RowAggregation& rhs):
 	fAggMapPtr(NULL), fRowGroupOut(NULL),
 	fTotalRowCount(0), fMaxTotalRowCount(AGG_ROWGROUP_SIZE),
-	fSmallSideRGs(NULL), fLargeSideRG(NULL), fSmallSideCount(0)
+	fSmallSideRGs(NULL), fLargeSideRG(NULL), fSmallSideCount(0), fArena(rhs.fArena)
 {
 	//fGroupByCols.clear();
 	//fFunctionCols.clear();
@@ -749,6 +816,7 @@ void RowAggregation::initialize()
 		fHasher.reset(new AggHasher(fRow, &tmpRow, fGroupByCols.size(), this));
 		fEq.reset(new AggComparator(fRow, &tmpRow, fGroupByCols.size(), this));
 		fAlloc.reset(new utils::STLPoolAllocator<RowPosition>());
+		fAlloc->getPoolAllocator()->setArena(fArena.get());
 		fAggMapPtr = new RowAggMap_t(10, *fHasher, *fEq, *fAlloc);
 	}
 	else
@@ -792,6 +860,7 @@ void RowAggregation::reset()
 		fHasher.reset(new AggHasher(fRow, &tmpRow, fGroupByCols.size(), this));
 		fEq.reset(new AggComparator(fRow, &tmpRow, fGroupByCols.size(), this));
 		fAlloc.reset(new utils::STLPoolAllocator<RowPosition>());
+		fAlloc->getPoolAllocator()->setArena(fArena.get());
 		delete fAggMapPtr;
 		fAggMapPtr = new RowAggMap_t(10, *fHasher, *fEq, *fAlloc);
 	}
@@ -812,6 +881,7 @@ void RowAggregationUM::reset()
 		fExtEq.reset(new ExternalKeyEq(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtHash.reset(new ExternalKeyHasher(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtKeyMapAlloc.reset(new utils::STLPoolAllocator<pair<RowPosition, RowPosition> >());
+		fExtKeyMapAlloc->getPoolAllocator()->setArena(fArena.get());
 		fExtKeyMap.reset(new ExtKeyMap_t(10, *fExtHash, *fExtEq, *fExtKeyMapAlloc));
 	}
 }
@@ -1009,7 +1079,8 @@ void RowAggregation::makeAggFieldsNull(Row& row)
 			fFunctionCols[i]->fAggFunction == ROWAGG_COUNT_DISTINCT_COL_NAME ||
 			fFunctionCols[i]->fAggFunction == ROWAGG_COUNT_NO_OP ||
 			fFunctionCols[i]->fAggFunction == ROWAGG_GROUP_CONCAT ||
-			fFunctionCols[i]->fAggFunction == ROWAGG_STATS)
+			fFunctionCols[i]->fAggFunction == ROWAGG_STATS ||
+			fFunctionCols[i]->fAggFunction == ROWAGG_APPROX_COUNT_DISTINCT)
 		{
 //			done by memset
 //			row.setIntField(0, colOut);
@@ -1454,6 +1525,11 @@ void RowAggregation::updateEntry(const Row& rowIn)
 				doStatistics(rowIn, colIn, colOut, colOut + 1);
 				break;
 
+			case ROWAGG_APPROX_COUNT_DISTINCT:
+				// the sketch is inserted after the count placeholder
+				doApproxCountDistinct(rowIn, colIn, colOut, colOut + 1);
+				break;
+
 			case ROWAGG_BIT_AND:
 			case ROWAGG_BIT_OR:
 			case ROWAGG_BIT_XOR:
@@ -1723,6 +1799,85 @@ void RowAggregation::doStatistics(const Row& rowIn, int64_t colIn, int64_t colOu
 }
 
 
+//------------------------------------------------------------------------------
+// Add a value to the HyperLogLog sketch if input is not null.
+// rowIn(in)  - Row to be included in aggregation.
+// colIn(in)  - column in the input row group
+// colOut(in) - column in the output row group for the estimate, set on UM
+// colAux(in) - column in the output row group stores the sketch
+//------------------------------------------------------------------------------
+void RowAggregation::doApproxCountDistinct(const Row& rowIn, int64_t colIn, int64_t colOut,
+	int64_t colAux)
+{
+	if (isNull(&fRowGroupIn, rowIn, colIn) == true)
+		return;
+
+	uint64_t hash = 0;
+	int colDataType = (fRowGroupIn.getColTypes())[colIn];
+	switch (colDataType)
+	{
+		case execplan::CalpontSystemCatalog::CHAR:
+		case execplan::CalpontSystemCatalog::VARCHAR:
+		{
+			if (rowIn.isLongString(colIn))
+			{
+				utils::Hasher128 hasher;
+				hash = hasher((const char*) rowIn.getStringPointer(colIn),
+					rowIn.getStringLength(colIn));
+			}
+			else
+			{
+				hash = utils::fmix(rowIn.getUintField(colIn));
+			}
+			break;
+		}
+
+		case execplan::CalpontSystemCatalog::VARBINARY:
+		{
+			uint32_t len = 0;
+			const uint8_t* val = rowIn.getVarBinaryField(len, colIn);
+			utils::Hasher128 hasher;
+			hash = hasher((const char*) val, len);
+			break;
+		}
+
+		case execplan::CalpontSystemCatalog::DOUBLE:
+		case execplan::CalpontSystemCatalog::UDOUBLE:
+		case execplan::CalpontSystemCatalog::FLOAT:
+		case execplan::CalpontSystemCatalog::UFLOAT:
+		case execplan::CalpontSystemCatalog::LONGDOUBLE:
+		{
+			// hash the double image, the same value hashes the same in any float type
+			double dbl = 0.0;
+			if (colDataType == execplan::CalpontSystemCatalog::FLOAT ||
+				colDataType == execplan::CalpontSystemCatalog::UFLOAT)
+				dbl = rowIn.getFloatField(colIn);
+			else if (colDataType == execplan::CalpontSystemCatalog::LONGDOUBLE)
+				dbl = (double) rowIn.getLongDoubleField(colIn);
+			else
+				dbl = rowIn.getDoubleField(colIn);
+
+			uint64_t bits = 0;
+			memcpy(&bits, &dbl, sizeof(bits));
+			hash = utils::fmix(bits);
+			break;
+		}
+
+		default:
+		{
+			// integer, decimal and date types
+			if (rowIn.isUnsigned(colIn))
+				hash = utils::fmix(rowIn.getUintField(colIn));
+			else
+				hash = utils::fmix((uint64_t) rowIn.getIntField(colIn));
+			break;
+		}
+	}
+
+	hllAdd(hllRegisters(fRow, colAux), hash);
+}
+
+
 //------------------------------------------------------------------------------
 // Allocate a new data array for the output RowGroup
 // return - true if successfully allocated
@@ -1783,7 +1938,7 @@ RowAggregationUM::RowAggregationUM(const vector<SP_ROWAGG_GRPBY_t>& rowAggGroupB
                                    const vector<SP_ROWAGG_FUNC_t>&  rowAggFunctionCols,
                                    joblist::ResourceManager *r, boost::shared_ptr<int64_t> sessionLimit) :
 	RowAggregation(rowAggGroupByCols, rowAggFunctionCols), fHasAvg(false), fKeyOnHeap(false),
-	fHasStatsFunc(false), fTotalMemUsage(0), fRm(r), fSessionMemLimit(sessionLimit),
+	fHasStatsFunc(false), fHasApproxDistinct(false), fTotalMemUsage(0), fRm(r), fSessionMemLimit(sessionLimit),
 	fLastMemUsage(0), fNextRGIndex(0)
 {
 	// Check if there are any avg functions.
@@ -1794,6 +1949,8 @@ RowAggregationUM::RowAggregationUM(const vector<SP_ROWAGG_GRPBY_t>& rowAggGroupB
 			fHasAvg = true;
 		else if (fFunctionCols[i]->fAggFunction == ROWAGG_STATS)
 			fHasStatsFunc = true;
+		else if (fFunctionCols[i]->fAggFunction == ROWAGG_APPROX_COUNT_DISTINCT)
+			fHasApproxDistinct = true;
 	}
 
 	// Check if all groupby column selected
@@ -1813,6 +1970,7 @@ RowAggregationUM::RowAggregationUM(const RowAggregationUM& rhs) :
 	fHasAvg(rhs.fHasAvg),
 	fKeyOnHeap(rhs.fKeyOnHeap),
 	fHasStatsFunc(rhs.fHasStatsFunc),
+	fHasApproxDistinct(rhs.fHasApproxDistinct),
 	fExpression(rhs.fExpression),
 	fTotalMemUsage(rhs.fTotalMemUsage),
 	fRm(rhs.fRm),
@@ -1865,6 +2023,7 @@ void RowAggregationUM::initialize()
 		fExtEq.reset(new ExternalKeyEq(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtHash.reset(new ExternalKeyHasher(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtKeyMapAlloc.reset(new utils::STLPoolAllocator<pair<RowPosition, RowPosition> >());
+		fExtKeyMapAlloc->getPoolAllocator()->setArena(fArena.get());
 		fExtKeyMap.reset(new ExtKeyMap_t(10, *fExtHash, *fExtEq, *fExtKeyMapAlloc));
 	}
 }
@@ -1878,6 +2037,10 @@ void RowAggregationUM::initialize()
 //------------------------------------------------------------------------------
 void RowAggregationUM::finalize()
 {
+	// UM: turn the sketches into counts before the duplicates are copied.
+	if (fHasApproxDistinct)
+		calculateApproxCountDistinct();
+
 	// copy the duplicates functions, except AVG
 	fixDuplicates(ROWAGG_DUP_FUNCT);
 
@@ -1976,6 +2139,13 @@ void RowAggregationUM::updateEntry(const Row& rowIn)
 				break;
 			}
 
+			case ROWAGG_APPROX_COUNT_DISTINCT:
+			{
+				int64_t colAux = fFunctionCols[i]->fAuxColumnIndex;
+				doApproxCountDistinct(rowIn, colIn, colOut, colAux);
+				break;
+			}
+
 			case ROWAGG_BIT_AND:
 			case ROWAGG_BIT_OR:
 			case ROWAGG_BIT_XOR:
@@ -2137,6 +2307,31 @@ void RowAggregationUM::calculateAvgColumns()
 }
 
 
+//------------------------------------------------------------------------------
+// After all PM rowgroups received, estimate the approx_count_distinct values.
+//------------------------------------------------------------------------------
+void RowAggregationUM::calculateApproxCountDistinct()
+{
+	for (uint64_t i = 0; i < fFunctionCols.size(); i++)
+	{
+		if (fFunctionCols[i]->fAggFunction != ROWAGG_APPROX_COUNT_DISTINCT)
+			continue;
+
+		int64_t colOut = fFunctionCols[i]->fOutputColumnIndex;
+		int64_t colAux = fFunctionCols[i]->fAuxColumnIndex;
+		fRowGroupOut->getRow(0, &fRow);
+		for (uint64_t j = 0; j < fRowGroupOut->getRowCount(); j++, fRow.nextRow())
+		{
+			const uint8_t* p = fRow.getData() + fRow.getOffset(colAux);
+			if (*((const uint16_t*) p) == 0)  // empty set, or all nulls
+				fRow.setIntField(0, colOut);
+			else
+				fRow.setIntField(hllEstimate(p + 2), colOut);
+		}
+	}
+}
+
+
 //------------------------------------------------------------------------------
 // After all PM rowgroups received, calculate the statistics.
 //------------------------------------------------------------------------------
@@ -2369,6 +2564,7 @@ void RowAggregationUM::doNullConstantAggregate(const ConstantAggData& aggData, u
 
 		case ROWAGG_COUNT_COL_NAME:
 		case ROWAGG_COUNT_DISTINCT_COL_NAME:
+		case ROWAGG_APPROX_COUNT_DISTINCT:
 		{
 			fRow.setIntField(0, colOut);
 		}
@@ -2642,6 +2838,7 @@ void RowAggregationUM::doNotNullConstantAggregate(const ConstantAggData& aggData
 		break;
 
 		case ROWAGG_COUNT_DISTINCT_COL_NAME:
+		case ROWAGG_APPROX_COUNT_DISTINCT:
 		{
 			fRow.setIntField(1, colOut);
 		}
@@ -2710,10 +2907,12 @@ bool RowAggregationUM::newRowGroup()
 	bool     ret = false;
 
 	allocSize = fRowGroupOut->getSizeWithStrings();
+	// hash map memory taken from the arena is already charged to the query
 	if (fKeyOnHeap)
-		memDiff = fKeyStore->getMemUsage() + fExtKeyMapAlloc->getMemUsage() - fLastMemUsage;
+		memDiff = fKeyStore->getMemUsage() - fLastMemUsage +
+			(fArena ? 0 : fExtKeyMapAlloc->getMemUsage());
 	else
-		memDiff = fAlloc->getMemUsage() - fLastMemUsage;
+		memDiff = (fArena ? 0 : fAlloc->getMemUsage()) - fLastMemUsage;
 
 	fLastMemUsage += memDiff;
 
@@ -2747,6 +2946,7 @@ void RowAggregationUM::setInputOutput(const RowGroup& pRowGroupIn, RowGroup* pRo
 		fExtEq.reset(new ExternalKeyEq(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtHash.reset(new ExternalKeyHasher(fKeyRG, fKeyStore.get(), fKeyRG.getColumnCount(), &tmpRow));
 		fExtKeyMapAlloc.reset(new utils::STLPoolAllocator<pair<RowPosition, RowPosition> >());
+		fExtKeyMapAlloc->getPoolAllocator()->setArena(fArena.get());
 		fExtKeyMap.reset(new ExtKeyMap_t(10, *fExtHash, *fExtEq, *fExtKeyMapAlloc));
 	}
 }
@@ -2846,6 +3046,13 @@ void RowAggregationUMP2::updateEntry(const Row& rowIn)
 				break;
 			}
 
+			case ROWAGG_APPROX_COUNT_DISTINCT:
+			{
+				int64_t colAux = fFunctionCols[i]->fAuxColumnIndex;
+				doApproxCountDistinct(rowIn, colIn, colOut, colAux);
+				break;
+			}
+
 			case ROWAGG_BIT_AND:
 			case ROWAGG_BIT_OR:
 			case ROWAGG_BIT_XOR:
@@ -3040,6 +3247,25 @@ void RowAggregationUMP2::doBitOp(const Row& rowIn, int64_t colIn, int64_t colOut
 }
 
 
+//------------------------------------------------------------------------------
+// Merge a partial HyperLogLog sketch from PM.
+// rowIn(in)  - Row to be included in aggregation.
+// colIn(in)  - column in the input row group, the sketch is at colIn + 1
+// colOut(in) - column in the output row group for the estimate
+// colAux(in) - column in the output row group stores the sketch
+//------------------------------------------------------------------------------
+void RowAggregationUMP2::doApproxCountDistinct(const Row& rowIn, int64_t colIn, int64_t colOut,
+	int64_t colAux)
+{
+	uint32_t len = 0;
+	const uint8_t* sketch = rowIn.getVarBinaryField(len, colIn + 1);
+	if (len != ROWAGG_HLL_REGISTERS)  // no value on that PM
+		return;
+
+	hllMerge(hllRegisters(fRow, colAux), sketch);
+}
+
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 RowAggregationDistinct::RowAggregationDistinct(const vector<SP_ROWAGG_GRPBY_t>& rowAggGroupByCols,
@@ -48,6 +48,7 @@
 #include "rowgroup.h"
 #include "hasher.h"
 #include "stlpoolallocator.h"
+#include "queryarena.h"
 #include "returnedcolumn.h"
 
 // To do: move code that depends on joblist to a proper subsystem.
@@ -97,6 +98,9 @@ enum RowAggFunctionType
 	// GROUP_CONCAT
 	ROWAGG_GROUP_CONCAT,
 
+	// APPROX_COUNT_DISTINCT: HyperLogLog sketch, merged on UM
+	ROWAGG_APPROX_COUNT_DISTINCT,
+
 	// DISTINCT: performed on UM only
 	ROWAGG_COUNT_DISTINCT_COL_NAME, // COUNT(distinct column_name) only counts non-null rows
 	ROWAGG_DISTINCT_SUM,
@@ -117,6 +121,14 @@ enum RowAggFunctionType
 
 };
 
+// APPROX_COUNT_DISTINCT keeps a HyperLogLog sketch of 2^11 one-byte registers
+// (about 2.3% standard error) in a VARBINARY column stored inline in the row:
+// 2-byte length followed by the registers.  The sketch is a fixed size, so the
+// memory per group does not depend on the number of distinct values.
+const uint32_t ROWAGG_HLL_PRECISION = 11;
+const uint32_t ROWAGG_HLL_REGISTERS = (1 << ROWAGG_HLL_PRECISION);
+const uint32_t ROWAGG_HLL_SKETCH_WIDTH = ROWAGG_HLL_REGISTERS + 2;
+
 
 //------------------------------------------------------------------------------
 /** @brief Specifies a column in a RowGroup that is part of the aggregation
@@ -311,6 +323,7 @@ struct GroupConcat
 	std::vector<std::pair<int, bool> >  fOrderCond;    // position to order by [asc/desc]
 	joblist::ResourceManager*           fRm;           // resource manager
 	boost::shared_ptr<int64_t>			fSessionMemLimit;
+	boost::shared_ptr<utils::QueryArena> fArena;       // for the result text
 
 	GroupConcat() : fRm(NULL) {}
 };
@@ -387,6 +400,13 @@ class RowAggregation : public messageqcpp::Serializeable
 		virtual void setInputOutput(const RowGroup &pRowGroupIn, RowGroup* pRowGroupOut)
 		{ fRowGroupIn = pRowGroupIn; fRowGroupOut = pRowGroupOut; initialize();}
 
+		/** @brief Take the hash map memory from a query arena.
+		 *
+		 * The arena charges it to the query's budget, so it is left out of the
+		 * aggregation's own accounting.  Must be set before setInputOutput().
+		 */
+		void setArena(const boost::shared_ptr<utils::QueryArena>& arena) { fArena = arena; }
+
 
 		/** @brief Define content of data to be joined
 		 *
@@ -470,6 +490,7 @@ class RowAggregation : public messageqcpp::Serializeable
 		virtual void doAvg(const Row&, int64_t, int64_t, int64_t);
 		virtual void doStatistics(const Row&, int64_t, int64_t, int64_t);
 		virtual void doBitOp(const Row&, int64_t, int64_t, int);
+		virtual void doApproxCountDistinct(const Row&, int64_t, int64_t, int64_t);
 		virtual bool countSpecial(const RowGroup* pRG)
 		{ fRow.setIntField<8>(fRow.getIntField<8>(0) + pRG->getRowCount(), 0); return true; }
 
@@ -520,7 +541,8 @@ class RowAggregation : public messageqcpp::Serializeable
 		uint32_t                                            fSmallSideCount;
 		boost::scoped_array<Row> rowSmalls;
 
-		// for hashmap
+		// for hashmap; the arena has to outlive the allocators that draw from it
+		boost::shared_ptr<utils::QueryArena> fArena;
 		boost::shared_ptr<utils::STLPoolAllocator<RowPosition> > fAlloc;
 
 		// for 8k poc
@@ -628,6 +650,9 @@ class RowAggregationUM : public RowAggregation
 		// calculate the statistics function all rows received. UM only function.
 		void calculateStatisticsFunctions();
 
+		// estimate approx_count_distinct from the sketches. UM only function.
+		void calculateApproxCountDistinct();
+
 		// fix duplicates. UM only function.
 		void fixDuplicates(RowAggFunctionType funct);
 
@@ -646,6 +671,7 @@ class RowAggregationUM : public RowAggregation
 		bool fHasAvg;
 		bool fKeyOnHeap;
 		bool fHasStatsFunc;
+		bool fHasApproxDistinct;
 
 		boost::shared_ptr<RowAggregation> fDistinctAggregator;
 
@@ -715,6 +741,7 @@ class RowAggregationUMP2 : public RowAggregationUM
 		void doStatistics(const Row&, int64_t, int64_t, int64_t);
 		void doGroupConcat(const Row&, int64_t, int64_t);
 		void doBitOp(const Row&, int64_t, int64_t, int);
+		void doApproxCountDistinct(const Row&, int64_t, int64_t, int64_t);
 		bool countSpecial(const RowGroup* pRG) { return false; }
 };
 
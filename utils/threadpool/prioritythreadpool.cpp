@@ -30,6 +30,8 @@ using namespace std;
 #include "messagelog.h"
 using namespace logging;
 
+#include "numatopology.h"
+
 #include "prioritythreadpool.h"
 using namespace boost;
 
@@ -37,17 +39,27 @@ namespace threadpool
 {
 
 PriorityThreadPool::PriorityThreadPool(uint targetWeightPerRun, uint highThreads,
-		uint midThreads, uint lowThreads, uint ID) :
+		uint midThreads, uint lowThreads, uint ID, uint numaNodes, const string &name) :
+		nodeCount(numaNodes > 0 ? numaNodes : 1), nextNode(0),
 		_stop(false), weightPerRun(targetWeightPerRun), id(ID)
 {
-	for (uint32_t i = 0; i < highThreads; i++)
-		threads.create_thread(ThreadHelper(this, HIGH));
-	for (uint32_t i = 0; i < midThreads; i++)
-		threads.create_thread(ThreadHelper(this, MEDIUM));
-	for (uint32_t i = 0; i < lowThreads; i++)
-		threads.create_thread(ThreadHelper(this, LOW));
+	jobQueues.reset(new list<Job>[nodeCount * _COUNT]);
+	newJob.reset(new condition[nodeCount]);
+
+	const char *names[] = { "low", "medium", "high" };
+	for (uint32_t i = 0; i < _COUNT; i++)
+		queueWait[i] = utils::Metrics::instance()->histogram("idb_threadpool_queue_wait_usec",
+			"pool=\"" + name + "\",priority=\"" + names[i] + "\"",
+			"Time jobs spend queued in a PriorityThreadPool");
+
+	startThreads(highThreads, HIGH);
+	startThreads(midThreads, MEDIUM);
+	startThreads(lowThreads, LOW);
 	cout << "started " << highThreads << " high, " << midThreads << " med, " << lowThreads
-			<< " low.\n";
+			<< " low";
+	if (nodeCount > 1)
+		cout << " on " << nodeCount << " NUMA nodes";
+	cout << ".\n";
 	threadCounts[HIGH] = highThreads;
 	threadCounts[MEDIUM] = midThreads;
 	threadCounts[LOW] = lowThreads;
@@ -58,6 +70,13 @@ PriorityThreadPool::~PriorityThreadPool()
 	stop();
 }
 
+void PriorityThreadPool::startThreads(uint32_t count, Priority queue)
+{
+	// deal them out so every node gets its share of each priority
+	for (uint32_t i = 0; i < count; i++)
+		threads.create_thread(ThreadHelper(this, queue, i % nodeCount));
+}
+
 void PriorityThreadPool::addJob(const Job &job, bool useLock)
 {
 	mutex::scoped_lock lk(mutex, defer_lock_t());
@@ -65,15 +84,26 @@ void PriorityThreadPool::addJob(const Job &job, bool useLock)
 	if (useLock)
 		lk.lock();
 
+	uint32_t node;
+	if (job.node >= 0)
+		node = job.node % nodeCount;
+	else
+		node = nextNode++ % nodeCount;
+
+	list<Job> *queue;
 	if (job.priority > 66)
-		jobQueues[HIGH].push_back(job);
+		queue = &jobQueues[node * _COUNT + HIGH];
 	else if (job.priority > 33)
-		jobQueues[MEDIUM].push_back(job);
+		queue = &jobQueues[node * _COUNT + MEDIUM];
 	else
-		jobQueues[LOW].push_back(job);
+		queue = &jobQueues[node * _COUNT + LOW];
+	queue->push_back(job);
+	queue->back().queuedAt = utils::monotonicUsec();
+	// a rescheduled job stays on the node it was given
+	queue->back().node = node;
 
 	if (useLock)
-		newJob.notify_one();
+		newJob[node].notify_one();
 }
 
 void PriorityThreadPool::removeJobs(uint32_t id)
@@ -82,7 +112,7 @@ void PriorityThreadPool::removeJobs(uint32_t id)
 
 	mutex::scoped_lock lk(mutex);
 
-	for (uint32_t i = 0; i < _COUNT; i++)
+	for (uint32_t i = 0; i < nodeCount * _COUNT; i++)
 		for (it = jobQueues[i].begin(); it != jobQueues[i].end();)
 			if (it->id == id)
 				it = jobQueues[i].erase(it);
@@ -90,39 +120,55 @@ void PriorityThreadPool::removeJobs(uint32_t id)
 				++it;
 }
 
-PriorityThreadPool::Priority PriorityThreadPool::pickAQueue(Priority preference)
+uint32_t PriorityThreadPool::pickAQueue(Priority preference, uint32_t node)
 {
-	if (!jobQueues[preference].empty())
-		return preference;
-	else if (!jobQueues[HIGH].empty())
-		return HIGH;
-	else if (!jobQueues[MEDIUM].empty())
-		return MEDIUM;
-	else
-		return LOW;
+	// this node's queues first, then work the other nodes haven't gotten to
+	for (uint32_t i = 0; i < nodeCount; i++) {
+		uint32_t base = ((node + i) % nodeCount) * _COUNT;
+
+		if (!jobQueues[base + preference].empty())
+			return base + preference;
+		else if (!jobQueues[base + HIGH].empty())
+			return base + HIGH;
+		else if (!jobQueues[base + MEDIUM].empty())
+			return base + MEDIUM;
+		else if (!jobQueues[base + LOW].empty())
+			return base + LOW;
+	}
+	return node * _COUNT + LOW;
 }
 
-void PriorityThreadPool::threadFcn(const Priority preferredQueue) throw()
+void PriorityThreadPool::threadFcn(const Priority preferredQueue, const uint32_t node) throw()
 {
-	Priority queue;
+	uint32_t queue;
 	uint32_t weight, i;
 	vector<Job> runList;
 	vector<bool> reschedule;
 	uint32_t rescheduleCount;
 	uint32_t queueSize;
+	uint64_t now;
+
+	if (nodeCount > 1)
+		utils::NumaTopology::instance()->bindThread(node);
 
 	while (!_stop) {
 
 		mutex::scoped_lock lk(mutex);
 
-		queue = pickAQueue(preferredQueue);
+		queue = pickAQueue(preferredQueue, node);
 		if (jobQueues[queue].empty()) {
-			newJob.wait(lk);
+			/* Jobs are only announced to their own node.  With more than one node,
+			   wake up now and then to look for jobs the other nodes are behind on. */
+			if (nodeCount > 1)
+				newJob[node].timed_wait(lk, posix_time::milliseconds(5));
+			else
+				newJob[node].wait(lk);
 			continue;
 		}
 
 		queueSize = jobQueues[queue].size();
 		weight = 0;
+		now = utils::monotonicUsec();
 		// 3 conditions stop this thread from grabbing all jobs in the queue
 		//
 		// 1: The weight limit has been exceeded
@@ -135,6 +181,7 @@ void PriorityThreadPool::threadFcn(const Priority preferredQueue) throw()
 			runList.push_back(jobQueues[queue].front());
 			jobQueues[queue].pop_front();
 			weight += runList.back().weight;
+			queueWait[queue % _COUNT]->record(now - runList.back().queuedAt);
 		}
 		lk.unlock();
 
@@ -162,9 +209,9 @@ void PriorityThreadPool::threadFcn(const Priority preferredQueue) throw()
 				if (reschedule[i])
 					addJob(runList[i], false);
 			if (rescheduleCount > 1)
-				newJob.notify_all();
+				newJob[node].notify_all();
 			else
-				newJob.notify_one();
+				newJob[node].notify_one();
 			lk.unlock();
 		}
 		runList.clear();
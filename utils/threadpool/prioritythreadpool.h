@@ -34,8 +34,10 @@
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/function.hpp>
 #include "winport.h"
+#include "metrics.h"
 
 namespace threadpool
 {
@@ -55,11 +57,13 @@ public:
     //typedef boost::function0<int> Functor;
 
 	struct Job {
-		Job() : weight(1), priority(0), id(0) { }
+		Job() : weight(1), priority(0), id(0), queuedAt(0), node(-1) { }
 		boost::shared_ptr<Functor> functor;
 		uint32_t weight;
 		uint32_t priority;
 		uint32_t id;
+		uint64_t queuedAt;	// set by addJob()
+		int32_t node;		// preferred NUMA node, -1 for any
 	};
 
 	enum Priority {
@@ -75,10 +79,17 @@ public:
      *********************************************/
 
     /** @brief ctor
+      *
+      * With numaNodes > 1 the threads of each priority are split across that many
+      * NUMA nodes and bound to their node's CPUs.  Every node has its own queues; a
+      * job goes to the queues of Job::node (round-robin if it has none) and is run
+      * by a thread of that node, unless the other nodes' threads go idle and take it.
+      * name tells the pools apart in the metrics.
       */
 
     PriorityThreadPool(uint targetWeightPerRun, uint highThreads, uint midThreads,
-    		uint lowThreads, uint id = 0);
+    		uint lowThreads, uint id = 0, uint numaNodes = 1,
+    		const std::string &name = "default");
     virtual ~PriorityThreadPool();
 
     void removeJobs(uint32_t id);
@@ -93,27 +104,34 @@ protected:
 
 private:
     struct ThreadHelper {
-        ThreadHelper(PriorityThreadPool *impl, Priority queue) : ptp(impl), preferredQueue(queue) { }
-        void operator()() { ptp->threadFcn(preferredQueue); }
+        ThreadHelper(PriorityThreadPool *impl, Priority queue, uint32_t n) :
+            ptp(impl), preferredQueue(queue), node(n) { }
+        void operator()() { ptp->threadFcn(preferredQueue, node); }
         PriorityThreadPool *ptp;
         Priority preferredQueue;
+        uint32_t node;
     };
 
     explicit PriorityThreadPool();
     explicit PriorityThreadPool(const PriorityThreadPool &);
     PriorityThreadPool & operator=(const PriorityThreadPool &);
 
-    Priority pickAQueue(Priority preference);
-    void threadFcn(const Priority preferredQueue) throw();
+    uint32_t pickAQueue(Priority preference, uint32_t node);
+    void threadFcn(const Priority preferredQueue, const uint32_t node) throw();
+    void startThreads(uint32_t count, Priority queue);
 
-    std::list<Job> jobQueues[3];  // higher indexes = higher priority
+    // node * _COUNT + priority; higher priorities = higher indexes
+    boost::scoped_array<std::list<Job> > jobQueues;
     uint32_t threadCounts[3];
+    uint32_t nodeCount;
+    uint32_t nextNode;
     boost::mutex mutex;
-    boost::condition newJob;
+    boost::scoped_array<boost::condition> newJob;	// one per node
     boost::thread_group threads;
     bool _stop;
     uint32_t weightPerRun;
     volatile uint id;   // prevent it from being optimized out
+    utils::LatencyHistogram *queueWait[_COUNT];
 };
 
 } // namespace threadpool
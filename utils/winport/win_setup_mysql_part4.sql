@@ -18,4 +18,5 @@ CREATE FUNCTION idbextentmin RETURNS STRING soname 'libcalmysql.dll';
 CREATE FUNCTION idbextentmax RETURNS STRING soname 'libcalmysql.dll';
 CREATE FUNCTION idbpartition RETURNS STRING soname 'libcalmysql.dll';
 CREATE FUNCTION idblocalpm RETURNS INTEGER soname 'libcalmysql.dll';
+CREATE AGGREGATE FUNCTION approx_count_distinct RETURNS INTEGER soname 'libcalmysql.dll';
 
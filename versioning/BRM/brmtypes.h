@@ -471,6 +471,8 @@ const uint8_t RELEASE_LBID_RANGES = 91;
 
 /* More main BRM functions 100-110 */
 const uint8_t BULK_UPDATE_DBROOT = 100;
+const uint8_t BULK_WRITE_VB_ENTRY = 101;
+const uint8_t SWAP_PARTITION = 102;
 
 
 /* Error codes returned by the DBRM functions. */
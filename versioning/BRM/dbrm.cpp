@@ -1823,6 +1823,41 @@ int DBRM::restorePartition(const std::vector<OID_t>& oids,
 	return err;
 }
 
+int DBRM::swapPartition(const vector<OID_t>& colOids, const vector<OID_t>& dictOids,
+	uint16_t dbRoot, uint32_t oldPartition, uint32_t newPartition,
+	const vector<BulkSetHWMArg>& hwmArgs) DBRM_THROW
+{
+#ifdef BRM_INFO
+	if (fDebug)
+	{
+		TRACER_WRITELATER("swapPartition");
+		TRACER_ADDSHORTINPUT(dbRoot);
+		TRACER_ADDINPUT(oldPartition);
+		TRACER_ADDINPUT(newPartition);
+		TRACER_WRITE;
+	}
+#endif
+
+	ByteStream command, response;
+	uint8_t err;
+
+	command << SWAP_PARTITION;
+	serializeInlineVector(command, colOids);
+	serializeInlineVector(command, dictOids);
+	command << dbRoot << oldPartition << newPartition;
+	serializeInlineVector(command, hwmArgs);
+	err = send_recv(command, response);
+	if (err != ERR_OK)
+		return err;
+
+	if (response.length() != 1)
+		return ERR_NETWORK;
+
+	response >> err;
+	CHECK_EMPTY(response);
+	return err;
+}
+
 //------------------------------------------------------------------------------
 // Return all the out-of-service partitions for the specified OID.
 //------------------------------------------------------------------------------
@@ -1942,6 +1977,42 @@ int DBRM::writeVBEntry(VER_t transID, LBID_t lbid, OID_t vbOID,
 	return err;
 }
 
+int DBRM::bulkWriteVBEntry(VER_t transID, const vector<LBID_t>& lbids, OID_t vbOID,
+	const vector<uint32_t>& vbFBOs) DBRM_THROW
+{
+
+#ifdef BRM_INFO
+	if (fDebug)
+	{
+  		TRACER_WRITELATER("bulkWriteVBEntry");
+		TRACER_ADDINPUT(transID);
+		TRACER_ADDINPUT(vbOID);
+		TRACER_WRITE;
+	}	
+#endif
+
+	ByteStream command, response;
+	uint8_t err;
+
+	idbassert(lbids.size() == vbFBOs.size());
+	if (lbids.empty())
+		return ERR_OK;
+
+	command << BULK_WRITE_VB_ENTRY << (uint32_t) transID << (uint32_t) vbOID;
+	serializeInlineVector(command, lbids);
+	serializeInlineVector(command, vbFBOs);
+	err = send_recv(command, response);
+	if (err != ERR_OK)
+		return err;
+
+	if (response.length() != 1)
+		return ERR_NETWORK;
+
+	response >> err;
+	CHECK_EMPTY(response);
+	return err;
+}
+
 struct _entry {
 	_entry(LBID_t l) : lbid(l) { };
 	LBID_t lbid;
@@ -568,6 +568,23 @@ public:
 	EXPORT int restorePartition(const std::vector<OID_t>& oids,
 						const std::set<LogicalPartition>& partitionNums, std::string& emsg) DBRM_THROW;
 
+	/** @brief Replace a partition on a DBRoot with a rewritten copy of it.
+	 *
+	 * In one extent map update, the HWMs in hwmArgs are set, the column
+	 * extents of oldPartition are marked out of service, those of newPartition
+	 * are put in service, and the dictionary store extents of oldPartition
+	 * are renumbered to newPartition.
+	 * @param colOids (in) the column OIDs of the table.
+	 * @param dictOids (in) the dictionary store OIDs of the table.
+	 * @param hwmArgs (in) the HWMs of the newPartition segment files, and
+	 * any others to set at the same time.
+	 * @return 0 on success, non-0 on error (see brmtypes.h)
+	 */
+	EXPORT int swapPartition(const std::vector<OID_t>& colOids,
+						const std::vector<OID_t>& dictOids, uint16_t dbRoot,
+						uint32_t oldPartition, uint32_t newPartition,
+						const std::vector<BulkSetHWMArg>& hwmArgs) DBRM_THROW;
+
 	/** @brief Get the list of out-of-service partitions for a given OID
 	 *
 	 * @param OID (in) the OID of interest.
@@ -604,6 +621,16 @@ public:
 	 */
 	EXPORT int writeVBEntry(VER_t transID, LBID_t lbid, OID_t vbOID, 
 					 uint32_t vbFBO) DBRM_THROW;
+
+	/** @brief Registers many version buffer entries in one operation.
+	 *
+	 * Same as calling writeVBEntry(transID, lbids[i], vbOID, vbFBOs[i])
+	 * for every i, but takes the VBBM and VSS locks and makes the round
+	 * trip to the controller only once.
+	 * @return 0 on success, non-0 on error (see brmtypes.h)
+	 */
+	EXPORT int bulkWriteVBEntry(VER_t transID, const std::vector<LBID_t>& lbids,
+					 OID_t vbOID, const std::vector<uint32_t>& vbFBOs) DBRM_THROW;
 	
 	/** @brief Retrieves a list of uncommitted LBIDs.
 	 * 
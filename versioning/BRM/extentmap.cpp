@@ -4691,6 +4691,87 @@ void ExtentMap::restorePartition(const set<OID_t>& oids,
 	}
 }
 
+//------------------------------------------------------------------------------
+// Put the rewritten copy (newPartition) of a partition on dbRoot in service in
+// place of the original, and carry the original's dictionary store extents
+// over to it.  The HWMs are set under the same lock, so the new partition
+// never shows up without them.  Nothing is changed unless both partitions are
+// found; a bad HWM argument throws, and the controller undoes what was done.
+//------------------------------------------------------------------------------
+void ExtentMap::swapPartition(const vector<OID_t>& colOids,
+	const vector<OID_t>& dictOids, uint16_t dbRoot,
+	uint32_t oldPartition, uint32_t newPartition,
+	const vector<BulkSetHWMArg>& hwmArgs)
+{
+#ifdef BRM_INFO
+	if (fDebug)
+	{
+		TRACER_WRITELATER("swapPartition");
+		TRACER_ADDSHORTINPUT(dbRoot);
+		TRACER_ADDINPUT(oldPartition);
+		TRACER_ADDINPUT(newPartition);
+		TRACER_WRITE;
+	}
+#endif
+	set<OID_t> cols(colOids.begin(), colOids.end());
+	set<OID_t> dicts(dictOids.begin(), dictOids.end());
+	vector<uint32_t> oldExtents, newExtents, dictExtents;
+
+	grabEMEntryTable(WRITE);
+
+	int emEntries = fEMShminfo->allocdSize/sizeof(struct EMEntry);
+	for (int i = 0; i < emEntries; i++)
+	{
+		if (fExtentMap[i].range.size == 0 || fExtentMap[i].dbRoot != dbRoot)
+			continue;
+
+		if (cols.find(fExtentMap[i].fileID) != cols.end())
+		{
+			if (fExtentMap[i].partitionNum == oldPartition)
+				oldExtents.push_back(i);
+			else if (fExtentMap[i].partitionNum == newPartition)
+				newExtents.push_back(i);
+		}
+		else if (fExtentMap[i].partitionNum == oldPartition &&
+				 dicts.find(fExtentMap[i].fileID) != dicts.end())
+		{
+			dictExtents.push_back(i);
+		}
+	}
+
+	if (oldExtents.empty() || newExtents.empty())
+	{
+		ostringstream oss;
+		oss << "ExtentMap::swapPartition(): partition " << 
+			(oldExtents.empty() ? oldPartition : newPartition) <<
+			" not found on DBRoot " << dbRoot;
+		log(oss.str(), logging::LOG_TYPE_CRITICAL);
+		throw invalid_argument(oss.str());
+	}
+
+	for (uint32_t i = 0; i < hwmArgs.size(); i++)
+		setLocalHWM(hwmArgs[i].oid, hwmArgs[i].partNum, hwmArgs[i].segNum,
+			hwmArgs[i].hwm, false, false);
+
+	for (uint32_t i = 0; i < oldExtents.size(); i++)
+	{
+		makeUndoRecord(&fExtentMap[oldExtents[i]], sizeof(EMEntry));
+		fExtentMap[oldExtents[i]].status = EXTENTOUTOFSERVICE;
+	}
+
+	for (uint32_t i = 0; i < newExtents.size(); i++)
+	{
+		makeUndoRecord(&fExtentMap[newExtents[i]], sizeof(EMEntry));
+		fExtentMap[newExtents[i]].status = EXTENTAVAILABLE;
+	}
+
+	for (uint32_t i = 0; i < dictExtents.size(); i++)
+	{
+		makeUndoRecord(&fExtentMap[dictExtents[i]], sizeof(EMEntry));
+		fExtentMap[dictExtents[i]].partitionNum = newPartition;
+	}
+}
+
 //------------------------------------------------------------------------------
 // Return all the out-of-service partitions for the specified OID.
 //------------------------------------------------------------------------------
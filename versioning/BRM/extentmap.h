@@ -722,6 +722,16 @@ public:
 	EXPORT void restorePartition(const std::set<OID_t>& oids,
 						const std::set<LogicalPartition>& partitionNums, std::string& emsg);
 
+	/** @brief Replace a partition on a DBRoot with a rewritten copy of it.
+	 *
+	 * See DBRM::swapPartition().  Throws if either partition has no column
+	 * extents on dbRoot.
+	 */
+	EXPORT void swapPartition(const std::vector<OID_t>& colOids,
+						const std::vector<OID_t>& dictOids, uint16_t dbRoot,
+						uint32_t oldPartition, uint32_t newPartition,
+						const std::vector<BulkSetHWMArg>& hwmArgs);
+
 	/** @brief Get the list of out-of-service partitions for a given OID
 	 *
 	 * @param OID (in) the OID of interest.
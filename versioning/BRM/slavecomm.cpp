@@ -299,6 +299,7 @@ void SlaveComm::processCommand(ByteStream &msg)
 		case BULK_SET_HWM: do_bulkSetHWM(msg); break;
 		case BULK_SET_HWM_AND_CP: do_bulkSetHWMAndCP(msg); break;
 		case WRITE_VB_ENTRY: do_writeVBEntry(msg); break;
+		case BULK_WRITE_VB_ENTRY: do_bulkWriteVBEntry(msg); break;
 		case BEGIN_VB_COPY: do_beginVBCopy(msg); break;
 		case END_VB_COPY: do_endVBCopy(msg); break;
 		case VB_ROLLBACK1: do_vbRollback1(msg); break;
@@ -323,6 +324,7 @@ void SlaveComm::processCommand(ByteStream &msg)
 		case RELEASE_LBID_RANGES: do_dmlReleaseLBIDRanges(msg); break;
 		case DELETE_DBROOT: do_deleteDBRoot(msg); break;
 		case BULK_UPDATE_DBROOT: do_bulkUpdateDBRoot(msg); break;
+		case SWAP_PARTITION: do_swapPartition(msg); break;
 
 		default:
 			cerr << "WorkerComm: unknown command " << (int) cmd << endl;
@@ -992,6 +994,45 @@ void SlaveComm::do_bulkUpdateDBRoot(ByteStream &msg)
 	doSaveDelta = true;
 }
 
+void SlaveComm::do_swapPartition(ByteStream &msg)
+{
+	vector<OID_t> colOids, dictOids;
+	uint16_t dbRoot;
+	uint32_t oldPartition, newPartition;
+	vector<BulkSetHWMArg> hwmArgs;
+	ByteStream reply;
+	int err;
+
+#ifdef BRM_VERBOSE
+	cerr << "WorkerComm: do_swapPartition()" << endl;
+#endif
+
+	deserializeInlineVector(msg, colOids);
+	deserializeInlineVector(msg, dictOids);
+	msg >> dbRoot >> oldPartition >> newPartition;
+	deserializeInlineVector(msg, hwmArgs);
+
+	if (printOnly) {
+		cout << "swapPartition: dbRoot=" << dbRoot << " oldPartition=" << oldPartition <<
+			" newPartition=" << newPartition << " columns=" << colOids.size() <<
+			" dictionaries=" << dictOids.size() << endl;
+		for (uint32_t i = 0; i < hwmArgs.size(); i++)
+			cout << "   oid=" << hwmArgs[i].oid << " partition=" << hwmArgs[i].partNum <<
+				" segment=" << hwmArgs[i].segNum << " hwm=" << hwmArgs[i].hwm << endl;
+		return;
+	}
+
+	err = slave->swapPartition(colOids, dictOids, dbRoot, oldPartition, newPartition,
+		hwmArgs);
+	reply << (uint8_t) err;
+#ifdef BRM_VERBOSE
+	cerr << "WorkerComm: do_swapPartition() err code is " << err << endl;
+#endif
+	if (!standalone)
+		master.write(reply);
+	doSaveDelta = true;
+}
+
 void SlaveComm::do_markInvalid(ByteStream &msg)
 {
 	LBID_t lbid;
@@ -1510,6 +1551,45 @@ void SlaveComm::do_writeVBEntry(ByteStream &msg)
 	doSaveDelta = true;
 }
 
+void SlaveComm::do_bulkWriteVBEntry(ByteStream &msg)
+{
+	VER_t transID;
+	OID_t vbOID;
+	vector<LBID_t> lbids;
+	vector<uint32_t> vbFBOs;
+	uint32_t tmp;
+	int err;
+	ByteStream reply;
+
+#ifdef BRM_VERBOSE
+	cerr << "WorkerComm: do_bulkWriteVBEntry()" << endl;
+#endif
+
+	msg >> tmp;
+	transID = tmp;
+	msg >> tmp;
+	vbOID = tmp;
+	deserializeInlineVector(msg, lbids);
+	deserializeInlineVector(msg, vbFBOs);
+
+	if (printOnly) {
+		cout << "bulkWriteVBEntry: transID=" << transID << " vbOID=" << vbOID <<
+			" entries=" << lbids.size() << endl;
+		for (uint32_t i = 0; i < lbids.size(); i++)
+			cout << "   lbid=" << lbids[i] << " vbFBO=" << vbFBOs[i] << endl;
+		return;
+	}
+
+	err = slave->bulkWriteVBEntry(transID, lbids, vbOID, vbFBOs);
+	reply << (uint8_t) err;
+#ifdef BRM_VERBOSE
+	cerr << "WorkerComm: do_bulkWriteVBEntry() err code is " << err << endl;
+#endif
+	if (!standalone)
+		master.write(reply);
+	doSaveDelta = true;
+}
+
 void SlaveComm::do_beginVBCopy(ByteStream &msg)
 {
 	VER_t transID;
@@ -89,6 +89,7 @@ class SlaveComm {
 		void do_bulkSetHWM(messageqcpp::ByteStream &msg);
 		void do_bulkSetHWMAndCP(messageqcpp::ByteStream &msg);
 		void do_writeVBEntry(messageqcpp::ByteStream &msg); 
+		void do_bulkWriteVBEntry(messageqcpp::ByteStream &msg);
 		void do_beginVBCopy(messageqcpp::ByteStream &msg);
 		void do_endVBCopy(messageqcpp::ByteStream &msg); 
 		void do_vbRollback1(messageqcpp::ByteStream &msg);
@@ -107,6 +108,7 @@ class SlaveComm {
 		void do_dmlReleaseLBIDRanges(messageqcpp::ByteStream &msg);
 		void do_deleteDBRoot(messageqcpp::ByteStream &msg);
 		void do_bulkUpdateDBRoot(messageqcpp::ByteStream &msg);
+		void do_swapPartition(messageqcpp::ByteStream &msg);
 
 		void do_undo();
 		void do_confirm();
@@ -414,6 +414,20 @@ int SlaveDBRMNode::bulkUpdateDBRoot(const vector<BulkUpdateDBRootArg> &args) thr
 	return 0;
 }
 
+int SlaveDBRMNode::swapPartition(const vector<OID_t>& colOids, const vector<OID_t>& dictOids,
+	uint16_t dbRoot, uint32_t oldPartition, uint32_t newPartition,
+	const vector<BulkSetHWMArg>& hwmArgs) throw()
+{
+	try {
+		em.swapPartition(colOids, dictOids, dbRoot, oldPartition, newPartition, hwmArgs);
+	}
+	catch (exception &e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+	return 0;
+}
+
 
 int SlaveDBRMNode::writeVBEntry(VER_t transID, LBID_t lbid, OID_t vbOID,
 										 uint32_t vbFBO) throw()
@@ -470,6 +484,50 @@ int SlaveDBRMNode::writeVBEntry(VER_t transID, LBID_t lbid, OID_t vbOID,
 	return 0;
 }
 
+int SlaveDBRMNode::bulkWriteVBEntry(VER_t transID, const vector<LBID_t>& lbids,
+	OID_t vbOID, const vector<uint32_t>& vbFBOs) throw()
+{
+	VER_t oldVerID;
+
+	try {
+		vbbm.lock(VBBM::WRITE);
+		locked[0] = true;
+		vss.lock(VSS::WRITE);
+		locked[1] = true;
+
+		// same as writeVBEntry(), one block at a time but under a single lock
+		for (uint32_t i = 0; i < lbids.size(); i++) {
+			oldVerID = vss.getCurrentVersion(lbids[i], NULL);
+
+			if (oldVerID == transID)
+				continue;
+			else if (oldVerID > transID) {
+				ostringstream str;
+
+				str << "WorkerDBRMNode::bulkWriteVBEntry(): Overlapping transactions detected.  "
+					"Transaction " << transID << " cannot overwrite blocks written by "
+					"transaction " << oldVerID;
+				log(str.str());
+				return ERR_OLDTXN_OVERWRITING_NEWTXN;
+			}
+
+			vbbm.insert(lbids[i], oldVerID, vbOID, vbFBOs[i]);
+			if (oldVerID > 0)
+				vss.setVBFlag(lbids[i], oldVerID, true);
+			else
+				vss.insert(lbids[i], oldVerID, true, false);
+
+			vss.insert(lbids[i], transID, false, true);
+		}
+	}
+	catch (exception &e) {
+		cerr << e.what() << endl;
+		return -1;
+	}
+
+	return 0;
+}
+
 int SlaveDBRMNode::beginVBCopy(VER_t transID, uint16_t vbOID,
 		const LBIDRange_v& ranges, VBRange_v& freeList, bool flushPMCache) throw()
 {
@@ -345,6 +345,15 @@ class SlaveDBRMNode {
 		EXPORT int restorePartition(const std::set<OID_t>& oids,
 						std::set<LogicalPartition>& partitionNum, std::string& emsg) throw();
 
+		/** @brief Replace a partition on a DBRoot with a rewritten copy of it.
+		 *
+		 * See DBRM::swapPartition().
+		 */
+		EXPORT int swapPartition(const std::vector<OID_t>& colOids,
+						const std::vector<OID_t>& dictOids, uint16_t dbRoot,
+						uint32_t oldPartition, uint32_t newPartition,
+						const std::vector<BulkSetHWMArg>& hwmArgs) throw();
+
 		/** @brief Delete all extent map rows for the specified dbroot
 		 *
 		 * @param dbroot (in) the dbroot
@@ -361,6 +370,15 @@ class SlaveDBRMNode {
 		 */
 		EXPORT int writeVBEntry(VER_t transID, LBID_t lbid, OID_t vbOID, 
 						 uint32_t vbFBO) throw();
+
+		/** @brief Registers many version buffer entries under one lock.
+		 *
+		 * Entry i is <lbids[i], vbFBOs[i]> in vbOID.  Stops at the
+		 * first error; the caller undoes the partial batch.
+		 * @return 0 on success, -1 or an ERR_ code on error
+		 */
+		EXPORT int bulkWriteVBEntry(VER_t transID, const std::vector<LBID_t>& lbids,
+						 OID_t vbOID, const std::vector<uint32_t>& vbFBOs) throw();
 		
 		/** @brief Atomically prepare to copy data to the version buffer
 		 * 
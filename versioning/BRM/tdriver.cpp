@@ -153,6 +153,7 @@ CPPUNIT_TEST(extentMap_good_1);
 CPPUNIT_TEST(extentMap_range_1);
 #endif
 CPPUNIT_TEST(extentMap_freelist);
+CPPUNIT_TEST(extentMap_swapPartition_1);
 // CPPUNIT_TEST(extentMap_overfill);
 //CPPUNIT_TEST(many_ExtentMap_instances); //Jean unsuggested this case since writeengine use singleton
 CPPUNIT_TEST(copyLocks_good_1);
@@ -428,6 +429,141 @@ public:
 	}
 #endif
 
+	/* State of the extent of a column OID in partition part, segment 0 on DBRoot 1 */
+	int extentState(ExtentMap& em, int oid, uint32_t part)
+	{
+		bool found;
+		int status;
+
+		em.getExtentState(oid, part, 0, found, status);
+		CPPUNIT_ASSERT(found);
+		return status;
+	}
+
+	/* Partition of the only extent of a dictionary OID */
+	uint32_t dictPartition(ExtentMap& em, int oid)
+	{
+		vector<struct EMEntry> entries;
+
+		em.getExtents(oid, entries, false, false, true);
+		CPPUNIT_ASSERT(entries.size() == 1);
+		return entries[0].partitionNum;
+	}
+
+	/* Compaction: two columns and a dictionary in partition 0 on DBRoot 1, the
+	 * rewritten copy in partition 1, out of service until it is swapped in */
+	void extentMap_swapPartition_1()
+	{
+		ExtentMap em;
+		const int col1 = 3001, col2 = 3002, dict = 3003;
+		vector<OID_t> colOids, dictOids;
+		vector<BulkSetHWMArg> hwmArgs;
+		set<OID_t> oids;
+		set<LogicalPartition> lps;
+		BulkSetHWMArg arg;
+		LBID_t lbid;
+		int allocdSize, status, caughtException, i;
+		uint32_t startBlock;
+		string emsg;
+
+		colOids.push_back(col1);
+		colOids.push_back(col2);
+		dictOids.push_back(dict);
+
+		for (i = 0; i < 2; i++) {
+			em.createColumnExtentExactFile(colOids[i], 4, 1, 0, 0,
+				execplan::CalpontSystemCatalog::INT, lbid, allocdSize, startBlock);
+			em.confirmChanges();
+			em.createColumnExtentExactFile(colOids[i], 4, 1, 1, 0,
+				execplan::CalpontSystemCatalog::INT, lbid, allocdSize, startBlock);
+			em.confirmChanges();
+			em.setLocalHWM(colOids[i], 0, 0, 20, false);
+			em.confirmChanges();
+		}
+		em.createDictStoreExtent(dict, 1, 0, 0, lbid, allocdSize);
+		em.confirmChanges();
+
+		oids.insert(col1);
+		oids.insert(col2);
+		lps.insert(LogicalPartition(1, 1, 0));
+		em.markPartitionForDeletion(oids, lps, emsg);
+		em.confirmChanges();
+		em.checkConsistency();
+
+		for (i = 0; i < 2; i++) {
+			arg.oid = colOids[i];
+			arg.partNum = 1;
+			arg.segNum = 0;
+			arg.hwm = 7;
+			hwmArgs.push_back(arg);
+		}
+
+		// a partition that isn't there, nothing changes
+		caughtException = 0;
+		try {
+			em.swapPartition(colOids, dictOids, 1, 0, 5, hwmArgs);
+		}
+		catch (invalid_argument& e) {
+			caughtException = 1;
+		}
+		em.undoChanges();
+		CPPUNIT_ASSERT(caughtException == 1);
+		CPPUNIT_ASSERT(extentState(em, col1, 0) == EXTENTAVAILABLE);
+		CPPUNIT_ASSERT(extentState(em, col1, 1) == EXTENTOUTOFSERVICE);
+
+		// a bad HWM argument after the good ones, all of it undone
+		arg.oid = col2;
+		arg.partNum = 9;
+		hwmArgs.push_back(arg);
+		caughtException = 0;
+		try {
+			em.swapPartition(colOids, dictOids, 1, 0, 1, hwmArgs);
+		}
+		catch (invalid_argument& e) {
+			caughtException = 1;
+		}
+		em.undoChanges();
+		hwmArgs.pop_back();
+		CPPUNIT_ASSERT(caughtException == 1);
+		for (i = 0; i < 2; i++) {
+			CPPUNIT_ASSERT(extentState(em, colOids[i], 0) == EXTENTAVAILABLE);
+			CPPUNIT_ASSERT(extentState(em, colOids[i], 1) == EXTENTOUTOFSERVICE);
+			CPPUNIT_ASSERT(em.getLocalHWM(colOids[i], 0, 0, status) == 20);
+			CPPUNIT_ASSERT(em.getLocalHWM(colOids[i], 1, 0, status) == 0);
+		}
+		CPPUNIT_ASSERT(dictPartition(em, dict) == 0);
+		em.checkConsistency();
+
+		// swapped in, then undone as the controller does when a slave fails
+		em.swapPartition(colOids, dictOids, 1, 0, 1, hwmArgs);
+		em.undoChanges();
+		CPPUNIT_ASSERT(extentState(em, col2, 0) == EXTENTAVAILABLE);
+		CPPUNIT_ASSERT(extentState(em, col2, 1) == EXTENTOUTOFSERVICE);
+		CPPUNIT_ASSERT(em.getLocalHWM(col2, 1, 0, status) == 0);
+		CPPUNIT_ASSERT(dictPartition(em, dict) == 0);
+
+		// swapped in
+		em.swapPartition(colOids, dictOids, 1, 0, 1, hwmArgs);
+		em.confirmChanges();
+		for (i = 0; i < 2; i++) {
+			CPPUNIT_ASSERT(extentState(em, colOids[i], 0) == EXTENTOUTOFSERVICE);
+			CPPUNIT_ASSERT(extentState(em, colOids[i], 1) == EXTENTAVAILABLE);
+			CPPUNIT_ASSERT(em.getLocalHWM(colOids[i], 0, 0, status) == 20);
+			CPPUNIT_ASSERT(em.getLocalHWM(colOids[i], 1, 0, status) == 7);
+			CPPUNIT_ASSERT(status == EXTENTAVAILABLE);
+		}
+		CPPUNIT_ASSERT(dictPartition(em, dict) == 1);
+		em.checkConsistency();
+
+		for (i = 0; i < 2; i++) {
+			em.deleteOID(colOids[i]);
+			em.confirmChanges();
+		}
+		em.deleteOID(dict);
+		em.confirmChanges();
+                Config::deleteInstanceMap();
+	}
+
 	void extentMap_freelist()
 	{
 		ExtentMap em;
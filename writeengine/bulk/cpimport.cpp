@@ -104,7 +104,7 @@ void printUsage()
   "    [-c readBufSize] [-e maxErrs] [-B libBufSize] [-n NullOption] " << endl<<
   "    [-E encloseChar] [-C escapeChar] [-I binaryOpt] [-S] "
   "[-d debugLevel] [-i] " << endl<<
-  "     [-D] [-N] [-L rejectDir]" << endl;
+  "     [-D] [-N] [-L rejectDir] [-K sortColumn]" << endl;
 
     cout << endl << "Traditional usage without positional parameters "
       "(XML job file required):" << endl <<
@@ -114,7 +114,7 @@ void printUsage()
   "    [-E encloseChar] [-C escapeChar] [-I binaryOpt] [-S] "
   "[-d debugLevel] [-i] " << endl<<
   "    [-p path] [-l loadFile]" << endl<<
-  "     [-D] [-N] [-L rejectDir]" << endl << endl;
+  "     [-D] [-N] [-L rejectDir] [-K sortColumn]" << endl << endl;
 
     cout << "    Positional parameters:" << endl <<
         "        dbName    Name of database to load" << endl <<
@@ -162,7 +162,11 @@ void printUsage()
         "        -S Treat string truncations as errors" << endl << 
         "        -D Disable timeout when waiting for table lock" << endl <<
         "        -N Disable console output" << endl <<
-        "        -L send *.err and *.bad (reject) files here" << endl << endl;
+        "        -L send *.err and *.bad (reject) files here" << endl <<
+        "        -K Sort the rows of each read buffer by this column, to "
+        "narrow" << endl <<
+        "           the min/max range of each extent (text imports only)"
+        << endl << endl;
 
     cout << "    Example1:" << endl <<
         "        cpimport.bin -j 1234" << endl <<
@@ -310,7 +314,7 @@ void parseCmdLineArgs(
     std::string jobUUID;
 
     while( (option=getopt(
-        argc,argv,"b:c:d:e:f:hij:kl:m:n:p:r:s:u:w:B:C:DE:I:P:R:SX:NL:")) != EOF )
+        argc,argv,"b:c:d:e:f:hij:kl:m:n:p:r:s:u:w:B:C:DE:I:K:P:R:SX:NL:")) != EOF )
     {
         switch(option)
         {
@@ -601,6 +605,12 @@ void parseCmdLineArgs(
                 break;
             }
 
+            case 'K':                                // -K: sort key column
+            {
+                curJob.setSortKey( std::string(optarg) );
+                break;
+            }
+
 			case 'L':                                // -L: Error log directory
 			{
 				curJob.setErrorDir( optarg );
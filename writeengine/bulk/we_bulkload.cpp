@@ -760,6 +760,12 @@ int BulkLoad::preProcess( Job& job, int tableNo,
         fLog.logMsg( oss12.str(), MSGLVL_INFO2 );
     }
 
+    // A sort key on the command line applies to every table in the job
+    const std::string& sortKey = fSortKey.empty() ?
+        job.jobTableList[tableNo].sortKey : fSortKey;
+    if (!sortKey.empty())
+        tableInfo->setSortKey( sortKey );
+
     // Initialize BulkLoadBuffers after we have added all the columns
     tableInfo->initializeBuffers(fNoOfBuffers, 
                                  job.jobTableList[tableNo].fFldRefs,
@@ -141,6 +141,7 @@ public:
     void                setProcessName       ( const std::string& processName );
     void                setReadBufferCount   ( int noOfReadBuffers );
     void                setReadBufferSize    ( int readBufferSize );
+    void                setSortKey           ( const std::string& sortKey );
     void                setTxnID             ( BRM::TxnID txnID );
     void                setVbufReadSize      ( int vbufReadSize );
     void                setTruncationAsError ( bool bTruncationAsError );
@@ -209,6 +210,8 @@ private:
     std::string fBRMRptFileName;           // Name of distributed mode rpt file
     bool        fbTruncationAsError;       // Treat string truncation as error
     ImportDataMode fImportDataMode;        // Importing text or binary data
+    std::string fSortKey;                  // Column to sort read buffers by;
+                                           //   overrides the Job XML sortKey
     bool        fbContinue;                // true when read and parse r running
                                            //
     static boost::mutex*       fDDLMutex;  // Insure only 1 DDL op at a time
@@ -382,6 +385,9 @@ inline void BulkLoad::setReadBufferCount( int noOfReadBuffers ) {
 inline void BulkLoad::setReadBufferSize( int readBufferSize ) {
     fBufferSize = readBufferSize; }
 
+inline void BulkLoad::setSortKey( const std::string& sortKey ) {
+    fSortKey = sortKey; }
+
 inline void BulkLoad::setTxnID( BRM::TxnID txnID ) {
     fTxnID = txnID; }
 
@@ -30,6 +30,8 @@
 #include <cmath>
 #include <ctype.h>
 #include <cfloat>
+#include <vector>
+#include <algorithm>
 #include "we_bulkload.h"
 #include "we_bulkloadbuffer.h"
 #include "we_brm.h"
@@ -107,6 +109,56 @@ inline void resizeRowDataArray( char** pRowData,
     *pRowData = tmpRaw;
 }
 
+//------------------------------------------------------------------------------
+// Sort key for one row of a read buffer; see BulkLoadBuffer::sortRows().
+// Only the member matching the column's RowSortKeyType is set.
+//------------------------------------------------------------------------------
+enum RowSortKeyType
+{
+    SORT_KEY_INT,                       // signed ints, dates, and datetimes
+    SORT_KEY_UINT,                      // unsigned ints
+    SORT_KEY_DOUBLE,                    // decimals and floating point
+    SORT_KEY_STRING                     // compared byte by byte
+};
+
+struct RowSortKey
+{
+    WriteEngine::ColPosPair* fRow;      // tokens for the row
+    bool        fNull;                  // NULLs sort ahead of all values
+    int64_t     fInt;
+    uint64_t    fUInt;
+    double      fDbl;
+    const char* fStr;
+    int         fLen;
+};
+
+class RowSortKeyCompare
+{
+public:
+    explicit RowSortKeyCompare(RowSortKeyType type) : fType(type) { }
+
+    bool operator()(const RowSortKey& a, const RowSortKey& b) const
+    {
+        if (a.fNull || b.fNull)
+            return (a.fNull && !b.fNull);
+
+        switch (fType)
+        {
+            case SORT_KEY_INT:    return (a.fInt  < b.fInt);
+            case SORT_KEY_UINT:   return (a.fUInt < b.fUInt);
+            case SORT_KEY_DOUBLE: return (a.fDbl  < b.fDbl);
+            default:
+            {
+                int rc = memcmp(a.fStr, b.fStr, std::min(a.fLen, b.fLen));
+                return ((rc < 0) || ((rc == 0) && (a.fLen < b.fLen)));
+            }
+        }
+    }
+
+private:
+    RowSortKeyType fType;
+};
+
 }
 
 //#define DEBUG_TOKEN_PARSING 1
@@ -128,7 +180,7 @@ BulkLoadBuffer::BulkLoadBuffer(
         fEnclosedByChar('\0'), fEscapeChar('\\'),
         fBufferId(bufferId), fTableName(tableName),
         fbTruncationAsError(false), fImportDataMode(IMPORT_DATA_TEXT),
-        fFixedBinaryRecLen(0)
+        fFixedBinaryRecLen(0), fSortColumn(-1)
 {
     fData            = new char[bufferSize];
     fOverflowBuf     = NULL;
@@ -1876,6 +1928,9 @@ int  BulkLoadBuffer::fillFromFile(
         if (fImportDataMode == IMPORT_DATA_TEXT)
         {
             tokenize( columnsInfo, allowedErrCntThisCall );
+
+            if ((fSortColumn >= 0) && (fTotalReadRows > 1))
+                sortRows( columnsInfo[fSortColumn].column );
         }
         else
         {
@@ -1899,6 +1954,110 @@ int  BulkLoadBuffer::fillFromFile(
     return NO_ERROR;
 }
 
+//------------------------------------------------------------------------------
+// Reorder the first fTotalReadRows rows of fTokens by the value each row holds
+// for the fSortColumn column, so that the extents this buffer is parsed into
+// get narrower min/max ranges.  Every column is parsed from fTokens, so moving
+// a row's token pointer moves the whole row.  The sort is stable, leaving rows
+// with equal keys in file order.  Values that can't be converted are sorted
+// with the NULLs; parseCol() will report them as usual.
+//------------------------------------------------------------------------------
+void BulkLoadBuffer::sortRows(const JobColumn& column)
+{
+    RowSortKeyType type;
+    switch (column.dataType)
+    {
+        case CalpontSystemCatalog::UTINYINT:
+        case CalpontSystemCatalog::USMALLINT:
+        case CalpontSystemCatalog::UMEDINT:
+        case CalpontSystemCatalog::UINT:
+        case CalpontSystemCatalog::UBIGINT:
+            type = SORT_KEY_UINT;
+            break;
+        case CalpontSystemCatalog::DECIMAL:
+        case CalpontSystemCatalog::UDECIMAL:
+        case CalpontSystemCatalog::FLOAT:
+        case CalpontSystemCatalog::UFLOAT:
+        case CalpontSystemCatalog::DOUBLE:
+        case CalpontSystemCatalog::UDOUBLE:
+            type = SORT_KEY_DOUBLE;
+            break;
+        case CalpontSystemCatalog::CHAR:
+        case CalpontSystemCatalog::VARCHAR:
+        case CalpontSystemCatalog::VARBINARY:
+        case CalpontSystemCatalog::CLOB:
+        case CalpontSystemCatalog::BLOB:
+            type = SORT_KEY_STRING;
+            break;
+        default:
+            type = SORT_KEY_INT;
+            break;
+    }
+
+    std::vector<RowSortKey> keys(fTotalReadRows);
+    char field[64];
+    for (uint32_t i = 0; i < fTotalReadRows; i++)
+    {
+        RowSortKey& key = keys[i];
+        const ColPosPair& token = fTokens[i][fSortColumn];
+        key.fRow  = fTokens[i];
+        key.fNull = (token.offset <= 0);
+        if (key.fNull)
+            continue;
+
+        const char* p = fData + token.start;
+        if (type == SORT_KEY_STRING)
+        {
+            key.fStr = p;
+            key.fLen = token.offset;
+            continue;
+        }
+
+        // Numbers and dates are short; anything longer is invalid anyway
+        int len = std::min(token.offset, (int)sizeof(field) - 1);
+        memcpy(field, p, len);
+        field[len] = '\0';
+
+        char* end = field;
+        int   rc  = 0;
+        switch (type)
+        {
+            case SORT_KEY_UINT:
+                key.fUInt = strtoull(field, &end, 10);
+                break;
+            case SORT_KEY_DOUBLE:
+                key.fDbl  = strtod(field, &end);
+                if (isnan(key.fDbl))
+                    end = field;
+                break;
+            default:
+                if (column.dataType == CalpontSystemCatalog::DATE)
+                {
+                    key.fInt = dataconvert::DataConvert::convertColumnDate(
+                        field, dataconvert::CALPONTDATE_ENUM, rc, len);
+                    end = field + len;
+                }
+                else if (column.dataType == CalpontSystemCatalog::DATETIME)
+                {
+                    key.fInt = dataconvert::DataConvert::convertColumnDatetime(
+                        field, dataconvert::CALPONTDATETIME_ENUM, rc, len);
+                    end = field + len;
+                }
+                else
+                {
+                    key.fInt = strtoll(field, &end, 10);
+                }
+                break;
+        }
+        key.fNull = ((end == field) || (rc != 0));
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), RowSortKeyCompare(type));
+
+    for (uint32_t i = 0; i < fTotalReadRows; i++)
+        fTokens[i] = keys[i].fRow;
+}
+
 //------------------------------------------------------------------------------
 // Parse the rows of data in "fData", saving the meta information that describes
 // the parsed data, in fTokens.  If the number of read parsing errors for a
@@ -140,6 +140,7 @@ private:
     bool fbTruncationAsError;           // Treat string truncation as error
     ImportDataMode fImportDataMode;     // Import data in text or binary mode
     unsigned int fFixedBinaryRecLen;    // Fixed rec len used in binary mode
+    int fSortColumn;                    // Column to sort rows by; -1 if none
 
     //--------------------------------------------------------------------------
     // Private Functions
@@ -210,6 +211,10 @@ private:
                   unsigned int allowedErrCntThisCall,
                   bool bEndOfData);
 
+    /** @brief Reorder the rows in fTokens by the value of the sort column.
+     */
+    void sortRows(const JobColumn& column);
+
     /** @brief Determine if specified value is NULL or not.
      */
     bool isBinaryFieldNull(void* val, WriteEngine::ColType ct,
@@ -342,6 +347,11 @@ public:
         unsigned int fixedBinaryRecLen )
     { fImportDataMode    = importMode;
       fFixedBinaryRecLen = fixedBinaryRecLen; }
+
+    /** @brief Set the column whose values the rows read into this buffer are
+     *         to be sorted by before parsing; -1 to leave them in file order.
+     */
+    void setSortColumn( int sortColumn ) { fSortColumn = sortColumn; }
 };
 
 }
@@ -34,6 +34,9 @@
 #include <sstream>
 
 #include <boost/scoped_array.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
 
 #include "we_define.h"
 #include "we_config.h"
@@ -48,8 +51,114 @@ using namespace idbdatafile;
 #include "idbcompress.h"
 using namespace compress;
 
+#include "threadpool.h"
+
+namespace
+{
+boost::mutex              compressPoolLock;
+threadpool::ThreadPool*   compressPool    = 0;
+unsigned                  compressThreads = 0;
+
+// Free slots for chunks queued or being compressed, of all columns.  Each
+// holds an uncompressed chunk and its compressed copy until written out.
+boost::mutex              compressSlotLock;
+unsigned                  compressSlots   = 0;
+
+// Worker pool shared by all compressed columns of the import; NULL if
+// chunks are to be compressed on the calling thread.
+threadpool::ThreadPool* getCompressPool()
+{
+    boost::mutex::scoped_lock lk(compressPoolLock);
+    if (compressThreads == 0)
+    {
+        compressThreads = WriteEngine::Config::getChunkCompressThreads();
+        if (compressThreads > 1)
+        {
+            boost::mutex::scoped_lock slk(compressSlotLock);
+            compressSlots = WriteEngine::Config::getChunkCompressQueue();
+            compressPool  = new threadpool::ThreadPool(compressThreads, 0);
+        }
+    }
+
+    return compressPool;
+}
+
+// Take a slot; false if there is none.  Never waits, a slot is only given back
+// once its column writes the chunk out.
+bool takeCompressSlot()
+{
+    boost::mutex::scoped_lock lk(compressSlotLock);
+    if (compressSlots == 0)
+        return false;
+
+    compressSlots--;
+    return true;
+}
+
+void releaseCompressSlot()
+{
+    boost::mutex::scoped_lock lk(compressSlotLock);
+    compressSlots++;
+}
+}
+
 namespace WriteEngine {
 
+//------------------------------------------------------------------------------
+// A full to-be-compressed buffer handed to the compression pool.  The job owns
+// the buffer, and the output buffer it compresses into, and the compression
+// slot taken for it by queueChunk().
+//------------------------------------------------------------------------------
+struct ColumnBufferCompressed::CompressJob
+{
+    CompressJob(const IDBCompressInterface* compressor, unsigned char* inBuf,
+        size_t inLen, unsigned int outSize) :
+        fCompressor(compressor), fInBuf(inBuf), fInLen(inLen),
+        fOutBuf(new unsigned char[outSize]), fOutSize(outSize), fOutLen(outSize),
+        fRc(NO_ERROR), fDone(false) { }
+
+    ~CompressJob() { releaseCompressSlot(); }
+
+    void run()
+    {
+        int rc = NO_ERROR;
+        if (fCompressor->compressBlock(reinterpret_cast<char*>(fInBuf.get()),
+            fInLen, fOutBuf.get(), fOutLen) != 0)
+            rc = ERR_COMP_COMPRESS;
+        else if (fCompressor->padCompressedChunks(fOutBuf.get(), fOutLen, fOutSize) != 0)
+            rc = ERR_COMP_PAD_DATA;
+
+        boost::mutex::scoped_lock lk(fMutex);
+        fRc   = rc;
+        fDone = true;
+        fCond.notify_all();
+    }
+
+    bool isDone()
+    {
+        boost::mutex::scoped_lock lk(fMutex);
+        return fDone;
+    }
+
+    void wait()
+    {
+        boost::mutex::scoped_lock lk(fMutex);
+        while (!fDone)
+            fCond.wait(lk);
+    }
+
+    const IDBCompressInterface*        fCompressor;
+    boost::scoped_array<unsigned char> fInBuf;
+    size_t                             fInLen;
+    boost::scoped_array<unsigned char> fOutBuf;
+    unsigned int                       fOutSize;
+    unsigned int                       fOutLen;
+    int                                fRc;
+    bool                               fDone;
+    boost::mutex                       fMutex;
+    boost::condition                   fCond;
+};
+
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -72,6 +181,11 @@ ColumnBufferCompressed::ColumnBufferCompressed( ColumnInfo* pColInfo,
 //------------------------------------------------------------------------------
 ColumnBufferCompressed::~ColumnBufferCompressed()
 {
+    // queued jobs use fCompressor
+    for (unsigned i = 0; i < fQueuedChunks.size(); i++)
+        fQueuedChunks[i]->wait();
+    fQueuedChunks.clear();
+
     if (fToBeCompressedBuffer)
         delete []fToBeCompressedBuffer;
     fToBeCompressedBuffer   = 0;
@@ -119,6 +233,9 @@ int ColumnBufferCompressed::resetToBeCompressedColBuf(
     // Don't load chunk, once we go to next extent
     fPreLoadHWMChunk = false;
 
+    // the chunk pointers must be complete to find the next offset
+    RETURN_ON_ERROR( writeQueuedChunks(true) );
+
     // Lazy creation of to-be-compressed buffer
     if (!fToBeCompressedBuffer)
     {
@@ -277,7 +394,10 @@ int ColumnBufferCompressed::writeToFile(int startOffset, int writeSize)
                 //std::cout << "dbg: before writeToFile->compressAndFlush" <<
                 //    std::endl;
                 //std::cin  >> resp;
-                int rc = compressAndFlush( false );
+                // Once the starting HWM chunk and its header are out,
+                // the remaining chunks can be compressed in the background.
+                int rc = fFlushedStartHwmChunk ? queueChunk() :
+                                                 compressAndFlush( false );
                 //std::cout << "dbg: after writeToFile->compressAndFlush" <<
                 //    std::endl;
                 //std::cin  >> resp;
@@ -355,6 +475,9 @@ int ColumnBufferCompressed::writeToFile(int startOffset, int writeSize)
 //------------------------------------------------------------------------------
 int ColumnBufferCompressed::compressAndFlush( bool bFinishingFile )
 {
+    // chunks already queued go first
+    RETURN_ON_ERROR( writeQueuedChunks(true) );
+
     const int OUTPUT_BUFFER_SIZE = IDBCompressInterface::maxCompressedSize(fToBeCompressedCapacity) +
         fUserPaddingBytes;
     unsigned char* compressedOutBuf = new unsigned char[ OUTPUT_BUFFER_SIZE ];
@@ -385,6 +508,20 @@ int ColumnBufferCompressed::compressAndFlush( bool bFinishingFile )
     
 #ifdef PROFILE
     Stats::stopParseEvent(WE_STATS_COMPRESS_COL_COMPRESS);
+#endif
+
+    return writeCompressedChunk( compressedOutBuf, outputLen, bFinishingFile );
+}
+
+//------------------------------------------------------------------------------
+// Write a compressed chunk at the current file offset and add it to the chunk
+// pointers.  Also writes out the compression header when finishing the file,
+// or for the starting HWM chunk; see compressAndFlush().
+//------------------------------------------------------------------------------
+int ColumnBufferCompressed::writeCompressedChunk( unsigned char* compressedOutBuf,
+    unsigned int outputLen, bool bFinishingFile )
+{
+#ifdef PROFILE
     Stats::startParseEvent(WE_STATS_WRITE_COL);
 #endif
 
@@ -448,6 +585,67 @@ int ColumnBufferCompressed::compressAndFlush( bool bFinishingFile )
     return NO_ERROR;
 }
 
+//------------------------------------------------------------------------------
+// Hand the full to-be-compressed buffer to the compression pool, and start
+// over with a new buffer.  Compressed chunks are written in order by
+// writeQueuedChunks().  Falls back to compressAndFlush() if there is no pool.
+//------------------------------------------------------------------------------
+int ColumnBufferCompressed::queueChunk()
+{
+    threadpool::ThreadPool* pool = getCompressPool();
+    if (!pool)
+        return compressAndFlush( false );
+
+    // All slots taken: compress this chunk here, after the chunks before it,
+    // rather than wait for other columns to write theirs out.
+    if (!takeCompressSlot())
+    {
+        RETURN_ON_ERROR( writeQueuedChunks(true) );
+        return compressAndFlush( false );
+    }
+
+    unsigned int outputSize =
+        IDBCompressInterface::maxCompressedSize(fToBeCompressedCapacity) +
+        fUserPaddingBytes;
+    SPCompressJob job(new CompressJob(fCompressor, fToBeCompressedBuffer,
+        fToBeCompressedCapacity, outputSize));
+    fToBeCompressedBuffer =
+        new unsigned char[IDBCompressInterface::UNCOMPRESSED_INBUF_LEN];
+
+    fQueuedChunks.push_back(job);
+    pool->invoke(boost::bind(&CompressJob::run, job));
+
+    return writeQueuedChunks(false);
+}
+
+//------------------------------------------------------------------------------
+// Write out the queued chunks that are done compressing, in order.  With bWait,
+// or once too many chunks are queued for this column, wait for them.
+//------------------------------------------------------------------------------
+int ColumnBufferCompressed::writeQueuedChunks(bool bWait)
+{
+    while (!fQueuedChunks.empty())
+    {
+        SPCompressJob job = fQueuedChunks.front();
+        if (!job->isDone())
+        {
+            if (!bWait && fQueuedChunks.size() <= compressThreads)
+                break;
+
+            job->wait();
+        }
+
+        fQueuedChunks.pop_front();
+        if (job->fRc != NO_ERROR)
+            return job->fRc;
+
+        RETURN_ON_ERROR( writeCompressedChunk(job->fOutBuf.get(),
+            job->fOutLen, false) );
+    }
+
+    return NO_ERROR;
+}
+
 //------------------------------------------------------------------------------
 // Final flushing of data and headers prior to closing the file.
 // File is also truncated if applicable.
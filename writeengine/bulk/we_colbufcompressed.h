@@ -31,6 +31,9 @@
 
 #include <cstdio>
 #include <vector>
+#include <deque>
+
+#include <boost/shared_ptr.hpp>
 
 #include "idbcompress.h"
 
@@ -44,6 +47,11 @@ struct ColumnInfo;
  * compressed column data before writing it out to the intended destination
  * (currently a file stream). The file stream should be initialized by
  * the client of this class
+ *
+ * Full chunks after the starting HWM chunk are compressed on a worker pool
+ * shared by all columns (WriteEngine/ChunkCompressThreads).  The compressed
+ * chunks are written, and their pointers recorded, in the order they were
+ * filled, on the thread calling writeToFile().
  */
 class ColumnBufferCompressed : public ColumnBuffer {
 
@@ -91,8 +99,17 @@ class ColumnBufferCompressed : public ColumnBuffer {
     ColumnBufferCompressed(const ColumnBufferCompressed&);
     ColumnBufferCompressed& operator=(const ColumnBufferCompressed&);
 
+    // A full chunk being compressed by the worker pool
+    struct CompressJob;
+    typedef boost::shared_ptr<CompressJob> SPCompressJob;
+
     // Compress and flush the to-be-compressed buffer; updates header if needed
     int compressAndFlush(bool bFinishFile);
+    int writeCompressedChunk(unsigned char* compressedBuf, unsigned int outputLen,
+                             bool bFinishFile);  // Write out a compressed chunk
+    int queueChunk();           // Hand the full buffer to the worker pool
+    int writeQueuedChunks(bool bWait);// Write out chunks done compressing;
+                                // bWait waits for all queued chunks
     int initToBeCompressedBuffer( long long& startFileOffset);
                                 // Initialize the to-be-compressed buffer
     int saveCompressionHeaders(); // Saves compression headers to the db file
@@ -110,6 +127,9 @@ class ColumnBufferCompressed : public ColumnBuffer {
     unsigned int         fUserPaddingBytes;     // compressed chunk padding
     bool                 fFlushedStartHwmChunk; // have we rewritten the hdr
                                                 //   for the starting HWM chunk
+    std::deque<SPCompressJob>
+                         fQueuedChunks;         // chunks being compressed,
+                                                //   in file order
 };
 
 }
@@ -30,6 +30,8 @@
 
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <algorithm>
 
 #include "we_define.h"
 #include "we_brm.h"
@@ -236,6 +238,64 @@ void ColExtInf::getCPInfoForBRM( JobColumn column, BRMReporter& brmReporter )
     fMap.clear(); // don't need map anymore, so release memory
 }
 
+//------------------------------------------------------------------------------
+// Log the CP selectivity of the extents loaded for this column: the share of
+// extents whose min/max range includes a given value, averaged over the
+// extents' own minimums.  This is the fraction of extents an equality
+// predicate on a loaded value can't eliminate; 1/extents is the best case.
+// Ranges are mapped to unsigned keys so that signed, unsigned, and (byte
+// swapped) character values all compare correctly as uint64_t.
+//------------------------------------------------------------------------------
+void ColExtInf::logCPSelectivity( const JobColumn& column )
+{
+    const uint64_t signFlip = (isUnsigned(column.dataType) ||
+        (column.weType == WriteEngine::WR_CHAR)) ? 0 : (1ULL << 63);
+    std::vector<uint64_t> mins;
+    std::vector<uint64_t> maxs;
+
+    {
+        boost::mutex::scoped_lock lock(fMapMutex);
+        RowExtMap::const_iterator iter = fMap.begin();
+        while (iter != fMap.end())
+        {
+            // Skip extents that received no rows, or only NULLs
+            uint64_t minVal = static_cast<uint64_t>(iter->second.fMinVal)
+                ^ signFlip;
+            uint64_t maxVal = static_cast<uint64_t>(iter->second.fMaxVal)
+                ^ signFlip;
+            if ((iter->second.fMinVal != LLONG_MIN) && (minVal <= maxVal))
+            {
+                mins.push_back( minVal );
+                maxs.push_back( maxVal );
+            }
+            ++iter;
+        }
+    }
+
+    if (mins.empty())
+        return;
+
+    // Extents containing v = extents with min <= v, less those with max < v
+    std::sort( mins.begin(), mins.end() );
+    std::sort( maxs.begin(), maxs.end() );
+    double total = 0;
+    for (unsigned i = 0; i < mins.size(); i++)
+    {
+        total += (std::upper_bound(mins.begin(), mins.end(), mins[i]) -
+                  mins.begin()) -
+                 (std::lower_bound(maxs.begin(), maxs.end(), mins[i]) -
+                  maxs.begin());
+    }
+    double selectivity = total / mins.size() / mins.size();
+
+    std::ostringstream oss;
+    oss << "CP selectivity for sort key " << column.colName <<
+           "; OID-" << fColOid << "; extents-" << mins.size() <<
+           "; an equality match scans " << (selectivity * 100.0) <<
+           "% of extents on average";
+    fLog->logMsg( oss.str(), MSGLVL_INFO1 );
+}
+
 //------------------------------------------------------------------------------
 // Print contents of this object to the log file.
 //------------------------------------------------------------------------------
@@ -125,6 +125,7 @@ public:
     virtual void getCPInfoForBRM ( JobColumn column,
                                    BRMReporter& brmReporter){ }
     virtual void print( const JobColumn& column )           { }
+    virtual void logCPSelectivity( const JobColumn& column ){ }
     virtual int updateEntryLbid( BRM::LBID_t startLbid )    { return NO_ERROR; }
 };
 
@@ -182,6 +183,12 @@ public:
      */
     virtual void print( const JobColumn& column );
 
+    /** @brief Log how well the extents' min/max ranges separate the values
+     *  loaded; used to report on the effect of a sort key.  Must be called
+     *  before getCPInfoForBRM(), which releases the collected ranges.
+     */
+    virtual void logCPSelectivity( const JobColumn& column );
+
     /** @brief Add extent's LBID to the oldest entry that is awaiting an LBID
      *  @param startLbid Starting LBID for a pending extent.
      *  @return NO_ERROR upon success; else error if extent entry not found
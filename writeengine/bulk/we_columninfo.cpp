@@ -148,7 +148,8 @@ ColumnInfo::ColumnInfo(Log*             logger,
                        fDbRootExtTrk(pDBRootExtTrk),
                        fColWidthFactor(1),
                        fDelayedFileCreation(INITIAL_DBFILE_STAT_FILE_EXISTS),
-                       fRowsPerExtent(0)
+                       fRowsPerExtent(0),
+                       fSortKey(false)
 {
     column = columnIn;
 
@@ -1265,6 +1266,9 @@ void ColumnInfo::getBRMUpdateInfo( BRMReporter& brmReporter )
 //------------------------------------------------------------------------------
 void ColumnInfo::getCPInfoForBRM( BRMReporter& brmReporter )
 {
+    if (fSortKey)
+        fColExtInf->logCPSelectivity(column);
+
     fColExtInf->getCPInfoForBRM(column, brmReporter);
 }
 
@@ -397,6 +397,11 @@ struct ColumnInfo
      */
     unsigned rowsPerExtent( );
 
+    /** @brief Flag this column as the table's sort key, so that the CP
+     *  selectivity of its extents is reported at the end of the import.
+     */
+    void setSortKey( bool bSortKey );
+
   protected:
 
     //--------------------------------------------------------------------------
@@ -502,6 +507,7 @@ struct ColumnInfo
                                             // to be created after preprocessing
 
     unsigned     fRowsPerExtent;            // Number of rows per column extent
+    bool         fSortKey;                  // Rows are sorted by this column
 };
 
 //------------------------------------------------------------------------------
@@ -557,6 +563,11 @@ inline unsigned ColumnInfo::rowsPerExtent()
     return fRowsPerExtent;
 }
 
+inline void ColumnInfo::setSortKey( bool bSortKey )
+{
+    fSortKey = bSortKey;
+}
+
 inline void ColumnInfo::updateCPInfo(
     RID     lastInputRow,
     int64_t minVal,
@@ -45,6 +45,7 @@ using namespace std;
 
 // @bug 2099-
 #include <boost/filesystem/path.hpp>
+#include <boost/algorithm/string/predicate.hpp>
 using namespace boost;
 
 #include "we_config.h"
@@ -112,6 +113,7 @@ TableInfo::TableInfo(Log* logger, const BRM::TxnID txnID,
     fKeepRbMetaFile(bKeepRbMetaFile),
     fbTruncationAsError(false),
     fImportDataMode(IMPORT_DATA_TEXT),
+    fSortColumn(-1),
     fTableLocked(false),
     fReadFromStdin(false),
     fNullStringMode(false),
@@ -1182,6 +1184,7 @@ void TableInfo::initializeBuffers(int   noOfBuffers,
         buffer->setTruncationAsError(getTruncationAsError());
         buffer->setImportDataMode(fImportDataMode,
                                   fixedBinaryRecLen);
+        buffer->setSortColumn    (fSortColumn);
         fBuffers.push_back(buffer);
     }
 }
@@ -1197,6 +1200,53 @@ void TableInfo::addColumn(ColumnInfo * info)
     fExtentStrAlloc.addColumn( info->column.mapOid,
                                info->column.width );
 }
+
+//------------------------------------------------------------------------------
+// Select the column the rows of each read buffer are to be sorted by.  Rows
+// are only reordered within a buffer, so the cost is bounded by the read
+// buffer size; a larger buffer (-c) gives tighter extent ranges.  Binary
+// imports and auto-increment columns (whose values are generated by the
+// parser) are loaded unsorted.
+//------------------------------------------------------------------------------
+bool TableInfo::setSortKey(const std::string& colName)
+{
+    fSortColumn = -1;
+
+    for (unsigned i = 0; i < fColumns.size(); i++)
+    {
+        if (!algorithm::iequals(fColumns[i].column.colName, colName))
+            continue;
+
+        ostringstream oss;
+        if (fImportDataMode != IMPORT_DATA_TEXT)
+        {
+            oss << "Sort key " << colName << " ignored for table " <<
+                fTableName << "; only text imports are sorted";
+        }
+        else if (fColumns[i].column.autoIncFlag)
+        {
+            oss << "Sort key " << colName << " ignored for table " <<
+                fTableName << "; auto-increment columns can't be sorted";
+        }
+        else
+        {
+            fSortColumn = i;
+            fColumns[i].setSortKey(true);
+            oss << "Rows of each read buffer for table " << fTableName <<
+                " will be sorted by " << fColumns[i].column.colName;
+            fLog->logMsg( oss.str(), MSGLVL_INFO2 );
+            return true;
+        }
+        fLog->logMsg( oss.str(), MSGLVL_WARNING );
+        return false;
+    }
+
+    ostringstream oss;
+    oss << "Sort key " << colName << " is not a column of table " <<
+        fTableName << "; rows will be loaded unsorted";
+    fLog->logMsg( oss.str(), MSGLVL_WARNING );
+    return false;
+}
 
 //------------------------------------------------------------------------------
 // Open the file corresponding to fFileName so that we can import it's contents.
@@ -128,6 +128,8 @@ private:
                                         //   data file
     bool fbTruncationAsError;           // Treat string truncation as error
     ImportDataMode fImportDataMode;     // Import data in text or binary mode
+    int fSortColumn;                    // Column to sort read buffers by;
+                                        //   -1 if rows are loaded as read
 
     volatile bool fTableLocked;         // Do we have db table lock
 
@@ -421,6 +423,13 @@ public:
      */
     void setTruncationAsError(bool bTruncationAsError);
 
+    /** @brief Sort the rows in each read buffer by the named column, so that
+     *  the extents loaded carry narrower min/max ranges.  Must be called
+     *  after the columns are added, and before initializeBuffers().
+     *  Returns false if colName doesn't name a column that can be sorted.
+     */
+    bool setSortKey(const std::string& colName);
+
     /** @brief log message to data_mods.log file.
      */
     void logToDataMods(const std::string& jobFile,
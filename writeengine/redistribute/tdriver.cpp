@@ -0,0 +1,195 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/** @file
+ * Partition compaction tests, on a column of a table with deleted rows.
+ */
+
+#include <vector>
+#include <cstring>
+using namespace std;
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "we_redistributecompact.h"
+using namespace redistribute;
+using namespace execplan;
+
+namespace
+{
+
+const uint32_t INT_EMPTY = 0x80000001;
+const uint32_t INT_NULL  = 0x80000000;
+const int32_t  DELETED   = (int32_t) INT_EMPTY;
+const int32_t  NUL       = (int32_t) INT_NULL;
+
+CompactColumn intColumn()
+{
+	CompactColumn c;
+	c.oid = 3001;
+	c.dataType = CalpontSystemCatalog::INT;
+	c.compressionType = 0;
+	c.width = 4;
+	c.emptyVal = INT_EMPTY;
+	c.nullVal = INT_NULL;
+	c.isToken = false;
+	return c;
+}
+
+// the rows of the segment files, one after the other, as compactPartition() reads them
+vector<char> column(const int32_t* rows, uint32_t n)
+{
+	vector<char> data(n * sizeof(int32_t));
+	memcpy(&data[0], rows, data.size());
+	return data;
+}
+
+}
+
+class RedistributeCompactTest : public CppUnit::TestFixture {
+
+CPPUNIT_TEST_SUITE(RedistributeCompactTest);
+
+CPPUNIT_TEST(compact_order_1);
+CPPUNIT_TEST(compact_order_2);
+CPPUNIT_TEST(compact_ranges_1);
+
+CPPUNIT_TEST_SUITE_END();
+
+public:
+	/* Two segment files with deleted rows, sorted by the column */
+	void compact_order_1() {
+		const int32_t rows[] = {
+			40, DELETED, -7, 12, DELETED, DELETED, 5, NUL,      // segment 0
+			DELETED, 99, -20, DELETED, 12, 0, DELETED, 3 };     // segment 1
+		CompactColumn c = intColumn();
+		vector<char> data = column(rows, 16);
+		vector<uint64_t> segRows(2, 8);
+		vector<uint32_t> order;
+		bool gain = false;
+		uint32_t i;
+
+		compactOrder(c, &data[0], segRows, true, order, gain);
+		CPPUNIT_ASSERT(gain);
+		CPPUNIT_ASSERT(order.size() == 10);
+
+		for (i = 0; i < order.size(); i++) {
+			CPPUNIT_ASSERT(order[i] < 16);
+			CPPUNIT_ASSERT(rows[order[i]] != DELETED);
+			if (i > 0)
+				CPPUNIT_ASSERT(sortKey(c, (uint32_t) rows[order[i - 1]]) <=
+					sortKey(c, (uint32_t) rows[order[i]]));
+		}
+
+		// NULL sorts first, negatives before positives, ties keep their order
+		CPPUNIT_ASSERT(rows[order[0]] == NUL);
+		CPPUNIT_ASSERT(rows[order[1]] == -20);
+		CPPUNIT_ASSERT(rows[order[2]] == -7);
+		CPPUNIT_ASSERT(rows[order[9]] == 99);
+		CPPUNIT_ASSERT(order[6] == 3 && order[7] == 12);
+
+		// in place, the live rows keep their order
+		compactOrder(c, &data[0], segRows, false, order, gain);
+		CPPUNIT_ASSERT(gain);
+		CPPUNIT_ASSERT(order.size() == 10);
+		for (i = 1; i < order.size(); i++)
+			CPPUNIT_ASSERT(order[i - 1] < order[i]);
+	}
+
+	/* Nothing to gain: deleted rows only at the end of a segment file */
+	void compact_order_2() {
+		const int32_t rows[] = {
+			1, 2, 3, DELETED,
+			4, 5, DELETED, DELETED };
+		CompactColumn c = intColumn();
+		vector<char> data = column(rows, 8);
+		vector<uint64_t> segRows(2, 4);
+		vector<uint32_t> order;
+		bool gain = true;
+
+		compactOrder(c, &data[0], segRows, true, order, gain);
+		CPPUNIT_ASSERT(!gain);
+		CPPUNIT_ASSERT(order.size() == 5);
+
+		compactOrder(c, &data[0], segRows, false, order, gain);
+		CPPUNIT_ASSERT(!gain);
+		CPPUNIT_ASSERT(order.size() == 5);
+
+		// all deleted, the partition is dropped
+		const int32_t none[] = { DELETED, DELETED, DELETED, DELETED };
+		data = column(none, 4);
+		compactOrder(c, &data[0], vector<uint64_t>(1, 4), true, order, gain);
+		CPPUNIT_ASSERT(order.empty());
+	}
+
+	/* Casual partition ranges of the new extents, NULL left out */
+	void compact_ranges_1() {
+		const int32_t rows[] = {
+			40, DELETED, -7, 12, DELETED, DELETED, 5, NUL,
+			DELETED, 99, -20, DELETED, 12, 0, DELETED, 3 };
+		CompactColumn c = intColumn();
+		vector<char> data = column(rows, 16);
+		vector<uint64_t> segRows(2, 8);
+		vector<uint32_t> order;
+		vector<ExtentRange> ranges;
+		bool gain = false;
+
+		compactOrder(c, &data[0], segRows, true, order, gain);
+
+		// NULL -20 -7 0 | 3 5 12 12 | 40 99 in a segment file of 10 rows, 4 per extent
+		compactRanges(c, &data[0], order, 0, 10, 4, ranges);
+		CPPUNIT_ASSERT(ranges.size() == 3);
+		CPPUNIT_ASSERT(ranges[0].seen);
+		CPPUNIT_ASSERT((int64_t) ranges[0].min == -20);
+		CPPUNIT_ASSERT((int64_t) ranges[0].max == 0);
+		CPPUNIT_ASSERT((int64_t) ranges[1].min == 3);
+		CPPUNIT_ASSERT((int64_t) ranges[1].max == 12);
+		CPPUNIT_ASSERT((int64_t) ranges[2].min == 40);
+		CPPUNIT_ASSERT((int64_t) ranges[2].max == 99);
+
+		// the last row, 99, in a segment file of its own
+		compactRanges(c, &data[0], order, 9, 1, 4, ranges);
+		CPPUNIT_ASSERT(ranges.size() == 1);
+		CPPUNIT_ASSERT((int64_t) ranges[0].min == 99 && (int64_t) ranges[0].max == 99);
+
+		// only NULL, no range
+		compactRanges(c, &data[0], order, 0, 1, 4, ranges);
+		CPPUNIT_ASSERT(ranges.size() == 1);
+		CPPUNIT_ASSERT(!ranges[0].seen);
+
+		// no casual partition for tokens
+		c.isToken = true;
+		compactRanges(c, &data[0], order, 0, 10, 4, ranges);
+		CPPUNIT_ASSERT(ranges.size() == 3);
+		CPPUNIT_ASSERT(!ranges[0].seen && !ranges[1].seen && !ranges[2].seen);
+	}
+
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( RedistributeCompactTest );
+
+#include <cppunit/extensions/TestFactoryRegistry.h>
+#include <cppunit/ui/text/TestRunner.h>
+
+int main( int argc, char **argv)
+{
+  CppUnit::TextUi::TestRunner runner;
+  CppUnit::TestFactoryRegistry &registry = CppUnit::TestFactoryRegistry::getRegistry();
+  runner.addTest( registry.makeTest() );
+  bool wasSuccessful = runner.run( "", false );
+  return (wasSuccessful ? 0 : 1);
+}
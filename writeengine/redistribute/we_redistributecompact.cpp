@@ -0,0 +1,996 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/*
+* Partition compaction for RED_ACTN_COMPACT, see compactPartition().
+*/
+
+#include <iostream>
+#include <set>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <sys/time.h>
+using namespace std;
+
+#include "boost/thread/mutex.hpp"
+#include "boost/filesystem/path.hpp"
+#include "boost/filesystem/operations.hpp"
+using namespace boost;
+
+#include "configcpp.h"
+using namespace config;
+
+#include "dbrm.h"
+using namespace BRM;
+
+#include "bytestream.h"
+using namespace messageqcpp;
+
+#include "calpontsystemcatalog.h"
+using namespace execplan;
+
+#include "dataconvert.h"
+#include "cacheutils.h"
+#include "idbcompress.h"
+
+#include "IDBDataFile.h"
+#include "IDBFileSystem.h"
+#include "IDBPolicy.h"
+using namespace idbdatafile;
+
+#include "we_define.h"
+#include "we_fileop.h"
+#include "we_colopcompress.h"
+#include "we_chunkmanager.h"
+#include "we_redistributedef.h"
+#include "we_redistributecontrol.h"
+#include "we_redistributeworkerthread.h"
+#include "we_redistributecompact.h"
+using namespace redistribute;
+
+
+namespace
+{
+
+// WriteEngine/CompactMBPerSecond, if not configured.
+const uint64_t DEFAULT_COMPACT_MB_PER_SECOND = 32;
+
+int64_t nowUs()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (int64_t) tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+inline uint64_t getValue(const char* p, uint32_t width)
+{
+	uint64_t v = 0;
+	memcpy(&v, p, width);
+	return v;
+}
+
+inline int64_t signExtend(uint64_t v, uint32_t width)
+{
+	if (width >= 8)
+		return (int64_t) v;
+
+	uint32_t shift = 64 - width * 8;
+	return ((int64_t) (v << shift)) >> shift;
+}
+
+bool isFloatType(CalpontSystemCatalog::ColDataType t)
+{
+	return (t == CalpontSystemCatalog::FLOAT || t == CalpontSystemCatalog::UFLOAT ||
+			t == CalpontSystemCatalog::DOUBLE || t == CalpontSystemCatalog::UDOUBLE);
+}
+
+// Same min/max rules as ExtentMap::mergeExtentsMaxMin().
+bool cpLess(const CompactColumn& c, uint64_t a, uint64_t b)
+{
+	if (isCharType(c.dataType))
+		return ((int64_t) uint64ToStr(a) < (int64_t) uint64ToStr(b));
+
+	if (isUnsigned(c.dataType))
+		return (a < b);
+
+	return ((int64_t) a < (int64_t) b);
+}
+
+CPInfoMerge makeCPMerge(const CompactColumn& c, LBID_t lbid, const ExtentRange& r)
+{
+	CPInfoMerge m;
+	m.startLbid = lbid;
+	m.seqNum = -1;
+	m.type = c.dataType;
+	m.newExtent = true;
+	if (r.seen)
+	{
+		m.min = (int64_t) r.min;
+		m.max = (int64_t) r.max;
+	}
+	else if (isUnsigned(c.dataType))
+	{
+		// all NULL
+		m.min = (int64_t) numeric_limits<uint64_t>::max();
+		m.max = 0;
+	}
+	else
+	{
+		m.min = numeric_limits<int64_t>::max();
+		m.max = numeric_limits<int64_t>::min();
+	}
+
+	return m;
+}
+
+// Read the first bytes bytes of a column segment file into buf, uncompressing
+// if needed.  Reads the file directly, without a ChunkManager, so that the file
+// is never written.  Returns RED_EC_OK or an error code with msg set.
+int readSegmentFile(const CompactColumn& c, uint16_t dbRoot, uint32_t partition,
+	uint16_t segment, char* buf, uint64_t bytes, string& msg)
+{
+	WriteEngine::FileOp fileOp;
+	string segFile;
+	IDBDataFile* pFile = fileOp.openFile(c.oid, dbRoot, partition, segment, segFile, "rb");
+	if (pFile == NULL)
+	{
+		ostringstream oss;
+		oss << "Failed to open oid=" << c.oid << ", dbroot=" << dbRoot
+			<< ", partition=" << partition << ", segment=" << segment;
+		msg = oss.str();
+		return redistribute::RED_EC_OPEN_FILE_FAIL;
+	}
+
+	int ret = redistribute::RED_EC_OK;
+	if (c.compressionType == 0)
+	{
+		if (pFile->seek(0, SEEK_SET) != 0 || pFile->read(buf, bytes) != (ssize_t) bytes)
+			ret = redistribute::RED_EC_FREAD_FAIL;
+	}
+	else
+	{
+		compress::IDBCompressInterface compressor;
+		compress::CompChunkPtrList ptrs;
+		vector<char> hdrs(compress::IDBCompressInterface::HDR_BUF_LEN * 2);
+		if (fileOp.readHeaders(pFile, &hdrs[0]) != WriteEngine::NO_ERROR ||
+			compressor.getPtrList(&hdrs[0], ptrs) != 0)
+			ret = redistribute::RED_EC_FREAD_FAIL;
+
+		vector<char> in;
+		vector<unsigned char> out(WriteEngine::UNCOMPRESSED_CHUNK_SIZE);
+		for (uint64_t k = 0, done = 0;
+				ret == redistribute::RED_EC_OK && done < bytes && k < ptrs.size(); k++)
+		{
+			in.resize(ptrs[k].second);
+			unsigned int outLen = out.size();
+			if (pFile->seek(ptrs[k].first, SEEK_SET) != 0 ||
+				pFile->read(&in[0], in.size()) != (ssize_t) in.size() ||
+				compressor.uncompressBlock(&in[0], in.size(), &out[0], outLen) != 0)
+			{
+				ret = redistribute::RED_EC_FREAD_FAIL;
+				break;
+			}
+
+			uint64_t n = min((uint64_t) outLen, bytes - done);
+			memcpy(buf + done, &out[0], n);
+			done += n;
+		}
+	}
+
+	if (ret != redistribute::RED_EC_OK)
+	{
+		ostringstream oss;
+		oss << "Failed to read " << segFile;
+		msg = oss.str();
+	}
+
+	delete pFile;
+	return ret;
+}
+
+}
+
+
+namespace redistribute
+{
+
+bool hasCasualPartition(const CompactColumn& c)
+{
+	return (!c.isToken && !isFloatType(c.dataType));
+}
+
+// Char values are stored with the first character in the lowest byte.
+uint64_t sortKey(const CompactColumn& c, uint64_t v)
+{
+	if (isCharType(c.dataType))
+		return uint64ToStr(v);
+
+	if (isUnsigned(c.dataType) || c.dataType == CalpontSystemCatalog::DATE ||
+		c.dataType == CalpontSystemCatalog::DATETIME)
+		return v;
+
+	if (isFloatType(c.dataType))
+	{
+		uint64_t sign = 1ULL << (c.width * 8 - 1);
+		uint64_t mask = (c.width >= 8) ? ~0ULL : ((1ULL << (c.width * 8)) - 1);
+		return ((v & sign) ? (~v & mask) : (v | sign));
+	}
+
+	return ((uint64_t) signExtend(v, c.width)) ^ (1ULL << 63);
+}
+
+void addToRange(const CompactColumn& c, ExtentRange& r, uint64_t v)
+{
+	if (v == c.nullVal)
+		return;
+
+	if (!isCharType(c.dataType) && !isUnsigned(c.dataType))
+		v = (uint64_t) signExtend(v, c.width);
+
+	if (!r.seen)
+	{
+		r.seen = true;
+		r.min = r.max = v;
+	}
+	else if (cpLess(c, v, r.min))
+	{
+		r.min = v;
+	}
+	else if (cpLess(c, r.max, v))
+	{
+		r.max = v;
+	}
+}
+
+void compactOrder(const CompactColumn& live, const char* data,
+	const vector<uint64_t>& segRows, bool sortRows, vector<uint32_t>& order, bool& gain)
+{
+	vector<pair<uint64_t, uint32_t> > keys;
+	uint64_t lastKey = 0;
+	uint64_t g = 0;
+	gain = false;
+	order.clear();
+	for (uint32_t s = 0; s < segRows.size(); s++)
+	{
+		bool hole = false;
+		for (uint64_t r = 0; r < segRows[s]; r++, g++)
+		{
+			uint64_t v = getValue(&data[g * live.width], live.width);
+			if (v == live.emptyVal)
+			{
+				hole = true;
+				continue;
+			}
+
+			if (hole)
+				gain = true;  // a deleted row in front of a live one
+
+			if (!sortRows)
+			{
+				order.push_back(g);
+				continue;
+			}
+
+			uint64_t key = sortKey(live, v);
+			if (!keys.empty() && key < lastKey)
+				gain = true;  // out of order
+
+			lastKey = key;
+			keys.push_back(make_pair(key, (uint32_t) g));
+		}
+	}
+
+	if (sortRows)
+	{
+		// ties are left in the original order.
+		if (gain)
+			sort(keys.begin(), keys.end());
+
+		order.reserve(keys.size());
+		for (vector<pair<uint64_t, uint32_t> >::iterator i = keys.begin(); i != keys.end(); i++)
+			order.push_back(i->second);
+	}
+}
+
+void compactRanges(const CompactColumn& c, const char* src, const vector<uint32_t>& order,
+	uint64_t start, uint64_t rows, uint64_t extentRows, vector<ExtentRange>& ranges)
+{
+	ranges.assign((rows + extentRows - 1) / extentRows, ExtentRange());
+	if (ranges.empty())
+		ranges.resize(1);
+
+	if (!hasCasualPartition(c))
+		return;
+
+	for (uint64_t r = 0; r < rows; r++)
+	{
+		const char* p = &src[(uint64_t) order[start + r] * c.width];
+		addToRange(c, ranges[r / extentRows], getValue(p, c.width));
+	}
+}
+
+// Rewrite partition fPlanEntry.partition on dbroot fPlanEntry.source without its
+// deleted rows, sorted by column fCompactKey if one is given, and with fresh
+// casual partition ranges.
+//
+// The rows are written into a new partition, one past the highest partition of
+// the table, which stays out of service until everything is written.  The
+// dictionary store files are shared with hard links, the tokens stay valid
+// because the dictionary extents keep their LBIDs.  swapPartition() then puts
+// the new partition in service in place of the old one in a single extent map
+// update; until then the old partition is untouched, so any failure or stop
+// only has to drop the new partition.  The table lock is held throughout, so
+// no DML or cpimport can change the partition, but queries run as usual.
+//
+// Memory use is a copy of one column of the partition, plus 4 bytes per live
+// row, or 16 while sorting.  I/O is limited to WriteEngine/CompactMBPerSecond.
+int RedistributeWorkerThread::compactPartition()
+{
+	uint16_t dbRoot = fPlanEntry.source;
+	uint32_t partition = fPlanEntry.partition;
+	uint32_t newPartition = 0;
+	vector<CompactColumn> cols;
+	vector<OID_t> colOids;
+	vector<OID_t> dictOids;
+	set<LogicalPartition> newLps;   // the new partition, while not committed
+	string emsg;
+
+	string rate = fConfig->getConfig("WriteEngine", "CompactMBPerSecond");
+	fCompactRate = (rate.empty() ? DEFAULT_COMPACT_MB_PER_SECOND : Config::uFromText(rate));
+	fCompactRate *= 1024 * 1024;
+	fCompactBytes = 0;
+	fCompactStart = nowUs();
+
+	try
+	{
+		boost::shared_ptr<CalpontSystemCatalog> csc = CalpontSystemCatalog::makeCalpontSystemCatalog(0);
+		const CalpontSystemCatalog::TableName table = csc->tableName(fPlanEntry.table);
+		CalpontSystemCatalog::RIDList rids = csc->columnRIDs(table, true);
+		for (CalpontSystemCatalog::RIDList::iterator i = rids.begin(); i != rids.end(); i++)
+		{
+			CalpontSystemCatalog::ColType colType = csc->colType(i->objnum);
+			CompactColumn c;
+			c.oid = i->objnum;
+			c.dataType = colType.colDataType;
+			c.compressionType = colType.compressionType;
+			c.width = 0;
+			c.emptyVal = c.nullVal = 0;
+			c.isToken = (colType.ddn.dictOID > 0);
+			cols.push_back(c);
+			colOids.push_back(c.oid);
+		}
+
+		CalpontSystemCatalog::DictOIDList dicts = csc->dictOIDs(table);
+		for (CalpontSystemCatalog::DictOIDList::iterator i = dicts.begin(); i != dicts.end(); i++)
+			dictOids.push_back(i->dictOID);
+
+		WriteEngine::ColumnOpCompress0 colOp0;
+		WriteEngine::ColumnOpCompress1 colOp1;
+		colOp0.setBulkFlag(true);
+		colOp1.setBulkFlag(true);
+
+		// Collect the layout of the partition, and the HWM_0 workaround, see
+		// buildEntryList(), for the highest extents on the dbroot, which won't
+		// be the highest after the new partition is added.
+		uint32_t minWidth = 8;  // column width greater than 8 will be dictionary.
+		uint32_t maxPartition = partition;
+		vector<BulkSetHWMArg> hwmArgs;
+		for (vector<CompactColumn>::iterator i = cols.begin(); i != cols.end(); i++)
+		{
+			vector<EMEntry> entries;
+			int rc = fDbrm->getExtents(i->oid, entries, false, false, true);
+			if (rc != 0 || entries.size() == 0)
+			{
+				ostringstream oss;
+				oss << "Error in DBRM getExtents; oid:" << i->oid << "; returnCode: " << rc;
+				throw runtime_error(oss.str());
+			}
+
+			i->width = entries.front().colWid;
+			if (i->width > 0 && i->width < minWidth)
+				minWidth = i->width;
+
+			vector<EMEntry>::iterator highest = entries.end();
+			for (vector<EMEntry>::iterator j = entries.begin(); j != entries.end(); j++)
+			{
+				if (j->partitionNum > maxPartition)
+					maxPartition = j->partitionNum;
+
+				if (j->dbRoot != dbRoot)
+					continue;
+
+				if (j->partitionNum == partition)
+				{
+					if (j->status == EXTENTOUTOFSERVICE)
+					{
+						fErrorCode = RED_EC_NOTHING_TO_COMPACT;
+						ostringstream oss;
+						oss << "partition " << partition << " on dbroot " << dbRoot
+							<< " is disabled, not compacted";
+						fErrorMsg = oss.str();
+						logMessage(fErrorMsg, __LINE__);
+						return fErrorCode;
+					}
+
+					// only the last extent of a segment file has the HWM
+					uint32_t& hwm = i->hwm[j->segmentNum];
+					if (j->HWM > hwm)
+						hwm = j->HWM;
+				}
+
+				if (highest == entries.end() ||
+					j->partitionNum > highest->partitionNum ||
+					(j->partitionNum == highest->partitionNum &&
+					 (j->blockOffset > highest->blockOffset ||
+					  (j->blockOffset == highest->blockOffset &&
+					   j->segmentNum > highest->segmentNum))))
+					highest = j;
+			}
+
+			if (highest != entries.end() && highest->partitionNum == partition)
+			{
+				fErrorCode = RED_EC_NOTHING_TO_COMPACT;
+				ostringstream oss;
+				oss << "partition " << partition << " is the last on dbroot " << dbRoot
+					<< ", not compacted";
+				fErrorMsg = oss.str();
+				logMessage(fErrorMsg, __LINE__);
+				return fErrorCode;
+			}
+
+			if (highest != entries.end() && highest->colWid > 0 && highest->HWM == 0)
+			{
+				BulkSetHWMArg arg;
+				arg.oid = i->oid;
+				arg.partNum = highest->partitionNum;
+				arg.segNum = highest->segmentNum;
+				arg.hwm = highest->colWid;  // will correct later based on minWidth
+				hwmArgs.push_back(arg);
+			}
+
+			bool sameSegments = (!i->hwm.empty() && i->hwm.size() == cols.front().hwm.size());
+			map<uint16_t, uint32_t>::const_iterator k = cols.front().hwm.begin();
+			for (map<uint16_t, uint32_t>::const_iterator j = i->hwm.begin();
+					sameSegments && j != i->hwm.end(); j++, k++)
+				sameSegments = (j->first == k->first);
+
+			if (!sameSegments)
+			{
+				fErrorCode = RED_EC_EXTENT_ERROR;
+				ostringstream oss;
+				oss << "oid:" << i->oid << " has " << i->hwm.size() << " segment files in partition "
+					<< partition << " on dbroot " << dbRoot << ", the first column has "
+					<< cols.front().hwm.size();
+				fErrorMsg = oss.str();
+				logMessage(fErrorMsg, __LINE__);
+				return fErrorCode;
+			}
+
+			// CHAR/VARCHAR NULL is 0xFE in the last byte, all others are empty - 1.
+			uint64_t mask = (i->width >= 8) ? ~0ULL : ((1ULL << (i->width * 8)) - 1);
+			i->emptyVal = colOp0.getEmptyRowValue(i->dataType, i->width) & mask;
+			if (isCharType(i->dataType))
+				i->nullVal = i->emptyVal - (1ULL << ((i->width - 1) * 8));
+			else
+				i->nullVal = (i->emptyVal - 1) & mask;
+		}
+
+		for (vector<BulkSetHWMArg>::iterator j = hwmArgs.begin(); j != hwmArgs.end(); j++)
+			j->hwm = (j->hwm <= 8) ? (j->hwm / minWidth) : 1;
+
+		// dictionary store files of the partition, to be carried over.
+		map<OID_t, set<uint16_t> > dictSegments;
+		for (vector<OID_t>::iterator i = dictOids.begin(); i != dictOids.end(); i++)
+		{
+			vector<EMEntry> entries;
+			int rc = fDbrm->getExtents(*i, entries, false, false, true);
+			if (rc != 0)
+			{
+				ostringstream oss;
+				oss << "Error in DBRM getExtents; oid:" << *i << "; returnCode: " << rc;
+				throw runtime_error(oss.str());
+			}
+
+			for (vector<EMEntry>::iterator j = entries.begin(); j != entries.end(); j++)
+			{
+				if (j->partitionNum > maxPartition)
+					maxPartition = j->partitionNum;
+
+				if (j->dbRoot == dbRoot && j->partitionNum == partition)
+					dictSegments[*i].insert(j->segmentNum);
+			}
+		}
+
+		newPartition = maxPartition + 1;
+
+		// the key column, or the narrowest, tells which rows are live.
+		int keyCol = -1;
+		if (fCompactKey != 0)
+		{
+			for (uint32_t i = 0; i < cols.size() && keyCol < 0; i++)
+			{
+				if (cols[i].oid == (int32_t) fCompactKey)
+					keyCol = i;
+			}
+
+			if (keyCol < 0)
+			{
+				fErrorCode = RED_EC_SORT_COLUMN;
+				ostringstream oss;
+				oss << "sort column " << fCompactKey << " is not in table " << fPlanEntry.table;
+				fErrorMsg = oss.str();
+				logMessage(fErrorMsg, __LINE__);
+				return fErrorCode;
+			}
+
+			if (cols[keyCol].isToken)
+			{
+				ostringstream oss;
+				oss << "sort column " << fCompactKey << " is a dictionary column, not sorting";
+				logMessage(oss.str(), __LINE__);
+				keyCol = -1;
+			}
+		}
+
+		int liveCol = keyCol;
+		for (uint32_t i = 0; i < cols.size() && liveCol < 0; i++)
+		{
+			if (cols[i].width == minWidth)
+				liveCol = i;
+		}
+
+		if (liveCol < 0)
+			liveCol = 0;
+
+		// rows of each old segment file, numbered across the partition.
+		const CompactColumn& live = cols[liveCol];
+		vector<uint16_t> segments;
+		vector<uint64_t> segRows;
+		vector<uint64_t> segBase;
+		uint64_t totalRows = 0;
+		for (map<uint16_t, uint32_t>::const_iterator i = live.hwm.begin(); i != live.hwm.end(); i++)
+		{
+			segments.push_back(i->first);
+			segBase.push_back(totalRows);
+			segRows.push_back((i->second + 1ULL) * WriteEngine::BYTE_PER_BLOCK / live.width);
+			totalRows += segRows.back();
+		}
+
+		vector<uint32_t> order;   // the live rows, in the order to write them
+		bool gain = false;
+		{
+			vector<char> data(totalRows * live.width);
+			for (uint32_t s = 0; s < segments.size(); s++)
+			{
+				uint64_t bytes = segRows[s] * live.width;
+				int rc = readSegmentFile(live, dbRoot, partition, segments[s],
+					&data[segBase[s] * live.width], bytes, fErrorMsg);
+				if (rc != RED_EC_OK)
+				{
+					fErrorCode = rc;
+					logMessage(fErrorMsg, __LINE__);
+					return fErrorCode;
+				}
+
+				throttle(bytes);
+				if (fStopAction)
+					return RED_EC_USER_STOP;
+			}
+
+			compactOrder(live, &data[0], segRows, keyCol >= 0, order, gain);
+		}
+
+		set<LogicalPartition> oldLps;
+		for (uint32_t s = 0; s < segments.size(); s++)
+			oldLps.insert(LogicalPartition(dbRoot, partition, segments[s]));
+
+		if (order.empty())
+		{
+			// every row is deleted, drop the partition.
+			vector<OID_t> oids(colOids);
+			oids.insert(oids.end(), dictOids.begin(), dictOids.end());
+
+			mutex::scoped_lock lock(fActionMutex);
+			if (fStopAction)
+				return RED_EC_USER_STOP;
+
+			cacheutils::flushPartition(colOids, oldLps);
+			if (fDbrm->deletePartition(oids, oldLps, emsg) != 0)
+			{
+				fErrorCode = RED_EC_UPDATE_DBRM_FAIL;
+				fErrorMsg = "Failed to drop empty partition: " + emsg;
+				logMessage(fErrorMsg, __LINE__);
+				return fErrorCode;
+			}
+
+			fCommitted = true;
+			lock.unlock();
+
+			WriteEngine::FileOp fileOp;
+			for (vector<OID_t>::iterator i = oids.begin(); i != oids.end(); i++)
+			{
+				for (uint32_t s = 0; s < segments.size(); s++)
+				{
+					char fileName[WriteEngine::FILE_NAME_SIZE];
+					if (fileOp.oid2FileName(*i, fileName, false, dbRoot, partition, segments[s])
+							== WriteEngine::NO_ERROR)
+						addToDirSet(fileName, true);
+				}
+			}
+
+			cacheutils::dropPrimProcFdCache();
+
+			ostringstream oss;
+			oss << "dropped partition " << partition << " on dbroot " << dbRoot
+				<< " of table " << fPlanEntry.table << ", no rows left";
+			logMessage(oss.str(), __LINE__);
+			return RED_EC_OK;
+		}
+
+		if (!gain)
+		{
+			fErrorCode = RED_EC_NOTHING_TO_COMPACT;
+			ostringstream oss;
+			oss << "partition " << partition << " on dbroot " << dbRoot
+				<< " is already compact";
+			fErrorMsg = oss.str();
+			logMessage(fErrorMsg, __LINE__);
+			return fErrorCode;
+		}
+
+		// Split the rows evenly over the segment files, lower segments take the
+		// remainder, so the extent counts don't grow with the segment number.
+		// Keep the narrowest column's HWM off 0 (HWM_0 workaround); the padding
+		// rows are empty.
+		uint64_t extentRows = fDbrm->getExtentRows();
+		uint32_t nSegs = min((uint64_t) segments.size(), (uint64_t) order.size());
+		vector<uint64_t> newRows(nSegs);
+		vector<uint64_t> newStart(nSegs);
+		vector<uint64_t> hwmRows(nSegs);
+		vector<uint32_t> newExtents(nSegs);
+		for (uint32_t i = 0; i < nSegs; i++)
+		{
+			newRows[i] = order.size() / nSegs + ((i < order.size() % nSegs) ? 1 : 0);
+			newStart[i] = (i == 0) ? 0 : (newStart[i - 1] + newRows[i - 1]);
+			newExtents[i] = max((uint64_t) 1, (newRows[i] + extentRows - 1) / extentRows);
+			hwmRows[i] = max(newRows[i], (uint64_t) (WriteEngine::BYTE_PER_BLOCK / minWidth + 1));
+			hwmRows[i] = min(hwmRows[i], newExtents[i] * extentRows);
+		}
+
+		vector<CPInfoMerge> cpMerges;
+		for (vector<CompactColumn>::iterator c = cols.begin(); c != cols.end(); c++)
+		{
+			WriteEngine::ColumnOp* colOp = (c->compressionType == 0) ?
+				(WriteEngine::ColumnOp*) &colOp0 : (WriteEngine::ColumnOp*) &colOp1;
+			WriteEngine::Column column;
+
+			// Create the extents, and hide them right away.
+			vector<vector<LBID_t> > lbids(nSegs);
+			set<LogicalPartition> lps;
+			for (uint32_t i = 0; i < nSegs; i++)
+			{
+				for (uint32_t k = 0; k < newExtents[i]; k++)
+				{
+					string segFile;
+					LBID_t startLbid = 0;
+					bool newFile = false;
+					int allocSize = 0;
+					colOp->setColParam(column, 0, c->width, c->dataType, WriteEngine::WR_CHAR,
+						c->oid, c->compressionType, dbRoot, newPartition, segments[i]);
+					int rc = colOp->addExtent(column, dbRoot, newPartition, segments[i],
+						segFile, startLbid, newFile, allocSize);
+					if (!segFile.empty())
+						addToDirSet(segFile.c_str(), false);
+
+					lps.insert(LogicalPartition(dbRoot, newPartition, segments[i]));
+					if (rc != WriteEngine::NO_ERROR)
+					{
+						fErrorCode = RED_EC_EXTENT_ERROR;
+						ostringstream oss;
+						oss << "Failed to add extent: oid=" << c->oid << ", dbroot=" << dbRoot
+							<< ", partition=" << newPartition << ", segment=" << segments[i]
+							<< ", rc=" << rc;
+						fErrorMsg = oss.str();
+						logMessage(fErrorMsg, __LINE__);
+						newLps.insert(lps.begin(), lps.end());
+						throw runtime_error(fErrorMsg);
+					}
+
+					lbids[i].push_back(startLbid);
+				}
+			}
+
+			newLps.insert(lps.begin(), lps.end());
+			if (fDbrm->markPartitionForDeletion(vector<OID_t>(1, c->oid), lps, emsg) != 0)
+			{
+				fErrorCode = RED_EC_UPDATE_DBRM_FAIL;
+				fErrorMsg = "Failed to disable the new partition: " + emsg;
+				logMessage(fErrorMsg, __LINE__);
+				throw runtime_error(fErrorMsg);
+			}
+
+			// the whole column of the old partition
+			vector<char> src(totalRows * c->width);
+			for (uint32_t s = 0; s < segments.size(); s++)
+			{
+				uint64_t bytes = min(segRows[s] * c->width,
+					(uint64_t) (c->hwm[segments[s]] + 1) * WriteEngine::BYTE_PER_BLOCK);
+				int rc = readSegmentFile(*c, dbRoot, partition, segments[s],
+					&src[segBase[s] * c->width], bytes, fErrorMsg);
+				if (rc != RED_EC_OK)
+				{
+					fErrorCode = rc;
+					logMessage(fErrorMsg, __LINE__);
+					throw runtime_error(fErrorMsg);
+				}
+
+				throttle(bytes);
+			}
+
+			unsigned char emptyBlock[WriteEngine::BYTE_PER_BLOCK];
+			unsigned char block[WriteEngine::BYTE_PER_BLOCK];
+			uint32_t rowsPerBlock = WriteEngine::BYTE_PER_BLOCK / c->width;
+			for (uint32_t r = 0; r < rowsPerBlock; r++)
+				memcpy(emptyBlock + r * c->width, &c->emptyVal, c->width);
+
+			for (uint32_t i = 0; i < nSegs; i++)
+			{
+				if (fStopAction)
+					throw runtime_error("User stop");
+
+				colOp->setColParam(column, 0, c->width, c->dataType, WriteEngine::WR_CHAR,
+					c->oid, c->compressionType, dbRoot, newPartition, segments[i]);
+				string segFile;
+				int rc = colOp->openColumnFile(column, segFile, false);
+				if (rc != WriteEngine::NO_ERROR)
+				{
+					fErrorCode = RED_EC_OPEN_FILE_FAIL;
+					ostringstream oss;
+					oss << "Failed to open " << segFile << ", rc=" << rc;
+					fErrorMsg = oss.str();
+					logMessage(fErrorMsg, __LINE__);
+					throw runtime_error(fErrorMsg);
+				}
+
+				BulkSetHWMArg arg;
+				arg.oid = c->oid;
+				arg.partNum = newPartition;
+				arg.segNum = segments[i];
+				arg.hwm = (hwmRows[i] * c->width - 1) / WriteEngine::BYTE_PER_BLOCK;
+				hwmArgs.push_back(arg);
+
+				vector<ExtentRange> ranges;
+				compactRanges(*c, &src[0], order, newStart[i], newRows[i], extentRows, ranges);
+				uint64_t r = 0;
+				for (uint64_t fbo = 0;
+						fbo <= arg.hwm && rc == WriteEngine::NO_ERROR && !fStopAction; fbo++)
+				{
+					memcpy(block, emptyBlock, WriteEngine::BYTE_PER_BLOCK);
+					for (uint32_t j = 0; j < rowsPerBlock && r < newRows[i]; j++, r++)
+					{
+						const char* p = &src[(uint64_t) order[newStart[i] + r] * c->width];
+						memcpy(block + j * c->width, p, c->width);
+					}
+
+					if (colOp->restoreBlock(column.dataFile.pFile, block, fbo) != WriteEngine::BYTE_PER_BLOCK)
+						rc = WriteEngine::ERR_FILE_WRITE;
+
+					throttle(WriteEngine::BYTE_PER_BLOCK);
+				}
+
+				// compressed files are left open to the ChunkManager, which writes
+				// the chunks out and closes them in flushFile().
+				map<WriteEngine::FID, WriteEngine::FID> oids;
+				oids[c->oid] = c->oid;
+				colOp->clearColumn(column);
+				rc = colOp->flushFile(rc, oids);
+				if (rc != WriteEngine::NO_ERROR)
+				{
+					fErrorCode = RED_EC_FWRITE_FAIL;
+					ostringstream oss;
+					oss << "Failed to write " << segFile << ", rc=" << rc;
+					fErrorMsg = oss.str();
+					logMessage(fErrorMsg, __LINE__);
+					throw runtime_error(fErrorMsg);
+				}
+
+				if (hasCasualPartition(*c))
+				{
+					for (uint32_t k = 0; k < newExtents[i]; k++)
+						cpMerges.push_back(makeCPMerge(*c, lbids[i][k], ranges[k]));
+				}
+			}
+		}
+
+		if (cpMerges.size() > 0 &&
+			fDbrm->bulkSetHWMAndCP(vector<BulkSetHWMArg>(), vector<CPInfo>(), cpMerges, 0) != 0)
+		{
+			fErrorCode = RED_EC_UPDATE_DBRM_FAIL;
+			fErrorMsg = "Failed to set casual partition of the new partition.";
+			logMessage(fErrorMsg, __LINE__);
+			throw runtime_error(fErrorMsg);
+		}
+
+		// carry the dictionary store files over to the new partition.
+		WriteEngine::FileOp fileOp;
+		IDBFileSystem& fs = IDBFileSystem::getFs(
+			(IDBPolicy::useHdfs() ? IDBDataFile::HDFS : IDBDataFile::UNBUFFERED) );
+		for (map<OID_t, set<uint16_t> >::iterator i = dictSegments.begin(); i != dictSegments.end(); i++)
+		{
+			for (set<uint16_t>::iterator j = i->second.begin(); j != i->second.end(); j++)
+			{
+				char oldName[WriteEngine::FILE_NAME_SIZE];
+				char newName[WriteEngine::FILE_NAME_SIZE];
+				if (fileOp.oid2FileName(i->first, oldName, false, dbRoot, partition, *j)
+						!= WriteEngine::NO_ERROR ||
+					fileOp.oid2FileName(i->first, newName, true, dbRoot, newPartition, *j)
+						!= WriteEngine::NO_ERROR)
+				{
+					fErrorCode = RED_EC_OID_TO_FILENAME;
+					ostringstream oss;
+					oss << "Failed to get file name: oid=" << i->first << ", dbroot=" << dbRoot
+						<< ", segment=" << *j;
+					fErrorMsg = oss.str();
+					logMessage(fErrorMsg, __LINE__);
+					throw runtime_error(fErrorMsg);
+				}
+
+				addToDirSet(newName, false);
+				bool linked = false;
+				if (!IDBPolicy::useHdfs())
+				{
+					boost::system::error_code ec;
+					filesystem::create_hard_link(oldName, newName, ec);
+					linked = !ec;
+				}
+
+				if (!linked && fs.copyFile(oldName, newName) != 0)
+				{
+					fErrorCode = RED_EC_COPY_FILE_FAIL;
+					fErrorMsg = string("Failed to copy ") + oldName + " to " + newName;
+					logMessage(fErrorMsg, __LINE__);
+					throw runtime_error(fErrorMsg);
+				}
+
+				addToDirSet(oldName, true);
+			}
+		}
+
+		// put the new partition in service.
+		{
+			mutex::scoped_lock lock(fActionMutex);
+			if (fStopAction)
+				throw runtime_error("User stop");
+
+			// blocks a query read during the brief time the extents were visible.
+			cacheutils::flushPartition(colOids, newLps);
+			if (fDbrm->swapPartition(colOids, dictOids, dbRoot, partition, newPartition, hwmArgs) != 0)
+			{
+				fErrorCode = RED_EC_UPDATE_DBRM_FAIL;
+				fErrorMsg = "Failed to swap in the compacted partition.";
+				logMessage(fErrorMsg, __LINE__);
+				throw runtime_error(fErrorMsg);
+			}
+
+			fCommitted = true;
+		}
+
+		// The new files are in use; from here on, a failure leaves the old
+		// partition behind, disabled, instead of failing the entry.
+		newLps.clear();
+		fNewDirSet.clear();
+
+		cacheutils::flushPartition(colOids, oldLps);
+		if (fDbrm->deletePartition(colOids, oldLps, emsg) == 0)
+		{
+			for (vector<OID_t>::iterator i = colOids.begin(); i != colOids.end(); i++)
+			{
+				for (uint32_t s = 0; s < segments.size(); s++)
+				{
+					char fileName[WriteEngine::FILE_NAME_SIZE];
+					if (fileOp.oid2FileName(*i, fileName, false, dbRoot, partition, segments[s])
+							== WriteEngine::NO_ERROR)
+						addToDirSet(fileName, true);
+				}
+			}
+		}
+		else
+		{
+			fOldDirSet.clear();
+			logMessage("Failed to drop the old partition, left disabled: " + emsg, __LINE__);
+		}
+
+		cacheutils::dropPrimProcFdCache();
+
+		ostringstream oss;
+		oss << "compacted partition " << partition << " on dbroot " << dbRoot << " of table "
+			<< fPlanEntry.table << " into partition " << newPartition << ", "
+			<< order.size() << " of " << totalRows << " rows";
+		logMessage(oss.str(), __LINE__);
+	}
+	catch (const std::exception& ex)
+	{
+		if (fErrorCode == RED_EC_OK && !fStopAction)
+		{
+			fErrorCode = RED_EC_EXTENT_ERROR;
+			fErrorMsg = ex.what();
+			logMessage(fErrorMsg, __LINE__);
+		}
+	}
+	catch (...)
+	{
+		if (fErrorCode == RED_EC_OK && !fStopAction)
+		{
+			fErrorCode = RED_EC_EXTENT_ERROR;
+			fErrorMsg = "compact partition error.";
+			logMessage(fErrorMsg, __LINE__);
+		}
+	}
+
+	// not committed, drop what was made of the new partition; confirmToPeer()
+	// removes its files.  One segment at a time, a failed addExtent() may have
+	// left a segment without any extent.
+	if (!newLps.empty())
+	{
+		try
+		{
+			cacheutils::flushPartition(colOids, newLps);
+			for (set<LogicalPartition>::iterator i = newLps.begin(); i != newLps.end(); i++)
+			{
+				set<LogicalPartition> lp;
+				lp.insert(*i);
+				fDbrm->deletePartition(colOids, lp, emsg);  // ignoring return code
+			}
+		}
+		catch (...)
+		{
+		}
+	}
+
+	if (fStopAction && fErrorCode == RED_EC_OK)
+		return RED_EC_USER_STOP;
+
+	return fErrorCode;
+}
+
+
+void RedistributeWorkerThread::throttle(uint64_t bytes)
+{
+	if (fCompactRate == 0)
+		return;
+
+	fCompactBytes += bytes;
+	int64_t due = fCompactStart + (int64_t) ((double) fCompactBytes * 1000000 / fCompactRate);
+	int64_t now = nowUs();
+	while (due > now && !fStopAction)
+	{
+		usleep(min(due - now, (int64_t) 100000));
+		now = nowUs();
+	}
+}
+
+
+} // namespace
+
+// vim:ts=4 sw=4:
@@ -0,0 +1,82 @@
+/* Copyright (C) 2014 InfiniDB, Inc.
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; version 2 of
+   the License.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+   MA 02110-1301, USA. */
+
+/*
+* Row selection and casual partition ranges of partition compaction, see
+* RedistributeWorkerThread::compactPartition().
+*/
+
+#ifndef WE_REDISTRIBUTECOMPACT_H
+#define WE_REDISTRIBUTECOMPACT_H
+
+#include <map>
+#include <vector>
+
+#include "calpontsystemcatalog.h"
+
+namespace redistribute
+{
+
+struct CompactColumn
+{
+	int32_t  oid;
+	execplan::CalpontSystemCatalog::ColDataType dataType;
+	int      compressionType;
+	uint32_t width;                     // bytes per value on disk
+	uint64_t emptyVal;
+	uint64_t nullVal;
+	bool     isToken;                   // dictionary token, no casual partition
+	std::map<uint16_t, uint32_t> hwm;   // segment -> file HWM in the old partition
+};
+
+// value range of one new extent, as the values are sent to BRM.
+struct ExtentRange
+{
+	bool     seen;
+	uint64_t min;
+	uint64_t max;
+
+	ExtentRange() : seen(false), min(0), max(0) {}
+};
+
+// float and double columns, and dictionary tokens, have no casual partition.
+bool hasCasualPartition(const CompactColumn& c);
+
+// The key a column value sorts by, compared as unsigned.
+uint64_t sortKey(const CompactColumn& c, uint64_t v);
+
+// Add v to r, NULL is left out.
+void addToRange(const CompactColumn& c, ExtentRange& r, uint64_t v);
+
+// The live rows of the partition, in the order to write them.  data holds the
+// column live, segment file after segment file, segRows rows each.  The rows
+// are sorted by their value if sortRows, else kept in place.  gain tells if
+// writing them out changes anything, i.e. a deleted row comes before a live one
+// in a segment file, or a sorted row moves.
+void compactOrder(const CompactColumn& live, const char* data,
+	const std::vector<uint64_t>& segRows, bool sortRows,
+	std::vector<uint32_t>& order, bool& gain);
+
+// Casual partition ranges of the extents of a new segment file, which gets
+// rows order[start] to order[start + rows - 1] of src, extentRows per extent.
+void compactRanges(const CompactColumn& c, const char* src,
+	const std::vector<uint32_t>& order, uint64_t start, uint64_t rows,
+	uint64_t extentRows, std::vector<ExtentRange>& ranges);
+
+}
+
+#endif  // WE_REDISTRIBUTECOMPACT_H
@@ -84,7 +84,8 @@ RedistributeControl* RedistributeControl::instance()
 }
 
 
-RedistributeControl::RedistributeControl() : fInfoFilePtr(NULL), fPlanFilePtr(NULL)
+RedistributeControl::RedistributeControl() : fInfoFilePtr(NULL), fPlanFilePtr(NULL),
+	fCompactTable(0), fCompactKey(0)
 {
 	// default path /usr/local/Calpont/data1/systemFiles/redistribute 
 	string installDir = startup::StartUp::installDir();
@@ -426,8 +427,18 @@ bool RedistributeControl::getStartOptions(messageqcpp::ByteStream& bs)
 			fDestinationList.push_back(d);
 		}
 
-		if (fSourceList.size() == 0 || fDestinationList.size() == 0)
+		// compaction rewrites partitions where they are, it has no destinations.
+		fCompactTable = 0;
+		fCompactKey = 0;
+		if (fOptions & RED_OPTN_COMPACT)
+			bs >> fCompactTable >> fCompactKey;
+
+		if (fSourceList.size() == 0 ||
+			(fDestinationList.size() == 0 && (fOptions & RED_OPTN_COMPACT) == 0))
 			throw runtime_error("Failed to get dbroot lists.");
+
+		if (fCompactKey != 0 && fCompactTable == 0)
+			throw runtime_error("A sort column needs a table to compact.");
 	}
 	catch (const std::exception& ex)
 	{
@@ -99,6 +99,8 @@ class RedistributeControl
 	uint32_t            fOptions;
 	std::vector<int>    fSourceList;
 	std::vector<int>    fDestinationList;
+	uint32_t            fCompactTable;     // RED_OPTN_COMPACT: table oid, 0 for all tables
+	uint32_t            fCompactKey;       // RED_OPTN_COMPACT: column oid to sort by, 0 for none
 	std::vector<RedistributePlanEntry> fRedistributePlan;
 	RedistributeInfo    fRedistributeInfo;
 
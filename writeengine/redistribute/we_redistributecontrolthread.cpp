@@ -101,7 +101,9 @@ void RedistributeControlThread::doRedistribute()
 {
 	if (setup() != 0)
 		fErrorCode = RED_EC_CNTL_SETUP_FAIL;
-	else if (makeRedistributePlan() != 0)
+	else if ((fControl->fOptions & RED_OPTN_COMPACT) != 0 && makeCompactPlan() != 0)
+		fErrorCode = RED_EC_MAKEPLAN_FAIL;
+	else if ((fControl->fOptions & RED_OPTN_COMPACT) == 0 && makeRedistributePlan() != 0)
 		fErrorCode = RED_EC_MAKEPLAN_FAIL;
 
 	try
@@ -380,6 +382,98 @@ int RedistributeControlThread::makeRedistributePlan()
 }
 
 
+// Plan a compaction of every partition of the table(s) on the source dbroots,
+// except the last partition on each dbroot, which is still being loaded into.
+// Each entry names the same dbroot as source and destination.
+int RedistributeControlThread::makeCompactPlan()
+{
+	int ret = 0;
+	try
+	{
+		if (fControl->fPlanFilePtr != NULL)
+		{
+			// should not happen, just in case.
+			fclose(fControl->fPlanFilePtr);
+			fControl->fPlanFilePtr = NULL;
+		}
+
+		boost::shared_ptr<CalpontSystemCatalog> csc = CalpontSystemCatalog::makeCalpontSystemCatalog(0);
+		vector<pair<CalpontSystemCatalog::OID, CalpontSystemCatalog::TableName> > tables;
+		if (fControl->fCompactTable != 0)
+			tables.push_back(make_pair((CalpontSystemCatalog::OID) fControl->fCompactTable,
+				csc->tableName(fControl->fCompactTable)));
+		else
+			tables = csc->getTables();
+
+		vector<pair<CalpontSystemCatalog::OID, CalpontSystemCatalog::TableName> >::iterator i;
+		for (i = tables.begin(); i != tables.end(); i++)
+		{
+			// in case, action is cancelled.
+			if (fStopAction)
+				break;
+
+			CalpontSystemCatalog::RIDList cols = csc->columnRIDs(i->second, true);
+			if (fControl->fCompactKey != 0)
+			{
+				CalpontSystemCatalog::RIDList::iterator k = cols.begin();
+				while (k != cols.end() && k->objnum != (CalpontSystemCatalog::OID) fControl->fCompactKey)
+					k++;
+
+				if (k == cols.end())
+				{
+					ostringstream oss;
+					oss << "Column " << fControl->fCompactKey << " is not in table " << i->second;
+					throw runtime_error(oss.str());
+				}
+			}
+
+			// sample the first column
+			vector<EMEntry> entries;
+			int rc = fControl->fDbrm->getExtents(cols[0].objnum, entries, false, false, true);
+			if (rc != 0 || entries.size() == 0)
+			{
+				ostringstream oss;
+				oss << "Error in DBRM getExtents; oid:" << cols[0].objnum << "; returnCode: " << rc;
+				throw runtime_error(oss.str());
+			}
+
+			vector<set<int> > dbPartSet(fMaxDbroot + 1);
+			for (vector<EMEntry>::iterator j = entries.begin(); j != entries.end(); j++)
+			{
+				if (fDbrootSet.find(j->dbRoot) != fDbrootSet.end())
+					dbPartSet[j->dbRoot].insert(j->partitionNum);
+			}
+
+			for (set<int>::iterator j = fDbrootSet.begin(); j != fDbrootSet.end(); ++j)
+			{
+				if (dbPartSet[*j].size() < 2)
+					continue;
+
+				// the last partition is not a candidate.
+				dbPartSet[*j].erase(--dbPartSet[*j].end());
+
+				vector<PartitionInfo> planVec;
+				for (set<int>::iterator k = dbPartSet[*j].begin(); k != dbPartSet[*j].end(); ++k)
+					planVec.push_back(PartitionInfo(*j, *k));
+
+				dumpPlanToFile(i->first, planVec, *j);
+			}
+		} // for tables
+	}
+	catch (const std::exception& ex)
+	{
+		fErrorMsg += ex.what();
+		ret = 2;
+	}
+	catch (...)
+	{
+		ret = 2;
+	}
+
+	return ret;
+}
+
+
 void RedistributeControlThread::dumpPlanToFile(uint64_t oid, vector<PartitionInfo>& vec, int target)
 {
 	// open the plan file, if not already opened, to write.
@@ -484,7 +578,10 @@ int RedistributeControlThread::executeRedistributePlan()
 			// send the job to source dbroot
 			size_t headerSize = sizeof(RedistributeMsgHeader);
 			size_t entrySize = sizeof(RedistributePlanEntry);
-			RedistributeMsgHeader header(entry.destination,entry.source,entryId,RED_ACTN_REQUEST);
+			uint32_t action = RED_ACTN_REQUEST;
+			if (fControl->fOptions & RED_OPTN_COMPACT)
+				action = RED_ACTN_COMPACT;
+			RedistributeMsgHeader header(entry.destination,entry.source,entryId,action);
 			if (connectToWes(header.source) == 0)
 			{
 				bs.restart();
@@ -492,6 +589,8 @@ int RedistributeControlThread::executeRedistributePlan()
 				bs << (ByteStream::byte) WriteEngine::WE_SVR_REDISTRIBUTE;
 				bs.append((const ByteStream::byte*) &header, headerSize);
 				bs.append((const ByteStream::byte*) &entry, entrySize);
+				if (action == RED_ACTN_COMPACT)
+					bs << (ByteStream::quadbyte) fControl->fCompactKey;
 				fMsgQueueClient->write(bs);
 
 				SBS sbs = fMsgQueueClient->read();
@@ -95,6 +95,7 @@ class RedistributeControlThread
 
 	int  setup();
 	int  makeRedistributePlan();
+	int  makeCompactPlan();
 	int  executeRedistributePlan();
 
 	int  connectToWes(int);
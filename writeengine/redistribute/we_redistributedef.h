@@ -90,6 +90,8 @@ enum RED_ErrorCode {
 	RED_EC_FILE_SIZE_NOT_MATCH,
 	RED_EC_UNKNOWN_DATA_MSG,
 	RED_EC_UNKNOWN_JOB_MSG,
+	RED_EC_NOTHING_TO_COMPACT,
+	RED_EC_SORT_COLUMN,
 
 };
 
@@ -106,6 +108,7 @@ const uint32_t RED_ACTN_REQUEST = 21;
 const uint32_t RED_ACTN_STOP    = 22;
 const uint32_t RED_ACTN_RESP    = 23;
 const uint32_t RED_ACTN_REPORT  = 24;
+const uint32_t RED_ACTN_COMPACT = 25;
 
 const uint32_t RED_DATA_INIT    = 51;
 const uint32_t RED_DATA_START   = 52;
@@ -117,6 +120,7 @@ const uint32_t RED_DATA_ACK     = 57;
 
 // options for start message
 const uint32_t RED_OPTN_REMOVE  = 0x00000001;
+const uint32_t RED_OPTN_COMPACT = 0x00000002;  // rewrite partitions in place, see compactPartition()
 
 
 
@@ -91,7 +91,11 @@ RedistributeWorkerThread::RedistributeWorkerThread(ByteStream& bs, IOSocket& ios
 	fTableLockId(0),
 	fErrorCode(RED_EC_OK),
 	fNewFilePtr(NULL),
-	fOldFilePtr(NULL)
+	fOldFilePtr(NULL),
+	fCompactKey(0),
+	fCompactRate(0),
+	fCompactBytes(0),
+	fCompactStart(0)
 {
 	fWriteBuffer.reset(new char[CHUNK_SIZE]);
 }
@@ -123,6 +127,8 @@ void RedistributeWorkerThread::operator()()
 	fBs.advance(sizeof(RedistributeMsgHeader));
 	if (fMsgHeader.messageId == RED_ACTN_REQUEST)
 		handleRequest();
+	else if (fMsgHeader.messageId == RED_ACTN_COMPACT)
+		handleCompact();
 	else if (fMsgHeader.messageId == RED_ACTN_STOP)
 		handleStop();
 	else if (fMsgHeader.messageId == RED_DATA_INIT)
@@ -194,6 +200,65 @@ void RedistributeWorkerThread::handleRequest()
 }
 
 
+void RedistributeWorkerThread::handleCompact()
+{
+	try
+	{
+		// clear stop flag if ever set.
+		{
+			mutex::scoped_lock lock(fActionMutex);
+			fStopAction = false;
+			fCommitted = false;
+		}
+
+		if (setup() == 0)
+		{
+			if (fBs.length() >= sizeof(RedistributePlanEntry))
+			{
+				memcpy(&fPlanEntry, fBs.buf(), sizeof(RedistributePlanEntry));
+				fBs.advance(sizeof(RedistributePlanEntry));
+				if (fBs.length() >= sizeof(ByteStream::quadbyte))
+				{
+					ByteStream::quadbyte key;
+					fBs >> key;
+					fCompactKey = key;
+				}
+
+				// the partition is rewritten on its own dbroot, there is no peer.
+				OamCache::dbRootPMMap_t dbrootToPM = fOamCache->getDBRootToPMMap();
+				fMyId.first = fPlanEntry.source;
+				fMyId.second = (*dbrootToPM)[fMyId.first];
+				fPeerId = fMyId;
+				if (grabTableLock() == 0)
+				{
+					// workaround extentmap slow update
+					sleep(1);
+
+					compactPartition();
+
+					// release the table lock, and remove the files of the loser.
+					confirmToPeer();
+				}
+			}
+		}
+	}
+	catch (const std::exception&)
+	{
+	}
+	catch (...)
+	{
+	}
+
+	sendResponse(RED_ACTN_COMPACT);
+
+	mutex::scoped_lock lock(fActionMutex);
+	fWesInUse.clear();
+
+	fStopAction = false;
+	fCommitted = false;
+}
+
+
 int RedistributeWorkerThread::setup()
 {
 	int ret = 0;
@@ -1086,11 +1151,12 @@ void RedistributeWorkerThread::sendResponse(uint32_t type)
 	fBs << (ByteStream::byte) WriteEngine::WE_SVR_REDISTRIBUTE;  // dummy, keep for now.
 	fBs.append((const ByteStream::byte*) &fMsgHeader, sizeof(fMsgHeader));
 
-	if (type == RED_ACTN_REQUEST)
+	if (type == RED_ACTN_REQUEST || type == RED_ACTN_COMPACT)
 	{
 		if (fErrorCode == RED_EC_OK && fStopAction == false)
 			fPlanEntry.status = RED_TRANS_SUCCESS;
-		else if (fErrorCode == RED_EC_PART_EXIST_ON_TARGET)
+		else if (fErrorCode == RED_EC_PART_EXIST_ON_TARGET ||
+				 fErrorCode == RED_EC_NOTHING_TO_COMPACT)
 			fPlanEntry.status = RED_TRANS_SKIPPED;
 		else if (fErrorCode != RED_EC_OK)
 			fPlanEntry.status = RED_TRANS_FAILED;
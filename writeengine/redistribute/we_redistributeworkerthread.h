@@ -78,6 +78,7 @@ class RedistributeWorkerThread
   private:
 
 	void  handleRequest();
+	void  handleCompact();
 	void  handleStop();
 	void  handleData();
 	void  handleUnknowJobMsg();
@@ -89,6 +90,8 @@ class RedistributeWorkerThread
 	int   connectToWes(int);
 	int   updateDbrm();
 	void  confirmToPeer();
+	int   compactPartition();    // in we_redistributecompact.cpp
+	void  throttle(uint64_t);
 	bool  checkDataTransferAck(SBS&, size_t);
 
 	void  sendResponse(uint32_t);
@@ -140,6 +143,12 @@ class RedistributeWorkerThread
 
 	boost::shared_ptr<BRM::DBRM>  fDbrm;
 
+	// for RED_ACTN_COMPACT
+	uint32_t                      fCompactKey;     // column oid to sort by, 0 for none
+	uint64_t                      fCompactRate;    // bytes per second, 0 for no limit
+	uint64_t                      fCompactBytes;   // bytes read and written since fCompactStart
+	int64_t                       fCompactStart;   // in microseconds
+
 	// for segment file # workaround
 	//uint64_t                      fSegPerRoot;
 
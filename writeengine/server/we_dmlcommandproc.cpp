@@ -750,8 +750,7 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 	WriteEngine::ColStructList colStructs;
 	WriteEngine::DctnryStructList dctnryStructList;
 	WriteEngine::DctnryValueList dctnryValueList;
-	WriteEngine::ColValueList colValuesList;
-    WriteEngine::DictStrList dicStringList ;
+	WriteEngine::ColBatchList colBatchList;
 	CalpontSystemCatalog::TableName tableName;
 	CalpontSystemCatalog::TableColName tableColName;
 	tableName.table = tableColName.table = tablePtr->get_TableName();
@@ -981,8 +980,6 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 		{
 			for (unsigned int i = 0; i < numcols; i++)
 			{
-				WriteEngine::ColTupleList colTuples;
-				WriteEngine::DctColTupleList dctColTuples;
 				RowList::const_iterator row_iterator = rows.begin();
 				bool pushWarning = false;
 				while (row_iterator != rows.end())
@@ -998,9 +995,11 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 
 					boost::any datavalue;
 					bool isNULL = false;
-					std::vector<std::string> origVals;
-					origVals = columnPtr->get_DataVector();
-					WriteEngine::dictStr dicStrings;
+					const std::vector<std::string>& origVals = columnPtr->get_DataVector();
+					// values go straight into a typed batch, no ColTuple per cell
+					colBatchList.push_back(WriteEngine::ColBatch());
+					WriteEngine::ColBatch& colBatch = colBatchList.back();
+					WriteEngine::WriteEngineWrapper::initColBatch(colStructs[i], colBatch, origVals.size());
 					// token
 					if ( isDictCol(colType) )
 					{
@@ -1034,16 +1033,9 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 								if ( !pushWarning )
 									pushWarning = true;
 							}
-							WriteEngine::ColTuple colTuple;
-							colTuple.data = datavalue;
-
-							colTuples.push_back(colTuple);
 							//@Bug 2515. Only pass string values to write engine
-							dicStrings.push_back( tmpStr );
+							colBatch.addString(tmpStr.c_str(), tmpStr.length());
 						}
-							colValuesList.push_back(colTuples);
-							//@Bug 2515. Only pass string values to write engine
-							dicStringList.push_back( dicStrings );
 					}
 					else
 					{
@@ -1156,15 +1148,8 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 							if ( pushWarning && ( rc != dmlpackageprocessor::DMLPackageProcessor::IDBRANGE_WARNING ) )
 								rc = dmlpackageprocessor::DMLPackageProcessor::IDBRANGE_WARNING;
 
-							WriteEngine::ColTuple colTuple;
-							colTuple.data = datavalue;
-
-							colTuples.push_back(colTuple);
-							//@Bug 2515. Only pass string values to write engine
-							dicStrings.push_back( tmpStr );
+							fWEWrapper.setColBatchValue(colBatch, i, datavalue);
 						}
-						colValuesList.push_back(colTuples);
-						dicStringList.push_back( dicStrings );
 					}
 					++row_iterator;
 				}
@@ -1187,20 +1172,20 @@ uint8_t WE_DMLCommandProc::processBatchInsert(messageqcpp::ByteStream& bs, std::
 	int error = NO_ERROR;
 		//fWriteEngine.setDebugLevel(WriteEngine::DEBUG_3);
 	//cout << "Batch inserting a row with transaction id " << txnid.id << endl;
-	if (colValuesList.size() > 0)
+	if (colBatchList.size() > 0)
 	{
-		if (colValuesList[0].size() > 0)
+		if (colBatchList[0].rowCount > 0)
 		{
 /* Begin-Disable use of MetaFile for bulk rollback support;
    Use alternate call below that passes 0 ptr for RBMetaWriter
 			if (NO_ERROR !=
-			(error = fWEWrapper.insertColumnRecs(txnid.id, colStructs, colValuesList, dctnryStructList, dicStringList,
+			(error = fWEWrapper.insertColumnRecs(txnid.id, colStructs, colBatchList, dctnryStructList,
 						dbRootExtTrackerVec, fRBMetaWriter.get(), bFirstExtentOnThisPM, isInsertSelect, 0, roPair.objnum, fIsFirstBatchPm)))
 End-Disable use of MetaFile for bulk rollback support
 */
 				
 			if (NO_ERROR !=
-			(error = fWEWrapper.insertColumnRecs(txnid.id, colStructs, colValuesList, dctnryStructList, dicStringList,
+			(error = fWEWrapper.insertColumnRecs(txnid.id, colStructs, colBatchList, dctnryStructList,
 						dbRootExtTrackerVec, 0, bFirstExtentOnThisPM, isInsertSelect, isAutocommitOn, roPair.objnum, fIsFirstBatchPm)))
 			{
 				if (error == ERR_BRM_DEAD_LOCK)
@@ -21,6 +21,9 @@
 *******************************************************************************/
 
 #include <unistd.h>
+#include <sstream>
+
+#include <boost/thread/once.hpp>
 
 #include "messagequeue.h"
 #include "bytestream.h"
@@ -38,9 +41,30 @@ using namespace threadpool;
 #include "we_redistribute.h"
 #include "we_config.h"
 #include "stopwatch.h"
+#include "metrics.h"
 using namespace logging;
 using namespace WriteEngine;
 //StopWatch timer;
+
+namespace
+{
+// one histogram per DML message id, all made before any thread uses the table
+const uint32_t dmlMsgIdCount = WE_SVR_WRITE_CREATE_SYSCOLUMN + 1;
+utils::LatencyHistogram* cmdTime[dmlMsgIdCount];
+boost::once_flag cmdTimeOnce = BOOST_ONCE_INIT;
+
+void initCmdTime()
+{
+	for (uint32_t i = 0; i < dmlMsgIdCount; i++)
+	{
+		std::ostringstream label;
+		label << "msgid=\"" << i << "\"";
+		cmdTime[i] = utils::Metrics::instance()->histogram("idb_wes_dml_command_usec",
+			label.str(), "Time WriteEngineServer spends on one DML command");
+	}
+}
+}
+
 namespace WriteEngine
 {
 
@@ -87,9 +111,13 @@ void DmlReadThread::operator()()
     //cout << "DmlReadThread created ..." << endl;
     // queryStats.blocksChanged for delete/update
     uint64_t blocksChanged = 0;
+    uint64_t cmdStart;
+
+    boost::call_once(initCmdTime, cmdTimeOnce);
 	
     while (ibs.length()>0)
     {
+        cmdStart = utils::monotonicUsec();
         try
         {
             errMsg.clear();
@@ -366,6 +394,9 @@ void DmlReadThread::operator()()
 		
 		if (msgId != WE_SVR_CLOSE_CONNECTION) 
 		{
+			if (msgId < dmlMsgIdCount)
+				cmdTime[msgId]->record(utils::monotonicUsec() - cmdStart);
+
 			//send response
 			obs.restart();
 			obs << uniqueID;
@@ -50,6 +50,7 @@ using namespace oam;
 #include "IDBPolicy.h"
 #include "utils_utf8.h"
 #include "dbrm.h"
+#include "metrics.h"
 
 namespace
 {
@@ -131,6 +132,7 @@ int main(int argc, char** argv)
 #endif
 	Config weConfig;
 	setupResources();
+	utils::Metrics::instance()->startDumper("WriteEngineServer");
 	
 	ostringstream serverParms;
 	serverParms << "pm" << weConfig.getLocalModuleID() << "_WriteEngineServer";
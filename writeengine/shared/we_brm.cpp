@@ -1472,6 +1472,8 @@ int BRMWrapper::writeVB(IDBDataFile* pSourceFile, const VER_t transID, const OID
     //std::vector<VBRange> freeList;
     IDBDataFile* pTargetFile;
     int32_t vbOid;
+    std::vector<LBID_t> vbLbids;
+    std::vector<uint32_t> vbFbos;
 
     if (isDebug(DEBUG_3))
     {
@@ -1586,6 +1588,8 @@ int BRMWrapper::writeVB(IDBDataFile* pSourceFile, const VER_t transID, const OID
     k = 0;
     vbOid = freeList[0].vbOID;
     rangeListCount = 0;
+    vbLbids.reserve(rangeList.size());
+    vbFbos.reserve(rangeList.size());
 	//cout << "writeVBEntry is putting the follwing lbids into VSS and freelist size is " << freeList.size() <<  endl;	 
     for (i = 0; i < freeList.size(); i++)
     {
@@ -1602,26 +1606,29 @@ int BRMWrapper::writeVB(IDBDataFile* pSourceFile, const VER_t transID, const OID
             if (rc != NO_ERROR)
                 goto cleanup;
 
+            // Collect the entries; they are all registered with one
+            // BRM call once every block is in the version buffer.
             for (; processedBlocks < (k+rangeListCount); processedBlocks++)
             {
-                rc = blockRsltnMgrPtr->writeVBEntry(transID, rangeList[processedBlocks].start,
-                    freeList[i].vbOID, freeList[i].vbFBO + (processedBlocks - rangeListCount));
-				//cout << (uint64_t)rangeList[processedBlocks].start << endl;
-                if (rc != NO_ERROR)
-				{
-					switch (rc)
-					{
-						case ERR_DEADLOCK: rc = ERR_BRM_DEAD_LOCK;
-						case ERR_VBBM_OVERFLOW: rc = ERR_BRM_VB_OVERFLOW;
-						case ERR_NETWORK: rc = ERR_BRM_NETWORK;
-						case ERR_READONLY: rc = ERR_BRM_READONLY;
-						default: rc = ERR_BRM_WR_VB_ENTRY;
-					}
-                    goto cleanup;
-				}
+                vbLbids.push_back(rangeList[processedBlocks].start);
+                vbFbos.push_back(freeList[i].vbFBO + (processedBlocks - rangeListCount));
             }
         }
     }
+
+    rc = blockRsltnMgrPtr->bulkWriteVBEntry(transID, vbLbids, vbOid, vbFbos);
+    if (rc != NO_ERROR)
+    {
+        switch (rc)
+        {
+            case ERR_DEADLOCK: rc = ERR_BRM_DEAD_LOCK; break;
+            case ERR_VBBM_OVERFLOW: rc = ERR_BRM_VB_OVERFLOW; break;
+            case ERR_NETWORK: rc = ERR_BRM_NETWORK; break;
+            case ERR_READONLY: rc = ERR_BRM_READONLY; break;
+            default: rc = ERR_BRM_WR_VB_ENTRY;
+        }
+        goto cleanup;
+    }
     if (pTargetFile)
     {
     	pTargetFile->flush();
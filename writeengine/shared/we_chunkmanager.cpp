@@ -29,11 +29,14 @@ using namespace std;
 
 #include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #include "logger.h"
 #include "cacheutils.h"
 
 #include "we_chunkmanager.h"
+#include "threadpool.h"
 
 #include "we_macro.h"
 #include "we_brm.h"
@@ -57,6 +60,26 @@ bool chunkDataPtrLessCompare(WriteEngine::ChunkData* p1, WriteEngine::ChunkData*
     return (p1->fChunkId) < (p2->fChunkId);
 }
 
+// Compress every nth chunk of a batch, starting at first.  A NULL chunk
+// or failed compression is left with length 0.
+void compressBatch(const compress::IDBCompressInterface* compressor,
+                   const std::vector<WriteEngine::ChunkData*>* chunks,
+                   char* outBuf, unsigned int outBufSize,
+                   std::vector<unsigned int>* outLen, size_t first, size_t n)
+{
+    for (size_t i = first; i < chunks->size(); i += n)
+    {
+        WriteEngine::ChunkData* chunkData = (*chunks)[i];
+        unsigned int len = outBufSize;
+        if (chunkData == NULL ||
+            compressor->compressBlock(chunkData->fBufUnCompressed, chunkData->fLenUnCompressed,
+                (unsigned char*)(outBuf + i * outBufSize), len) != 0)
+            len = 0;
+
+        (*outLen)[i] = len;
+    }
+}
+
 }
 
 namespace WriteEngine
@@ -70,24 +93,22 @@ extern WErrorCodes ec;                    // defined in we_log.cpp
 //------------------------------------------------------------------------------
 ChunkData* CompFileData::findChunk(int64_t id) const
 {
-    ChunkData* pChunkData = NULL;
-    for (list<ChunkData*>::const_iterator lit = fChunkList.begin(); lit != fChunkList.end(); ++lit)
-    {
-        if ((*lit)->fChunkId == id)
-        {
-            pChunkData = *lit;
-            break;
-        }
-    }
+    ChunkIndex::const_iterator it = fChunkIndex.find(id);
+    if (it == fChunkIndex.end())
+        return NULL;
 
-    return pChunkData;
+    return it->second->second;
 }
 
+boost::mutex ChunkManager::fDMLLogLock;
+
 //------------------------------------------------------------------------------
 // ChunkManager constructor
 //------------------------------------------------------------------------------
-ChunkManager::ChunkManager() : fMaxActiveChunkNum(100), fLenCompressed(0), fIsBulkLoad(false),
-                               fDropFdCache(false), fIsInsert(false), fIsHdfs(IDBPolicy::useHdfs()),
+ChunkManager::ChunkManager() : fMaxActiveChunkNum(100), fCompressThreads(1),
+                               fLenCompressed(0), fIsBulkLoad(false),
+                               fDropFdCache(false), fIsInsert(false), fKeepBackups(false),
+                               fIsHdfs(IDBPolicy::useHdfs()),
                                fFileOp(0), fSysLogger(NULL), fTransId(-1),
                                fLocalModuleId(Config::getLocalModuleID()),
                                fFs(fIsHdfs ?
@@ -98,6 +119,13 @@ ChunkManager::ChunkManager() : fMaxActiveChunkNum(100), fLenCompressed(0), fIsBu
     fCompressor.numUserPaddingBytes(fUserPaddings);
     fMaxCompressedBufSize = COMPRESSED_CHUNK_SIZE + fUserPaddings;
     fBufCompressed = new char[fMaxCompressedBufSize];
+
+    uint64_t cacheMem = (uint64_t)Config::getChunkCacheMemory() * 1024 * 1024;
+    fMaxActiveChunkNum = cacheMem / sizeof(ChunkData);
+    if (fMaxActiveChunkNum < 2)
+        fMaxActiveChunkNum = 2;
+    fCompressThreads = Config::getChunkCompressThreads();
+
     fSysLogger = new logging::Logger(SUBSYSTEM_ID_WE);
     logging::MsgMap msgMap;
     msgMap[logging::M0080] = logging::Message(logging::M0080);
@@ -131,6 +159,7 @@ int ChunkManager::writeLog(TxnID txnId, string backUpFileType, string filename,
         return ERR_DML_LOG_NAME;
 
     //Open file
+    boost::mutex::scoped_lock lk(fDMLLogLock);
     boost::scoped_ptr<IDBDataFile> aDMLLogFile;
     try
     {
@@ -170,13 +199,14 @@ int ChunkManager::writeLog(TxnID txnId, string backUpFileType, string filename,
 int ChunkManager::removeBackups(TxnID txnId)
 {
     // HDFS update/delete is handled differently
-    if (fIsHdfs || fIsBulkLoad)
+    if (fIsHdfs || fIsBulkLoad || fKeepBackups)
         return NO_ERROR;
 
     string aDMLLogFileName;
     if (getDMLLogFileName(aDMLLogFileName, txnId) != NO_ERROR)
         return ERR_DML_LOG_NAME;
 
+    boost::mutex::scoped_lock lk(fDMLLogLock);
     if (IDBPolicy::exists(aDMLLogFileName.c_str()))
     {
         boost::scoped_ptr<IDBDataFile> aDMLLogFile(IDBDataFile::open(
@@ -449,7 +479,7 @@ int ChunkManager::readBlock(IDBDataFile* pFile, unsigned char* readBuf, uint64_t
 
     // find the chunk ID and offset in the chunk
     lldiv_t offset = lldiv(fbo * BYTE_PER_BLOCK, UNCOMPRESSED_CHUNK_SIZE);
-    ChunkData* chunkData = (fpIt->second)->findChunk(offset.quot);
+    ChunkData* chunkData = useChunk(fpIt->second, offset.quot);
 
     WE_COMP_DBG(cout << "fbo:" << fbo << "  chunk id:" << offset.quot << " offset:" << offset.rem
                     << "  chunkData*:" << chunkData << endl;)
@@ -484,7 +514,7 @@ int ChunkManager::saveBlock(IDBDataFile* pFile, const unsigned char* writeBuf, u
 
     // find the chunk ID and offset in the chunk
     lldiv_t offset = lldiv(fbo * BYTE_PER_BLOCK, UNCOMPRESSED_CHUNK_SIZE);
-    ChunkData* chunkData = (fpIt->second)->findChunk(offset.quot);
+    ChunkData* chunkData = useChunk(fpIt->second, offset.quot);
 
     int rc = NO_ERROR;
     // chunk is not already read in
@@ -529,24 +559,11 @@ int ChunkManager::flushChunks(int rc, const std::map<FID, FID> & columOids)
         while (k-- > 0 && rc == NO_ERROR)
         {
             map<IDBDataFile*, CompFileData*>::iterator i = fFilePtrMap.begin();
-            // sort the chunk list first
             CompFileData* fileData = i->second;
             it = columOids.find (fileData->fFid);
             if (it != columOids.end())
             {
-                list<ChunkData*>& chunkList = fileData->fChunkList;
-                chunkList.sort(chunkDataPtrLessCompare);
-                list<ChunkData*>::iterator j = chunkList.begin();
-                while (j != chunkList.end())
-                {
-                    if ((rc = writeChunkToFile(fileData, *j)) != NO_ERROR)
-                        break;
-
-                    // write chunk to file removes the written chunk from the list
-                    j = chunkList.begin();
-                }
-
-                if (rc != NO_ERROR)
+                if ((rc = writeChunks(fileData)) != NO_ERROR)
                     break;
 
                 // finally update the header
@@ -566,21 +583,9 @@ int ChunkManager::flushChunks(int rc, const std::map<FID, FID> & columOids)
         while (k-- > 0 && rc == NO_ERROR)
         {
             map<IDBDataFile*, CompFileData*>::iterator i = fFilePtrMap.begin();
-            // sort the chunk list first
             CompFileData* fileData = i->second;
 
-            list<ChunkData*>& chunkList = fileData->fChunkList;
-            chunkList.sort(chunkDataPtrLessCompare);
-            list<ChunkData*>::iterator j = chunkList.begin();
-            while (j != chunkList.end())
-            {
-                if ((rc = writeChunkToFile(fileData, *j)) != NO_ERROR)
-                    break;
-                // write chunk to file removes the written chunk from the list
-                j = chunkList.begin();
-            }
-
-            if (rc != NO_ERROR)
+            if ((rc = writeChunks(fileData)) != NO_ERROR)
                 break;
 
             // finally update the header
@@ -618,8 +623,8 @@ int ChunkManager::flushChunks(int rc, const std::map<FID, FID> & columOids)
 // Load and uncompress the requested chunk (id) for the specified file (pFile),
 // into chunkData.
 // id is: (fbo*BYTE_PER_BLOCK)/UNCOMPRESSED_CHUNK_SIZE
-// If the active chunk list is already full, then we flush the oldest pending
-// chunk to disk, to make room for fetching the requested chunk.
+// If the active chunk list is already full, then we flush the least recently
+// used chunk to disk, to make room for fetching the requested chunk.
 // If the header ptr for the requested chunk is 0 (or has length 0), then
 // chunkData is initialized with a new empty chunk.
 //------------------------------------------------------------------------------
@@ -642,10 +647,10 @@ int ChunkManager::fetchChunkFromFile(IDBDataFile* pFile, int64_t id, ChunkData*&
 
     if (fActiveChunks.size() >= fMaxActiveChunkNum)
     {
-        list<std::pair<FileID, ChunkData*> >::iterator lIt = fActiveChunks.begin();
+        ActiveChunkList::iterator lIt = fActiveChunks.begin();
         if (!fIsBulkLoad && !(fpIt->second->fDctnryCol))
         {
-            while ((lIt->first == fpIt->second->fFileID) && (lIt != fActiveChunks.end()))
+            while ((lIt != fActiveChunks.end()) && (lIt->first == fpIt->second->fFileID))
                 lIt++;
         }
 
@@ -684,8 +689,7 @@ int ChunkManager::fetchChunkFromFile(IDBDataFile* pFile, int64_t id, ChunkData*&
     // get a new ChunkData object
     chunkData = new ChunkData(id);
     pFile = fileData->fFilePtr; //update to get the reopened file ptr.
-    fileData->fChunkList.push_back(chunkData);
-    fActiveChunks.push_back(make_pair(fileData->fFileID, chunkData));
+    addActiveChunk(fileData, chunkData);
 
     // read the compressed chunk from file
     uint64_t* ptrs = reinterpret_cast<uint64_t*>(fileData->fFileHeader.fPtrSection);
@@ -818,7 +822,8 @@ int ChunkManager::writeChunkToFile(CompFileData* fileData, int64_t id)
 // then subsequent chunks in the file are shifted down as needed, if the com-
 // pressed chunk will not fit in the currently available embedded free space.
 //------------------------------------------------------------------------------
-int ChunkManager::writeChunkToFile(CompFileData* fileData, ChunkData* chunkData)
+int ChunkManager::writeChunkToFile(CompFileData* fileData, ChunkData* chunkData,
+                                   const char* compressed, unsigned int compressedLen)
 {
     WE_COMP_DBG(cout << "write chunk id=" << chunkData->fChunkId << " data "
                      << ((chunkData->fWriteToFile) ? "changed" : "NOT changed") << endl;)
@@ -833,7 +838,12 @@ int ChunkManager::writeChunkToFile(CompFileData* fileData, ChunkData* chunkData)
 #endif
         // compress the chunk before writing it to file
         fLenCompressed = fMaxCompressedBufSize;
-        if (fCompressor.compressBlock((char*)chunkData->fBufUnCompressed,
+        if (compressed != NULL && compressedLen > 0)
+        {
+            memcpy(fBufCompressed, compressed, compressedLen);
+            fLenCompressed = compressedLen;
+        }
+        else if (fCompressor.compressBlock((char*)chunkData->fBufUnCompressed,
                                         chunkData->fLenUnCompressed,
                                         (unsigned char*)fBufCompressed,
                                         fLenCompressed) != 0)
@@ -918,8 +928,7 @@ int ChunkManager::writeChunkToFile(CompFileData* fileData, ChunkData* chunkData)
 
     if (!needReallocateChunks)
     {
-        fActiveChunks.remove(make_pair(fileData->fFileID, chunkData));
-        fileData->fChunkList.remove(chunkData);
+        removeActiveChunk(fileData, chunkData);
         delete chunkData;
     }
     else
@@ -1421,8 +1430,12 @@ void ChunkManager::cleanUp(const std::map<FID, FID> & columOids)
         if (fIsInsert && it != columOids.end())
         {
             list<ChunkData*>& chunks = fileData->fChunkList;
-            for (list<ChunkData*>::iterator j = chunks.begin(); j != chunks.end(); ++j)
-                delete *j;
+            while (!chunks.empty())
+            {
+                ChunkData* chunkData = chunks.front();
+                removeActiveChunk(fileData, chunkData);
+                delete chunkData;
+            }
 
             delete fileData->fFilePtr;
             fFileMap.erase(fileData->fFileID);
@@ -1434,8 +1447,12 @@ void ChunkManager::cleanUp(const std::map<FID, FID> & columOids)
         else if (!fIsInsert || (columOids.size() == 0))
         {
             list<ChunkData*>& chunks = fileData->fChunkList;
-            for (list<ChunkData*>::iterator j = chunks.begin(); j != chunks.end(); ++j)
-                delete *j;
+            while (!chunks.empty())
+            {
+                ChunkData* chunkData = chunks.front();
+                removeActiveChunk(fileData, chunkData);
+                delete chunkData;
+            }
 
             delete fileData->fFilePtr;
             fFileMap.erase(fileData->fFileID);
@@ -1456,6 +1473,112 @@ void ChunkManager::cleanUp(const std::map<FID, FID> & columOids)
     }
 }
 
+//------------------------------------------------------------------------------
+// Add a chunk to its file and to the end (most recently used) of the active
+// chunk list.
+//------------------------------------------------------------------------------
+void ChunkManager::addActiveChunk(CompFileData* fileData, ChunkData* chunkData)
+{
+    fileData->fChunkList.push_back(chunkData);
+    fActiveChunks.push_back(make_pair(fileData->fFileID, chunkData));
+    fileData->fChunkIndex[chunkData->fChunkId] = --fActiveChunks.end();
+}
+
+//------------------------------------------------------------------------------
+// Remove a chunk from its file and the active chunk list; does not delete it.
+//------------------------------------------------------------------------------
+void ChunkManager::removeActiveChunk(CompFileData* fileData, ChunkData* chunkData)
+{
+    CompFileData::ChunkIndex::iterator it = fileData->fChunkIndex.find(chunkData->fChunkId);
+    if (it != fileData->fChunkIndex.end() && it->second->second == chunkData)
+    {
+        fActiveChunks.erase(it->second);
+        fileData->fChunkIndex.erase(it);
+    }
+
+    fileData->fChunkList.remove(chunkData);
+}
+
+//------------------------------------------------------------------------------
+// Find chunk id of fileData in memory, and move it to the most recently used
+// end of the active chunk list.  Returns NULL if the chunk is not in memory.
+//------------------------------------------------------------------------------
+ChunkData* ChunkManager::useChunk(CompFileData* fileData, int64_t id)
+{
+    CompFileData::ChunkIndex::iterator it = fileData->fChunkIndex.find(id);
+    if (it == fileData->fChunkIndex.end())
+        return NULL;
+
+    fActiveChunks.splice(fActiveChunks.end(), fActiveChunks, it->second);
+    return it->second->second;
+}
+
+//------------------------------------------------------------------------------
+// Write all chunks of fileData to disk, in chunk id order.  Changed chunks are
+// compressed fCompressThreads at a time in parallel; the compressed chunks are
+// then written one by one, since a chunk that outgrows its space shifts the
+// chunks after it.
+//------------------------------------------------------------------------------
+int ChunkManager::writeChunks(CompFileData* fileData)
+{
+    int rc = NO_ERROR;
+    list<ChunkData*>& chunkList = fileData->fChunkList;
+    chunkList.sort(chunkDataPtrLessCompare);
+
+    vector<ChunkData*> batch;
+    vector<ChunkId> batchIds;
+    vector<unsigned int> batchLen;
+    while (!chunkList.empty())
+    {
+        batch.clear();
+        batchIds.clear();
+        list<ChunkData*>::iterator j = chunkList.begin();
+        for (; j != chunkList.end() && batch.size() < fCompressThreads; ++j)
+        {
+            batch.push_back((*j)->fWriteToFile ? *j : NULL);
+            batchIds.push_back((*j)->fChunkId);
+        }
+
+        batchLen.assign(batch.size(), 0);
+        if (batch.size() > 1)
+        {
+            // a manager that never flushes more than one chunk never needs them
+            if (!fCompressPool)
+            {
+                fBatchBufCompressed.reset(new char[fCompressThreads * fMaxCompressedBufSize]);
+                fCompressPool.reset(new threadpool::ThreadPool(fCompressThreads - 1, 0));
+            }
+
+            for (size_t t = 1; t < batch.size(); t++)
+                fCompressPool->invoke(boost::bind(compressBatch, &fCompressor, &batch,
+                    fBatchBufCompressed.get(), fMaxCompressedBufSize, &batchLen, t, batch.size()));
+            compressBatch(&fCompressor, &batch, fBatchBufCompressed.get(), fMaxCompressedBufSize,
+                &batchLen, 0, batch.size());
+            fCompressPool->wait();
+        }
+
+        for (size_t i = 0; i < batchIds.size(); i++)
+        {
+            // a chunk shift writes out, and drops, all chunks of the file
+            ChunkData* chunkData = fileData->findChunk(batchIds[i]);
+            if (chunkData == NULL)
+                break;
+
+            // write chunk to file removes the written chunk from the list
+            if (batchLen[i] > 0)
+                rc = writeChunkToFile(fileData, chunkData,
+                    fBatchBufCompressed.get() + i * fMaxCompressedBufSize, batchLen[i]);
+            else
+                rc = writeChunkToFile(fileData, chunkData);
+
+            if (rc != NO_ERROR)
+                return rc;
+        }
+    }
+
+    return rc;
+}
+
 //------------------------------------------------------------------------------
 // Read "n" blocks from pFile starting at fbo, into readBuf.
 //------------------------------------------------------------------------------
@@ -1486,7 +1609,7 @@ int ChunkManager::readBlocks(IDBDataFile* pFile, unsigned char* readBuf, uint64_
     num = (left > num) ? num : left;
     do
     {
-        ChunkData* chunkData = (fpIt->second)->findChunk(idx);
+        ChunkData* chunkData = useChunk(fpIt->second, idx);
 
         WE_COMP_DBG(cout << "id:" << idx << " ofst:" << rem << " num:" << num <<
                             " left:" << left << endl;)
@@ -1533,7 +1656,7 @@ int ChunkManager::restoreBlock(IDBDataFile* pFile, const unsigned char* writeBuf
     // the n blocks may cross more than one chunk
     // find the chunk ID and offset of the 1st fbo
     lldiv_t offset = lldiv(fbo * BYTE_PER_BLOCK, UNCOMPRESSED_CHUNK_SIZE);
-    ChunkData* chunkData = (fpIt->second)->findChunk(offset.quot);
+    ChunkData* chunkData = useChunk(fpIt->second, offset.quot);
     WE_COMP_DBG(cout << "id:" << offset.quot << " ofst:" << offset.rem << endl;)
     // chunk is not already uncompressed
     if (chunkData == NULL)
@@ -1795,8 +1918,7 @@ int ChunkManager::reallocateChunks(CompFileData* fileData)
     while (j != chunkList.end())
     {
         ChunkData* chunkData = *j;
-        fActiveChunks.remove(make_pair(fileData->fFileID, chunkData));
-        fileData->fChunkList.remove(chunkData);
+        removeActiveChunk(fileData, chunkData);
         delete chunkData;
 
         j = chunkList.begin();
@@ -2470,8 +2592,7 @@ int ChunkManager::checkFixLastDictChunk(const FID& fid,
         if (fCompressor.uncompressBlock((char*)fBufCompressed, chunkSize,
                     (unsigned char*)chunkData->fBufUnCompressed, dataLen) != 0)
         {
-			mit->second->fChunkList.push_back(chunkData);
-			fActiveChunks.push_back(make_pair(mit->second->fFileID, chunkData));
+			addActiveChunk(mit->second, chunkData);
             //replace this chunk with empty chunk
             uint64_t blocks = 512;
 			if ((numOfChunks-1)== 0)
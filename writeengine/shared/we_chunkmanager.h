@@ -27,7 +27,15 @@
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
+#ifdef _MSC_VER
+#include <unordered_map>
+#else
+#include <tr1/unordered_map>
+#endif
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include "we_type.h"
 #include "we_typeext.h"
@@ -58,6 +66,11 @@ namespace logging
 class Logger;
 }
 
+namespace threadpool
+{
+class ThreadPool;
+}
+
 namespace WriteEngine
 {
 
@@ -123,6 +136,9 @@ struct FileID
 
 };
 
+// chunks in memory, least recently used first
+typedef std::list<std::pair<FileID, ChunkData*> > ActiveChunkList;
+
 
 // compressed DB file information
 class CompFileData
@@ -135,6 +151,8 @@ public:
     ChunkData* findChunk(int64_t cid) const;
 
 protected:
+    typedef std::tr1::unordered_map<ChunkId, ActiveChunkList::iterator> ChunkIndex;
+
     FileID          fFileID;
     FID             fFid;
     execplan::CalpontSystemCatalog::ColDataType fColDataType;
@@ -144,6 +162,7 @@ protected:
     std::string     fFileName;
     CompFileHeader  fFileHeader;
     std::list<ChunkData*>   fChunkList;
+    ChunkIndex      fChunkIndex;    // fChunkList by chunk id, into fActiveChunks
     boost::scoped_array<char> fIoBuffer;
     size_t          fIoBSize;
 
@@ -230,9 +249,18 @@ public:
     // @brief Set FileOp pointer (for compression type, empty value, txnId, etc.)
     void fileOp(FileOp* fileOp);
 
-    // @brief Control the number of active chunks being stored in memory
+    // @brief Control the number of active chunks being stored in memory.
+    //        Defaults to WriteEngine/ChunkCacheMemory worth of chunks.
     void setMaxActiveChunkNum(unsigned int maxActiveChunkNum)
     { fMaxActiveChunkNum = maxActiveChunkNum; }
+    unsigned int getMaxActiveChunkNum() const { return fMaxActiveChunkNum; }
+
+    // @brief Keep the DML recovery log and backups of the transaction after
+    //        a write, while other ChunkManagers write for it in parallel.
+    void setKeepBackups(bool keepBackups) { fKeepBackups = keepBackups; }
+
+    // @brief remove DML recovery logs
+    EXPORT int removeBackups(TxnID txnId);
 
     // @brief Use this flag to avoid logging and backing up chunks, tmp files.
     void setBulkFlag(bool isBulkLoad)
@@ -275,8 +303,21 @@ protected:
     int fetchChunkFromFile(IDBDataFile* pFile, int64_t id, ChunkData*& chunkData);
 
     // @brief Compress a chunk and write it to file.
+    //        compressed/compressedLen pass in the chunk already compressed.
     int writeChunkToFile(CompFileData* fileData, int64_t id);
-    int writeChunkToFile(CompFileData* fileData, ChunkData* chunkData);
+    int writeChunkToFile(CompFileData* fileData, ChunkData* chunkData,
+                         const char* compressed = NULL, unsigned int compressedLen = 0);
+
+    // @brief Write all chunks of a file in chunk id order, compressing
+    //        several of them at a time on fCompressThreads threads.
+    int writeChunks(CompFileData* fileData);
+
+    // @brief Add/remove a chunk to/from its file and the active chunk list.
+    void addActiveChunk(CompFileData* fileData, ChunkData* chunkData);
+    void removeActiveChunk(CompFileData* fileData, ChunkData* chunkData);
+
+    // @brief Find a chunk in memory and mark it most recently used.
+    ChunkData* useChunk(CompFileData* fileData, int64_t id);
 
     // @brief Write the compressed data to file and log a recover entry.
     int writeCompressedChunk(CompFileData* fileData, int64_t offset, int64_t size);
@@ -323,9 +364,6 @@ protected:
     int writeLog(TxnID txnId, std::string backUpFileType, std::string filename,
                  std::string &aDMLLogFileName, int64_t size=0, int64_t offset=0) const;
 
-    // @brief remove DML recovery logs
-    int removeBackups(TxnID txnId);
-
     // @brief swap the src file to dest file
     int swapTmpFile(const std::string& src, const std::string& dest);
 
@@ -334,8 +372,11 @@ protected:
 
     mutable std::map<FileID, CompFileData*>     fFileMap;
     mutable std::map<IDBDataFile*, CompFileData*> fFilePtrMap;
-    std::list<std::pair<FileID, ChunkData*> >   fActiveChunks;
-    unsigned int                                fMaxActiveChunkNum;  // max active chunks per file
+    ActiveChunkList                             fActiveChunks;
+    unsigned int                                fMaxActiveChunkNum;  // max active chunks, all files
+    unsigned int                                fCompressThreads;    // chunks compressed at once on flush
+    boost::scoped_array<char>                   fBatchBufCompressed; // fCompressThreads out buffers,
+    boost::scoped_ptr<threadpool::ThreadPool>   fCompressPool;       // and helper threads, on first use
     char*                                       fBufCompressed;
     unsigned int                                fLenCompressed;
     unsigned int                                fMaxCompressedBufSize;
@@ -343,6 +384,7 @@ protected:
     bool                                        fIsBulkLoad;
     bool                                        fDropFdCache;
     bool                                        fIsInsert;
+    bool                                        fKeepBackups;
     bool                                        fIsHdfs;
     FileOp*                                     fFileOp;
     compress::IDBCompressInterface              fCompressor;
@@ -351,6 +393,9 @@ protected:
     int                                         fLocalModuleId;
     idbdatafile::IDBFileSystem&                 fFs;
 	bool 										fIsFix;
+
+    // the DML log of a transaction is shared by all its ChunkManagers
+    static boost::mutex                         fDMLLogLock;
 	
 private:
 };
@@ -47,6 +47,8 @@ namespace WriteEngine
     const int      DEFAULT_BULK_PROCESS_PRIORITY      = -1;
     const unsigned DEFAULT_MAX_FILESYSTEM_DISK_USAGE  = 98; // allow 98% full
     const unsigned DEFAULT_COMPRESSED_PADDING_BLKS    =  1;
+    const unsigned DEFAULT_CHUNK_CACHE_MEMORY         = 400; // MB, 100 chunks
+    const unsigned DEFAULT_CHUNK_COMPRESS_THREADS     =  4;
     const int      DEFAULT_LOCAL_MODULE_ID            = 1;
     const bool     DEFAULT_PARENT_OAM                 = true;
     const char*    DEFAULT_LOCAL_MODULE_TYPE          = "pm";
@@ -73,6 +75,9 @@ namespace WriteEngine
     unsigned Config::m_MaxFileSystemDiskUsage  =
         DEFAULT_MAX_FILESYSTEM_DISK_USAGE;
     unsigned Config::m_NumCompressedPadBlks    =DEFAULT_COMPRESSED_PADDING_BLKS;
+    unsigned Config::m_ChunkCacheMemory        = DEFAULT_CHUNK_CACHE_MEMORY;
+    unsigned Config::m_ChunkCompressThreads    = DEFAULT_CHUNK_COMPRESS_THREADS;
+    unsigned Config::m_ChunkCompressQueue      = 2 * DEFAULT_CHUNK_COMPRESS_THREADS;
     bool     Config::m_ParentOAMModuleFlag     = DEFAULT_PARENT_OAM;
     string   Config::m_LocalModuleType;
     int      Config::m_LocalModuleID           = DEFAULT_LOCAL_MODULE_ID;
@@ -205,6 +210,28 @@ void Config::checkReload( )
     if ( ncpb.length() != 0 )
         m_NumCompressedPadBlks = cf->uFromText(ncpb);
 
+    //--------------------------------------------------------------------------
+    // Memory for uncompressed chunks, and threads to compress them on flush
+    //--------------------------------------------------------------------------
+    m_ChunkCacheMemory = DEFAULT_CHUNK_CACHE_MEMORY;
+    string ccm = cf->getConfig("WriteEngine", "ChunkCacheMemory");
+    if ( ccm.length() != 0 )
+        m_ChunkCacheMemory = cf->uFromText(ccm);
+
+    m_ChunkCompressThreads = DEFAULT_CHUNK_COMPRESS_THREADS;
+    string cct = cf->getConfig("WriteEngine", "ChunkCompressThreads");
+    if ( cct.length() != 0 )
+        m_ChunkCompressThreads = cf->uFromText(cct);
+    if (m_ChunkCompressThreads == 0)
+        m_ChunkCompressThreads = 1;
+
+    m_ChunkCompressQueue = 0;
+    string ccq = cf->getConfig("WriteEngine", "ChunkCompressQueue");
+    if ( ccq.length() != 0 )
+        m_ChunkCompressQueue = cf->uFromText(ccq);
+    if (m_ChunkCompressQueue == 0)
+        m_ChunkCompressQueue = 2 * m_ChunkCompressThreads;
+
 #if 0  // common code, moved to IDBPolicy
     //--------------------------------------------------------------------------
     // IDBDataFile logging
@@ -598,6 +625,49 @@ unsigned Config::getNumCompressedPadBlks()
     return m_NumCompressedPadBlks;
 }
 
+/*******************************************************************************
+ * DESCRIPTION:
+ *    Get the memory (MB) a ChunkManager may use for uncompressed chunks.
+ * PARAMETERS:
+ *    none
+ ******************************************************************************/
+unsigned Config::getChunkCacheMemory()
+{
+    boost::mutex::scoped_lock lk(fCacheLock);
+    checkReload( );
+
+    return m_ChunkCacheMemory;
+}
+
+/*******************************************************************************
+ * DESCRIPTION:
+ *    Get the number of threads used to compress chunks when flushing a file.
+ * PARAMETERS:
+ *    none
+ ******************************************************************************/
+unsigned Config::getChunkCompressThreads()
+{
+    boost::mutex::scoped_lock lk(fCacheLock);
+    checkReload( );
+
+    return m_ChunkCompressThreads;
+}
+
+/*******************************************************************************
+ * DESCRIPTION:
+ *    Get the number of chunks, of all columns, that cpimport may have queued
+ *    or being compressed at a time.
+ * PARAMETERS:
+ *    none
+ ******************************************************************************/
+unsigned Config::getChunkCompressQueue()
+{
+    boost::mutex::scoped_lock lk(fCacheLock);
+    checkReload( );
+
+    return m_ChunkCompressQueue;
+}
+
 /*******************************************************************************
  * DESCRIPTION:
  *    Get Parent OAM Module flag; are we running on active parent OAM node.
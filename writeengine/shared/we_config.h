@@ -131,6 +131,21 @@ public:
      */
     EXPORT static unsigned getNumCompressedPadBlks();
 
+    /**
+     * @brief Memory (MB) each ChunkManager may hold in uncompressed chunks.
+     */
+    EXPORT static unsigned getChunkCacheMemory();
+
+    /**
+     * @brief Number of threads compressing chunks when a file is flushed.
+     */
+    EXPORT static unsigned getChunkCompressThreads();
+
+    /**
+     * @brief Number of chunks, of all columns, queued or being compressed.
+     */
+    EXPORT static unsigned getChunkCompressQueue();
+
     /**
      * @brief Parent OAM Module flag (is this the parent OAM node, ex: pm1)
      */
@@ -188,6 +203,9 @@ private:
     static std::string  m_BulkRollbackDir;       // bulk rollback meta data dir
     static unsigned     m_MaxFileSystemDiskUsage;// max file system % disk usage
     static unsigned     m_NumCompressedPadBlks;  // num blks to pad comp chunks
+    static unsigned     m_ChunkCacheMemory;      // MB of uncompressed chunks
+    static unsigned     m_ChunkCompressThreads;  // chunk compression threads
+    static unsigned     m_ChunkCompressQueue;    // chunks queued to compress
     static bool         m_ParentOAMModuleFlag;   // are we running on parent PM
     static std::string  m_LocalModuleType;       // local node type (ex: "pm")
     static int          m_LocalModuleID;         // local node id   (ex: 1   )
@@ -272,6 +272,41 @@ namespace WriteEngine
     typedef std::vector<std::string> dictStr;
     typedef std::vector<dictStr> DictStrList;
 
+   /************************************************************************
+    * @brief Values of one column for a batch insert, already in the
+    * internal format writeRow() takes and packed back to back, so a batch
+    * goes to disk without a ColTuple/boost::any per cell.  Strings of a
+    * dictionary column are kept in one arena; their tokens are filled into
+    * values by WriteEngineWrapper::insertColumnRecs().
+    ************************************************************************/
+    struct ColBatch
+    {
+        ColType        colType;             /** @brief internal column type */
+        int            stride;              /** @brief bytes per value */
+        uint64_t       rowCount;            /** @brief number of values */
+        std::vector<unsigned char> values;  /** @brief rowCount packed values */
+        std::string    strArena;            /** @brief dictionary strings */
+        std::vector<uint32_t> strOffsets;   /** @brief start of each string in strArena, plus the end */
+        ColBatch() : colType(WR_INT), stride(0), rowCount(0), strOffsets(1, 0) { }
+
+        void* valuePtr(uint64_t row)
+        { return values.empty() ? NULL : &values[row * stride]; }
+
+        void addString(const char* str, uint32_t len)
+        {
+            strArena.append(str, len);
+            strOffsets.push_back(strArena.length());
+        }
+
+        unsigned char* stringAt(uint64_t row, int& len)
+        {
+            len = strOffsets[row + 1] - strOffsets[row];
+            return len ? (unsigned char*)&strArena[strOffsets[row]] : NULL;
+        }
+    };
+
+    typedef std::vector<ColBatch>       ColBatchList;  /** @brief column batch list */
+
     // dictionary
     struct DctnryStruct                     /** @brief Dctnry Interface Struct*/
     {
@@ -364,6 +399,7 @@ namespace WriteEngine
         OID            mapOid;              /** @brief table OID */
         std::string    loadFileName;        /** @brief table load file name */
         uint64_t       maxErrNum;           /** @brief max number of error rows before abort */
+        std::string    sortKey;             /** @brief column to sort each read buffer by; empty if none */
         JobColList     colList;             /** @brief list of columns to be loaded; followed by default columns to be loaded */
         JobColList     fIgnoredFields;      /** @brief list of fields in input file to be ignored */
         JobFieldRefList fFldRefs;           /** @brief Combined list of refs to entries in colList and fIgnoredFields */
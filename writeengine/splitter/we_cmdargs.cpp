@@ -200,6 +200,9 @@ std::string WECmdArgs::getCpImportCmdLine()
 	if(fbTruncationAsError)
 		aSS << " -S ";
 
+	if(fSortKey.length()>0)
+		aSS << " -K " << fSortKey;
+
 	if((fJobId.length()>0)&&(fMode==1)&&(!fJobLogOnly))
 	{
 		// if JobPath provided, make it w.r.t WES
@@ -459,7 +462,7 @@ void WECmdArgs::usage()
 	cout << "\t\t [-r readers] [-j JobID] [-e maxErrs] [-B libBufSize] [-w parsers]\n";
 	cout << "\t\t [-s c] [-E enclosedChar] [-C escapeChar] [-n NullOption]\n";
 	cout << "\t\t [-q batchQty] [-p jobPath] [-P list of PMs] [-S] [-i] [-v verbose]\n";
-	cout << "\t\t [-I binaryOpt]\n";
+	cout << "\t\t [-I binaryOpt] [-K sortColumn]\n";
 
 
 	cout << "Traditional usage without positional parameters (XML job file required):\n";
@@ -468,7 +471,7 @@ void WECmdArgs::usage()
 	cout << "\t\t [-b readBufs] [-p path] [-c readBufSize] [-e maxErrs] [-B libBufSize]\n";
 	cout << "\t\t [-n NullOption] [-E encloseChar] [-C escapeChar] [-i] [-v verbose]\n";
 	cout << "\t\t [-d debugLevel] [-q batchQty] [-l loadFile] [-P list of PMs] [-S]\n";
-	cout << "\t\t [-I binaryOpt]\n";
+	cout << "\t\t [-I binaryOpt] [-K sortColumn]\n";
 
 	cout << "\n\nPositional parameters:\n";
 	cout << "\tdbName     Name of the database to load\n";
@@ -509,6 +512,8 @@ void WECmdArgs::usage()
 			<<"\t\t\t2 - saturate NULL values\n"
 			<<"\t-P\tList of PMs ex: -P 1,2,3. Default is all PMs.\n"
 			<<"\t-S\tTreat string truncations as errors.\n"
+			<<"\t-K\tSort the rows of each read buffer by this column, to narrow\n"
+			<<"\t\t\tthe min/max range of each extent (text imports only).\n"
 			<<"\t-m\tmode\n"
 			<<"\t\t\t1 - rows will be loaded in a distributed manner across PMs.\n"
 			<<"\t\t\t2 - PM based input files loaded onto their respective PM.\n"
@@ -551,7 +556,7 @@ void WECmdArgs::parseCmdLineArgs(int argc, char** argv)
 	//	fPrgmName = "/home/bpaul/genii/export/bin/cpimport";
 
 	while ((aCh = getopt(argc, argv,
-		"d:j:w:s:v:l:r:b:e:B:f:q:ihm:E:C:P:I:n:p:c:SN"))
+		"d:j:w:s:v:l:r:b:e:B:f:q:ihm:E:C:P:I:K:n:p:c:SN"))
 			!= EOF)
 	{
 		switch (aCh)
@@ -754,6 +759,11 @@ void WECmdArgs::parseCmdLineArgs(int argc, char** argv)
 			}
 			break;
 		}
+		case 'K': // -K: Sort each read buffer by this column
+		{
+			fSortKey = optarg;
+			break;
+		}
 		case 'S': // -S: Treat string truncations as errors
 		{
 			setTruncationAsError(true);
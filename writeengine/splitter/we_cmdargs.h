@@ -170,6 +170,7 @@ class WECmdArgs
         bool fCpiInvoke;		// invoke cpimport in mode 3
         bool fBlockMode3;		// Do not allow Mode 3
         bool fbTruncationAsError; // Treat string truncation as error
+        std::string fSortKey;	// Column to sort each read buffer by
 		boost::uuids::uuid fUUID;
         bool fConsoleOutput;    // If false, no output to console.
 };
@@ -22,9 +22,11 @@
  */
 #include <cmath>
 #include <cstdlib>
+#include <algorithm>
 #include <unistd.h>
 #include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
 using namespace std;
 
 #include "joblisttypes.h"
@@ -58,6 +60,8 @@ using namespace execplan;
 #include "MonitorProcMem.h"
 using namespace idbdatafile;
 
+#include "threadpool.h"
+
 #ifdef _MSC_VER
 #define isnan _isnan
 #endif
@@ -68,9 +72,12 @@ namespace WriteEngine
 {
 StopWatch timer;
 
+unsigned WriteEngineWrapper::m_colWriteLanes = 4;
+
 /**@brief WriteEngineWrapper Constructor
 */
-WriteEngineWrapper::WriteEngineWrapper() :  m_opType(NOOP)
+WriteEngineWrapper::WriteEngineWrapper() :  m_opType(NOOP), m_lanePool(0),
+   m_isBulk(false), m_isFix(false)
 {
    m_colOp[UN_COMPRESSED_OP] = new ColumnOpCompress0;
    m_colOp[COMPRESSED_OP]    = new ColumnOpCompress1;
@@ -79,7 +86,8 @@ WriteEngineWrapper::WriteEngineWrapper() :  m_opType(NOOP)
    m_dctnry[COMPRESSED_OP]    = new DctnryCompress1;
 }
 
-WriteEngineWrapper::WriteEngineWrapper(const WriteEngineWrapper& rhs) :  m_opType(rhs.m_opType)
+WriteEngineWrapper::WriteEngineWrapper(const WriteEngineWrapper& rhs) :  m_opType(rhs.m_opType),
+   m_lanePool(0), m_isBulk(false), m_isFix(false)
 {
    m_colOp[UN_COMPRESSED_OP] = new ColumnOpCompress0;
    m_colOp[COMPRESSED_OP]    = new ColumnOpCompress1;
@@ -96,6 +104,11 @@ WriteEngineWrapper::~WriteEngineWrapper()
 	delete m_colOp[COMPRESSED_OP];
 	delete m_dctnry[UN_COMPRESSED_OP];
 	delete m_dctnry[COMPRESSED_OP];
+
+	// stop the lane threads before their ColumnOps go away
+	delete m_lanePool;
+	for (unsigned i = 0; i < m_laneColOp.size(); i++)
+		delete m_laneColOp[i];
 }
 
 /**@brief Perform upfront initialization
@@ -136,6 +149,17 @@ WriteEngineWrapper::~WriteEngineWrapper()
     {
         new boost::thread(utils::MonitorProcMem(maxPct, checkPct, subSystemID));
     }
+
+    //--------------------------------------------------------------------------
+    // DMLColumnWriteThreads. The number of columns of an update that are
+    // written at the same time. 1 writes them one after another. HDFS always
+    // writes serially since its tmp file handling is per ChunkManager.
+    //--------------------------------------------------------------------------
+    string strLanes = cf->getConfig("WriteEngine", "DMLColumnWriteThreads");
+    if ( strLanes.length() != 0 )
+        m_colWriteLanes = cf->uFromText(strLanes);
+    if (m_colWriteLanes == 0 || IDBPolicy::useHdfs())
+        m_colWriteLanes = 1;
 }
 
 /*@brief checkValid --Check input parameters are valid
@@ -446,6 +470,73 @@ void WriteEngineWrapper::convertValue(const ColType colType, void* valArray, con
    } // end of if
 }
 
+/***********************************************************
+ * DESCRIPTION:
+ *    Size a column batch for rowCount values of a column.
+ *    The internal type is worked out from colStruct the same
+ *    way insertColumnRecs() does it.
+ * PARAMETERS:
+ *    colStruct - column struct
+ *    colBatch - batch to initialize
+ *    rowCount - number of values the batch will hold
+ * RETURN:
+ *    none
+ ***********************************************************/
+void WriteEngineWrapper::initColBatch(const ColStruct& colStruct, ColBatch& colBatch, uint64_t rowCount)
+{
+   ColStruct curColStruct = colStruct;
+   Convertor::convertColType(&curColStruct);
+
+   colBatch.colType = curColStruct.colType;
+   switch (colBatch.colType)
+   {
+      case WriteEngine::WR_VARBINARY : // treat same as char for now
+      case WriteEngine::WR_CHAR:
+      case WriteEngine::WR_BLOB:
+         colBatch.stride = MAX_COLUMN_BOUNDARY;
+         break;
+      case WriteEngine::WR_BYTE:
+      case WriteEngine::WR_UBYTE:
+         colBatch.stride = 1;
+         break;
+      case WriteEngine::WR_SHORT:
+      case WriteEngine::WR_USHORT:
+         colBatch.stride = 2;
+         break;
+      case WriteEngine::WR_INT:
+      case WriteEngine::WR_UINT:
+      case WriteEngine::WR_FLOAT:
+         colBatch.stride = 4;
+         break;
+      case WriteEngine::WR_TOKEN:
+         colBatch.stride = sizeof(Token);
+         break;
+      default:
+         colBatch.stride = 8;
+         break;
+   }
+
+   colBatch.rowCount = rowCount;
+   colBatch.values.assign(rowCount * colBatch.stride, 0);
+   colBatch.strArena.clear();
+   colBatch.strOffsets.assign(1, 0);
+}
+
+/***********************************************************
+ * DESCRIPTION:
+ *    Store one value in a column batch
+ * PARAMETERS:
+ *    colBatch - batch set up by initColBatch()
+ *    row - position of the value
+ *    data - value, as returned by DataConvert
+ * RETURN:
+ *    none
+ ***********************************************************/
+void WriteEngineWrapper::setColBatchValue(ColBatch& colBatch, uint64_t row, boost::any& data)
+{
+   convertValue(colBatch.colType, &colBatch.values[0], row, data);
+}
+
 /*@createColumn -  Create column files, including data and bitmap files
  */
 /***********************************************************
@@ -518,8 +609,8 @@ int WriteEngineWrapper::fillColumn(const TxnID& txnid, const OID& dataOid,
    ColType  newColType;
    ColType  refColType;
    boost::scoped_array<char> defVal(new char[MAX_COLUMN_BOUNDARY]);
-   ColumnOp* colOpNewCol = m_colOp[op(compressionType)];
-   ColumnOp* refColOp = m_colOp[op(refCompressionType)];
+   ColumnOp* colOpNewCol = colOpFor(dataOid, compressionType);
+   ColumnOp* refColOp = colOpFor(refColOID, refCompressionType);
    Dctnry*   dctnry  = m_dctnry[op(compressionType)]; 
    colOpNewCol->initColumn(newCol);
    refColOp->initColumn(refCol);
@@ -606,7 +697,7 @@ int WriteEngineWrapper::fillColumn(const TxnID& txnid, const OID& dataOid,
      {
       curTupleList.clear();
       curColStruct = colStructList[i];
-      emptyVal = m_colOp[op(curColStruct.fCompressionType)]->
+      emptyVal = colOpFor(curColStruct.dataOid, curColStruct.fCompressionType)->
                      getEmptyRowValue(curColStruct.colDataType, curColStruct.colWidth);
 
       curTuple.data = emptyVal;
@@ -651,7 +742,7 @@ int WriteEngineWrapper::deleteBadRows(const TxnID& txnid, ColStructList& colStru
 	void*          valArray = NULL;
 	for (unsigned i = 0; i < colStructs.size(); i++)
 	{
-		ColumnOp* colOp = m_colOp[op(colStructs[i].fCompressionType)];
+		ColumnOp* colOp = colOpFor(colStructs[i].dataOid, colStructs[i].fCompressionType);
 		unsigned needFixFiles = colStructs[i].tokenFlag? 2:1;
 		colOp->initColumn(curCol);
 		for (unsigned j=0; j < needFixFiles; j++)
@@ -794,24 +885,84 @@ int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
 										bool isAutoCommitOn,
 										OID tableOid,
 										bool isFirstBatchPm)
+{
+   RIDList ridList;
+   // debug information for testing
+   if (isDebug(DEBUG_2)) {
+      printf("\nIn wrapper insert\n");
+      printInputValue(colStructList, colValueList, ridList);
+   }
+   // end
+
+   // Pack the values into typed column batches and insert those
+   ColTupleList::size_type totalRow = colValueList[0].size();
+   ColBatchList colBatchList(colStructList.size());
+   try {
+      for (unsigned i = 0; i < colStructList.size(); i++)
+      {
+         ColBatch& colBatch = colBatchList[i];
+         initColBatch(colStructList[i], colBatch, totalRow);
+         if (colStructList[i].tokenFlag)
+         {
+            for (ColTupleList::size_type j = 0; j < totalRow; j++)
+               colBatch.addString(dictStrList[i][j].c_str(), dictStrList[i][j].length());
+         }
+         else
+         {
+            convertValArray(totalRow, colBatch.colType, colValueList[i], colBatch.valuePtr(0));
+         }
+      }
+   }
+   catch(...) {
+      return ERR_PARSING;
+   }
+
+   return insertColumnRecs(txnid, colStructList, colBatchList, dctnryStructList,
+      dbRootExtentTrackers, fRBMetaWriter, bFirstExtentOnThisPM, insertSelect,
+      isAutoCommitOn, tableOid, isFirstBatchPm);
+}
+
+ /*@insertColumnRecs -  Insert column batches into a table
+ */
+/***********************************************************
+ * DESCRIPTION:
+ *    Insert typed column batches into columns (batchinsert).
+ *    Dictionary columns are tokenized straight into the batch
+ *    and the rows for a new extent are written from the tail
+ *    of each batch, so values are never copied per cell.
+ * PARAMETERS:
+ *    colStructList - column struct list
+ *    colBatchList - column batch list
+ * RETURN:
+ *    NO_ERROR if success
+ *    others if something wrong in inserting the value
+ ***********************************************************/
+
+int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
+                                        ColStructList& colStructList,
+                                        ColBatchList& colBatchList,
+                                        DctnryStructList& dctnryStructList,
+                                        std::vector<boost::shared_ptr<DBRootExtentTracker> > & dbRootExtentTrackers,
+										RBMetaWriter* fRBMetaWriter,
+										bool bFirstExtentOnThisPM,
+										bool insertSelect, 
+										bool isAutoCommitOn,
+										OID tableOid,
+										bool isFirstBatchPm)
 {
    int            rc;
    RID*           rowIdArray = NULL;
-   ColTupleList   curTupleList;
    Column         curCol;
    ColStruct      curColStruct;
-   ColValueList   colOldValueList;
-   ColValueList   colNewValueList;
    ColStructList  newColStructList;
    DctnryStructList newDctnryStructList;
    HWM            hwm = 0;
    HWM            oldHwm = 0;
    HWM    		  newHwm = 0;
-   ColTupleList::size_type totalRow;
+   uint64_t       totalRow;
    ColStructList::size_type totalColumns;
    uint64_t rowsLeft = 0;
    bool newExtent = false;
-   RIDList ridList;
    ColumnOp* colOp = NULL;
 
    // Set tmp file suffix to modify HDFS db file
@@ -826,12 +977,6 @@ int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
 #ifdef PROFILE
  StopWatch timer;
 #endif
-   // debug information for testing
-   if (isDebug(DEBUG_2)) {
-      printf("\nIn wrapper insert\n");
-      printInputValue(colStructList, colValueList, ridList);
-   }
-   // end
 
    //Convert data type and column width to write engine specific
    for (i = 0; i < colStructList.size(); i++)
@@ -902,7 +1047,7 @@ int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
 			cpInfo.seqNum = -1;	
 			for ( i=0; i < extents.size(); i++)
 			{
-				colOp = m_colOp[op(colStructList[i].fCompressionType)];
+				colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 				colOp->initColumn(curCol);
 				colOp->setColParam(curCol, 0, colStructList[i].colWidth, colStructList[i].colDataType,
 				colStructList[i].colType, colStructList[i].dataOid, colStructList[i].fCompressionType,
@@ -1052,8 +1197,7 @@ int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
 		}
 	}
 
-   curTupleList = static_cast<ColTupleList>(colValueList[0]);
-   totalRow = curTupleList.size();
+   totalRow = colBatchList[0].rowCount;
    totalColumns = colStructList.size();
    rowIdArray = new RID[totalRow];
    // use scoped_array to ensure ptr deletion regardless of where we return
@@ -1064,7 +1208,7 @@ int WriteEngineWrapper::insertColumnRecs(const TxnID& txnid,
 	// allocate row id(s)
 	//--------------------------------------------------------------------------
    curColStruct = colStructList[0];
-   colOp = m_colOp[op(curColStruct.fCompressionType)];
+   colOp = colOpFor(curColStruct.dataOid, curColStruct.fCompressionType);
 
    colOp->initColumn(curCol);
 
@@ -1138,7 +1282,7 @@ timer.stop("allocRowId");
        for (unsigned k=1; k<colStructList.size(); k++)
        {
            Column expandCol;
-           colOp = m_colOp[op(colStructList[k].fCompressionType)];
+           colOp = colOpFor(colStructList[k].dataOid, colStructList[k].fCompressionType);
            colOp->setColParam(expandCol, 0,
                colStructList[k].colWidth,
                colStructList[k].colDataType,
@@ -1168,58 +1312,12 @@ timer.stop("allocRowId");
 	// Tokenize data if needed
 	//--------------------------------------------------------------------------
    BRMWrapper::setUseVb( true );
-   dictStr::iterator dctStr_iter;
-   ColTupleList::iterator col_iter;
    for (i = 0; i < colStructList.size(); i++)
    {
       if (colStructList[i].tokenFlag)
       {
-         dctStr_iter = dictStrList[i].begin();
-         col_iter = colValueList[i].begin();
-         Dctnry* dctnry = m_dctnry[op(dctnryStructList[i].fCompressionType)];
-         rc = dctnry->openDctnry(dctnryStructList[i].dctnryOid,
-                     dctnryStructList[i].fColDbRoot, dctnryStructList[i].fColPartition,
-                     dctnryStructList[i].fColSegment,
-                     useTmpSuffix); // @bug 5572 HDFS tmp file
-         if (rc !=NO_ERROR)
-		 {
-			cout << "Error opening dctnry file " << dctnryStructList[i].dctnryOid<< endl;
-             return rc;
-		}
-
-         for (uint32_t     rows = 0; rows < (totalRow - rowsLeft); rows++)
-         {
-             if (dctStr_iter->length() == 0)
-               {
-                   Token nullToken;
-                 col_iter->data = nullToken;
-               }
-             else
-               {
-#ifdef PROFILE
-timer.start("tokenize");
-#endif
-                 DctnryTuple dctTuple;
-                 memcpy(dctTuple.sigValue, dctStr_iter->c_str(), dctStr_iter->length());
-                 dctTuple.sigSize = dctStr_iter->length();
-                 dctTuple.isNull = false;
-                   rc = tokenize(txnid, dctTuple, dctnryStructList[i].fCompressionType);
-                 if (rc != NO_ERROR)
-                 {
-                     dctnry->closeDctnry();
-                     return rc;
-                 }
-#ifdef PROFILE
-timer.stop("tokenize");
-#endif
-                   col_iter->data = dctTuple.token;
-               }
-               dctStr_iter++;
-               col_iter++;
-
-         }
-         //close dictionary files
-         rc = dctnry->closeDctnry(false);
+         rc = tokenizeColBatch(txnid, dctnryStructList[i], colBatchList[i],
+                               0, totalRow - rowsLeft, useTmpSuffix); // @bug 5572 HDFS tmp file
          if (rc != NO_ERROR)
              return rc;
 
@@ -1228,45 +1326,8 @@ timer.stop("tokenize");
 			//@Bug 4854 back up hwm chunk for the file to be modified
 			if (fRBMetaWriter)
 				fRBMetaWriter->backupDctnryHWMChunk(newDctnryStructList[i].dctnryOid, newDctnryStructList[i].fColDbRoot, newDctnryStructList[i].fColPartition, newDctnryStructList[i].fColSegment);
-             rc = dctnry->openDctnry(newDctnryStructList[i].dctnryOid,
-                           newDctnryStructList[i].fColDbRoot, newDctnryStructList[i].fColPartition,
-                           newDctnryStructList[i].fColSegment,
-                           false); // @bug 5572 HDFS tmp file
-             if (rc !=NO_ERROR)
-                 return rc;
-
-             for (uint32_t     rows = 0; rows < rowsLeft; rows++)
-             {
-             if (dctStr_iter->length() == 0)
-               {
-                   Token nullToken;
-                 col_iter->data = nullToken;
-               }
-             else
-               {
-#ifdef PROFILE
-timer.start("tokenize");
-#endif
-                 DctnryTuple dctTuple;
-                 memcpy(dctTuple.sigValue, dctStr_iter->c_str(), dctStr_iter->length());
-                 dctTuple.sigSize = dctStr_iter->length();
-                 dctTuple.isNull = false;
-                 rc = tokenize(txnid, dctTuple, newDctnryStructList[i].fCompressionType);
-                 if (rc != NO_ERROR)
-                 {
-                     dctnry->closeDctnry();
-                     return rc;
-                 }
-#ifdef PROFILE
-timer.stop("tokenize");
-#endif
-                     col_iter->data = dctTuple.token;
-                 }
-                 dctStr_iter++;
-                 col_iter++;
-             }
-             //close dictionary files
-             rc = dctnry->closeDctnry(false);
+             rc = tokenizeColBatch(txnid, newDctnryStructList[i], colBatchList[i],
+                                   totalRow - rowsLeft, rowsLeft, false); // @bug 5572 HDFS tmp file
              if (rc != NO_ERROR)
                  return rc;
          }
@@ -1296,7 +1357,7 @@ timer.stop("tokenize");
    //First column already processed
 
    //@Bug 1701. Close the file (if uncompressed)
-   m_colOp[op(curCol.compressionType)]->clearColumn(curCol);
+   colOpFor(curCol.dataFile.fid, curCol.compressionType)->clearColumn(curCol);
    //cout << "Saving hwm info for new ext batch" << endl;
    //Update hwm to set them in the end
     bool succFlag = false;
@@ -1368,30 +1429,6 @@ timer.stop("tokenize");
 	  tableMetaData->setColExtsInfo(colStructList[i].dataOid, aColExtsInfo);
     }
 		
-	//--------------------------------------------------------------------------
-	//Prepare the valuelist for the new extent
-	//--------------------------------------------------------------------------
-      ColTupleList colTupleList;
-      ColTupleList newColTupleList;
-      ColTupleList firstPartTupleList;
-      for (unsigned i=0; i < totalColumns; i++)
-      {
-         colTupleList = static_cast<ColTupleList>(colValueList[i]);
-         for (uint64_t j=rowsLeft; j > 0; j--)
-         {
-            newColTupleList.push_back(colTupleList[totalRow-j]);
-         }
-         colNewValueList.push_back(newColTupleList);
-         newColTupleList.clear();
-         //upate the oldvalue list for the old extent
-         for (uint64_t j=0; j < (totalRow-rowsLeft); j++)
-         {
-            firstPartTupleList.push_back(colTupleList[j]);
-         }
-         colOldValueList.push_back(firstPartTupleList);
-         firstPartTupleList.clear();
-      }
-
    // end of allocate row id
 
 #ifdef PROFILE
@@ -1415,7 +1452,7 @@ timer.start("writeColumnRec");
 		else {
 		for (unsigned i = 0; i < colStructList.size(); i++)
 		{
-			colOp = m_colOp[op(colStructList[i].fCompressionType)];
+			colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 			width = colStructList[i].colWidth;
 			successFlag = colOp->calculateRowId(lastRid , BYTE_PER_BLOCK/width, width, curFbo, curBio);
 			if (successFlag) {
@@ -1436,7 +1473,10 @@ timer.start("writeColumnRec");
 		//----------------------------------------------------------------------
 		// Write row(s) to database file(s)
 		//----------------------------------------------------------------------
-		rc = writeColumnRec(txnid, colStructList, colOldValueList, rowIdArray, newColStructList, colNewValueList, tableOid, useTmpSuffix); // @bug 5572 HDFS tmp file
+		//The first totalRow-rowsLeft rows of each batch go to the current extent,
+		//the rest to the new one.
+		rc = writeColumnRec(txnid, colStructList, colBatchList, rowIdArray, newColStructList,
+			totalRow - rowsLeft, rowsLeft, tableOid, useTmpSuffix); // @bug 5572 HDFS tmp file
 	}
    return rc;
 }
@@ -1497,7 +1537,7 @@ int WriteEngineWrapper::insertColumnRec_SYS(const TxnID& txnid,
 
    // allocate row id(s)
    curColStruct = colStructList[0];
-   colOp = m_colOp[op(curColStruct.fCompressionType)];
+   colOp = colOpFor(curColStruct.dataOid, curColStruct.fCompressionType);
 
    colOp->initColumn(curCol);
 
@@ -1616,7 +1656,7 @@ timer.start("allocRowId");
        for (unsigned k=1; k<colStructList.size(); k++)
        {
            Column expandCol;
-           colOp = m_colOp[op(colStructList[k].fCompressionType)];
+           colOp = colOpFor(colStructList[k].dataOid, colStructList[k].fCompressionType);
            colOp->setColParam(expandCol, 0,
                colStructList[k].colWidth,
                colStructList[k].colDataType,
@@ -1820,7 +1860,7 @@ timer.stop("tokenize");
    //if a new extent is created, all the columns in this table should have their own new extent
 
    //@Bug 1701. Close the file
-   m_colOp[op(curCol.compressionType)]->clearColumn(curCol);
+   colOpFor(curCol.dataFile.fid, curCol.compressionType)->clearColumn(curCol);
    std::vector<BulkSetHWMArg> hwmVecNewext;
    std::vector<BulkSetHWMArg> hwmVecOldext;
    if (newExtent) //Save all hwms to set them later.
@@ -1837,7 +1877,7 @@ timer.stop("tokenize");
 		 Column         curColLocal;
 		 colOp->initColumn(curColLocal);
 		 
-         colOp = m_colOp[op(newColStructList[i].fCompressionType)];
+         colOp = colOpFor(newColStructList[i].dataOid, newColStructList[i].fCompressionType);
          colOp->setColParam(curColLocal, 0,
             newColStructList[i].colWidth, newColStructList[i].colDataType,
             newColStructList[i].colType, newColStructList[i].dataOid,
@@ -1881,7 +1921,7 @@ timer.stop("tokenize");
 			aHwmEntryNew.hwm = curFbo;
 			hwmVecNewext.push_back(aHwmEntryNew); 
          }
-		 m_colOp[op(curColLocal.compressionType)]->clearColumn(curColLocal);
+		 colOpFor(curColLocal.dataFile.fid, curColLocal.compressionType)->clearColumn(curColLocal);
       }
 
       //Prepare the valuelist for the new extent
@@ -1918,7 +1958,7 @@ timer.stop("tokenize");
    {
       for (unsigned i = 0; i < colStructList.size(); i++)
       {
-         colOp = m_colOp[op(colStructList[i].fCompressionType)];
+         colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
          width = colStructList[i].colWidth;
          successFlag = colOp->calculateRowId(lastRid , BYTE_PER_BLOCK/width, width, curFbo, curBio);
          if (successFlag) {
@@ -1935,7 +1975,7 @@ timer.stop("tokenize");
    lastRid = rowIdArray[totalRow-1];
    for (unsigned i = 0; i < newColStructList.size(); i++)
    {
-      colOp = m_colOp[op(newColStructList[i].fCompressionType)];
+      colOp = colOpFor(newColStructList[i].dataOid, newColStructList[i].fCompressionType);
       width = newColStructList[i].colWidth;
       successFlag = colOp->calculateRowId(lastRid , BYTE_PER_BLOCK/width, width, curFbo, curBio);
       if (successFlag) 
@@ -1985,7 +2025,7 @@ timer.stop("writeColumnRec");
 	  std::vector<BulkSetHWMArg> hwmVec;
       for (unsigned i=0; i < totalColumns; i++)
       {
-         //colOp = m_colOp[op(colStructList[i].fCompressionType)];
+         //colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 		 //Set all columns hwm together
 		 BulkSetHWMArg aHwmEntry;
          RETURN_ON_ERROR(BRMWrapper::getInstance()->getLastHWM_DBroot(colStructList[i].dataOid, dbRoot, partitionNum, segmentNum, hwm,
@@ -2092,7 +2132,7 @@ StopWatch timer;
 	// allocate row id(s)
 	//--------------------------------------------------------------------------
 	curColStruct = colStructList[0];
-	colOp = m_colOp[op(curColStruct.fCompressionType)];
+	colOp = colOpFor(curColStruct.dataOid, curColStruct.fCompressionType);
 
 	colOp->initColumn(curCol);
 
@@ -2244,7 +2284,7 @@ timer.stop("allocRowId");
 		for (unsigned k=1; k<colStructList.size(); k++)
 		{
 			Column expandCol;
-			colOp = m_colOp[op(colStructList[k].fCompressionType)];
+			colOp = colOpFor(colStructList[k].dataOid, colStructList[k].fCompressionType);
 			colOp->setColParam(expandCol, 0,
 				colStructList[k].colWidth,
 				colStructList[k].colDataType,
@@ -2452,7 +2492,7 @@ timer.stop("tokenize");
 	//@Bug 1701. Close the file
 	if (bUseStartExtent)
 	{
-		m_colOp[op(curCol.compressionType)]->clearColumn(curCol);
+		colOpFor(curCol.dataFile.fid, curCol.compressionType)->clearColumn(curCol);
 	}
 
 	std::vector<BulkSetHWMArg> hwmVecNewext;
@@ -2468,7 +2508,7 @@ timer.stop("tokenize");
 
 		for (i=0; i < totalColumns; i++)
 		{
-			colOp = m_colOp[op(newColStructList[i].fCompressionType)];
+			colOp = colOpFor(newColStructList[i].dataOid, newColStructList[i].fCompressionType);
 
 			// @Bug 2714 need to set hwm for the old extent
 			colWidth = colStructList[i].colWidth;
@@ -2543,7 +2583,7 @@ timer.stop("tokenize");
 	{
 		for (unsigned i = 0; i < colStructList.size(); i++)
 		{
-			colOp = m_colOp[op(colStructList[i].fCompressionType)];
+			colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 			width = colStructList[i].colWidth;
 			successFlag = colOp->calculateRowId(lastRid ,
 				BYTE_PER_BLOCK/width, width, curFbo, curBio);
@@ -2563,7 +2603,7 @@ timer.stop("tokenize");
 	lastRid = rowIdArray[totalRow-1];
 	for (unsigned i = 0; i < colStructList.size(); i++)
 	{
-		colOp = m_colOp[op(colStructList[i].fCompressionType)];
+		colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 		width = colStructList[i].colWidth;
 		successFlag = colOp->calculateRowId(lastRid ,
 			BYTE_PER_BLOCK/width, width, curFbo, curBio);
@@ -2629,7 +2669,7 @@ timer.stop("writeColumnRec");
 		std::vector<BulkSetHWMArg> hwmVec;
 		for (unsigned i=0; i < totalColumns; i++)
 		{
-			//colOp = m_colOp[op(colStructList[i].fCompressionType)];
+			//colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 			//Set all columns hwm together
 			BulkSetHWMArg aHwmEntry;
 			RETURN_ON_ERROR(BRMWrapper::getInstance()->getLastHWM_DBroot(
@@ -2823,7 +2863,7 @@ int WriteEngineWrapper::processVersionBuffer(IDBDataFile* pFile, const TxnID& tx
    BRM::VER_t  verId = (BRM::VER_t) txnid;
    vector<uint32_t> fboList;
    LBIDRange   range;
-   ColumnOp* colOp = m_colOp[op(colStruct.fCompressionType)];
+   ColumnOp* colOp = colOpFor(colStruct.dataOid, colStruct.fCompressionType);
 
    for (int i = 0; i < totalRow; i++) {
       curRowId = rowIdArray[i];
@@ -2853,7 +2893,7 @@ int WriteEngineWrapper::processVersionBuffer(IDBDataFile* pFile, const TxnID& tx
 int WriteEngineWrapper::processVersionBuffers(IDBDataFile* pFile, const TxnID& txnid,
                                               const ColStruct& colStruct, int width,
                                               int totalRow, const RIDList& ridList,
-                                              vector<LBIDRange> &   rangeList)
+                                              vector<LBIDRange> &   rangeList, ColumnOp* colOp)
 {
    if (idbdatafile::IDBPolicy::useHdfs())
       return 0;
@@ -2867,7 +2907,6 @@ int WriteEngineWrapper::processVersionBuffers(IDBDataFile* pFile, const TxnID& t
    LBIDRange   range;
    vector<uint32_t> fboList;
    //vector<LBIDRange>   rangeList;
-   ColumnOp* colOp = m_colOp[op(colStruct.fCompressionType)];
    for (int i = 0; i < totalRow; i++) {
       curRowId = ridList[i];
       //cout << "processVersionBuffer got rid " << curRowId << endl;
@@ -2916,7 +2955,7 @@ int WriteEngineWrapper::processBeginVBCopy(const TxnID& txnid, const vector<ColS
 	vector<uint32_t> fboList;
    vector<LBIDRange>    rangeList;
    lastFbo = -1;
-	ColumnOp* colOp = m_colOp[op(colStructList[j].fCompressionType)];
+	ColumnOp* colOp = colOpFor(colStructList[j].dataOid, colStructList[j].fCompressionType);
 	
 	ColStruct curColStruct = colStructList[j];	
 	Convertor::convertColType(&curColStruct);
@@ -2965,7 +3004,7 @@ int WriteEngineWrapper::processBeginVBCopy(const TxnID& txnid, const vector<ColS
 	//open the column files
 	for ( unsigned i = 0; i < columns.size(); i++)
 	{
-		ColumnOp* colOp = m_colOp[op(columns[i].compressionType)];
+		ColumnOp* colOp = colOpFor(columns[i].dataFile.fid, columns[i].compressionType);
 		Column curCol;
 		// set params
 		colOp->initColumn(curCol);
@@ -3129,7 +3168,7 @@ int WriteEngineWrapper::processBeginVBCopy(const TxnID& txnid, const vector<ColS
       RID aRid = *rid_iter;
       for (unsigned j = 0; j< colStructList.size(); j++)
       {
-         colOp = m_colOp[op(colStructList[j].fCompressionType)];
+         colOp = colOpFor(colStructList[j].dataOid, colStructList[j].fCompressionType);
          if (colStructList[j].tokenFlag)
              continue;
 
@@ -3192,7 +3231,7 @@ int WriteEngineWrapper::updateColumnRecs(const TxnID& txnid,
 
     for (unsigned j = 0; j< colExtentsStruct.size(); j++)
     {
-        colOp = m_colOp[op(colExtentsStruct[j].fCompressionType)];
+        colOp = colOpFor(colExtentsStruct[j].dataOid, colExtentsStruct[j].fCompressionType);
         if (colExtentsStruct[j].tokenFlag)
             continue;
 
@@ -3229,12 +3268,7 @@ int WriteEngineWrapper::writeColumnRecords(const TxnID& txnid,
                                            ColValueList& colValueList,
                                            const RIDList& ridLists, const int32_t tableOid, bool versioning)
 {
-   bool           bExcp;
    int            rc = 0;
-   void*          valArray = NULL;
-   Column         curCol;
-   ColStruct      curColStruct;
-   ColTupleList   curTupleList;
    ColStructList::size_type  totalColumn;
    ColStructList::size_type  i;
    ColTupleList::size_type   totalRow;
@@ -3242,24 +3276,16 @@ int WriteEngineWrapper::writeColumnRecords(const TxnID& txnid,
    totalColumn = colStructList.size();
    totalRow = ridLists.size();
 
+   // Everything that touches shared state or can fail on the input is done
+   // up front, before any block gets versioned.
+   ColStructList curColStructList(colStructList);
+   ColBatchList colBatchList(totalColumn);
    TableMetaData* aTbaleMetaData = TableMetaData::makeTableMetaData(tableOid);
    for (i = 0; i < totalColumn; i++)
    {
-      valArray = NULL;
-      curColStruct = colStructList[i];
-      curTupleList = colValueList[i];
-      ColumnOp* colOp = m_colOp[op(curColStruct.fCompressionType)];
-
+      ColStruct& curColStruct = curColStructList[i];
       Convertor::convertColType(&curColStruct);
 
-      // set params
-      colOp->initColumn(curCol);
-
-      colOp->setColParam(curCol, 0, curColStruct.colWidth,
-         curColStruct.colDataType, curColStruct.colType, curColStruct.dataOid,
-         curColStruct.fCompressionType,
-         curColStruct.fColDbRoot, curColStruct.fColPartition, curColStruct.fColSegment);
-		 
 	  ColExtsInfo aColExtsInfo = aTbaleMetaData->getColExtsInfo(curColStruct.dataOid);
 	  ColExtsInfo::iterator it = aColExtsInfo.begin();
 	  while (it != aColExtsInfo.end())
@@ -3280,112 +3306,233 @@ int WriteEngineWrapper::writeColumnRecords(const TxnID& txnid,
 		aColExtsInfo.push_back(aExt);
 		aTbaleMetaData->setColExtsInfo(colStructList[i].dataOid, aColExtsInfo);
 	  }
-	
-      string segFile;
-      rc = colOp->openColumnFile(curCol, segFile, true); // @bug 5572 HDFS tmp file
-      if (rc != NO_ERROR)
-         break;
-	  vector<LBIDRange>   rangeList;
-	  if (versioning) {
-			rc = processVersionBuffers(curCol.dataFile.pFile, txnid, curColStruct,
-                                 curColStruct.colWidth, totalRow, ridLists, rangeList);
-	  }
 
-      if (rc != NO_ERROR) {
-		if (curColStruct.fCompressionType == 0)
-		{
-			curCol.dataFile.pFile->flush();
-		}
-    	BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-        break;
+      // convert values to a typed batch
+      ColBatch& colBatch = colBatchList[i];
+      initColBatch(colStructList[i], colBatch, totalRow);
+      try {
+         convertValArray(totalRow, colBatch.colType, colValueList[i], colBatch.valuePtr(0));
+      }
+      catch(...) {
+         return ERR_PARSING;
       }
+   }
 
-      switch (curColStruct.colType)
+   // Each column is versioned, decompressed, modified, recompressed and
+   // written independently of the others, so spread them over the lanes.
+   // A column goes to the same lane colOpFor() gives it on every other path.
+   unsigned lanes = m_colWriteLanes;
+   vector<unsigned> usedLanes;
+   for (unsigned i = 0; i < totalColumn; i++)
+   {
+      unsigned lane = (unsigned)curColStructList[i].dataOid % lanes;
+      if (find(usedLanes.begin(), usedLanes.end(), lane) == usedLanes.end())
+         usedLanes.push_back(lane);
+   }
+   if (usedLanes.empty())
+      return rc;
+
+   if (lanes > 1)
+      initColumnWriteLanes(txnid);
+
+   // The lanes share the transaction's DML log; a lane must not remove the
+   // backups of another lane's write in progress, so they are removed once
+   // all lanes are done.
+   if (usedLanes.size() > 1)
+      keepLaneBackups(true);
+   vector<int> laneRc(lanes, NO_ERROR);
+   for (unsigned i = 1; i < usedLanes.size(); i++)
+      m_lanePool->invoke(boost::bind(&WriteEngineWrapper::writeColumnLane, this, txnid, usedLanes[i],
+         lanes, boost::cref(curColStructList), boost::ref(colBatchList), boost::cref(ridLists),
+         versioning, &laneRc[usedLanes[i]]));
+   writeColumnLane(txnid, usedLanes[0], lanes, curColStructList, colBatchList, ridLists,
+      versioning, &laneRc[usedLanes[0]]);
+   if (usedLanes.size() > 1)
+      m_lanePool->wait();
+
+   for (unsigned lane = 0; lane < lanes; lane++)
+   {
+      if (laneRc[lane] != NO_ERROR)
       {
-         case WriteEngine::WR_INT:
-            valArray = (int*) calloc(sizeof(int), totalRow);
-            break;
-         case WriteEngine::WR_UINT:
-            valArray = (uint32_t*) calloc(sizeof(uint32_t), totalRow);
-            break;
-         case WriteEngine::WR_VARBINARY : // treat same as char for now
-         case WriteEngine::WR_CHAR:
-         case WriteEngine::WR_BLOB:
-            valArray = (char*) calloc(sizeof(char), totalRow * MAX_COLUMN_BOUNDARY);
-            break;
-         case WriteEngine::WR_FLOAT:
-            valArray = (float*) calloc(sizeof(float), totalRow);
-            break;
-         case WriteEngine::WR_DOUBLE:
-            valArray = (double*) calloc(sizeof(double), totalRow);
-            break;
-         case WriteEngine::WR_BYTE:
-            valArray = (char*) calloc(sizeof(char), totalRow);
-            break;
-         case WriteEngine::WR_UBYTE:
-            valArray = (uint8_t*) calloc(sizeof(uint8_t), totalRow);
-            break;
-         case WriteEngine::WR_SHORT:
-            valArray = (short*) calloc(sizeof(short), totalRow);
-            break;
-         case WriteEngine::WR_USHORT:
-            valArray = (uint16_t*) calloc(sizeof(uint16_t), totalRow);
-            break;
-         case WriteEngine::WR_LONGLONG:
-            valArray = (long long*) calloc(sizeof(long long), totalRow);
-            break;
-         case WriteEngine::WR_ULONGLONG:
-            valArray = (uint64_t*) calloc(sizeof(uint64_t), totalRow);
-            break;
-         case WriteEngine::WR_TOKEN:
-            valArray = (Token*) calloc(sizeof(Token), totalRow);
-            break;
+         rc = laneRc[lane];
+         break;
       }
+   }
 
-      // convert values to valArray
-      bExcp = false;
-      try {
-         convertValArray(totalRow, curColStruct.colType, curTupleList, valArray);
-      }
-      catch(...) {
-         bExcp = true;
+   if (usedLanes.size() > 1)
+   {
+      keepLaneBackups(false);
+      if (rc == NO_ERROR)
+         rc = m_colOp[COMPRESSED_OP]->chunkManager()->removeBackups(txnid);
+   }
+
+   return rc;
+}
+
+/*@brief writeColumnLane - Write the columns of one lane
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Write the columns of writeColumnRecords() that map to lane,
+ *    stopping at the first error. A column maps to its data OID
+ *    modulo lanes, as in colOpFor(), so a file is always handled by
+ *    the same lane.
+ * PARAMETERS:
+ *    lane - this lane
+ *    lanes - number of lanes (WriteEngine/DMLColumnWriteThreads)
+ *    rc - (out) NO_ERROR or the first error
+ ***********************************************************/
+void WriteEngineWrapper::writeColumnLane(const TxnID txnid, unsigned lane, unsigned lanes,
+                                         const ColStructList& colStructList,
+                                         ColBatchList& colBatchList,
+                                         const RIDList& ridList, bool versioning, int* rc)
+{
+   *rc = NO_ERROR;
+   try {
+      for (ColStructList::size_type i = 0; i < colStructList.size(); i++)
+      {
+         if ((unsigned)colStructList[i].dataOid % lanes != lane)
+            continue;
+
+         ColumnOp* colOp = laneColOp(lane, colStructList[i].fCompressionType);
+         *rc = writeColumnValues(txnid, colOp, colStructList[i], colBatchList[i], ridList, versioning);
+         if (*rc != NO_ERROR)
+            break;
       }
-      if (bExcp) {
-    	 BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-         return ERR_PARSING;
+   }
+   catch (...) {
+      *rc = ERR_UNKNOWN;
+   }
+}
+
+/*@brief writeColumnValues - Version and write one column
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Copy the blocks of the given rows to the version buffer,
+ *    then write the new values of the column
+ * PARAMETERS:
+ *    colOp - column operations to use for this column
+ *    colStruct - column struct, already converted
+ *    colBatch - the new values
+ *    ridList - row ids to update
+ * RETURN:
+ *    NO_ERROR if success
+ *    others if something wrong in writing the values
+ ***********************************************************/
+int WriteEngineWrapper::writeColumnValues(const TxnID& txnid, ColumnOp* colOp,
+                                          const ColStruct& curColStruct,
+                                          ColBatch& colBatch,
+                                          const RIDList& ridList, bool versioning)
+{
+   int            rc = NO_ERROR;
+   Column         curCol;
+   ColTupleList::size_type totalRow = ridList.size();
+
+   // set params
+   colOp->initColumn(curCol);
+
+   colOp->setColParam(curCol, 0, curColStruct.colWidth,
+      curColStruct.colDataType, curColStruct.colType, curColStruct.dataOid,
+      curColStruct.fCompressionType,
+      curColStruct.fColDbRoot, curColStruct.fColPartition, curColStruct.fColSegment);
+
+   string segFile;
+   rc = colOp->openColumnFile(curCol, segFile, true); // @bug 5572 HDFS tmp file
+   if (rc != NO_ERROR)
+      return rc;
+   vector<LBIDRange>   rangeList;
+   if (versioning) {
+      rc = processVersionBuffers(curCol.dataFile.pFile, txnid, curColStruct,
+                                 curColStruct.colWidth, totalRow, ridList, rangeList, colOp);
+   }
+
+   if (rc != NO_ERROR) {
+      if (curColStruct.fCompressionType == 0)
+      {
+         curCol.dataFile.pFile->flush();
       }
+      BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
+      return rc;
+   }
+
 #ifdef PROFILE
 timer.start("writeRow ");
 #endif
-      rc = colOp->writeRowsValues(curCol, totalRow, ridLists, valArray);
+   rc = colOp->writeRowsValues(curCol, totalRow, ridList, colBatch.valuePtr(0));
 #ifdef PROFILE
 timer.stop("writeRow ");
 #endif
-      colOp->clearColumn(curCol);
-	  if (curColStruct.fCompressionType == 0)
-	  {
-		std::vector<BRM::FileInfo> files;
-		BRM::FileInfo aFile;			
-		aFile.partitionNum = curColStruct.fColPartition;
-		aFile.dbRoot =curColStruct.fColDbRoot;;
-		aFile.segmentNum = curColStruct.fColSegment;
-		aFile.compType = curColStruct.fCompressionType;
-		files.push_back(aFile);
-		if (idbdatafile::IDBPolicy::useHdfs())
-			cacheutils::purgePrimProcFdCache(files, Config::getLocalModuleID());
-	  }
-	  BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-      if (valArray != NULL)
-         free(valArray);
-
-      // check error
-      if (rc != NO_ERROR)
-         break;
+   colOp->clearColumn(curCol);
+   if (curColStruct.fCompressionType == 0)
+   {
+      std::vector<BRM::FileInfo> files;
+      BRM::FileInfo aFile;			
+      aFile.partitionNum = curColStruct.fColPartition;
+      aFile.dbRoot =curColStruct.fColDbRoot;;
+      aFile.segmentNum = curColStruct.fColSegment;
+      aFile.compType = curColStruct.fCompressionType;
+      files.push_back(aFile);
+      if (idbdatafile::IDBPolicy::useHdfs())
+         cacheutils::purgePrimProcFdCache(files, Config::getLocalModuleID());
    }
+   BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
 
    return rc;
 }
 
+/*@brief initColumnWriteLanes - Create the extra write lanes
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Create the ColumnOps of lanes 1..n and the threads that run
+ *    them. Done once per WriteEngineWrapper, the lanes then keep
+ *    their ChunkManagers until the wrapper goes away.
+ ***********************************************************/
+void WriteEngineWrapper::initColumnWriteLanes(const TxnID& txnid)
+{
+   if (m_lanePool)
+      return;
+
+   // the lanes split WriteEngine/ChunkCacheMemory between them
+   ChunkManager* chunkManager = m_colOp[COMPRESSED_OP]->chunkManager();
+   bool isInsert = chunkManager->getIsInsert();
+   unsigned maxChunks = max(chunkManager->getMaxActiveChunkNum() / m_colWriteLanes, 2U);
+   chunkManager->setMaxActiveChunkNum(maxChunks);
+   for (unsigned lane = 1; lane < m_colWriteLanes; lane++)
+   {
+      ColumnOp* colOp[TOTAL_COMPRESS_OP];
+      colOp[UN_COMPRESSED_OP] = new ColumnOpCompress0;
+      colOp[COMPRESSED_OP]    = new ColumnOpCompress1;
+      for (int i = 0; i < TOTAL_COMPRESS_OP; i++)
+      {
+         colOp[i]->setTransId(txnid);
+         colOp[i]->setBulkFlag(m_isBulk);
+         colOp[i]->setFixFlag(m_isFix);
+         colOp[i]->setDebugLevel(getDebugLevel());
+         m_laneColOp.push_back(colOp[i]);
+      }
+      colOp[COMPRESSED_OP]->chunkManager()->setIsInsert(isInsert);
+      colOp[COMPRESSED_OP]->chunkManager()->setMaxActiveChunkNum(maxChunks);
+   }
+
+   m_lanePool = new threadpool::ThreadPool(m_colWriteLanes - 1, 0);
+}
+
+/*@brief keepLaneBackups - Hold back the removal of DML backups
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Set or clear the keep-backups flag of the compressed
+ *    ChunkManagers of all lanes.
+ ***********************************************************/
+void WriteEngineWrapper::keepLaneBackups(bool keep)
+{
+   m_colOp[COMPRESSED_OP]->chunkManager()->setKeepBackups(keep);
+   for (unsigned i = COMPRESSED_OP; i < m_laneColOp.size(); i += TOTAL_COMPRESS_OP)
+      m_laneColOp[i]->chunkManager()->setKeepBackups(keep);
+}
+
 /*@brief writeColumnRec - Write values to a column
 */
 /***********************************************************
@@ -3413,15 +3560,68 @@ int WriteEngineWrapper::writeColumnRec(const TxnID& txnid,
 									   bool useTmpSuffix,
 									   bool versioning)
 {
-   bool           bExcp;
+   ColTupleList::size_type totalRow1 = colValueList[0].size();
+   ColTupleList::size_type totalRow2 = 0;
+   if (newColValueList.size() > 0)
+      totalRow2 = newColValueList[0].size();
+
+   // Pack both extents' values of each column into one batch
+   ColBatchList colBatchList(colStructList.size());
+   for (ColStructList::size_type i = 0; i < colStructList.size(); i++)
+   {
+      ColBatch& colBatch = colBatchList[i];
+      initColBatch(colStructList[i], colBatch, totalRow1 + totalRow2);
+      if (m_opType == DELETE)
+         continue;
+      try {
+         convertValArray(totalRow1, colBatch.colType, colValueList[i], colBatch.valuePtr(0));
+         if (totalRow2 > 0)
+            convertValArray(totalRow2, colBatch.colType, newColValueList[i], colBatch.valuePtr(totalRow1));
+      }
+      catch(...) {
+         return ERR_PARSING;
+      }
+   }
+
+   return writeColumnRec(txnid, colStructList, colBatchList, rowIdArray, newColStructList,
+      totalRow1, totalRow2, tableOid, useTmpSuffix, versioning);
+}
+
+/*@brief writeColumnRec - Write column batches to a column
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Write values from typed column batches. The first
+ *    totalRow1 values of each batch go to the extents in
+ *    colStructList, the next totalRow2 to newColStructList.
+ * PARAMETERS:
+ *    tableOid - table object id
+ *    colStructList - column struct list
+ *    colBatchList - column batch list
+ *    rowIdArray -  row id list
+ *    newColStructList - the new extent struct list
+ *    useTmpSuffix - use temp suffix for db output file
+ * RETURN:
+ *    NO_ERROR if success
+ *    others if something wrong in inserting the value
+ ***********************************************************/
+int WriteEngineWrapper::writeColumnRec(const TxnID& txnid,
+                                       const ColStructList& colStructList,
+                                       ColBatchList& colBatchList,
+                                       RID* rowIdArray,
+                                       const ColStructList& newColStructList,
+                                       uint64_t totalRow1,
+                                       uint64_t totalRow2,
+									   const int32_t tableOid,
+									   bool useTmpSuffix,
+									   bool versioning)
+{
    int            rc = 0;
    void*          valArray;
    string         segFile;
    Column         curCol;
-   ColTupleList   oldTupleList;
    ColStructList::size_type  totalColumn;
    ColStructList::size_type  i;
-   ColTupleList::size_type   totalRow1, totalRow2;
 
    setTransId(txnid);
 
@@ -3429,17 +3629,6 @@ int WriteEngineWrapper::writeColumnRec(const TxnID& txnid,
 #ifdef PROFILE
 StopWatch timer;
 #endif
-   if (newColValueList.size() > 0)
-   { 
-       totalRow1 = colValueList[0].size();
-       totalRow2 = newColValueList[0].size();
-   }
-   else
-   {
-       totalRow1 = colValueList[0].size();
-       totalRow2 = 0;
-   }
-
 	TableMetaData* aTbaleMetaData = TableMetaData::makeTableMetaData(tableOid);
    for (i = 0; i < totalColumn; i++) {
       if (totalRow2 > 0)
@@ -3451,7 +3640,7 @@ StopWatch timer;
             //Write the first batch
             valArray = NULL;
             RID * firstPart = rowIdArray;
-            ColumnOp* colOp = m_colOp[op(colStructList[i].fCompressionType)];
+            ColumnOp* colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 
             // set params
             colOp->initColumn(curCol);
@@ -3502,65 +3691,10 @@ StopWatch timer;
 				}
             }
 
-            //totalRow1 -= totalRow2;
-            // have to init the size here
-            // nullArray = (bool*) malloc(sizeof(bool) * totalRow);
-            switch (colStructList[i].colType)
-            {
-               case WriteEngine::WR_INT:
-                  valArray = (int*) calloc(sizeof(int), totalRow1);
-                  break;
-               case WriteEngine::WR_UINT:
-                  valArray = (uint32_t*) calloc(sizeof(uint32_t), totalRow1);
-                  break;
-               case WriteEngine::WR_VARBINARY : // treat same as char for now
-               case WriteEngine::WR_CHAR:
-               case WriteEngine::WR_BLOB:
-                  valArray = (char*) calloc(sizeof(char), totalRow1 * MAX_COLUMN_BOUNDARY);
-                  break;
-               case WriteEngine::WR_FLOAT:
-                  valArray = (float*) calloc(sizeof(float), totalRow1);
-                  break;
-               case WriteEngine::WR_DOUBLE:
-                  valArray = (double*) calloc(sizeof(double), totalRow1);
-                  break;
-               case WriteEngine::WR_BYTE:
-                  valArray = (char*) calloc(sizeof(char), totalRow1);
-                  break;
-               case WriteEngine::WR_UBYTE:
-                  valArray = (uint8_t*) calloc(sizeof(uint8_t), totalRow1);
-                  break;
-               case WriteEngine::WR_SHORT:
-                  valArray = (short*) calloc(sizeof(short), totalRow1);
-                  break;
-               case WriteEngine::WR_USHORT:
-                  valArray = (uint16_t*) calloc(sizeof(uint16_t), totalRow1);
-                  break;
-               case WriteEngine::WR_LONGLONG:
-                  valArray = (long long*) calloc(sizeof(long long), totalRow1);
-                  break;
-               case WriteEngine::WR_ULONGLONG:
-                  valArray = (uint64_t*) calloc(sizeof(uint64_t), totalRow1);
-                  break;
-               case WriteEngine::WR_TOKEN:
-                  valArray = (Token*) calloc(sizeof(Token), totalRow1);
-                  break;
-            }
+            valArray = colBatchList[i].valuePtr(0);
 
-            // convert values to valArray
+            // values are already in valArray
             if (m_opType != DELETE) {
-               bExcp = false;
-               try {
-                 convertValArray(totalRow1, colStructList[i].colType, colValueList[i], valArray);
-               }
-               catch(...) {
-                  bExcp = true;
-               }
-               if (bExcp) {
-				  if (versioning)
-						BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-                  return ERR_PARSING;
-               }
 #ifdef PROFILE
 timer.start("writeRow ");
 #endif
@@ -3585,8 +3719,6 @@ timer.stop("writeRow ");
 			if (versioning)
 				BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
 				
-            if (valArray != NULL)
-               free(valArray);
 
             // check error
             if (rc != NO_ERROR)
@@ -3595,7 +3727,7 @@ timer.stop("writeRow ");
          //Process the second batch
          valArray = NULL;
 
-         ColumnOp* colOp = m_colOp[op(newColStructList[i].fCompressionType)];
+         ColumnOp* colOp = colOpFor(newColStructList[i].dataOid, newColStructList[i].fCompressionType);
 
          // set params
          colOp->initColumn(curCol);
@@ -3647,65 +3779,10 @@ timer.stop("writeRow ");
 			}
 		 }
 
-         //totalRow1 -= totalRow2;
-         // have to init the size here
-//       nullArray = (bool*) malloc(sizeof(bool) * totalRow);
-         switch (newColStructList[i].colType)
-         {
-            case WriteEngine::WR_INT:
-               valArray = (int*) calloc(sizeof(int), totalRow2);
-               break;
-            case WriteEngine::WR_UINT:
-               valArray = (uint32_t*) calloc(sizeof(uint32_t), totalRow2);
-               break;
-            case WriteEngine::WR_VARBINARY : // treat same as char for now
-            case WriteEngine::WR_CHAR:
-            case WriteEngine::WR_BLOB:
-               valArray = (char*) calloc(sizeof(char), totalRow2 * MAX_COLUMN_BOUNDARY);
-               break;
-            case WriteEngine::WR_FLOAT:
-               valArray = (float*) calloc(sizeof(float), totalRow2);
-               break;
-            case WriteEngine::WR_DOUBLE:
-               valArray = (double*) calloc(sizeof(double), totalRow2);
-               break;
-            case WriteEngine::WR_BYTE:
-               valArray = (char*) calloc(sizeof(char), totalRow2);
-               break;
-            case WriteEngine::WR_UBYTE:
-               valArray = (uint8_t*) calloc(sizeof(uint8_t), totalRow2);
-               break;
-            case WriteEngine::WR_SHORT:
-               valArray = (short*) calloc(sizeof(short), totalRow2);
-               break;
-            case WriteEngine::WR_USHORT:
-               valArray = (uint16_t*) calloc(sizeof(uint16_t), totalRow2);
-               break;
-            case WriteEngine::WR_LONGLONG:
-               valArray = (long long*) calloc(sizeof(long long), totalRow2);
-               break;
-            case WriteEngine::WR_ULONGLONG:
-               valArray = (uint64_t*) calloc(sizeof(uint64_t), totalRow2);
-               break;
-            case WriteEngine::WR_TOKEN:
-               valArray = (Token*) calloc(sizeof(Token), totalRow2);
-               break;
-         }
+         valArray = colBatchList[i].valuePtr(totalRow1);
 
-         // convert values to valArray
+         // values are already in valArray
          if (m_opType != DELETE) {
-            bExcp = false;
-            try {
-               convertValArray(totalRow2, newColStructList[i].colType, newColValueList[i], valArray);
-            }
-            catch(...) {
-               bExcp = true;
-            }
-            if (bExcp) {
-			   if (versioning)
-					BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-               return ERR_PARSING;
-            }
 #ifdef PROFILE
 timer.start("writeRow ");
 #endif
@@ -3730,8 +3807,6 @@ timer.stop("writeRow ");
 		 if (versioning)
 			BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
 			
-         if (valArray != NULL)
-            free(valArray);
 
          // check error
          if (rc != NO_ERROR)
@@ -3741,7 +3816,7 @@ timer.stop("writeRow ");
       {
          valArray = NULL;
 
-         ColumnOp* colOp = m_colOp[op(colStructList[i].fCompressionType)];
+         ColumnOp* colOp = colOpFor(colStructList[i].dataOid, colStructList[i].fCompressionType);
 
          // set params
          colOp->initColumn(curCol);
@@ -3790,64 +3865,10 @@ timer.stop("writeRow ");
 			}
 		}
 
-         // have to init the size here
-//       nullArray = (bool*) malloc(sizeof(bool) * totalRow);
-         switch (colStructList[i].colType)
-         {
-            case WriteEngine::WR_INT:
-               valArray = (int*) calloc(sizeof(int), totalRow1);
-               break;
-            case WriteEngine::WR_UINT:
-               valArray = (uint32_t*) calloc(sizeof(uint32_t), totalRow1);
-               break;
-            case WriteEngine::WR_VARBINARY : // treat same as char for now
-            case WriteEngine::WR_CHAR:
-            case WriteEngine::WR_BLOB:
-               valArray = (char*) calloc(sizeof(char), totalRow1 * MAX_COLUMN_BOUNDARY);
-               break;
-            case WriteEngine::WR_FLOAT:
-               valArray = (float*) calloc(sizeof(float), totalRow1);
-               break;
-            case WriteEngine::WR_DOUBLE:
-               valArray = (double*) calloc(sizeof(double), totalRow1);
-               break;
-            case WriteEngine::WR_BYTE:
-               valArray = (char*) calloc(sizeof(char), totalRow1);
-               break;
-            case WriteEngine::WR_UBYTE:
-               valArray = (uint8_t*) calloc(sizeof(uint8_t), totalRow1);
-               break;
-            case WriteEngine::WR_SHORT:
-               valArray = (short*) calloc(sizeof(short), totalRow1);
-               break;
-            case WriteEngine::WR_USHORT:
-               valArray = (uint16_t*) calloc(sizeof(uint16_t), totalRow1);
-               break;
-            case WriteEngine::WR_LONGLONG:
-               valArray = (long long*) calloc(sizeof(long long), totalRow1);
-               break;
-            case WriteEngine::WR_ULONGLONG:
-               valArray = (uint64_t*) calloc(sizeof(uint64_t), totalRow1);
-               break;
-            case WriteEngine::WR_TOKEN:
-               valArray = (Token*) calloc(sizeof(Token), totalRow1);
-               break;
-         }
+         valArray = colBatchList[i].valuePtr(0);
 
-         // convert values to valArray
+         // values are already in valArray
          if (m_opType != DELETE) {
-            bExcp = false;
-            try {
-              convertValArray(totalRow1, colStructList[i].colType, colValueList[i], valArray);
-            }
-            catch(...) {
-               bExcp = true;
-            }
-            if (bExcp) {
-				if (versioning)
-					BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-                return ERR_PARSING;
-            }
 #ifdef PROFILE
 timer.start("writeRow ");
 #endif
@@ -3871,8 +3892,6 @@ timer.stop("writeRow ");
 		 
 		 if (versioning)
 			BRMWrapper::getInstance()->writeVBEnd(txnid, rangeList);
-         if (valArray != NULL)
-            free(valArray);
 
          // check error
          if (rc != NO_ERROR)
@@ -3943,7 +3962,7 @@ StopWatch timer;
       valArray = NULL;
       curColStruct = colStructList[i];
       curTupleList = colValueList[i]; //same value for all rows
-      ColumnOp* colOp = m_colOp[op(curColStruct.fCompressionType)];
+      ColumnOp* colOp = colOpFor(curColStruct.dataOid, curColStruct.fCompressionType);
       // convert column data type
       if (convertStructFlag)
          Convertor::convertColType(&curColStruct);
@@ -4184,6 +4203,64 @@ int WriteEngineWrapper::tokenize(const TxnID& txnid, DctnryTuple& dctnryTuple, i
   return m_dctnry[cop]->updateDctnry(dctnryTuple.sigValue, dctnryTuple.sigSize, dctnryTuple.token);
 }
 
+/*@brief tokenizeColBatch - tokenize the strings of a column batch
+*/
+/***********************************************************
+ * DESCRIPTION:
+ *    Tokenize rowCount strings of a dictionary column batch,
+ *    starting at startRow, and store the tokens as the batch's
+ *    values. Strings are passed to the dictionary straight
+ *    from the batch's arena. An empty string gets a null token.
+ * PARAMETERS:
+ *    dctnryStruct - dictionary file to add the strings to
+ *    colBatch - batch holding the strings
+ *    startRow, rowCount - range of rows to tokenize
+ *    useTmpSuffix - use temp suffix for db output file
+ * RETURN:
+ *    NO_ERROR if success
+ *    others if something wrong in inserting the value
+ ***********************************************************/
+int WriteEngineWrapper::tokenizeColBatch(const TxnID& txnid,
+                                         const DctnryStruct& dctnryStruct,
+                                         ColBatch& colBatch,
+                                         uint64_t startRow, uint64_t rowCount,
+                                         bool useTmpSuffix)
+{
+   Dctnry* dctnry = m_dctnry[op(dctnryStruct.fCompressionType)];
+   int rc = dctnry->openDctnry(dctnryStruct.dctnryOid,
+                               dctnryStruct.fColDbRoot, dctnryStruct.fColPartition,
+                               dctnryStruct.fColSegment,
+                               useTmpSuffix); // @bug 5572 HDFS tmp file
+   if (rc != NO_ERROR)
+   {
+      cout << "Error opening dctnry file " << dctnryStruct.dctnryOid << endl;
+      return rc;
+   }
+
+   dctnry->setTransId(txnid);
+   Token* tokenArray = (Token*)colBatch.valuePtr(startRow);
+   for (uint64_t row = 0; row < rowCount; row++)
+   {
+      int sigSize;
+      unsigned char* sigValue = colBatch.stringAt(startRow + row, sigSize);
+      if (sigSize == 0)
+      {
+         tokenArray[row] = Token();
+         continue;
+      }
+
+      rc = dctnry->updateDctnry(sigValue, sigSize, tokenArray[row]);
+      if (rc != NO_ERROR)
+      {
+         dctnry->closeDctnry();
+         return rc;
+      }
+   }
+
+   //close dictionary files
+   return dctnry->closeDctnry(false);
+}
+
 /*@brief tokenize - return a token for a given signature and size
  *                          accept OIDs as input
 */
@@ -4347,6 +4424,12 @@ int WriteEngineWrapper::rollbackCommon(const TxnID& txnid, int sessionId)
     // BUG 4312
     RemoveTxnFromLBIDMap(txnid);
 
+    // Drop whatever the write lanes still cache for the failed statement;
+    // the chunks are recovered from the DML log below.
+    std::map<FID,FID> noOids;
+    for (unsigned i = 0; i < m_laneColOp.size(); i++)
+        m_laneColOp[i]->flushFile(ERR_UNKNOWN, noOids);
+
     config::Config *config = config::Config::makeConfig();
 	prefix = config->getConfig("SystemConfig", "DBRMRoot");
 	if (prefix.length() == 0) {
@@ -4672,6 +4755,14 @@ int WriteEngineWrapper::flushDataFiles(int rc, const TxnID txnId, std::map<FID,F
       }
    }
 
+   // the write lanes, which writeColumnRecords() and colOpFor() fill
+   for (unsigned i = 0; i < m_laneColOp.size(); i++)
+   {
+      int rc1 = m_laneColOp[i]->flushFile(rc, columnOids);
+      if (rc == NO_ERROR)
+         rc = rc1;
+   }
+
    return rc;
 }
 
@@ -49,6 +49,11 @@
 
 #define IO_BUFF_SIZE 81920
 
+namespace threadpool
+{
+class ThreadPool;
+}
+
 #if defined(_MSC_VER) && defined(WRITEENGINE_DLLEXPORT)
 #define EXPORT __declspec(dllexport)
 #else
@@ -304,6 +309,36 @@ public:
                                bool isAutoCommitOn = false,
                                OID tableOid = 0,
                                bool isFirstBatchPm = false);
+
+   /**
+    * @brief Insert values into a table from typed column batches
+    *
+    * Same as the ColValueList version above, but each column's values are
+    * already packed in a ColBatch (see initColBatch()) and dictionary
+    * strings are in the batch's string arena.
+    */
+   EXPORT int insertColumnRecs(const TxnID& txnid,
+                               ColStructList& colStructList,
+                               ColBatchList& colBatchList,
+                               DctnryStructList& dctnryStructList,
+                               std::vector<boost::shared_ptr<DBRootExtentTracker> > & dbRootExtentTrackers,
+                               RBMetaWriter* fRBMetaWriter,
+                               bool bFirstExtentOnThisPM,
+                               bool insertSelect = false,
+                               bool isAutoCommitOn = false,
+                               OID tableOid = 0,
+                               bool isFirstBatchPm = false);
+
+   /**
+    * @brief Size colBatch to hold rowCount values of the column in colStruct
+    */
+   EXPORT static void initColBatch(const ColStruct& colStruct, ColBatch& colBatch, uint64_t rowCount);
+
+   /**
+    * @brief Store data as value row of a non-dictionary column batch.
+    * Throws boost::bad_any_cast if data doesn't hold the column's type.
+    */
+   EXPORT void setColBatchValue(ColBatch& colBatch, uint64_t row, boost::any& data);
    
    /**
     * @brief Insert values into systables
@@ -377,6 +412,8 @@ public:
    { 
        m_colOp[COMPRESSED_OP]->chunkManager()->setIsInsert(bIsInsert); 
        m_dctnry[COMPRESSED_OP]->chunkManager()->setIsInsert(true); 
+       for (unsigned i = COMPRESSED_OP; i < m_laneColOp.size(); i += TOTAL_COMPRESS_OP)
+           m_laneColOp[i]->chunkManager()->setIsInsert(bIsInsert);
    }
    
    /**
@@ -402,6 +439,12 @@ public:
    { 
        int rtn1 = m_colOp[COMPRESSED_OP]->chunkManager()->flushChunks(rc, columOids); 
        int rtn2 = m_dctnry[COMPRESSED_OP]->chunkManager()->flushChunks(rc, columOids);
+       for (unsigned i = COMPRESSED_OP; i < m_laneColOp.size(); i += TOTAL_COMPRESS_OP)
+       {
+           int rtn3 = m_laneColOp[i]->chunkManager()->flushChunks(rc, columOids);
+           if (rtn1 == NO_ERROR)
+               rtn1 = rtn3;
+       }
 
        return (rtn1 != NO_ERROR ? rtn1 : rtn2);
    }
@@ -416,6 +459,8 @@ public:
            m_colOp[i]->setTransId(txnid);
            m_dctnry[i]->setTransId(txnid);
        }
+       for (unsigned i = 0; i < m_laneColOp.size(); i++)
+           m_laneColOp[i]->setTransId(txnid);
    }
 
 	/**
@@ -428,6 +473,9 @@ public:
            m_colOp[i]->setBulkFlag(isBulk);
            m_dctnry[i]->setBulkFlag(isBulk);
        }
+       for (unsigned i = 0; i < m_laneColOp.size(); i++)
+           m_laneColOp[i]->setBulkFlag(isBulk);
+       m_isBulk = isBulk;
    }
    
    	/**
@@ -440,6 +488,9 @@ public:
            m_colOp[i]->setFixFlag(isFix);
            m_dctnry[i]->setFixFlag(isFix);
        }
+       for (unsigned i = 0; i < m_laneColOp.size(); i++)
+           m_laneColOp[i]->setFixFlag(isFix);
+       m_isFix = isFix;
    }
    
 	/**
@@ -622,7 +673,7 @@ private:
     */
    int processVersionBuffers(IDBDataFile* pFile, const TxnID& txnid, const ColStruct& colStruct,
                              int width, int totalRow, const RIDList& ridList,
-                             std::vector<BRM::LBIDRange> &  rangeList);
+                             std::vector<BRM::LBIDRange> &  rangeList, ColumnOp* colOp);
 							 
    int processBeginVBCopy(const TxnID& txnid, const std::vector<ColStruct> & colStructList, const RIDList & ridList, 
 							std::vector<BRM::VBRange> & freeList, std::vector<std::vector<uint32_t> > & fboLists, 
@@ -636,6 +687,8 @@ private:
          m_colOp[i]->setDebugLevel(level);
          m_dctnry[i]->setDebugLevel(level);
       }
+      for (unsigned i = 0; i < m_laneColOp.size(); i++)
+         m_laneColOp[i]->setDebugLevel(level);
    }  // todo: cleanup
 
    /**
@@ -647,6 +700,19 @@ private:
                        ColValueList& newColValueList, const int32_t tableOid,
 					   bool useTmpSuffix, bool versioning = true);
 
+    int writeColumnRec(const TxnID& txnid, const ColStructList& colStructList,
+                       ColBatchList& colBatchList,
+                       RID* rowIdArray, const ColStructList& newColStructList,
+                       uint64_t totalRow1, uint64_t totalRow2, const int32_t tableOid,
+                       bool useTmpSuffix, bool versioning = true);
+
+    /**
+     * @brief Tokenize rowCount strings of colBatch starting at startRow into
+     * the batch's token values
+     */
+    int tokenizeColBatch(const TxnID& txnid, const DctnryStruct& dctnryStruct,
+                         ColBatch& colBatch, uint64_t startRow, uint64_t rowCount,
+                         bool useTmpSuffix);
 
 
     //@Bug 1886,2870 pass the address of ridList vector
@@ -660,6 +726,52 @@ private:
                            ColValueList& colValueList, const RIDList & ridLists, 
 						   const int32_t tableOid, bool versioning = true);
 
+    /**
+     * @brief Version and write the values of one column of writeColumnRecords()
+     */
+    int writeColumnValues(const TxnID& txnid, ColumnOp* colOp, const ColStruct& colStruct,
+                          ColBatch& colBatch, const RIDList& ridList, bool versioning);
+
+    /**
+     * @brief Write the columns of writeColumnRecords() that belong to one lane
+     */
+    void writeColumnLane(const TxnID txnid, unsigned lane, unsigned lanes,
+                         const ColStructList& colStructList, ColBatchList& colBatchList,
+                         const RIDList& ridList, bool versioning, int* rc);
+
+    /**
+     * @brief Column operations of a write lane. Lane 0 is m_colOp.
+     */
+    ColumnOp* laneColOp(unsigned lane, int compressionType)
+    {
+        if (lane == 0)
+            return m_colOp[op(compressionType)];
+        return m_laneColOp[(lane - 1) * TOTAL_COMPRESS_OP + op(compressionType)];
+    }
+
+    /**
+     * @brief Column operations for the files of a column. Every write path
+     * uses these, so a column file is only ever cached in the ChunkManager
+     * of lane dataOid % m_colWriteLanes.
+     */
+    ColumnOp* colOpFor(OID dataOid, int compressionType)
+    {
+        unsigned lane = (unsigned)dataOid % m_colWriteLanes;
+        if (lane != 0)
+            initColumnWriteLanes(m_colOp[UN_COMPRESSED_OP]->getTransId());
+        return laneColOp(lane, compressionType);
+    }
+
+    /**
+     * @brief Create the extra write lanes and their threads on first use
+     */
+    void initColumnWriteLanes(const TxnID& txnid);
+
+    /**
+     * @brief Keep the DML backups of all lanes while they write in parallel
+     */
+    void keepLaneBackups(bool keep);
+
     /**
     * @brief util method to convert rowid to a column file
     *
@@ -689,6 +801,18 @@ private:
     Dctnry*        m_dctnry[TOTAL_COMPRESS_OP];         // dictionary operations
     OpType         m_opType;                            // operation type
     DebugLevel     m_debugLevel;                        // debug level
+
+    // Column operations of write lanes 1..n, TOTAL_COMPRESS_OP per lane.
+    // writeColumnRecords() writes the columns of an update on these in
+    // parallel. A column file always maps to the same lane (colOpFor()), so
+    // each file stays with one ChunkManager until flushChunks() or
+    // flushDataFiles().
+    std::vector<ColumnOp*> m_laneColOp;
+    threadpool::ThreadPool* m_lanePool;                 // runs lanes 1..n
+    bool           m_isBulk;                            // last setBulkFlag()
+    bool           m_isFix;                             // last setFixFlag()
+
+    static unsigned m_colWriteLanes;                    // WriteEngine/DMLColumnWriteThreads
 };
 
 } //end of namespace
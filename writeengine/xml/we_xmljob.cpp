@@ -165,6 +165,8 @@ void XMLJob::printJobInfo( Log& logger ) const
         oss2 << "\tTable Load Name : " << jobTable.loadFileName <<
                 endl;
         oss2 << "\tMax Err Num     : " << jobTable.maxErrNum << endl;
+        if (!jobTable.sortKey.empty())
+            oss2 << "\tSort Key        : " << jobTable.sortKey << endl;
          
         const JobColList& colList = jobTable.colList;
 
@@ -484,6 +486,9 @@ void XMLJob::setJobDataTable( xmlNode* pNode )
         TYPE_INT))
         curTable.maxErrNum = intVal;
 
+    if( getNodeAttributeStr( pNode, xmlTagTable[TAG_SORT_KEY], bufString ) )
+        curTable.sortKey = bufString;
+
     fJob.jobTableList.push_back( curTable );
 }
 
@@ -69,6 +69,7 @@ namespace WriteEngine
       TAG_ORIG_NAME, //@bug 3599: deprecated; kept for backwards compatibility
       TAG_PRECISION,
       TAG_SCALE,
+      TAG_SORT_KEY,
       TAG_TBL_NAME,
       TAG_TBL_OID,
       TAG_WIDTH,
@@ -115,6 +116,7 @@ namespace WriteEngine
       "origName", //@bug 3599: deprecated; kept for backwards compatibility
       "precision",
       "scale",
+      "sortKey",
       "tblName",  //@bug 3599: replaces origName
       "tblOid",
       "width",